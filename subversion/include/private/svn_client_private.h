@@ -383,6 +383,30 @@ svn_client__get_diff_writer_svn(
                 svn_client_ctx_t *ctx,
                 apr_pool_t *pool);
 
+/** Let the diff writer @a diff_processor, as returned by
+ * svn_client__get_diff_writer_svn(), compute text diffs of larger files
+ * on worker threads.  The output of each node is buffered until it can
+ * be written to the writer's output stream in traversal order.
+ *
+ * The caller must call svn_client__diff_writer_flush() once the diff
+ * drive has been completed.  This is a no-op without thread support or
+ * if an external diff command is being used.
+ *
+ * Use @a scratch_pool for temporary allocations.
+ */
+svn_error_t *
+svn_client__diff_writer_parallelize(svn_diff_tree_processor_t *diff_processor,
+                                    apr_pool_t *scratch_pool);
+
+/** Wait for all text diffs queued by the diff writer @a diff_processor
+ * and write all buffered output to the writer's output stream.
+ *
+ * Use @a scratch_pool for temporary allocations.
+ */
+svn_error_t *
+svn_client__diff_writer_flush(svn_diff_tree_processor_t *diff_processor,
+                              apr_pool_t *scratch_pool);
+
 /*** Editor for diff summary ***/
 
 /* Set *DIFF_PROCESSOR to a diff processor that will report a diff summary
@@ -108,6 +108,29 @@ svn_txdelta__read_raw_window_len(apr_size_t *window_len,
                                  svn_stream_t *stream,
                                  apr_pool_t *pool);
 
+/** Callback type for svn_txdelta__stream_create_stored().  If the delta
+    data is available in svndiff format version @a max_version or lower,
+    set @a *svndiff to a stream of the complete svndiff data, including
+    the header.  Otherwise, set it to NULL.  Allocate the stream in
+    @a pool. */
+typedef svn_error_t *
+(*svn_txdelta__svndiff_func_t)(svn_stream_t **svndiff,
+                               void *baton,
+                               int max_version,
+                               apr_pool_t *pool);
+
+/** Like svn_txdelta_stream_create() but for deltas that are already
+    stored in svndiff format.  Unless windows have been read from the
+    stream, svn_txdelta_send_txstream() will get that data from
+    @a svndiff_func and forward it as-is to svndiff encoders created by
+    svn_txdelta_to_svndiff3(), instead of parsing and re-encoding it. */
+svn_txdelta_stream_t *
+svn_txdelta__stream_create_stored(void *baton,
+                                  svn_txdelta_next_window_fn_t next_window,
+                                  svn_txdelta_md5_digest_fn_t md5_digest,
+                                  svn_txdelta__svndiff_func_t svndiff_func,
+                                  apr_pool_t *pool);
+
 /* Return a debug editor that wraps @a wrapped_editor.
  *
  * The debug editor simply prints an indication of what callbacks are being
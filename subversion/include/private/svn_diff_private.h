@@ -30,6 +30,7 @@
 
 #include "svn_types.h"
 #include "svn_io.h"
+#include "svn_diff.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -148,6 +149,72 @@ svn_diff_hunk__create_deletes_single_line(svn_diff_hunk_t **hunk,
 svn_linenum_t
 svn_diff_hunk__get_fuzz_penalty(const svn_diff_hunk_t *hunk);
 
+
+/*** Blame ***/
+
+/** One chunk of blame: the tokens (lines) from @a start up to the start
+ * of the next chunk, or up to the end of the file for the last chunk,
+ * are to be blamed on @a rev.
+ *
+ * @a rev is an opaque, caller-defined descriptor of the responsible
+ * revision and may be NULL.
+ */
+typedef struct svn_diff__blame_chunk_t
+{
+  const void *rev;
+  apr_off_t start;
+  struct svn_diff__blame_chunk_t *next;
+} svn_diff__blame_chunk_t;
+
+/** A chain of blame chunks for one version of a file.
+ */
+typedef struct svn_diff__blame_chain_t
+{
+  /** Linked list of blame chunks, NULL for an empty chain.  A non-empty
+   * chain always starts at token 0. */
+  svn_diff__blame_chunk_t *blame;
+
+  /** Linked list of free blame chunks. */
+  svn_diff__blame_chunk_t *avail;
+
+  /** Allocate chunks from this pool. */
+  apr_pool_t *pool;
+} svn_diff__blame_chain_t;
+
+/** Return a new, empty blame chain allocated in @a result_pool.  Its
+ * chunks will be allocated in @a result_pool as well.
+ */
+svn_diff__blame_chain_t *
+svn_diff__blame_chain_create(apr_pool_t *result_pool);
+
+/** Return a blame chunk for @a rev starting at token @a start.  Its
+ * @a next member is NULL.  Allocate it from @a chain.
+ */
+svn_diff__blame_chunk_t *
+svn_diff__blame_chunk_create(svn_diff__blame_chain_t *chain,
+                             const void *rev,
+                             apr_off_t start);
+
+/** Update the blame in @a chain for the changes between the file at
+ * @a last_file and the file at @a cur_file, blaming all tokens added or
+ * modified in @a cur_file on @a rev.  @a last_file may be NULL, in
+ * which case @a chain must be empty and all of @a cur_file will be
+ * blamed on @a rev.
+ *
+ * Diff the files according to @a diff_options.  Call @a cancel_func
+ * with @a cancel_baton to allow for cancellation.  Use @a scratch_pool
+ * for temporary allocations.
+ */
+svn_error_t *
+svn_diff__blame_add_file(svn_diff__blame_chain_t *chain,
+                         const char *last_file,
+                         const char *cur_file,
+                         const void *rev,
+                         const svn_diff_file_options_t *diff_options,
+                         svn_cancel_func_t cancel_func,
+                         void *cancel_baton,
+                         apr_pool_t *scratch_pool);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
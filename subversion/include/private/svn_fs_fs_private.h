@@ -364,6 +364,19 @@ typedef struct svn_fs_fs__ioctl_build_rep_cache_input_t
 /* See svn_fs_fs__build_rep_cache(). */
 SVN_FS_DECLARE_IOCTL_CODE(SVN_FS_FS__IOCTL_BUILD_REP_CACHE, SVN_FS_TYPE_FSFS, 1004);
 
+/* See svn_fs_fs__bulk_load_checkpoint().  No input or output. */
+SVN_FS_DECLARE_IOCTL_CODE(SVN_FS_FS__IOCTL_BULK_LOAD_CHECKPOINT, SVN_FS_TYPE_FSFS, 1005);
+
+typedef struct svn_fs_fs__ioctl_read_ahead_stats_output_t
+{
+  /* Number of chunks of file contents that this FS instance delivered
+     through SVN_FS_CONFIG_FSFS_READ_AHEAD so far. */
+  apr_uint32_t chunks;
+} svn_fs_fs__ioctl_read_ahead_stats_output_t;
+
+/* Read-ahead statistics of the FS instance.  No input. */
+SVN_FS_DECLARE_IOCTL_CODE(SVN_FS_FS__IOCTL_READ_AHEAD_STATS, SVN_FS_TYPE_FSFS, 1006);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -211,6 +211,18 @@ svn_fs__get_deleted_node(svn_fs_root_t **node_root,
                          apr_pool_t *result_pool,
                          apr_pool_t *scratch_pool);
 
+/** Set @a *instance_id to the instance ID of the filesystem @a fs,
+ * allocated in @a result_pool.  The instance ID changes whenever a
+ * filesystem gets re-created, even if it keeps its path and UUID, and
+ * may therefore be used as part of cache keys that must not survive
+ * such a replacement.  Set @a *instance_id to NULL if the backend does
+ * not support instance IDs.
+ */
+svn_error_t *
+svn_fs__get_instance_id(const char **instance_id,
+                        svn_fs_t *fs,
+                        apr_pool_t *result_pool);
+
 
 /** @} */
 
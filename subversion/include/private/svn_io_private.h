@@ -85,6 +85,19 @@ svn_io__file_lock_autocreate(const char *lock_file,
                              apr_pool_t *pool);
 
 
+/** Tell the OS that the @a length bytes at @a offset in @a file will be
+ * read soon, so it can start reading them in the background.  Other I/O
+ * on @a file is not affected.
+ *
+ * This is only a hint.  It does nothing on platforms without
+ * posix_fadvise().
+ */
+void
+svn_io__file_prefetch(apr_file_t *file,
+                      apr_off_t offset,
+                      apr_off_t length);
+
+
 /** Return the underlying file, if any, associated with the stream, or
  * NULL if not available.  Accessing the file bypasses the stream.
  */
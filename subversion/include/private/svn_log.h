@@ -85,6 +85,16 @@ svn_log__get_file(const char *path, svn_revnum_t rev,
                   svn_boolean_t want_contents, svn_boolean_t want_props,
                   apr_pool_t *pool);
 
+/**
+ * Return a log string for a get-files action on all @a paths.
+ *
+ * @since New in 1.15.
+ */
+const char *
+svn_log__get_files(const apr_array_header_t *paths, svn_revnum_t rev,
+                   svn_boolean_t want_contents, svn_boolean_t want_props,
+                   apr_pool_t *pool);
+
 /**
  * Return a log string for a get-dir action.
  *
@@ -96,6 +106,15 @@ svn_log__get_dir(const char *path, svn_revnum_t rev,
                  apr_uint32_t dirent_fields,
                  apr_pool_t *pool);
 
+/**
+ * Return a log string for a stat-many action on all @a paths.
+ *
+ * @since New in 1.15.
+ */
+const char *
+svn_log__stat_many(const apr_array_header_t *paths, svn_revnum_t rev,
+                   apr_pool_t *pool);
+
 /**
  * Return a log string for a get-mergeinfo action.
  *
@@ -198,6 +217,16 @@ svn_log__get_file_revs(const char *path, svn_revnum_t start, svn_revnum_t end,
                        svn_boolean_t include_merged_revisions,
                        apr_pool_t *pool);
 
+/**
+ * Return a log string for a get-file-blame action.
+ *
+ * @since New in 1.15.
+ */
+const char *
+svn_log__get_file_blame(const char *path,
+                        svn_revnum_t start, svn_revnum_t end,
+                        apr_pool_t *pool);
+
 /**
  * Return a log string for a lock action.
  *
@@ -32,6 +32,7 @@
 #include "svn_error.h"
 #include "svn_ra.h"
 #include "svn_delta.h"
+#include "svn_diff.h"
 #include "svn_editor.h"
 #include "svn_io.h"
 
@@ -154,6 +155,164 @@ svn_ra__release_operational_lock(svn_ra_session_t *session,
                                  const svn_string_t *mylocktoken,
                                  apr_pool_t *scratch_pool);
 
+
+/*** Batched Requests ***/
+
+/** Callback type for svn_ra__stat_many(), reporting the @a dirent of
+ * @a path, which is one of the paths passed to svn_ra__stat_many().
+ * @a dirent is NULL if @a path does not exist.
+ *
+ * Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+typedef svn_error_t *(*svn_ra__stat_receiver_t)(void *baton,
+                                                const char *path,
+                                                const svn_dirent_t *dirent,
+                                                apr_pool_t *scratch_pool);
+
+/** Like calling svn_ra_stat() in @a revision for each of the @a paths
+ * (relpaths relative to the session URL, as <tt>const char *</tt>), but
+ * invoke @a receiver with @a receiver_baton for each of them, in order,
+ * as soon as its result is available.
+ *
+ * Servers that support it answer all @a paths in a single round trip.
+ * With all others, this falls back to individual svn_ra_stat() calls.
+ *
+ * Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_ra__stat_many(svn_ra_session_t *session,
+                  const apr_array_header_t *paths,
+                  svn_revnum_t revision,
+                  svn_ra__stat_receiver_t receiver,
+                  void *receiver_baton,
+                  apr_pool_t *scratch_pool);
+
+/** Callback type for svn_ra__get_files(), asking for the stream to write
+ * the contents of @a path to, which is one of the paths passed to
+ * svn_ra__get_files().  Set @a *stream to NULL to discard the contents.
+ *
+ * The stream will be closed after all contents have been written.
+ * Allocate it in @a result_pool, which will be cleared after the
+ * file has been processed.  Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+typedef svn_error_t *(*svn_ra__file_stream_func_t)(svn_stream_t **stream,
+                                                   void *baton,
+                                                   const char *path,
+                                                   apr_pool_t *result_pool,
+                                                   apr_pool_t *scratch_pool);
+
+/** Callback type for svn_ra__get_files(), called for @a path after its
+ * contents have been written.  @a fetched_rev is the revision of the
+ * file and @a props are its properties, or NULL if they have not been
+ * requested.
+ *
+ * Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+typedef svn_error_t *(*svn_ra__file_receiver_t)(void *baton,
+                                                const char *path,
+                                                svn_revnum_t fetched_rev,
+                                                apr_hash_t *props,
+                                                apr_pool_t *scratch_pool);
+
+/** Like calling svn_ra_get_file() in @a revision for each of the @a paths
+ * (relpaths relative to the session URL, as <tt>const char *</tt>), but
+ * process the files in order as they arrive.
+ *
+ * If @a stream_func is not NULL, call it with @a baton before each file
+ * to get the stream to write the contents to.  Otherwise, don't fetch
+ * any contents.  Fetch the properties only if @a want_props is set.
+ * Call @a receiver with @a baton once each file has been processed.
+ *
+ * Servers that support it send all files in a single response.  With
+ * all others, this falls back to individual svn_ra_get_file() calls.
+ * It is an error if any of @a paths is not a file.
+ *
+ * Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_ra__get_files(svn_ra_session_t *session,
+                  const apr_array_header_t *paths,
+                  svn_revnum_t revision,
+                  svn_boolean_t want_props,
+                  svn_ra__file_stream_func_t stream_func,
+                  svn_ra__file_receiver_t receiver,
+                  void *baton,
+                  apr_pool_t *scratch_pool);
+
+
+/*** Server-side Blame ***/
+
+/** Callback type for svn_ra__get_file_blame(), reporting a version of
+ * the file: @a path (relative to the repository root, with a leading
+ * slash) in @a revision with the revision properties @a rev_props.
+ *
+ * @since New in 1.15.
+ */
+typedef svn_error_t *(*svn_ra__blame_rev_func_t)(void *baton,
+                                                 const char *path,
+                                                 svn_revnum_t revision,
+                                                 apr_hash_t *rev_props,
+                                                 apr_pool_t *scratch_pool);
+
+/** Callback type for svn_ra__get_file_blame(), reporting a range of
+ * lines with the same origin.  The range starts at the 0-based line
+ * number @a line_start and extends up to the start of the next range,
+ * or up to the end of the file for the last range.  @a revision is
+ * #SVN_INVALID_REVNUM for lines that are older than the blamed range.
+ *
+ * @since New in 1.15.
+ */
+typedef svn_error_t *(*svn_ra__blame_chunk_func_t)(void *baton,
+                                                   apr_int64_t line_start,
+                                                   svn_revnum_t revision,
+                                                   apr_pool_t *scratch_pool);
+
+/** Let the server determine for each line of the file at @a path
+ * (relative to the session URL) in revision @a end the revision between
+ * @a start and @a end that last changed it.  Compare subsequent versions
+ * of the file according to @a diff_options.
+ *
+ * First call @a rev_func for every version of the file that
+ * svn_ra_get_file_revs2() would report, oldest first, including the last
+ * version before @a start, if any.  Then call @a chunk_func for every
+ * range of lines of the file in @a end, ordered by line number.  Pass
+ * @a baton to both.  Finally, write the contents of the file in @a end
+ * to @a contents.
+ *
+ * @a start must not be greater than @a end.  Merged revisions are not
+ * taken into account.
+ *
+ * Return #SVN_ERR_RA_NOT_IMPLEMENTED before calling any callback if the
+ * server can't do that.  The caller is expected to fall back to
+ * svn_ra_get_file_revs2() then.
+ *
+ * Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_ra__get_file_blame(svn_ra_session_t *session,
+                       const char *path,
+                       svn_revnum_t start,
+                       svn_revnum_t end,
+                       const svn_diff_file_options_t *diff_options,
+                       svn_ra__blame_rev_func_t rev_func,
+                       svn_ra__blame_chunk_func_t chunk_func,
+                       void *baton,
+                       svn_stream_t *contents,
+                       apr_pool_t *scratch_pool);
+
+
 /** Register CALLBACKS to be used with the Ev2 shims in RA_SESSION. */
 svn_error_t *
 svn_ra__register_editor_shim_callbacks(svn_ra_session_t *ra_session,
@@ -390,6 +390,165 @@ svn_repos__get_dump_editor(const svn_delta_editor_t **editor,
                            const char *update_anchor_relpath,
                            apr_pool_t *pool);
 
+/**
+ * Like svn_repos_dump_fs4() but dump the revisions in segments of
+ * consecutive revisions, using up to @a jobs worker threads.
+ *
+ * Every worker opens its own instance of @a repos with the given
+ * @a fs_config and sets @a warning_func with @a warning_baton as its
+ * filesystem warning handler.  The process-wide cache must therefore
+ * not be configured as single-threaded.  The segments are written to
+ * temporary files and appended to @a stream in revision order.  Only a
+ * few segments per job are buffered at any time.  The result is
+ * identical to what svn_repos_dump_fs4() would produce, including
+ * @a incremental and @a use_deltas dumps.
+ *
+ * @a notify_func and @a cancel_func are only called from the current
+ * thread, the notifications being sent once a segment has been written.
+ * @a filter_func and @a warning_func, however, must be thread-safe.
+ */
+svn_error_t *
+svn_repos__dump_fs_parallel(svn_repos_t *repos,
+                            apr_hash_t *fs_config,
+                            svn_fs_warning_callback_t warning_func,
+                            void *warning_baton,
+                            svn_stream_t *stream,
+                            svn_revnum_t start_rev,
+                            svn_revnum_t end_rev,
+                            svn_boolean_t incremental,
+                            svn_boolean_t use_deltas,
+                            svn_boolean_t include_revprops,
+                            svn_boolean_t include_changes,
+                            int jobs,
+                            svn_repos_notify_func_t notify_func,
+                            void *notify_baton,
+                            svn_repos_dump_filter_func_t filter_func,
+                            void *filter_baton,
+                            svn_cancel_func_t cancel_func,
+                            void *cancel_baton,
+                            apr_pool_t *pool);
+
+/** One range of lines in the result of svn_repos__get_file_blame().
+ *
+ * @since New in 1.15.
+ */
+typedef struct svn_repos__blame_chunk_t
+{
+  /** The 0-based number of the first line in the range. */
+  apr_int64_t line_start;
+
+  /** Index of the file version that last changed the lines, as passed to
+   * svn_repos__blame_diff_t.add_file(). */
+  int version;
+} svn_repos__blame_chunk_t;
+
+/** The line-based file comparison that svn_repos__get_file_blame() uses
+ * to attribute lines to revisions.  libsvn_repos does not depend on
+ * libsvn_diff, so callers implement this with the blame functions of
+ * libsvn_diff.
+ *
+ * @since New in 1.15.
+ */
+typedef struct svn_repos__blame_diff_t
+{
+  /** Update the attribution kept in @a baton for the change from the
+   * file contents in @a last_file to those in @a file.  Blame all lines
+   * that the change adds on the file version with index @a version.
+   * @a last_file is NULL for the first version.  Use @a scratch_pool for
+   * temporary allocations. */
+  svn_error_t *(*add_file)(void *baton,
+                           const char *last_file,
+                           const char *file,
+                           int version,
+                           apr_pool_t *scratch_pool);
+
+  /** Set @a *chunks to the attribution of the file last passed to
+   * @a add_file, as an array of #svn_repos__blame_chunk_t ordered by
+   * line number.  Allocate it in @a result_pool. */
+  svn_error_t *(*get_chunks)(apr_array_header_t **chunks,
+                             void *baton,
+                             apr_pool_t *result_pool);
+
+  /** Identifies the way that @a add_file compares lines, e.g. which
+   * whitespace changes it ignores.  Results are cached per key. */
+  const char *options_key;
+
+  /** Baton to pass to the functions above. */
+  void *baton;
+} svn_repos__blame_diff_t;
+
+/** Callback type for the file versions that svn_repos__get_file_blame()
+ * visited: @a path in @a revision with the revision properties
+ * @a rev_props.  Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+typedef svn_error_t *(*svn_repos__blame_rev_func_t)(
+  void *baton,
+  const char *path,
+  svn_revnum_t revision,
+  apr_hash_t *rev_props,
+  apr_pool_t *scratch_pool);
+
+/** Callback type for the ranges of lines reported by
+ * svn_repos__get_file_blame().  The range starts at the 0-based line
+ * number @a line_start and extends up to the start of the next range,
+ * or up to the end of the file for the last range.  @a revision last
+ * changed the lines in the range.  It is #SVN_INVALID_REVNUM for lines
+ * that are older than the blamed revision range.  Use @a scratch_pool
+ * for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+typedef svn_error_t *(*svn_repos__blame_chunk_func_t)(
+  void *baton,
+  apr_int64_t line_start,
+  svn_revnum_t revision,
+  apr_pool_t *scratch_pool);
+
+/** Determine for each line of the file at @a path in revision @a end the
+ * revision between @a start and @a end that last changed it.  This is
+ * the line attribution behind "svn blame", computed in the repository
+ * instead of from the deltas that svn_repos_get_file_revs2() would send.
+ * Compare subsequent versions of the file with @a diff.
+ *
+ * First call @a rev_func for every version of the file that
+ * svn_repos_get_file_revs2() would report, oldest first.  That includes
+ * the last version before @a start, if any.  The revision properties are
+ * the ones returned by svn_repos_fs_revision_proplist().  Then call
+ * @a chunk_func for every range of lines with the same origin, ordered by
+ * line number.  Pass @a baton to both.
+ *
+ * @a start must not be greater than @a end.  Merged revisions are not
+ * taken into account.  The contents of the file are not checked for
+ * being binary.
+ *
+ * Like svn_repos_get_file_revs2(), stop following the history of the
+ * file at the first location that @a authz_read_func denies read access
+ * to.  All lines that the oldest readable version already had are
+ * blamed on that version then.
+ *
+ * The results are cached per node-revision of @a path in @a end, @a start
+ * and @a diff's options key.  Cached results are only used if all the
+ * versions that they cover are readable.
+ *
+ * Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos__get_file_blame(svn_repos_t *repos,
+                          const char *path,
+                          svn_revnum_t start,
+                          svn_revnum_t end,
+                          const svn_repos__blame_diff_t *diff,
+                          svn_repos_authz_func_t authz_read_func,
+                          void *authz_read_baton,
+                          svn_repos__blame_rev_func_t rev_func,
+                          svn_repos__blame_chunk_func_t chunk_func,
+                          void *baton,
+                          apr_pool_t *scratch_pool);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
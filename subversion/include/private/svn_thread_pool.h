@@ -0,0 +1,73 @@
+/**
+ * @copyright
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ * @endcopyright
+ *
+ * @file svn_thread_pool.h
+ * @brief Process-wide pool of worker threads
+ */
+
+#ifndef SVN_THREAD_POOL_H
+#define SVN_THREAD_POOL_H
+
+#include <apr_thread_pool.h>
+
+#include "svn_pools.h"
+#include "svn_error.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Maximum number of threads in the process-wide worker thread pool.
+ * This is also the number of background jobs that may be executed
+ * concurrently throughout the process.
+ */
+#define SVN_THREAD_POOL__MAX_THREADS 8
+
+#if APR_HAS_THREADS
+
+/**
+ * Set @a *thread_pool to the worker thread pool shared by all libraries
+ * within this process, creating it upon first use.  Idle threads linger
+ * for a while before they get terminated.  Jobs are only queued once all
+ * #SVN_THREAD_POOL__MAX_THREADS threads are busy.
+ *
+ * The pool lives until APR gets terminated.  Jobs pushed to it must not
+ * use single-threaded pools or caches of the calling thread.
+ *
+ * A job must never block waiting for other jobs of the same pool, e.g.
+ * by using an FS instance with read-ahead.  Once all threads run such
+ * jobs, the jobs they wait for never get to run.
+ *
+ * Use @a scratch_pool for temporary allocations.
+ */
+svn_error_t *
+svn_thread_pool__get(apr_thread_pool_t **thread_pool,
+                     apr_pool_t *scratch_pool);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_THREAD_POOL_H */
@@ -487,6 +487,16 @@ typedef struct svn_diff_file_options_t
    *
    * @since New in 1.9 */
   int context_size;
+
+  /** Whether to use the patience diff algorithm, which anchors the
+   * comparison on lines that occur exactly once in both files.  This is
+   * much faster on large files with few repeated lines (generated code,
+   * tables) and often gives more readable output, but does not always
+   * find the minimal diff.  Only two-way diffs use this option.  The
+   * default is @c FALSE.
+   *
+   * @since New in 1.15. */
+  svn_boolean_t patience;
 } svn_diff_file_options_t;
 
 /** Allocate a @c svn_diff_file_options_t structure in @a pool, initializing
@@ -510,6 +520,7 @@ svn_diff_file_options_create(apr_pool_t *pool);
  * - --ignore-eol-style
  * - --show-c-function, -p @since New in 1.5.
  * - --context, -U ARG @since New in 1.9.
+ * - --patience @since New in 1.15.
  * - --unified, -u (for compatibility, does nothing).
  */
 svn_error_t *
@@ -146,6 +146,35 @@ typedef struct svn_fs_t svn_fs_t;
  */
 #define SVN_FS_CONFIG_FSFS_BLOCK_READ           "fsfs-block-read"
 
+/** String with a decimal representation of the number of delta windows
+ * that FSFS shall reconstruct ahead of the reader on worker threads when
+ * reading large deltified file contents.  Zero ("0"), the default, reads
+ * all windows in the caller's thread.  Larger values are limited to twice
+ * the number of worker threads.
+ *
+ * This option is ignored if APR does not support threads.
+ *
+ * @since New in 1.15.
+ */
+#define SVN_FS_CONFIG_FSFS_READ_AHEAD           "fsfs-read-ahead"
+
+/** Enable the bulk-load mode of FSFS.  Boolean type, defaults to FALSE.
+ *
+ * Meant for the initial load of large dump files into a repository that
+ * nobody else is accessing at the same time.  Commits will neither flush
+ * the new revisions to disk nor commit their rep-cache.db entries one at
+ * a time.  Both happen at checkpoints every 1000 revisions and when the
+ * caller explicitly requests a checkpoint.
+ *
+ * @note A system crash or power failure may leave the repository in an
+ * inconsistent state until it has been recovered and its rep-cache.db
+ * has been rebuilt.  A checkpoint flushes the new revisions to disk
+ * before it commits their rep-cache.db entries.
+ *
+ * @since New in 1.15.
+ */
+#define SVN_FS_CONFIG_FSFS_BULK_LOAD            "fsfs-bulk-load"
+
 /** String with a decimal representation of the FSFS format shard size.
  * Zero ("0") means that a repository with linear layout should be created.
  *
@@ -71,6 +71,10 @@ extern "C" {
 #define SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE "file-revs-reverse"
 /* maps to SVN_RA_CAPABILITY_LIST */
 #define SVN_RA_SVN_CAP_LIST "list"
+/* server supports the stat-many and get-files commands */
+#define SVN_RA_SVN_CAP_BATCHED_FETCH "batched-fetch"
+/* server supports the get-file-blame command */
+#define SVN_RA_SVN_CAP_FILE_BLAME "file-blame"
 
 
 /** ra_svn passes @c svn_dirent_t fields over the wire as a list of
@@ -2116,6 +2116,19 @@ typedef svn_error_t *(*svn_repos_log_entry_receiver_t)(
   apr_pool_t *scratch_pool);
 
 
+/** Key in the @a fs_config hash passed to svn_repos_open3() and friends.
+ * If set to a true value, svn_repos_get_logs5() traces the histories of
+ * many log targets on worker threads, each using its own filesystem
+ * instance.  Boolean type, defaults to FALSE.
+ *
+ * This option is ignored if APR does not support threads, if the
+ * filesystem is a Berkeley DB one or if the process-wide cache has been
+ * configured as single-threaded (see #svn_cache_config_t).
+ *
+ * @since New in 1.15.
+ */
+#define SVN_REPOS_CONFIG_PARALLEL_LOG "repos-parallel-log"
+
 /**
  * Invoke @a revision_receiver with @a revision_receiver_baton on each
  * revision from @a start to @a end in @a repos's filesystem.  @a start may
@@ -2176,6 +2189,9 @@ typedef svn_error_t *(*svn_repos_log_entry_receiver_t)(
  * @a path_change_receiver is @c NULL, the same filtering is performed
  * just without reporting any path changes.
  *
+ * If @a repos has been opened with #SVN_REPOS_CONFIG_PARALLEL_LOG set,
+ * the histories of multiple @a paths may be traced on worker threads.
+ *
  * Use @a scratch_pool for temporary allocations.
  *
  * @see svn_repos_path_change_receiver_t, svn_repos_log_entry_receiver_t
@@ -37,6 +37,8 @@
 #include "svn_hash.h"
 #include "svn_sorts.h"
 
+#include "private/svn_diff_private.h"
+#include "private/svn_ra_private.h"
 #include "private/svn_wc_private.h"
 
 #include "svn_private_config.h"
@@ -52,28 +54,6 @@ struct rev
   const char *path;      /* the absolute repository path */
 };
 
-/* One chunk of blame */
-struct blame
-{
-  const struct rev *rev;    /* the responsible revision */
-  apr_off_t start;          /* the starting diff-token (line) */
-  struct blame *next;       /* the next chunk */
-};
-
-/* A chain of blame chunks */
-struct blame_chain
-{
-  struct blame *blame;      /* linked list of blame chunks */
-  struct blame *avail;      /* linked list of free blame chunks */
-  struct apr_pool_t *pool;  /* Allocate members from this pool. */
-};
-
-/* The baton use for the diff output routine. */
-struct diff_baton {
-  struct blame_chain *chain;
-  const struct rev *rev;
-};
-
 /* The baton used for a file revision. Lives the entire operation */
 struct file_rev_baton {
   svn_revnum_t start_rev, end_rev;
@@ -84,7 +64,7 @@ struct file_rev_baton {
   /* name of file containing the previous revision of the file */
   const char *last_filename;
   struct rev *last_rev;   /* the rev of the last modification */
-  struct blame_chain *chain;      /* the original blame chain. */
+  svn_diff__blame_chain_t *chain; /* the original blame chain. */
   const char *repos_root_url;    /* To construct a url */
   apr_pool_t *mainpool;  /* lives during the whole sequence of calls */
   apr_pool_t *lastpool;  /* pool used during previous call */
@@ -92,7 +72,7 @@ struct file_rev_baton {
 
   /* These are used for tracking merged revisions. */
   svn_boolean_t include_merged_revisions;
-  struct blame_chain *merged_chain;  /* the merged blame chain. */
+  svn_diff__blame_chain_t *merged_chain; /* the merged blame chain. */
   /* name of file containing the previous merged revision of the file */
   const char *last_original_filename;
   /* pools for files which may need to persist for more than one rev. */
@@ -123,201 +103,6 @@ struct delta_baton {
 
 
 
-/* Return a blame chunk associated with REV for a change starting
-   at token START, and allocated in CHAIN->mainpool. */
-static struct blame *
-blame_create(struct blame_chain *chain,
-             const struct rev *rev,
-             apr_off_t start)
-{
-  struct blame *blame;
-  if (chain->avail)
-    {
-      blame = chain->avail;
-      chain->avail = blame->next;
-    }
-  else
-    blame = apr_palloc(chain->pool, sizeof(*blame));
-  blame->rev = rev;
-  blame->start = start;
-  blame->next = NULL;
-  return blame;
-}
-
-/* Destroy a blame chunk. */
-static void
-blame_destroy(struct blame_chain *chain,
-              struct blame *blame)
-{
-  blame->next = chain->avail;
-  chain->avail = blame;
-}
-
-/* Return the blame chunk that contains token OFF, starting the search at
-   BLAME. */
-static struct blame *
-blame_find(struct blame *blame, apr_off_t off)
-{
-  struct blame *prev = NULL;
-  while (blame)
-    {
-      if (blame->start > off) break;
-      prev = blame;
-      blame = blame->next;
-    }
-  return prev;
-}
-
-/* Shift the start-point of BLAME and all subsequence blame-chunks
-   by ADJUST tokens */
-static void
-blame_adjust(struct blame *blame, apr_off_t adjust)
-{
-  while (blame)
-    {
-      blame->start += adjust;
-      blame = blame->next;
-    }
-}
-
-/* Delete the blame associated with the region from token START to
-   START + LENGTH */
-static svn_error_t *
-blame_delete_range(struct blame_chain *chain,
-                   apr_off_t start,
-                   apr_off_t length)
-{
-  struct blame *first = blame_find(chain->blame, start);
-  struct blame *last = blame_find(chain->blame, start + length);
-  struct blame *tail = last->next;
-
-  if (first != last)
-    {
-      struct blame *walk = first->next;
-      while (walk != last)
-        {
-          struct blame *next = walk->next;
-          blame_destroy(chain, walk);
-          walk = next;
-        }
-      first->next = last;
-      last->start = start;
-      if (first->start == start)
-        {
-          *first = *last;
-          blame_destroy(chain, last);
-          last = first;
-        }
-    }
-
-  if (tail && tail->start == last->start + length)
-    {
-      *last = *tail;
-      blame_destroy(chain, tail);
-      tail = last->next;
-    }
-
-  blame_adjust(tail, -length);
-
-  return SVN_NO_ERROR;
-}
-
-/* Insert a chunk of blame associated with REV starting
-   at token START and continuing for LENGTH tokens */
-static svn_error_t *
-blame_insert_range(struct blame_chain *chain,
-                   const struct rev *rev,
-                   apr_off_t start,
-                   apr_off_t length)
-{
-  struct blame *head = chain->blame;
-  struct blame *point = blame_find(head, start);
-  struct blame *insert;
-
-  if (point->start == start)
-    {
-      insert = blame_create(chain, point->rev, point->start + length);
-      point->rev = rev;
-      insert->next = point->next;
-      point->next = insert;
-    }
-  else
-    {
-      struct blame *middle;
-      middle = blame_create(chain, rev, start);
-      insert = blame_create(chain, point->rev, start + length);
-      middle->next = insert;
-      insert->next = point->next;
-      point->next = middle;
-    }
-  blame_adjust(insert->next, length);
-
-  return SVN_NO_ERROR;
-}
-
-/* Callback for diff between subsequent revisions */
-static svn_error_t *
-output_diff_modified(void *baton,
-                     apr_off_t original_start,
-                     apr_off_t original_length,
-                     apr_off_t modified_start,
-                     apr_off_t modified_length,
-                     apr_off_t latest_start,
-                     apr_off_t latest_length)
-{
-  struct diff_baton *db = baton;
-
-  if (original_length)
-    SVN_ERR(blame_delete_range(db->chain, modified_start, original_length));
-
-  if (modified_length)
-    SVN_ERR(blame_insert_range(db->chain, db->rev, modified_start,
-                               modified_length));
-
-  return SVN_NO_ERROR;
-}
-
-static const svn_diff_output_fns_t output_fns = {
-        NULL,
-        output_diff_modified
-};
-
-/* Add the blame for the diffs between LAST_FILE and CUR_FILE to CHAIN,
-   for revision REV.  LAST_FILE may be NULL in which
-   case blame is added for every line of CUR_FILE. */
-static svn_error_t *
-add_file_blame(const char *last_file,
-               const char *cur_file,
-               struct blame_chain *chain,
-               struct rev *rev,
-               const svn_diff_file_options_t *diff_options,
-               svn_cancel_func_t cancel_func,
-               void *cancel_baton,
-               apr_pool_t *pool)
-{
-  if (!last_file)
-    {
-      SVN_ERR_ASSERT(chain->blame == NULL);
-      chain->blame = blame_create(chain, rev, 0);
-    }
-  else
-    {
-      svn_diff_t *diff;
-      struct diff_baton diff_baton;
-
-      diff_baton.chain = chain;
-      diff_baton.rev = rev;
-
-      /* We have a previous file.  Get the diff and adjust blame info. */
-      SVN_ERR(svn_diff_file_diff_2(&diff, last_file, cur_file,
-                                   diff_options, pool));
-      SVN_ERR(svn_diff_output2(diff, &diff_baton, &output_fns,
-                               cancel_func, cancel_baton));
-    }
-
-  return SVN_NO_ERROR;
-}
-
 /* Record the blame information for the revision in BATON->file_rev_baton.
  */
 static svn_error_t *
@@ -325,7 +110,7 @@ update_blame(void *baton)
 {
   struct delta_baton *dbaton = baton;
   struct file_rev_baton *frb = dbaton->file_rev_baton;
-  struct blame_chain *chain;
+  svn_diff__blame_chain_t *chain;
 
   /* Close the source file used for the delta.
      It is important to do this early, since otherwise, they will be deleted
@@ -342,11 +127,12 @@ update_blame(void *baton)
     chain = frb->chain;
 
   /* Process this file. */
-  SVN_ERR(add_file_blame(frb->last_filename,
-                         dbaton->filename, chain, dbaton->rev,
-                         frb->diff_options,
-                         frb->ctx->cancel_func, frb->ctx->cancel_baton,
-                         frb->currpool));
+  SVN_ERR(svn_diff__blame_add_file(chain, frb->last_filename,
+                                   dbaton->filename, dbaton->rev,
+                                   frb->diff_options,
+                                   frb->ctx->cancel_func,
+                                   frb->ctx->cancel_baton,
+                                   frb->currpool));
 
   /* If we are including merged revisions, and the current revision is not a
      merged one, we need to add its blame info to the chain for the original
@@ -355,11 +141,13 @@ update_blame(void *baton)
     {
       apr_pool_t *tmppool;
 
-      SVN_ERR(add_file_blame(frb->last_original_filename,
-                             dbaton->filename, frb->chain, dbaton->rev,
-                             frb->diff_options,
-                             frb->ctx->cancel_func, frb->ctx->cancel_baton,
-                             frb->currpool));
+      SVN_ERR(svn_diff__blame_add_file(frb->chain,
+                                       frb->last_original_filename,
+                                       dbaton->filename, dbaton->rev,
+                                       frb->diff_options,
+                                       frb->ctx->cancel_func,
+                                       frb->ctx->cancel_baton,
+                                       frb->currpool));
 
       /* This filename could be around for a while, potentially, so
          use the longer lifetime pool, and switch it with the previous one*/
@@ -414,6 +202,40 @@ window_handler(svn_txdelta_window_t *window, void *baton)
 }
 
 
+/* Notify the client of FRB that PATH in REVNUM with the revision
+ * properties REV_PROPS has been processed and check for cancellation.
+ * Use POOL for temporary allocations.
+ */
+static svn_error_t *
+notify_blame_revision(struct file_rev_baton *frb,
+                      const char *path,
+                      svn_revnum_t revnum,
+                      apr_hash_t *rev_props,
+                      apr_pool_t *pool)
+{
+  if (frb->ctx->notify_func2)
+    {
+      svn_wc_notify_t *notify
+            = svn_wc_create_notify_url(
+                            svn_path_url_add_component2(frb->repos_root_url,
+                                                        path+1, pool),
+                            svn_wc_notify_blame_revision, pool);
+      notify->path = path;
+      notify->kind = svn_node_none;
+      notify->content_state = notify->prop_state
+        = svn_wc_notify_state_inapplicable;
+      notify->lock_state = svn_wc_notify_lock_state_inapplicable;
+      notify->revision = revnum;
+      notify->rev_props = rev_props;
+      frb->ctx->notify_func2(frb->ctx->notify_baton2, notify, pool);
+    }
+
+  if (frb->ctx->cancel_func)
+    SVN_ERR(frb->ctx->cancel_func(frb->ctx->cancel_baton));
+
+  return SVN_NO_ERROR;
+}
+
 /* Calculate and record blame information for one revision of the file,
  * by comparing the file content against the previously seen revision.
  *
@@ -461,25 +283,7 @@ file_rev_handler(void *baton, const char *path, svn_revnum_t revnum,
         }
     }
 
-  if (frb->ctx->notify_func2)
-    {
-      svn_wc_notify_t *notify
-            = svn_wc_create_notify_url(
-                            svn_path_url_add_component2(frb->repos_root_url,
-                                                        path+1, pool),
-                            svn_wc_notify_blame_revision, pool);
-      notify->path = path;
-      notify->kind = svn_node_none;
-      notify->content_state = notify->prop_state
-        = svn_wc_notify_state_inapplicable;
-      notify->lock_state = svn_wc_notify_lock_state_inapplicable;
-      notify->revision = revnum;
-      notify->rev_props = rev_props;
-      frb->ctx->notify_func2(frb->ctx->notify_baton2, notify, pool);
-    }
-
-  if (frb->ctx->cancel_func)
-    SVN_ERR(frb->ctx->cancel_func(frb->ctx->cancel_baton));
+  SVN_ERR(notify_blame_revision(frb, path, revnum, rev_props, pool));
 
   /* If there were no content changes and no (potential) merges, we couldn't
      care less about this revision now.  Note that we checked the mime type
@@ -593,16 +397,140 @@ file_rev_handler(void *baton, const char *path, svn_revnum_t revnum,
   return SVN_NO_ERROR;
 }
 
+/* The baton used by server_blame_rev() and server_blame_chunk(). */
+struct server_blame_baton {
+  struct file_rev_baton *frb;
+  apr_hash_t *revs;                 /* svn_revnum_t -> struct rev * */
+  struct rev *old_rev;              /* blamed for lines older than START */
+  svn_diff__blame_chunk_t *last;    /* the last chunk in FRB->CHAIN */
+};
+
+/* Notify the client of a file version that the server processed and
+ * remember its revision properties in (server_blame_baton) BATON.
+ *
+ * Implements svn_ra__blame_rev_func_t.
+ */
+static svn_error_t *
+server_blame_rev(void *baton,
+                 const char *path,
+                 svn_revnum_t revision,
+                 apr_hash_t *rev_props,
+                 apr_pool_t *scratch_pool)
+{
+  struct server_blame_baton *sbb = baton;
+  struct file_rev_baton *frb = sbb->frb;
+
+  SVN_ERR(notify_blame_revision(frb, path, revision, rev_props,
+                                scratch_pool));
+
+  if (revision >= frb->start_rev)
+    {
+      struct rev *rev = apr_pcalloc(frb->mainpool, sizeof(*rev));
+
+      rev->revision = revision;
+      rev->rev_props = svn_prop_hash_dup(rev_props, frb->mainpool);
+      apr_hash_set(sbb->revs, &rev->revision, sizeof(rev->revision), rev);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Append the blame for the lines starting at LINE_START to the chain in
+ * (server_blame_baton) BATON.
+ *
+ * Implements svn_ra__blame_chunk_func_t.
+ */
+static svn_error_t *
+server_blame_chunk(void *baton,
+                   apr_int64_t line_start,
+                   svn_revnum_t revision,
+                   apr_pool_t *scratch_pool)
+{
+  struct server_blame_baton *sbb = baton;
+  svn_diff__blame_chain_t *chain = sbb->frb->chain;
+  struct rev *rev = sbb->old_rev;
+  svn_diff__blame_chunk_t *blame;
+
+  if (SVN_IS_VALID_REVNUM(revision))
+    {
+      rev = apr_hash_get(sbb->revs, &revision, sizeof(revision));
+
+      /* Every blamed revision should have been reported before.  Blame
+         the lines on it anyway, just without revision properties. */
+      if (!rev)
+        {
+          rev = apr_pcalloc(sbb->frb->mainpool, sizeof(*rev));
+          rev->revision = revision;
+          apr_hash_set(sbb->revs, &rev->revision, sizeof(rev->revision),
+                       rev);
+        }
+    }
+
+  blame = svn_diff__blame_chunk_create(chain, rev, line_start);
+  if (sbb->last)
+    sbb->last->next = blame;
+  else
+    chain->blame = blame;
+  sbb->last = blame;
+
+  return SVN_NO_ERROR;
+}
+
+/* Let the server calculate the blame for FRB->START_REV to FRB->END_REV
+   of the file at RA_SESSION's URL, store it in FRB->CHAIN and the file
+   contents in FRB->END_REV in FRB->LAST_FILENAME.  Set *HANDLED to TRUE
+   on success and to FALSE, if the server does not support that.
+   Allocate the results in POOL. */
+static svn_error_t *
+get_server_blame(svn_boolean_t *handled,
+                 struct file_rev_baton *frb,
+                 svn_ra_session_t *ra_session,
+                 apr_pool_t *pool)
+{
+  struct server_blame_baton sbb;
+  svn_stream_t *stream;
+  const char *filename;
+  svn_error_t *err;
+
+  sbb.frb = frb;
+  sbb.revs = apr_hash_make(pool);
+  sbb.old_rev = apr_pcalloc(pool, sizeof(*sbb.old_rev));
+  sbb.old_rev->revision = SVN_INVALID_REVNUM;
+  sbb.last = NULL;
+
+  SVN_ERR(svn_stream_open_unique(&stream, &filename, NULL,
+                                 svn_io_file_del_on_pool_cleanup,
+                                 pool, pool));
+
+  err = svn_ra__get_file_blame(ra_session, "", frb->start_rev, frb->end_rev,
+                               frb->diff_options, server_blame_rev,
+                               server_blame_chunk, &sbb, stream, pool);
+  if (err && err->apr_err == SVN_ERR_RA_NOT_IMPLEMENTED)
+    {
+      svn_error_clear(err);
+      *handled = FALSE;
+
+      return svn_error_trace(svn_stream_close(stream));
+    }
+  SVN_ERR(err);
+  SVN_ERR(svn_stream_close(stream));
+
+  frb->last_filename = filename;
+  *handled = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
 /* Ensure that CHAIN_ORIG and CHAIN_MERGED have the same number of chunks,
    and that for every chunk C, CHAIN_ORIG[C] and CHAIN_MERGED[C] have the
    same starting value.  Both CHAIN_ORIG and CHAIN_MERGED should not be
    NULL.  */
 static void
-normalize_blames(struct blame_chain *chain,
-                 struct blame_chain *chain_merged,
+normalize_blames(svn_diff__blame_chain_t *chain,
+                 svn_diff__blame_chain_t *chain_merged,
                  apr_pool_t *pool)
 {
-  struct blame *walk, *walk_merged;
+  svn_diff__blame_chunk_t *walk, *walk_merged;
 
   /* Walk over the CHAIN's blame chunks and CHAIN_MERGED's blame chunks,
      creating new chunks as needed. */
@@ -616,7 +544,8 @@ normalize_blames(struct blame_chain *chain,
       if (walk->next->start < walk_merged->next->start)
         {
           /* insert a new chunk in CHAIN_MERGED. */
-          struct blame *tmp = blame_create(chain_merged, walk_merged->rev,
+          svn_diff__blame_chunk_t *tmp
+            = svn_diff__blame_chunk_create(chain_merged, walk_merged->rev,
                                            walk->next->start);
           tmp->next = walk_merged->next;
           walk_merged->next = tmp;
@@ -625,7 +554,8 @@ normalize_blames(struct blame_chain *chain,
       if (walk->next->start > walk_merged->next->start)
         {
           /* insert a new chunk in CHAIN. */
-          struct blame *tmp = blame_create(chain, walk->rev,
+          svn_diff__blame_chunk_t *tmp
+            = svn_diff__blame_chunk_create(chain, walk->rev,
                                            walk_merged->next->start);
           tmp->next = walk->next;
           walk->next = tmp;
@@ -637,7 +567,8 @@ normalize_blames(struct blame_chain *chain,
      to CHAIN_MERGED until its length matches that of CHAIN. */
   while (walk->next != NULL)
     {
-      struct blame *tmp = blame_create(chain_merged, walk_merged->rev,
+      svn_diff__blame_chunk_t *tmp
+        = svn_diff__blame_chunk_create(chain_merged, walk_merged->rev,
                                        walk->next->start);
       walk_merged->next = tmp;
 
@@ -648,7 +579,8 @@ normalize_blames(struct blame_chain *chain,
   /* Same as above, only extend CHAIN to match CHAIN_MERGED. */
   while (walk_merged->next != NULL)
     {
-      struct blame *tmp = blame_create(chain, walk->rev,
+      svn_diff__blame_chunk_t *tmp
+        = svn_diff__blame_chunk_create(chain, walk->rev,
                                        walk_merged->next->start);
       walk->next = tmp;
 
@@ -675,11 +607,12 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
   struct file_rev_baton frb;
   svn_ra_session_t *ra_session;
   svn_revnum_t start_revnum, end_revnum;
-  struct blame *walk, *walk_merged = NULL;
+  svn_diff__blame_chunk_t *walk, *walk_merged = NULL;
   apr_pool_t *iterpool;
   svn_stream_t *last_stream;
   svn_stream_t *stream;
   const char *target_abspath_or_url;
+  svn_boolean_t server_blame = FALSE;
 
   if (start->kind == svn_opt_revision_unspecified
       || end->kind == svn_opt_revision_unspecified)
@@ -783,17 +716,9 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
   frb.last_filename = NULL;
   frb.last_rev = NULL;
   frb.last_original_filename = NULL;
-  frb.chain = apr_palloc(pool, sizeof(*frb.chain));
-  frb.chain->blame = NULL;
-  frb.chain->avail = NULL;
-  frb.chain->pool = pool;
+  frb.chain = svn_diff__blame_chain_create(pool);
   if (include_merged_revisions)
-    {
-      frb.merged_chain = apr_palloc(pool, sizeof(*frb.merged_chain));
-      frb.merged_chain->blame = NULL;
-      frb.merged_chain->avail = NULL;
-      frb.merged_chain->pool = pool;
-    }
+    frb.merged_chain = svn_diff__blame_chain_create(pool);
   frb.backwards = (frb.start_rev > frb.end_rev);
   frb.last_revnum = SVN_INVALID_REVNUM;
   frb.last_props = NULL;
@@ -813,16 +738,22 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
       frb.prevfilepool = svn_pool_create(pool);
     }
 
-  /* Collect all blame information.
+  /* Servers that support it calculate the forward blame for us and only
+     send the result, the revisions they processed and the final text. */
+  if (!include_merged_revisions && !frb.backwards)
+    SVN_ERR(get_server_blame(&server_blame, &frb, ra_session, pool));
+
+  /* Otherwise, collect all blame information.
      We need to ensure that we get one revision before the start_rev,
      if available so that we can know what was actually changed in the start
      revision. */
-  SVN_ERR(svn_ra_get_file_revs2(ra_session, "",
-                                frb.backwards ? start_revnum
-                                              : MAX(0, start_revnum-1),
-                                end_revnum,
-                                include_merged_revisions,
-                                file_rev_handler, &frb, pool));
+  if (!server_blame)
+    SVN_ERR(svn_ra_get_file_revs2(ra_session, "",
+                                  frb.backwards ? start_revnum
+                                                : MAX(0, start_revnum-1),
+                                  end_revnum,
+                                  include_merged_revisions,
+                                  file_rev_handler, &frb, pool));
 
   if (end->kind == svn_opt_revision_working)
     {
@@ -876,9 +807,10 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
           SVN_ERR(svn_stream_copy3(wcfile, tempfile, ctx->cancel_func,
                                    ctx->cancel_baton, pool));
 
-          SVN_ERR(add_file_blame(frb.last_filename, temppath, frb.chain, NULL,
-                                 frb.diff_options,
-                                 ctx->cancel_func, ctx->cancel_baton, pool));
+          SVN_ERR(svn_diff__blame_add_file(frb.chain, frb.last_filename,
+                                           temppath, NULL, frb.diff_options,
+                                           ctx->cancel_func,
+                                           ctx->cancel_baton, pool));
 
           frb.last_filename = temppath;
         }
@@ -908,7 +840,8 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
          the most recently changed revision.  ### Is this really what we want
          to do here?  Do the semantics of copy change? */
       if (!frb.chain->blame)
-        frb.chain->blame = blame_create(frb.chain, frb.last_rev, 0);
+        frb.chain->blame = svn_diff__blame_chunk_create(frb.chain,
+                                                        frb.last_rev, 0);
 
       normalize_blames(frb.chain, frb.merged_chain, pool);
       walk_merged = frb.merged_chain->blame;
@@ -917,6 +850,7 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
   /* Process each blame item. */
   for (walk = frb.chain->blame; walk; walk = walk->next)
     {
+      const struct rev *rev = walk->rev;
       apr_off_t line_no;
       svn_revnum_t merged_rev;
       const char *merged_path;
@@ -924,9 +858,11 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
 
       if (walk_merged)
         {
-          merged_rev = walk_merged->rev->revision;
-          merged_rev_props = walk_merged->rev->rev_props;
-          merged_path = walk_merged->rev->path;
+          const struct rev *merged = walk_merged->rev;
+
+          merged_rev = merged->revision;
+          merged_rev_props = merged->rev_props;
+          merged_path = merged->path;
         }
       else
         {
@@ -951,10 +887,10 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
               svn_string_t line;
               line.data = sb->data;
               line.len = sb->len;
-              if (walk->rev)
+              if (rev)
                 SVN_ERR(receiver(receiver_baton,
-                                 line_no, walk->rev->revision,
-                                 walk->rev->rev_props, merged_rev,
+                                 line_no, rev->revision,
+                                 rev->rev_props, merged_rev,
                                  merged_rev_props, merged_path,
                                  &line, FALSE, iterpool));
               else
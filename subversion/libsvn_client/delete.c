@@ -279,8 +279,37 @@ struct repos_deletables_t
 {
   svn_ra_session_t *ra_session;
   apr_array_header_t *target_uris;
+
+  /* TARGET_URIS relative to the repository root. */
+  apr_array_header_t *target_relpaths;
+};
+
+/* Baton for check_deletable(). */
+struct check_deletable_baton_t
+{
+  /* The URIs being checked, and the index of the next one. */
+  const apr_array_header_t *target_uris;
+  int next;
 };
 
+/* Implements svn_ra__stat_receiver_t.  Return an error if PATH, the
+   next target of the check_deletable_baton_t BATON, does not exist. */
+static svn_error_t *
+check_deletable(void *baton,
+                const char *path,
+                const svn_dirent_t *dirent,
+                apr_pool_t *scratch_pool)
+{
+  struct check_deletable_baton_t *b = baton;
+  const char *uri = APR_ARRAY_IDX(b->target_uris, b->next++, const char *);
+
+  if (dirent == NULL)
+    return svn_error_createf(SVN_ERR_FS_NOT_FOUND, NULL,
+                             _("URL '%s' does not exist"), uri);
+
+  return SVN_NO_ERROR;
+}
+
 
 static svn_error_t *
 delete_urls_multi_repos(const apr_array_header_t *uris,
@@ -302,7 +331,6 @@ delete_urls_multi_repos(const apr_array_header_t *uris,
       const char *uri = APR_ARRAY_IDX(uris, i, const char *);
       struct repos_deletables_t *repos_deletables = NULL;
       const char *repos_relpath;
-      svn_node_kind_t kind;
 
       for (hi = apr_hash_first(pool, deletables); hi; hi = apr_hash_next(hi))
         {
@@ -317,6 +345,8 @@ delete_urls_multi_repos(const apr_array_header_t *uris,
               repos_deletables = apr_hash_this_val(hi);
               APR_ARRAY_PUSH(repos_deletables->target_uris, const char *) =
                 apr_pstrdup(pool, uri);
+              APR_ARRAY_PUSH(repos_deletables->target_relpaths,
+                             const char *) = repos_relpath;
               break;
             }
         }
@@ -348,6 +378,10 @@ delete_urls_multi_repos(const apr_array_header_t *uris,
           repos_deletables = apr_pcalloc(pool, sizeof(*repos_deletables));
           repos_deletables->ra_session = ra_session;
           repos_deletables->target_uris = target_uris;
+          repos_deletables->target_relpaths
+            = apr_array_make(pool, 1, sizeof(const char *));
+          APR_ARRAY_PUSH(repos_deletables->target_relpaths, const char *)
+            = repos_relpath;
           svn_hash_sets(deletables, repos_root, repos_deletables);
         }
 
@@ -357,13 +391,21 @@ delete_urls_multi_repos(const apr_array_header_t *uris,
       if (!repos_relpath || !*repos_relpath)
         return svn_error_createf(SVN_ERR_RA_ILLEGAL_URL, NULL,
                                  _("URL '%s' not within a repository"), uri);
+    }
 
-      /* Now, test to see if the thing actually exists in HEAD. */
-      SVN_ERR(svn_ra_check_path(repos_deletables->ra_session, repos_relpath,
-                                SVN_INVALID_REVNUM, &kind, pool));
-      if (kind == svn_node_none)
-        return svn_error_createf(SVN_ERR_FS_NOT_FOUND, NULL,
-                                 _("URL '%s' does not exist"), uri);
+  /* Now, test to see if the things actually exist in HEAD, using a
+     single request per repository where the server supports that. */
+  for (hi = apr_hash_first(pool, deletables); hi; hi = apr_hash_next(hi))
+    {
+      struct repos_deletables_t *repos_deletables = apr_hash_this_val(hi);
+      struct check_deletable_baton_t baton;
+
+      baton.target_uris = repos_deletables->target_uris;
+      baton.next = 0;
+      SVN_ERR(svn_ra__stat_many(repos_deletables->ra_session,
+                                repos_deletables->target_relpaths,
+                                SVN_INVALID_REVNUM, check_deletable, &baton,
+                                pool));
     }
 
   /* Now we iterate over the DELETABLES hash, issuing a commit for
@@ -1289,14 +1289,18 @@ svn_client_diff7(const apr_array_header_t *options,
                                           header_encoding,
                                           outstream, errstream,
                                           ctx, pool));
-
-  return svn_error_trace(do_diff(ddi,
-                                 path_or_url1, path_or_url2,
-                                 revision1, revision2,
-                                 &peg_revision, TRUE /* no_peg_revision */,
-                                 depth, ignore_ancestry, changelists,
-                                 TRUE /* text_deltas */,
-                                 diff_processor, ctx, pool, pool));
+  SVN_ERR(svn_client__diff_writer_parallelize(diff_processor, pool));
+
+  SVN_ERR(do_diff(ddi,
+                  path_or_url1, path_or_url2,
+                  revision1, revision2,
+                  &peg_revision, TRUE /* no_peg_revision */,
+                  depth, ignore_ancestry, changelists,
+                  TRUE /* text_deltas */,
+                  diff_processor, ctx, pool, pool));
+
+  return svn_error_trace(svn_client__diff_writer_flush(diff_processor,
+                                                       pool));
 }
 
 svn_error_t *
@@ -1352,14 +1356,18 @@ svn_client_diff_peg7(const apr_array_header_t *options,
                                           header_encoding,
                                           outstream, errstream,
                                           ctx, pool));
-
-  return svn_error_trace(do_diff(ddi,
-                                 path_or_url, path_or_url,
-                                 start_revision, end_revision,
-                                 peg_revision, FALSE /* no_peg_revision */,
-                                 depth, ignore_ancestry, changelists,
-                                 TRUE /* text_deltas */,
-                                 diff_processor, ctx, pool, pool));
+  SVN_ERR(svn_client__diff_writer_parallelize(diff_processor, pool));
+
+  SVN_ERR(do_diff(ddi,
+                  path_or_url, path_or_url,
+                  start_revision, end_revision,
+                  peg_revision, FALSE /* no_peg_revision */,
+                  depth, ignore_ancestry, changelists,
+                  TRUE /* text_deltas */,
+                  diff_processor, ctx, pool, pool));
+
+  return svn_error_trace(svn_client__diff_writer_flush(diff_processor,
+                                                       pool));
 }
 
 svn_error_t *
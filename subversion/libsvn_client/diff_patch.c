@@ -47,6 +47,8 @@
 #include "private/svn_wc_private.h"
 #include "private/svn_diff_private.h"
 #include "private/svn_io_private.h"
+#include "private/svn_thread_pool.h"
+#include "private/svn_waitable_counter.h"
 
 #include "svn_private_config.h"
 
@@ -654,6 +656,9 @@ display_prop_diffs(const apr_array_header_t *propchanges,
 
 /*** Callbacks for 'svn diff', invoked by the repos-diff editor. ***/
 
+/* Text diffs being computed by worker threads, see diff_job_queue_t. */
+typedef struct diff_job_queue_t diff_job_queue_t;
+
 /* Diff writer state */
 typedef struct diff_writer_info_t
 {
@@ -714,9 +719,429 @@ typedef struct diff_writer_info_t
   svn_cancel_func_t cancel_func;
   void *cancel_baton;
 
+  /* If not NULL, OUTSTREAM buffers the output in this queue and text
+     diffs are computed by worker threads. */
+  diff_job_queue_t *queue;
+
   svn_client__diff_driver_info_t ddi;
 } diff_writer_info_t;
 
+/* Do not bother worker threads with files smaller than this in total. */
+#define PARALLEL_DIFF_MIN_SIZE 0x4000
+
+/* Maximum number of text diff jobs queued at any time. */
+#define PARALLEL_DIFF_MAX_JOBS (4 * SVN_THREAD_POOL__MAX_THREADS)
+
+/* Once more output than this has been buffered, wait for the oldest
+   job instead of reading further input. */
+#define PARALLEL_DIFF_MAX_BUFFERED 0x1000000
+
+/* A text diff computed by a worker thread, followed by all output of the
+   diff writer up to the next job. */
+typedef struct text_diff_job_t
+{
+  /* Private copies of the files to compare. */
+  const char *file1;
+  const char *file2;
+
+  /* Labels for the unified diff header. */
+  const char *label1;
+  const char *label2;
+
+  /* "Index:" and git headers, to be written if there is any output. */
+  svn_stringbuf_t *header;
+
+  /* Whether to write the diff even if the files are equal. */
+  svn_boolean_t force_diff;
+
+  /* Expected size of OUTPUT, counted in the queue's BUFFERED from the
+     moment the job is queued until its output has been written. */
+  apr_size_t reserved;
+
+  /* Results, only valid once DONE is 1. */
+  svn_boolean_t wrote_header;
+  svn_stringbuf_t *output;
+  svn_error_t *err;
+  svn_waitable_counter_t *done;
+
+  /* Property changes of the same node with and without diff header.
+     The former is used if there was no text diff output. */
+  svn_stringbuf_t *props_with_header;
+  svn_stringbuf_t *props_without_header;
+
+  /* Output of the following nodes up to the next job. */
+  svn_stringbuf_t *after;
+
+  /* The writer that queued this job. */
+  diff_writer_info_t *dwi;
+
+  /* Thread-safe pool used by the worker, contains FILE1, FILE2, the labels
+     and OUTPUT. */
+  apr_pool_t *work_pool;
+
+  /* Used by the diff writer only, contains the other buffers. */
+  apr_pool_t *out_pool;
+
+  /* Next job in the queue or in the list of unused jobs. */
+  struct text_diff_job_t *next;
+} text_diff_job_t;
+
+struct diff_job_queue_t
+{
+  /* Shared thread pool to run the jobs. */
+  apr_thread_pool_t *thread_pool;
+
+  /* Where the output finally goes to. */
+  svn_stream_t *outstream;
+
+  /* Jobs in traversal order.  Output is buffered while FIRST is not
+     NULL. */
+  text_diff_job_t *first;
+  text_diff_job_t *last;
+  int job_count;
+
+  /* Job structures for reuse, so that their pools, counters and buffers
+     get recycled. */
+  text_diff_job_t *unused;
+
+  /* Total size of the output buffered by the diff writer, including the
+     output expected from pending jobs. */
+  apr_size_t buffered;
+
+  /* The job queued for the file currently being processed, if any.
+     Property changes of that file depend on its result. */
+  text_diff_job_t *current;
+};
+
+/* Compute the diff described by JOB.
+   This is the only function to be run by worker threads. */
+static void
+process_text_diff_job(text_diff_job_t *job)
+{
+  diff_writer_info_t *dwi = job->dwi;
+  svn_diff_file_options_t *options = dwi->options.for_internal;
+  svn_diff_t *diff;
+
+  job->err = svn_diff_file_diff_2(&diff, job->file1, job->file2, options,
+                                  job->work_pool);
+
+  /* Same logic as in diff_content_changed(). */
+  if (!job->err
+      && (job->force_diff
+          || dwi->use_git_diff_format
+          || svn_diff_contains_diffs(diff)))
+    {
+      job->wrote_header = TRUE;
+      job->output = svn_stringbuf_dup(job->header, job->work_pool);
+
+      /* Cancellation is checked by the diff writer. */
+      if (job->force_diff || svn_diff_contains_diffs(diff))
+        job->err = svn_diff_file_output_unified4(
+                     svn_stream_from_stringbuf(job->output, job->work_pool),
+                     diff, job->file1, job->file2, job->label1, job->label2,
+                     dwi->header_encoding, dwi->relative_to_dir,
+                     options->show_c_function, options->context_size,
+                     NULL, NULL, job->work_pool);
+    }
+
+  /* As soon as the increment call returns, JOB may be reused. */
+  svn_error_clear(svn_waitable_counter__increment(job->done));
+}
+
+#if APR_HAS_THREADS
+
+/* Thread-pool task processing the text_diff_job_t given by DATA. */
+static void * APR_THREAD_FUNC
+text_diff_task(apr_thread_t *tid,
+               void *data)
+{
+  process_text_diff_job(data);
+  return NULL;
+}
+
+#endif
+
+/* Put JOB back onto the list of unused jobs in QUEUE. */
+static void
+recycle_job(diff_job_queue_t *queue,
+            text_diff_job_t *job)
+{
+  svn_pool_clear(job->work_pool);
+  svn_pool_clear(job->out_pool);
+  svn_error_clear(job->err);
+  job->err = SVN_NO_ERROR;
+
+  job->next = queue->unused;
+  queue->unused = job;
+}
+
+/* Wait for the oldest job in the queue of DWI and write its output as
+   well as everything buffered after it to the final output stream. */
+static svn_error_t *
+write_oldest_job(diff_writer_info_t *dwi)
+{
+  diff_job_queue_t *queue = dwi->queue;
+  text_diff_job_t *job = queue->first;
+  svn_stringbuf_t *props;
+  svn_error_t *err;
+
+  SVN_ERR(svn_waitable_counter__wait_for(job->done, 1));
+
+  queue->first = job->next;
+  if (!queue->first)
+    queue->last = NULL;
+  --queue->job_count;
+
+  if (queue->current == job)
+    queue->current = NULL;
+
+  props = job->wrote_header ? job->props_without_header
+                            : job->props_with_header;
+  queue->buffered -= job->reserved
+                   + job->props_with_header->len
+                   + job->props_without_header->len
+                   + job->after->len;
+
+  err = svn_error_trace(job->err);
+  job->err = SVN_NO_ERROR;
+
+  if (!err && job->wrote_header)
+    err = svn_stream_write(queue->outstream, job->output->data,
+                           &job->output->len);
+  if (!err && props->len)
+    err = svn_stream_write(queue->outstream, props->data, &props->len);
+  if (!err && job->after->len)
+    err = svn_stream_write(queue->outstream, job->after->data,
+                           &job->after->len);
+
+  recycle_job(queue, job);
+
+  return svn_error_trace(err);
+}
+
+/* Implements svn_write_fn_t for the output stream of the diff writer
+   in parallel mode.  BATON is the diff_writer_info_t. */
+static svn_error_t *
+queue_write(void *baton,
+            const char *data,
+            apr_size_t *len)
+{
+  diff_writer_info_t *dwi = baton;
+  diff_job_queue_t *queue = dwi->queue;
+
+  /* Bound the memory used for buffering by waiting for the oldest job. */
+  if (queue->first && queue->buffered > PARALLEL_DIFF_MAX_BUFFERED)
+    SVN_ERR(write_oldest_job(dwi));
+
+  if (!queue->first)
+    return svn_error_trace(svn_stream_write(queue->outstream, data, len));
+
+  svn_stringbuf_appendbytes(queue->last->after, data, *len);
+  queue->buffered += *len;
+
+  return SVN_NO_ERROR;
+}
+
+/* Wait for all jobs of the diff_writer_info_t given by DATA to finish and
+   release their pools.  Must be run as a pre-cleanup hook of the pool that
+   contains DATA. */
+static apr_status_t
+diff_job_queue_pre_cleanup(void *data)
+{
+  diff_writer_info_t *dwi = data;
+  diff_job_queue_t *queue = dwi->queue;
+
+  while (queue->first)
+    {
+      text_diff_job_t *job = queue->first;
+      queue->first = job->next;
+
+      svn_error_clear(svn_waitable_counter__wait_for(job->done, 1));
+      svn_error_clear(job->err);
+      svn_pool_destroy(job->work_pool);
+    }
+
+  while (queue->unused)
+    {
+      text_diff_job_t *job = queue->unused;
+      queue->unused = job->next;
+
+      svn_pool_destroy(job->work_pool);
+    }
+
+  return APR_SUCCESS;
+}
+
+/* Set *JOB to an unused text diff job of DWI, waiting for older jobs to
+   finish if the queue is full. */
+static svn_error_t *
+get_unused_job(text_diff_job_t **job,
+               diff_writer_info_t *dwi)
+{
+  diff_job_queue_t *queue = dwi->queue;
+
+  while (queue->job_count >= PARALLEL_DIFF_MAX_JOBS
+         || (queue->first && queue->buffered > PARALLEL_DIFF_MAX_BUFFERED))
+    SVN_ERR(write_oldest_job(dwi));
+
+  if (queue->unused)
+    {
+      *job = queue->unused;
+      queue->unused = (*job)->next;
+      SVN_ERR(svn_waitable_counter__reset((*job)->done));
+    }
+  else
+    {
+      *job = apr_pcalloc(dwi->pool, sizeof(**job));
+      (*job)->dwi = dwi;
+      SVN_ERR(svn_waitable_counter__create(&(*job)->done, dwi->pool));
+
+      /* Workers need a thread-safe pool; a root pool is exactly that. */
+      (*job)->work_pool = svn_pool_create(NULL);
+      (*job)->out_pool = svn_pool_create(dwi->pool);
+    }
+
+  (*job)->next = NULL;
+  (*job)->wrote_header = FALSE;
+  (*job)->output = NULL;
+  (*job)->header = svn_stringbuf_create_empty((*job)->out_pool);
+  (*job)->props_with_header = svn_stringbuf_create_empty((*job)->out_pool);
+  (*job)->props_without_header
+    = svn_stringbuf_create_empty((*job)->out_pool);
+  (*job)->after = svn_stringbuf_create_empty((*job)->out_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *PATH to a copy of FILE that lives as long as JOB's work pool. */
+static svn_error_t *
+copy_job_file(const char **path,
+              text_diff_job_t *job,
+              const char *file,
+              apr_pool_t *scratch_pool)
+{
+  SVN_ERR(svn_io_open_unique_file3(NULL, path, NULL,
+                                   svn_io_file_del_on_pool_cleanup,
+                                   job->work_pool, scratch_pool));
+  SVN_ERR(svn_io_copy_file(file, *path, FALSE, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Fill the header and the input of JOB and hand it to a worker thread.
+   The parameters are the same as for svn_diff_file_output_unified4()
+   in diff_content_changed(), HEADER being the diff headers already
+   formatted.  INPUT_SIZE is the total size of both files. */
+static svn_error_t *
+queue_text_diff_job(text_diff_job_t *job,
+                    diff_writer_info_t *dwi,
+                    const char *tmpfile1,
+                    const char *tmpfile2,
+                    const char *label1,
+                    const char *label2,
+                    const svn_stringbuf_t *header,
+                    svn_boolean_t force_diff,
+                    apr_size_t input_size,
+                    apr_pool_t *scratch_pool)
+{
+  diff_job_queue_t *queue = dwi->queue;
+  svn_error_t *err;
+
+  /* The files given to the diff processor are only valid during the
+     callback. */
+  err = copy_job_file(&job->file1, job, tmpfile1, scratch_pool);
+  if (!err)
+    err = copy_job_file(&job->file2, job, tmpfile2, scratch_pool);
+  if (err)
+    {
+      recycle_job(queue, job);
+      return svn_error_trace(err);
+    }
+
+  job->label1 = apr_pstrdup(job->work_pool, label1);
+  job->label2 = apr_pstrdup(job->work_pool, label2);
+  svn_stringbuf_appendstr(job->header, header);
+  job->force_diff = force_diff;
+
+  /* The unified diff hardly ever gets larger than both files together. */
+  job->reserved = header->len + input_size;
+
+#if APR_HAS_THREADS
+  {
+    apr_status_t status = apr_thread_pool_push(queue->thread_pool,
+                                               text_diff_task,
+                                               job, 0, NULL);
+    if (status)
+      {
+        recycle_job(queue, job);
+        return svn_error_wrap_apr(status, _("Can't push task"));
+      }
+  }
+#else
+  process_text_diff_job(job);
+#endif
+
+  if (queue->last)
+    queue->last->next = job;
+  else
+    queue->first = job;
+  queue->last = job;
+  ++queue->job_count;
+  queue->buffered += job->reserved;
+
+  queue->current = job;
+
+  return SVN_NO_ERROR;
+}
+
+/* Return TRUE if the text diff between TMPFILE1 and TMPFILE2 should be
+   computed by a worker thread of DWI.  If so, set *INPUT_SIZE to the
+   total size of both files. */
+static svn_boolean_t
+use_text_diff_job(apr_size_t *input_size,
+                  diff_writer_info_t *dwi,
+                  const char *tmpfile1,
+                  const char *tmpfile2,
+                  apr_pool_t *scratch_pool)
+{
+  const char *files[2];
+  svn_filesize_t size = 0;
+  int i;
+
+  /* Files are only stat'ed in parallel mode. */
+  if (!dwi->queue)
+    return FALSE;
+
+  files[0] = tmpfile1;
+  files[1] = tmpfile2;
+  for (i = 0; i < 2; ++i)
+    {
+      apr_finfo_t finfo;
+      svn_error_t *err;
+
+      /* Added and deleted files are compared to an empty file. */
+      if (dwi->empty_file && strcmp(files[i], dwi->empty_file) == 0)
+        continue;
+
+      /* Errors will be reported by the diff itself. */
+      err = svn_io_stat(&finfo, files[i], APR_FINFO_SIZE, scratch_pool);
+      if (err)
+        {
+          svn_error_clear(err);
+          return FALSE;
+        }
+
+      size += finfo.size;
+    }
+
+  if (size < PARALLEL_DIFF_MIN_SIZE || size > APR_SIZE_MAX)
+    return FALSE;
+
+  *input_size = (apr_size_t)size;
+  return TRUE;
+}
+
+
 /* An helper for diff_dir_props_changed, diff_file_changed and diff_file_added
  */
 static svn_error_t *
@@ -739,7 +1164,39 @@ diff_props_changed(const char *diff_relpath,
   SVN_ERR(svn_categorize_props(propchanges, NULL, NULL, &props,
                                scratch_pool));
 
-  if (props->nelts > 0)
+  /* Whether the header has already been written depends on the text
+     diff still being computed for this node. */
+  if (props->nelts > 0 && show_diff_header
+      && dwi->queue && dwi->queue->current)
+    {
+      text_diff_job_t *job = dwi->queue->current;
+
+      SVN_ERR(display_prop_diffs(props, left_props, right_props,
+                                 diff_relpath, rev1, rev2,
+                                 dwi->header_encoding,
+                                 svn_stream_from_stringbuf(
+                                   job->props_with_header, scratch_pool),
+                                 dwi->relative_to_dir, TRUE,
+                                 dwi->use_git_diff_format,
+                                 dwi->pretty_print_mergeinfo,
+                                 &dwi->ddi,
+                                 dwi->cancel_func, dwi->cancel_baton,
+                                 scratch_pool));
+      SVN_ERR(display_prop_diffs(props, left_props, right_props,
+                                 diff_relpath, rev1, rev2,
+                                 dwi->header_encoding,
+                                 svn_stream_from_stringbuf(
+                                   job->props_without_header, scratch_pool),
+                                 dwi->relative_to_dir, FALSE,
+                                 dwi->use_git_diff_format,
+                                 dwi->pretty_print_mergeinfo,
+                                 &dwi->ddi,
+                                 dwi->cancel_func, dwi->cancel_baton,
+                                 scratch_pool));
+      dwi->queue->buffered += job->props_with_header->len
+                            + job->props_without_header->len;
+    }
+  else if (props->nelts > 0)
     {
       /* We're using the revnums from the dwi since there's
        * no revision argument to the svn_wc_diff_callback_t
@@ -855,6 +1312,7 @@ diff_content_changed(svn_boolean_t *wrote_header,
   const char *mimetype1 = svn_prop_get_value(left_props, SVN_PROP_MIME_TYPE);
   const char *mimetype2 = svn_prop_get_value(right_props, SVN_PROP_MIME_TYPE);
   const char *index_shas = NULL;
+  apr_size_t input_size;
 
   /* If only property differences are shown, there's nothing to do. */
   if (dwi->properties_only)
@@ -1042,6 +1500,37 @@ diff_content_changed(svn_boolean_t *wrote_header,
                                    NULL, NULL, scratch_pool));
         }
     }
+  else if (use_text_diff_job(&input_size, dwi, tmpfile1, tmpfile2,
+                             scratch_pool))
+    {
+      text_diff_job_t *job;
+      svn_stringbuf_t *header = svn_stringbuf_create_empty(scratch_pool);
+      svn_stream_t *header_stream = svn_stream_from_stringbuf(header,
+                                                              scratch_pool);
+
+      /* Format the headers here, as the git header needs the working
+         copy.  Whether they get written is up to the worker. */
+      SVN_ERR(print_diff_index_header(header_stream, dwi->header_encoding,
+                                      index_path, "", scratch_pool));
+      if (dwi->use_git_diff_format)
+        SVN_ERR(print_git_diff_header(header_stream,
+                                      &label1, &label2,
+                                      operation,
+                                      rev1, rev2,
+                                      diff_relpath,
+                                      copyfrom_path, copyfrom_rev,
+                                      left_props, right_props,
+                                      index_shas,
+                                      dwi->header_encoding,
+                                      &dwi->ddi, scratch_pool));
+
+      /* *WROTE_HEADER remains FALSE; property changes of this node are
+         formatted both ways until the job has finished. */
+      SVN_ERR(get_unused_job(&job, dwi));
+      SVN_ERR(queue_text_diff_job(job, dwi, tmpfile1, tmpfile2,
+                                  label1, label2, header, force_diff,
+                                  input_size, scratch_pool));
+    }
   else   /* use libsvn_diff to generate the diff  */
     {
       svn_diff_t *diff;
@@ -1122,6 +1611,10 @@ diff_file_changed(const char *relpath,
                                right_source->revision, prop_changes,
                                left_props, right_props, !wrote_header,
                                dwi, scratch_pool));
+
+  if (dwi->queue)
+    dwi->queue->current = NULL;
+
   return SVN_NO_ERROR;
 }
 
@@ -1221,6 +1714,9 @@ diff_file_added(const char *relpath,
                                left_props, right_props,
                                ! wrote_header, dwi, scratch_pool));
 
+  if (dwi->queue)
+    dwi->queue->current = NULL;
+
   return SVN_NO_ERROR;
 }
 
@@ -1283,6 +1779,9 @@ diff_file_deleted(const char *relpath,
                                      left_props, NULL,
                                      ! wrote_header, dwi, scratch_pool));
         }
+
+      if (dwi->queue)
+        dwi->queue->current = NULL;
     }
 
   return SVN_NO_ERROR;
@@ -1521,3 +2020,56 @@ svn_client__get_diff_writer_svn(
   *ddi_p = &dwi->ddi;
   return SVN_NO_ERROR;
 }
+
+svn_error_t *
+svn_client__diff_writer_parallelize(svn_diff_tree_processor_t *diff_processor,
+                                    apr_pool_t *scratch_pool)
+{
+  diff_writer_info_t *dwi = diff_processor->baton;
+
+  if (dwi->queue || dwi->diff_cmd)
+    return SVN_NO_ERROR;
+
+#if APR_HAS_THREADS
+  {
+    apr_thread_pool_t *thread_pool;
+    diff_job_queue_t *queue;
+
+    /* Not being able to start threads is not fatal.  We simply compute
+       all diffs in this thread then. */
+    svn_error_t *err = svn_thread_pool__get(&thread_pool, scratch_pool);
+    if (err)
+      {
+        svn_error_clear(err);
+        return SVN_NO_ERROR;
+      }
+
+    queue = apr_pcalloc(dwi->pool, sizeof(*queue));
+    queue->thread_pool = thread_pool;
+    queue->outstream = dwi->outstream;
+
+    dwi->queue = queue;
+    dwi->outstream = svn_stream_create(dwi, dwi->pool);
+    svn_stream_set_write(dwi->outstream, queue_write);
+
+    /* Workers must be done before the job counters get cleaned up. */
+    apr_pool_pre_cleanup_register(dwi->pool, dwi,
+                                  diff_job_queue_pre_cleanup);
+  }
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_client__diff_writer_flush(svn_diff_tree_processor_t *diff_processor,
+                              apr_pool_t *scratch_pool)
+{
+  diff_writer_info_t *dwi = diff_processor->baton;
+
+  if (dwi->queue)
+    while (dwi->queue->first)
+      SVN_ERR(write_oldest_job(dwi));
+
+  return SVN_NO_ERROR;
+}
@@ -488,6 +488,11 @@ struct edit_baton
   const char *repos_root_url;
   const char *root_path;
   const char *root_url;
+
+  /* Absolute version of ROOT_PATH.  Resolving relative paths means asking
+     the OS for the CWD, so we don't want to do that for every node. */
+  const char *root_abspath;
+
   svn_boolean_t overwrite;
   svn_revnum_t *target_revision;
   apr_hash_t *externals;
@@ -505,6 +510,7 @@ struct dir_baton
 {
   struct edit_baton *edit_baton;
   const char *path;
+  const char *abspath;
 };
 
 
@@ -513,6 +519,11 @@ struct file_baton
   struct edit_baton *edit_baton;
 
   const char *path;
+  const char *abspath;
+
+  /* Absolute path of the directory containing the file. */
+  const char *dir_abspath;
+
   /* The writer for the file being exported. */
   svn_wc__working_file_writer_t *file_writer;
 
@@ -538,13 +549,6 @@ struct file_baton
 };
 
 
-struct handler_baton
-{
-  svn_txdelta_window_handler_t apply_handler;
-  void *apply_baton;
-};
-
-
 static svn_error_t *
 set_target_revision(void *edit_baton,
                     svn_revnum_t target_revision,
@@ -574,6 +578,7 @@ open_root(void *edit_baton,
 
   /* Build our dir baton. */
   db->path = eb->root_path;
+  db->abspath = eb->root_abspath;
   db->edit_baton = eb;
   *root_baton = db;
 
@@ -594,19 +599,28 @@ add_directory(const char *path,
   struct dir_baton *db = apr_pcalloc(pool, sizeof(*db));
   struct edit_baton *eb = pb->edit_baton;
   const char *full_path = svn_dirent_join(eb->root_path, path, pool);
-  svn_node_kind_t kind;
+  svn_error_t *err;
 
-  SVN_ERR(svn_io_check_path(full_path, &kind, pool));
-  if (kind == svn_node_none)
-    SVN_ERR(svn_io_dir_make(full_path, APR_OS_DEFAULT, pool));
-  else if (kind == svn_node_file)
-    return svn_error_createf(SVN_ERR_WC_NOT_WORKING_COPY, NULL,
-                             _("'%s' exists and is not a directory"),
-                             svn_dirent_local_style(full_path, pool));
-  else if (! (kind == svn_node_dir && eb->overwrite))
-    return svn_error_createf(SVN_ERR_WC_OBSTRUCTED_UPDATE, NULL,
-                             _("'%s' already exists"),
-                             svn_dirent_local_style(full_path, pool));
+  /* The target usually does not exist, yet.  So, don't bother checking
+     before trying to create it. */
+  err = svn_io_dir_make(full_path, APR_OS_DEFAULT, pool);
+  if (err && APR_STATUS_IS_EEXIST(err->apr_err))
+    {
+      svn_node_kind_t kind;
+
+      svn_error_clear(err);
+      SVN_ERR(svn_io_check_path(full_path, &kind, pool));
+      if (kind == svn_node_file)
+        return svn_error_createf(SVN_ERR_WC_NOT_WORKING_COPY, NULL,
+                                 _("'%s' exists and is not a directory"),
+                                 svn_dirent_local_style(full_path, pool));
+      else if (! (kind == svn_node_dir && eb->overwrite))
+        return svn_error_createf(SVN_ERR_WC_OBSTRUCTED_UPDATE, NULL,
+                                 _("'%s' already exists"),
+                                 svn_dirent_local_style(full_path, pool));
+    }
+  else
+    SVN_ERR(err);
 
   if (eb->notify_func)
     {
@@ -619,6 +633,7 @@ add_directory(const char *path,
 
   /* Build our dir baton. */
   db->path = full_path;
+  db->abspath = svn_dirent_join(eb->root_abspath, path, pool);
   db->edit_baton = eb;
   *baton = db;
 
@@ -648,6 +663,8 @@ add_file(const char *path,
 
   fb->edit_baton = eb;
   fb->path = full_path;
+  fb->abspath = svn_dirent_join(eb->root_abspath, path, pool);
+  fb->dir_abspath = pb->abspath;
   fb->url = full_url;
   fb->repos_root_url = eb->repos_root_url;
   fb->pool = pool;
@@ -657,17 +674,6 @@ add_file(const char *path,
 }
 
 
-static svn_error_t *
-window_handler(svn_txdelta_window_t *window, void *baton)
-{
-  struct handler_baton *hb = baton;
-
-  SVN_ERR(hb->apply_handler(window, hb->apply_baton));
-
-  return SVN_NO_ERROR;
-}
-
-
 /* Create the writer for the file being exported based on the
    state in the file baton FB. */
 static svn_error_t *
@@ -681,8 +687,6 @@ open_working_file_writer(svn_wc__working_file_writer_t **writer_p,
   const char *eol;
   apr_hash_t *keywords;
   apr_time_t final_mtime;
-  const char *tmp_path;
-  const char *tmp_abspath;
 
   if (fb->eol_style_val)
     eol_style_val = fb->eol_style_val->data;
@@ -710,10 +714,8 @@ open_working_file_writer(svn_wc__working_file_writer_t **writer_p,
     final_mtime = -1;
 
   /* Create a temporary file in the same directory as the file. */
-  tmp_path = svn_dirent_dirname(fb->path, scratch_pool);
-  SVN_ERR(svn_dirent_get_absolute(&tmp_abspath, tmp_path, scratch_pool));
   SVN_ERR(svn_wc__working_file_writer_open(writer_p,
-                                           tmp_abspath,
+                                           fb->dir_abspath,
                                            final_mtime,
                                            eol_style,
                                            eol,
@@ -737,17 +739,15 @@ apply_textdelta(void *file_baton,
                 void **handler_baton)
 {
   struct file_baton *fb = file_baton;
-  struct handler_baton *hb = apr_palloc(pool, sizeof(*hb));
 
   SVN_ERR(open_working_file_writer(&fb->file_writer, fb, fb->pool, pool));
 
+  /* The delta applicator can be driven directly; no need to wrap it. */
   svn_txdelta_apply2(svn_stream_empty(pool),
                      svn_wc__working_file_writer_get_stream(fb->file_writer),
                      fb->text_digest, NULL, pool,
-                     &hb->apply_handler, &hb->apply_baton);
+                     handler, handler_baton);
 
-  *handler_baton = hb;
-  *handler = window_handler;
   return SVN_NO_ERROR;
 }
 
@@ -816,7 +816,6 @@ close_file(void *file_baton,
   struct file_baton *fb = file_baton;
   svn_checksum_t *text_checksum;
   svn_checksum_t *actual_checksum;
-  const char *target_abspath;
 
   /* Was a txdelta even sent? */
   if (! fb->file_writer)
@@ -834,11 +833,9 @@ close_file(void *file_baton,
                                      _("Checksum mismatch for '%s'"),
                                      svn_dirent_local_style(fb->path, pool));
 
-  SVN_ERR(svn_dirent_get_absolute(&target_abspath, fb->path, pool));
-
   SVN_ERR(svn_wc__working_file_writer_finalize(NULL, NULL, fb->file_writer,
                                                pool));
-  SVN_ERR(svn_wc__working_file_writer_install(fb->file_writer, target_abspath,
+  SVN_ERR(svn_wc__working_file_writer_install(fb->file_writer, fb->abspath,
                                               pool));
 
   if (fb->edit_baton->notify_func)
@@ -1236,6 +1233,8 @@ export_file(const char *from_url,
   /* This is the equivalent of a parentless add_file(). */
   fb->edit_baton = eb;
   fb->path = eb->root_path;
+  SVN_ERR(svn_dirent_get_absolute(&fb->abspath, fb->path, scratch_pool));
+  fb->dir_abspath = svn_dirent_dirname(fb->abspath, scratch_pool);
   fb->url = eb->root_url;
   fb->pool = scratch_pool;
   fb->repos_root_url = eb->repos_root_url;
@@ -1301,6 +1300,9 @@ export_directory(const char *from_url,
 
   SVN_ERR_ASSERT(svn_path_is_url(from_url));
 
+  SVN_ERR(svn_dirent_get_absolute(&eb->root_abspath, eb->root_path,
+                                  scratch_pool));
+
   if (!ENABLE_EV2_IMPL)
     SVN_ERR(get_editor_ev1(&export_editor, &edit_baton, eb, ctx,
                            scratch_pool, scratch_pool));
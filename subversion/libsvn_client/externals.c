@@ -747,6 +747,78 @@ handle_external_item_removal(const svn_client_ctx_t *ctx,
   return svn_error_trace(err);
 }
 
+/* RA sessions that may be reused while processing externals.
+
+   Externals are processed one at a time, so a session is never used
+   concurrently.  Opening a new session costs at least one round trip and
+   possibly an authentication exchange.  With many externals pointing to
+   the same few repositories, that setup latency dominates the total. */
+typedef struct external_ra_sessions_t
+{
+  /* All sessions opened so far plus the one provided by our caller,
+     if any.  Element type is svn_ra_session_t *. */
+  apr_array_header_t *sessions;
+
+  /* Pool to open new sessions in.  Must outlive the processing of
+     all externals. */
+  apr_pool_t *pool;
+} external_ra_sessions_t;
+
+/* Return a new, empty session cache allocated in RESULT_POOL.
+   Add RA_SESSION to it, unless that is NULL. */
+static external_ra_sessions_t *
+external_ra_sessions_create(svn_ra_session_t *ra_session,
+                            apr_pool_t *result_pool)
+{
+  external_ra_sessions_t *ra_sessions = apr_palloc(result_pool,
+                                                   sizeof(*ra_sessions));
+  ra_sessions->sessions = apr_array_make(result_pool, 4,
+                                         sizeof(svn_ra_session_t *));
+  ra_sessions->pool = result_pool;
+
+  if (ra_session)
+    APR_ARRAY_PUSH(ra_sessions->sessions, svn_ra_session_t *) = ra_session;
+
+  return ra_sessions;
+}
+
+/* Set *RA_SESSION to a session from RA_SESSIONS that is reparented to
+   URL.  If no session for the repository of URL has been opened, yet,
+   set *RA_SESSION to NULL.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+reuse_ra_session(svn_ra_session_t **ra_session,
+                 external_ra_sessions_t *ra_sessions,
+                 const char *url,
+                 apr_pool_t *scratch_pool)
+{
+  int i;
+
+  for (i = 0; i < ra_sessions->sessions->nelts; ++i)
+    {
+      svn_ra_session_t *session
+        = APR_ARRAY_IDX(ra_sessions->sessions, i, svn_ra_session_t *);
+
+      /* Only succeeds for URLs within the session's repository.  URLs
+         outside of it get rejected locally, but moving to one inside it
+         may cost a 'reparent' round trip with ra_svn.  That is still much
+         cheaper than opening a new session. */
+      svn_error_t *err = svn_ra_reparent(session, url, scratch_pool);
+      if (!err)
+        {
+          *ra_session = session;
+          return SVN_NO_ERROR;
+        }
+
+      if (err->apr_err != SVN_ERR_RA_ILLEGAL_URL)
+        return svn_error_trace(err);
+
+      svn_error_clear(err);
+    }
+
+  *ra_session = NULL;
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 handle_external_item_change(svn_client_ctx_t *ctx,
                             const char *repos_root_url,
@@ -755,10 +827,11 @@ handle_external_item_change(svn_client_ctx_t *ctx,
                             const char *local_abspath,
                             const char *old_defining_abspath,
                             const svn_wc_external_item2_t *new_item,
-                            svn_ra_session_t *ra_session,
+                            external_ra_sessions_t *ra_sessions,
                             svn_boolean_t *timestamp_sleep,
                             apr_pool_t *scratch_pool)
 {
+  svn_ra_session_t *ra_session;
   svn_client__pathrev_t *new_loc;
   const char *new_url;
   svn_node_kind_t ext_kind;
@@ -779,40 +852,31 @@ handle_external_item_change(svn_client_ctx_t *ctx,
                                                 scratch_pool, scratch_pool));
 
   /* Determine if the external is a file or directory. */
-  /* Get the RA connection, if needed. */
+  /* Get the RA connection, reusing an existing one if possible. */
+  SVN_ERR(reuse_ra_session(&ra_session, ra_sessions, new_url,
+                           scratch_pool));
   if (ra_session)
     {
-      svn_error_t *err = svn_ra_reparent(ra_session, new_url, scratch_pool);
-
-      if (err)
-        {
-          if (err->apr_err == SVN_ERR_RA_ILLEGAL_URL)
-            {
-              svn_error_clear(err);
-              ra_session = NULL;
-            }
-          else
-            return svn_error_trace(err);
-        }
-      else
-        {
-          SVN_ERR(svn_client__resolve_rev_and_url(&new_loc,
-                                                  ra_session, new_url,
-                                                  &(new_item->peg_revision),
-                                                  &(new_item->revision), ctx,
-                                                  scratch_pool));
-
-          SVN_ERR(svn_ra_reparent(ra_session, new_loc->url, scratch_pool));
-        }
-    }
-
-  if (!ra_session)
-    SVN_ERR(svn_client__ra_session_from_path2(&ra_session, &new_loc,
-                                              new_url, NULL,
+      SVN_ERR(svn_client__resolve_rev_and_url(&new_loc,
+                                              ra_session, new_url,
                                               &(new_item->peg_revision),
                                               &(new_item->revision), ctx,
                                               scratch_pool));
 
+      SVN_ERR(svn_ra_reparent(ra_session, new_loc->url, scratch_pool));
+    }
+  else
+    {
+      /* The session must survive this external, so allocate it in the
+         cache's pool.  This happens once per repository only. */
+      SVN_ERR(svn_client__ra_session_from_path2(&ra_session, &new_loc,
+                                                new_url, NULL,
+                                                &(new_item->peg_revision),
+                                                &(new_item->revision), ctx,
+                                                ra_sessions->pool));
+      APR_ARRAY_PUSH(ra_sessions->sessions, svn_ra_session_t *) = ra_session;
+    }
+
   SVN_ERR(svn_ra_check_path(ra_session, "", new_loc->rev, &ext_kind,
                             scratch_pool));
 
@@ -969,7 +1033,7 @@ handle_externals_change(svn_client_ctx_t *ctx,
                         apr_hash_t *old_externals,
                         svn_depth_t ambient_depth,
                         svn_depth_t requested_depth,
-                        svn_ra_session_t *ra_session,
+                        external_ra_sessions_t *ra_sessions,
                         apr_pool_t *scratch_pool)
 {
   apr_array_header_t *new_desc;
@@ -1038,7 +1102,7 @@ handle_externals_change(svn_client_ctx_t *ctx,
                                                   local_abspath, url,
                                                   target_abspath,
                                                   old_defining_abspath,
-                                                  new_item, ra_session,
+                                                  new_item, ra_sessions,
                                                   timestamp_sleep,
                                                   iterpool),
                       iterpool));
@@ -1068,10 +1132,12 @@ svn_client__handle_externals(apr_hash_t *externals_new,
   apr_hash_t *old_external_defs;
   apr_hash_index_t *hi;
   apr_pool_t *iterpool;
+  external_ra_sessions_t *ra_sessions;
 
   SVN_ERR_ASSERT(repos_root_url);
 
   iterpool = svn_pool_create(scratch_pool);
+  ra_sessions = external_ra_sessions_create(ra_session, scratch_pool);
 
   SVN_ERR(svn_wc__externals_defined_below(&old_external_defs,
                                           ctx->wc_ctx, target_abspath,
@@ -1111,7 +1177,7 @@ svn_client__handle_externals(apr_hash_t *externals_new,
                                       local_abspath,
                                       desc_text, old_external_defs,
                                       ambient_depth, requested_depth,
-                                      ra_session, iterpool));
+                                      ra_sessions, iterpool));
     }
 
   /* Remove the remaining externals */
@@ -28,6 +28,7 @@
 #include <apr_hash.h>
 
 #include "svn_delta.h"
+#include "private/svn_delta_private.h"
 
 #ifndef SVN_LIBSVN_DELTA_H
 #define SVN_LIBSVN_DELTA_H
@@ -81,6 +82,21 @@ svn_txdelta__make_window(const svn_txdelta__ops_baton_t *build_baton,
                          apr_pool_t *pool);
 
 
+/* If HANDLER with HANDLER_BATON is an svndiff encoder created by
+   svn_txdelta_to_svndiff3() that has not written anything yet, get the
+   svndiff data from SVNDIFF_FUNC with SVNDIFF_BATON, copy it to the
+   encoder's output as-is and close the encoder.  Set *SENT to TRUE in
+   that case and to FALSE if the caller has to send the windows itself.
+   Use POOL for temporary allocations. */
+svn_error_t *
+svn_txdelta__try_send_svndiff(svn_boolean_t *sent,
+                              svn_txdelta__svndiff_func_t svndiff_func,
+                              void *svndiff_baton,
+                              svn_txdelta_window_handler_t handler,
+                              void *handler_baton,
+                              apr_pool_t *pool);
+
+
 /* Create xdelta window data. Allocate temporary data from POOL. */
 void svn_txdelta__xdelta(svn_txdelta__ops_baton_t *build_baton,
                          const char *start,
@@ -323,6 +323,37 @@ svn_txdelta_to_svndiff3(svn_txdelta_window_handler_t *handler,
   *handler_baton = eb;
 }
 
+svn_error_t *
+svn_txdelta__try_send_svndiff(svn_boolean_t *sent,
+                              svn_txdelta__svndiff_func_t svndiff_func,
+                              void *svndiff_baton,
+                              svn_txdelta_window_handler_t handler,
+                              void *handler_baton,
+                              apr_pool_t *pool)
+{
+  struct encoder_baton *eb = handler_baton;
+  svn_stream_t *svndiff;
+
+  *sent = FALSE;
+  if (handler != window_handler || eb->header_done)
+    return SVN_NO_ERROR;
+
+  /* The receiver will accept any format version up to the one it asked
+     for, so there is no need to re-encode older ones. */
+  SVN_ERR(svndiff_func(&svndiff, svndiff_baton, eb->version, pool));
+  if (!svndiff)
+    return SVN_NO_ERROR;
+
+  /* The data comes with its own header. */
+  eb->header_done = TRUE;
+  SVN_ERR(svn_stream_copy3(svndiff, svn_stream_disown(eb->output, pool),
+                           NULL, NULL, pool));
+  SVN_ERR(window_handler(NULL, eb));
+
+  *sent = TRUE;
+  return SVN_NO_ERROR;
+}
+
 void
 svn_txdelta_to_svndiff2(svn_txdelta_window_handler_t *handler,
                         void **handler_baton,
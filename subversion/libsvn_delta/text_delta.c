@@ -43,6 +43,12 @@ struct svn_txdelta_stream_t {
   void *baton;
   svn_txdelta_next_window_fn_t next_window;
   svn_txdelta_md5_digest_fn_t md5_digest;
+
+  /* Source of the raw svndiff data.  May be NULL. */
+  svn_txdelta__svndiff_func_t svndiff_func;
+
+  /* TRUE, once the first window has been read. */
+  svn_boolean_t started;
 };
 
 /* Delta stream baton. */
@@ -333,6 +339,22 @@ svn_txdelta_stream_create(void *baton,
   stream->baton = baton;
   stream->next_window = next_window;
   stream->md5_digest = md5_digest;
+  stream->svndiff_func = NULL;
+  stream->started = FALSE;
+
+  return stream;
+}
+
+svn_txdelta_stream_t *
+svn_txdelta__stream_create_stored(void *baton,
+                                  svn_txdelta_next_window_fn_t next_window,
+                                  svn_txdelta_md5_digest_fn_t md5_digest,
+                                  svn_txdelta__svndiff_func_t svndiff_func,
+                                  apr_pool_t *pool)
+{
+  svn_txdelta_stream_t *stream
+    = svn_txdelta_stream_create(baton, next_window, md5_digest, pool);
+  stream->svndiff_func = svndiff_func;
 
   return stream;
 }
@@ -342,6 +364,7 @@ svn_txdelta_next_window(svn_txdelta_window_t **window,
                         svn_txdelta_stream_t *stream,
                         apr_pool_t *pool)
 {
+  stream->started = TRUE;
   return stream->next_window(window, stream->baton, pool);
 }
 
@@ -951,9 +974,21 @@ svn_error_t *svn_txdelta_send_txstream(svn_txdelta_stream_t *txstream,
                                        apr_pool_t *pool)
 {
   svn_txdelta_window_t *window;
+  apr_pool_t *wpool;
+
+  /* Don't decode stored svndiff data just to encode it again. */
+  if (txstream->svndiff_func && !txstream->started)
+    {
+      svn_boolean_t sent;
+      SVN_ERR(svn_txdelta__try_send_svndiff(&sent, txstream->svndiff_func,
+                                            txstream->baton, handler,
+                                            handler_baton, pool));
+      if (sent)
+        return SVN_NO_ERROR;
+    }
 
   /* create a pool just for the windows */
-  apr_pool_t *wpool = svn_pool_create(pool);
+  wpool = svn_pool_create(pool);
 
   do
     {
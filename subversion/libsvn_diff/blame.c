@@ -0,0 +1,240 @@
+/*
+ * blame.c :  line attribution across subsequent versions of a file
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr.h>
+#include <apr_tables.h>
+
+#include "svn_error.h"
+#include "svn_types.h"
+#include "svn_diff.h"
+#include "svn_sorts.h"
+
+#include "private/svn_diff_private.h"
+
+/* A modified range between two subsequent revisions, in tokens (lines). */
+struct blame_hunk
+{
+  apr_off_t original_start;
+  apr_off_t original_length;
+  apr_off_t modified_start;
+  apr_off_t modified_length;
+};
+
+/* The baton use for the diff output routine. */
+struct diff_baton {
+  /* Collects all struct blame_hunk in the order reported by the diff. */
+  apr_array_header_t *hunks;
+};
+
+svn_diff__blame_chain_t *
+svn_diff__blame_chain_create(apr_pool_t *result_pool)
+{
+  svn_diff__blame_chain_t *chain = apr_pcalloc(result_pool, sizeof(*chain));
+  chain->pool = result_pool;
+
+  return chain;
+}
+
+svn_diff__blame_chunk_t *
+svn_diff__blame_chunk_create(svn_diff__blame_chain_t *chain,
+                             const void *rev,
+                             apr_off_t start)
+{
+  svn_diff__blame_chunk_t *blame;
+  if (chain->avail)
+    {
+      blame = chain->avail;
+      chain->avail = blame->next;
+    }
+  else
+    blame = apr_palloc(chain->pool, sizeof(*blame));
+  blame->rev = rev;
+  blame->start = start;
+  blame->next = NULL;
+  return blame;
+}
+
+/* Destroy a blame chunk. */
+static void
+blame_destroy(svn_diff__blame_chain_t *chain,
+              svn_diff__blame_chunk_t *blame)
+{
+  blame->next = chain->avail;
+  chain->avail = blame;
+}
+
+/* Append a chunk for REV starting at token START to the chain beginning
+   at *HEAD and ending with LAST.  Either may be NULL for an empty chain.
+   Return the new last chunk.  Chunks are allocated from CHAIN. */
+static svn_diff__blame_chunk_t *
+blame_append(svn_diff__blame_chain_t *chain,
+             svn_diff__blame_chunk_t **head,
+             svn_diff__blame_chunk_t *last,
+             const void *rev,
+             apr_off_t start)
+{
+  svn_diff__blame_chunk_t *blame;
+
+  /* Never leave empty chunks behind. */
+  if (last && last->start == start)
+    {
+      last->rev = rev;
+      return last;
+    }
+
+  blame = svn_diff__blame_chunk_create(chain, rev, start);
+  if (last)
+    last->next = blame;
+  else
+    *head = blame;
+
+  return blame;
+}
+
+/* Update the blame in CHAIN for the changes between the previous revision
+   and REV as given by HUNKS, an array of struct blame_hunk in ascending
+   order.
+
+   The chain is rebuilt in a single pass over the old chunks and the hunks.
+   Applying the hunks one by one would require a linear search for the
+   affected chunks and an update of the start of all chunks following it,
+   i.e. O(N * M) for N chunks and M hunks instead of O(N + M). */
+static void
+blame_apply_hunks(svn_diff__blame_chain_t *chain,
+                  const void *rev,
+                  const apr_array_header_t *hunks)
+{
+  svn_diff__blame_chunk_t *old = chain->blame; /* Remainder of the old
+                                                  chain. */
+  svn_diff__blame_chunk_t *head = NULL;        /* The new chain. */
+  svn_diff__blame_chunk_t *last = NULL;
+  apr_off_t pos = 0;                  /* Next token in the old version. */
+  apr_off_t delta = 0;                /* New token position minus POS. */
+  int i;
+
+  /* The old chain always covers [0, infinity) and OLD is always the chunk
+     containing POS.  The extra iteration copies the tail after the last
+     hunk. */
+  for (i = 0; i <= hunks->nelts; ++i)
+    {
+      const struct blame_hunk *hunk
+        = i < hunks->nelts ? &APR_ARRAY_IDX(hunks, i, struct blame_hunk)
+                           : NULL;
+
+      /* Copy the unchanged blame up to the start of HUNK. */
+      while (old && (!hunk || MAX(old->start, pos) < hunk->original_start))
+        {
+          svn_diff__blame_chunk_t *next = old->next;
+
+          last = blame_append(chain, &head, last, old->rev,
+                              MAX(old->start, pos) + delta);
+
+          /* Will OLD continue after HUNK? */
+          if (hunk && (!next || next->start > hunk->original_start))
+            break;
+
+          blame_destroy(chain, old);
+          old = next;
+        }
+
+      if (!hunk)
+        break;
+
+      /* The tokens added in HUNK are to be blamed on REV. */
+      if (hunk->modified_length)
+        last = blame_append(chain, &head, last, rev, hunk->modified_start);
+
+      /* Skip the blame for all tokens that HUNK removed. */
+      pos = hunk->original_start + hunk->original_length;
+      delta = hunk->modified_start + hunk->modified_length - pos;
+
+      while (old && old->next && old->next->start <= pos)
+        {
+          svn_diff__blame_chunk_t *next = old->next;
+          blame_destroy(chain, old);
+          old = next;
+        }
+    }
+
+  chain->blame = head;
+}
+
+/* Callback for diff between subsequent revisions */
+static svn_error_t *
+output_diff_modified(void *baton,
+                     apr_off_t original_start,
+                     apr_off_t original_length,
+                     apr_off_t modified_start,
+                     apr_off_t modified_length,
+                     apr_off_t latest_start,
+                     apr_off_t latest_length)
+{
+  struct diff_baton *db = baton;
+  struct blame_hunk *hunk = apr_array_push(db->hunks);
+
+  hunk->original_start = original_start;
+  hunk->original_length = original_length;
+  hunk->modified_start = modified_start;
+  hunk->modified_length = modified_length;
+
+  return SVN_NO_ERROR;
+}
+
+static const svn_diff_output_fns_t output_fns = {
+        NULL,
+        output_diff_modified
+};
+
+svn_error_t *
+svn_diff__blame_add_file(svn_diff__blame_chain_t *chain,
+                         const char *last_file,
+                         const char *cur_file,
+                         const void *rev,
+                         const svn_diff_file_options_t *diff_options,
+                         svn_cancel_func_t cancel_func,
+                         void *cancel_baton,
+                         apr_pool_t *scratch_pool)
+{
+  if (!last_file)
+    {
+      SVN_ERR_ASSERT(chain->blame == NULL);
+      chain->blame = svn_diff__blame_chunk_create(chain, rev, 0);
+    }
+  else
+    {
+      svn_diff_t *diff;
+      struct diff_baton diff_baton;
+
+      diff_baton.hunks = apr_array_make(scratch_pool, 16,
+                                        sizeof(struct blame_hunk));
+
+      /* We have a previous file.  Get the diff and adjust blame info. */
+      SVN_ERR(svn_diff_file_diff_2(&diff, last_file, cur_file,
+                                   diff_options, scratch_pool));
+      SVN_ERR(svn_diff_output2(diff, &diff_baton, &output_fns,
+                               cancel_func, cancel_baton));
+      blame_apply_hunks(chain, rev, diff_baton.hunks);
+    }
+
+  return SVN_NO_ERROR;
+}
@@ -114,6 +114,26 @@ svn_diff__lcs(svn_diff__position_t *position_list1, /* pointer to tail (ring) */
               apr_off_t suffix_lines,
               apr_pool_t *pool);
 
+/*
+ * Like svn_diff__lcs(), but first match up the tokens that occur exactly
+ * once in each of POSITION_LIST1 and POSITION_LIST2 ("patience diff").
+ * The longest increasing sequence of those unique matches is used as a
+ * set of anchors, and svn_diff__lcs() only runs on the ranges between
+ * consecutive anchors.  On large inputs with many unique lines (generated
+ * files, tables) this is near-linear, while svn_diff__lcs() may degrade to
+ * quadratic behavior.  The result is a common subsequence, but not
+ * necessarily the longest one.
+ */
+svn_diff__lcs_t *
+svn_diff__lcs_patience(svn_diff__position_t *position_list1,
+                       svn_diff__position_t *position_list2,
+                       svn_diff__token_index_t *token_counts_list1,
+                       svn_diff__token_index_t *token_counts_list2,
+                       svn_diff__token_index_t num_tokens,
+                       apr_off_t prefix_lines,
+                       apr_off_t suffix_lines,
+                       apr_pool_t *pool);
+
 
 /*
  * Returns number of tokens in a tree
@@ -158,6 +178,15 @@ svn_diff__diff(svn_diff__lcs_t *lcs,
                svn_boolean_t want_common,
                apr_pool_t *pool);
 
+/* Implementation of svn_diff_diff_2().  If PATIENCE is TRUE, use
+ * svn_diff__lcs_patience() instead of svn_diff__lcs(). */
+svn_error_t *
+svn_diff__diff_2(svn_diff_t **diff,
+                 void *diff_baton,
+                 const svn_diff_fns2_t *vtable,
+                 svn_boolean_t patience,
+                 apr_pool_t *pool);
+
 void
 svn_diff__resolve_conflict(svn_diff_t *hunk,
                            svn_diff__position_t **position_list1,
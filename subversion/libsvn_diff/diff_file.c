@@ -86,6 +86,12 @@ typedef struct svn_diff__file_baton_t
     char *curp;    /* current position in the current chunk */
     char *endp;    /* next memory address after the current chunk */
 
+    /* If not NULL, the whole file is mapped into memory at this address
+       and BUFFER points into the mapping rather than to a copy of the
+       current chunk.  Only used if no normalization is required, since
+       that happens in place. */
+    char *mapped;
+
     svn_diff__normalize_state_t normalize_state;
 
     /* Where the identical suffix starts in this datasource */
@@ -152,6 +158,25 @@ read_chunk(apr_file_t *file,
 }
 
 
+/* Point FILE->BUFFER to the LENGTH bytes of chunk number CHUNK of FILE.
+ * If FILE is memory-mapped, this is a simple pointer update.  Otherwise,
+ * read the data into the existing buffer.
+ */
+static APR_INLINE svn_error_t *
+load_chunk(struct file_info *file, int chunk, apr_off_t length,
+           apr_pool_t *scratch_pool)
+{
+  if (file->mapped)
+    {
+      file->buffer = file->mapped + chunk_to_offset((apr_off_t) chunk);
+      return SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(read_chunk(file->file, file->buffer, length,
+                                    chunk_to_offset(chunk), scratch_pool));
+}
+
+
 /* Map or read a file at PATH. *BUFFER will point to the file
  * contents; if the file was mapped, *FILE and *MM will contain the
  * mmap context; otherwise they will be NULL.  SIZE will contain the
@@ -288,9 +313,7 @@ increment_chunk(struct file_info *file, apr_pool_t *pool)
       file->chunk++;
       length = file->chunk == last_chunk ?
         offset_in_chunk(file->size) : CHUNK_SIZE;
-      SVN_ERR(read_chunk(file->file, file->buffer,
-                         length, chunk_to_offset(file->chunk),
-                         pool));
+      SVN_ERR(load_chunk(file, file->chunk, length, pool));
       file->endp = file->buffer + length;
       file->curp = file->buffer;
     }
@@ -315,9 +338,7 @@ decrement_chunk(struct file_info *file, apr_pool_t *pool)
     {
       /* Read previous chunk and reset pointers. */
       file->chunk--;
-      SVN_ERR(read_chunk(file->file, file->buffer,
-                         CHUNK_SIZE, chunk_to_offset(file->chunk),
-                         pool));
+      SVN_ERR(load_chunk(file, file->chunk, CHUNK_SIZE, pool));
       file->endp = file->buffer + CHUNK_SIZE;
       file->curp = file->endp - 1;
     }
@@ -370,6 +391,31 @@ static svn_boolean_t contains_eol(apr_uintptr_t chunk)
 
   return (r_test & n_test & SVN__BIT_7_SET) != SVN__BIT_7_SET;
 }
+
+/* Quickly determine whether there is a \r char in CHUNK. */
+static svn_boolean_t contains_cr(apr_uintptr_t chunk)
+{
+  apr_uintptr_t r_test = chunk ^ SVN__N_MASK;
+
+  r_test |= (r_test & SVN__LOWER_7BITS_SET) + SVN__LOWER_7BITS_SET;
+
+  return (r_test & SVN__BIT_7_SET) != SVN__BIT_7_SET;
+}
+
+/* Return the number of \n chars in CHUNK. */
+static apr_size_t count_lf(apr_uintptr_t chunk)
+{
+  apr_uintptr_t n_test = chunk ^ SVN__R_MASK;
+
+  /* Unlike in contains_eol(), we need an exact result per byte: bit 7 of
+   * a byte in N_TEST gets set iff that byte was \n in CHUNK. */
+  n_test = ~(((n_test & SVN__LOWER_7BITS_SET) + SVN__LOWER_7BITS_SET)
+             | n_test) & SVN__BIT_7_SET;
+
+  /* Sum up the flags of all bytes in the topmost byte. */
+  return (apr_size_t)(((n_test >> 7) * (SVN__BIT_7_SET >> 7))
+                      >> ((sizeof(apr_uintptr_t) - 1) * 8));
+}
 #endif
 
 /* Find the prefix which is identical between all elements of the FILE array.
@@ -438,8 +484,6 @@ find_identical_prefix(svn_boolean_t *reached_one_eof, apr_off_t *prefix_lines,
       for (delta = 0; delta < max_delta; delta += sizeof(apr_uintptr_t))
         {
           apr_uintptr_t chunk = *(const apr_uintptr_t *)(file[0].curp + delta);
-          if (contains_eol(chunk))
-            break;
 
           for (i = 1; i < file_len; i++)
             if (chunk != *(const apr_uintptr_t *)(file[i].curp + delta))
@@ -450,18 +494,31 @@ find_identical_prefix(svn_boolean_t *reached_one_eof, apr_off_t *prefix_lines,
 
           if (! is_match)
             break;
+
+          /* Lines ending in a plain \n can be counted without leaving the
+           * fast path.  Anything involving a \r, including a \n that
+           * directly follows a \r we just processed, is left to the
+           * byte-wise code above. */
+          if (contains_eol(chunk))
+            {
+              if ((delta == 0 && had_cr) || contains_cr(chunk))
+                break;
+
+              lines += count_lf(chunk);
+            }
         }
 
       if (delta /* > 0*/)
         {
-          /* We either found a mismatch or an EOL at or shortly behind curp+delta
-           * or we cannot proceed with chunky ops without exceeding endp.
-           * In any way, everything up to curp + delta is equal and not an EOL.
+          /* We either found a mismatch or a \r at or shortly behind
+           * curp+delta or we cannot proceed with chunky ops without
+           * exceeding endp.  In any way, everything up to curp + delta is
+           * equal and does not contain a \r.
            */
           for (i = 0; i < file_len; i++)
             file[i].curp += delta;
 
-          /* Skipped data without EOL markers, so last char was not a CR. */
+          /* Skipped data without CR markers, so last char was not a CR. */
           had_cr = FALSE;
         }
 #endif
@@ -553,6 +610,7 @@ find_identical_suffix(apr_off_t *suffix_lines, struct file_info file[],
     {
       file_for_suffix[i].path = file[i].path;
       file_for_suffix[i].file = file[i].file;
+      file_for_suffix[i].mapped = file[i].mapped;
       file_for_suffix[i].size = file[i].size;
       file_for_suffix[i].chunk =
         (int) offset_to_chunk(file_for_suffix[i].size); /* last chunk */
@@ -572,12 +630,11 @@ find_identical_suffix(apr_off_t *suffix_lines, struct file_info file[],
       else
         {
           /* There is at least more than 1 chunk,
-             so allocate full chunk size buffer */
-          file_for_suffix[i].buffer = apr_palloc(pool, CHUNK_SIZE);
-          SVN_ERR(read_chunk(file_for_suffix[i].file,
-                             file_for_suffix[i].buffer, length[i],
-                             chunk_to_offset(file_for_suffix[i].chunk),
-                             pool));
+             so allocate full chunk size buffer, unless mapped */
+          if (! file_for_suffix[i].mapped)
+            file_for_suffix[i].buffer = apr_palloc(pool, CHUNK_SIZE);
+          SVN_ERR(load_chunk(&file_for_suffix[i], file_for_suffix[i].chunk,
+                             length[i], pool));
         }
       file_for_suffix[i].endp = file_for_suffix[i].buffer + length[i];
       file_for_suffix[i].curp = file_for_suffix[i].endp - 1;
@@ -661,7 +718,7 @@ find_identical_suffix(apr_off_t *suffix_lines, struct file_info file[],
 
           chunk = *(const apr_uintptr_t *)(file_for_suffix[0].curp + 1
                                              - sizeof(apr_uintptr_t));
-          if (contains_eol(chunk))
+          if (contains_cr(chunk))
             break;
 
           for (i = 1, is_match = TRUE; is_match && i < file_len; i++)
@@ -673,6 +730,9 @@ find_identical_suffix(apr_off_t *suffix_lines, struct file_info file[],
           if (! is_match)
             break;
 
+          /* Without any \r, every \n ends exactly one line. */
+          lines += count_lf(chunk);
+
           for (i = 0; i < file_len; i++)
             {
               file_for_suffix[i].curp -= sizeof(apr_uintptr_t);
@@ -682,8 +742,10 @@ find_identical_suffix(apr_off_t *suffix_lines, struct file_info file[],
                                   > min_curp[i]);
             }
 
-          /* We skipped some bytes, so there are no closing EOLs */
-          had_nl = FALSE;
+          /* The byte following curp is the first one of the word we just
+             skipped.  A \r right before it must not end another line
+             if it is a \n. */
+          had_nl = (file_for_suffix[0].curp[1] == '\n');
         }
 
       /* The > min_curp[i] check leaves at least one final byte for checking
@@ -799,9 +861,48 @@ datasources_open(void *baton,
       SVN_ERR(svn_io_file_size_get(&filesize, file->file, file_baton->pool));
       file->size = filesize;
       length[i] = filesize > CHUNK_SIZE ? CHUNK_SIZE : filesize;
-      file->buffer = apr_palloc(file_baton->pool, (apr_size_t) length[i]);
-      SVN_ERR(read_chunk(file->file, file->buffer,
-                         length[i], 0, file_baton->pool));
+      file->mapped = NULL;
+
+#if APR_HAS_MMAP
+      /* Map regular files as a whole, so that moving between chunks and
+       * comparing tokens does not copy any data.  The mapping is read-only,
+       * so we can't do that if the tokens get normalized in place.  If the
+       * mapping fails, e.g. for special files, use the chunked reads.
+       *
+       * Like APR does for file buckets, don't map more than APR_MMAP_LIMIT
+       * bytes per file.  Also, only map files without any write permission,
+       * such as pristines.  Accessing a mapping of a file that got truncated
+       * during the diff raises SIGBUS, while the chunked reads simply fail. */
+      if (filesize > APR_MMAP_THRESHOLD && filesize <= APR_MMAP_LIMIT
+          && ! file_baton->options->ignore_space
+          && ! file_baton->options->ignore_eol_style)
+        {
+          apr_finfo_t finfo;
+          apr_mmap_t *mm;
+
+          SVN_ERR(svn_io_file_info_get(&finfo, APR_FINFO_PROT, file->file,
+                                       file_baton->pool));
+          if ((finfo.valid & APR_FINFO_PROT)
+              && ! (finfo.protection
+                    & (APR_UWRITE | APR_GWRITE | APR_WWRITE))
+              && apr_mmap_create(&mm, file->file, 0, (apr_size_t) filesize,
+                                 APR_MMAP_READ,
+                                 file_baton->pool) == APR_SUCCESS)
+            file->mapped = mm->mm;
+        }
+#endif /* APR_HAS_MMAP */
+
+      if (file->mapped)
+        {
+          file->buffer = file->mapped;
+        }
+      else
+        {
+          file->buffer = apr_palloc(file_baton->pool,
+                                    (apr_size_t) length[i]);
+          SVN_ERR(read_chunk(file->file, file->buffer,
+                             length[i], 0, file_baton->pool));
+        }
       file->endp = file->buffer + length[i];
       file->curp = file->buffer;
       /* Set suffix_start_chunk to a guard value, so if suffix scanning is
@@ -953,12 +1054,9 @@ datasource_get_next_token(apr_uint32_t *hash, void **token, void *baton,
         h = svn__adler32(h, c, length);
       }
 
-      curp = endp = file->buffer;
       file->chunk++;
       length = file->chunk == last_chunk ?
         offset_in_chunk(file->size) : CHUNK_SIZE;
-      endp += length;
-      file->endp = endp;
 
       /* Issue #4283: Normally we should have checked for reaching the skipped
          suffix here, but because we assume that a suffix always starts on a
@@ -968,10 +1066,10 @@ datasource_get_next_token(apr_uint32_t *hash, void **token, void *baton,
          When changing things here, make sure the whitespace settings are
          applied, or we might not reach the exact suffix boundary as token
          boundary. */
-      SVN_ERR(read_chunk(file->file,
-                         curp, length,
-                         chunk_to_offset(file->chunk),
-                         file_baton->pool));
+      SVN_ERR(load_chunk(file, file->chunk, length, file_baton->pool));
+      curp = endp = file->buffer;
+      endp += length;
+      file->endp = endp;
 
       /* If the last chunk ended in a CR, we're done. */
       if (had_cr)
@@ -1062,7 +1160,15 @@ token_compare(void *baton, void *token1, void *token2, int *compare)
       offset[i] = file_token[i]->norm_offset;
       state[i] = svn_diff__normalize_state_normal;
 
-      if (offset_to_chunk(offset[i]) == file[i]->chunk)
+      if (file[i]->mapped)
+        {
+          /* The entire file is in memory. */
+          bufp[i] = file[i]->mapped + offset[i];
+
+          length[i] = total_length;
+          raw_length[i] = 0;
+        }
+      else if (offset_to_chunk(offset[i]) == file[i]->chunk)
         {
           /* If the start of the token is in memory, the entire token is
            * in memory.
@@ -1182,6 +1288,9 @@ static const svn_diff_fns2_t svn_diff__file_vtable =
 /* Id for the --ignore-eol-style option, which doesn't have a short name. */
 #define SVN_DIFF__OPT_IGNORE_EOL_STYLE 256
 
+/* Id for the --patience option, which doesn't have a short name either. */
+#define SVN_DIFF__OPT_PATIENCE 257
+
 /* Options supported by svn_diff_file_options_parse(). */
 static const apr_getopt_option_t diff_options[] =
 {
@@ -1189,6 +1298,7 @@ static const apr_getopt_option_t diff_options[] =
   { "ignore-all-space", 'w', 0, NULL },
   { "ignore-eol-style", SVN_DIFF__OPT_IGNORE_EOL_STYLE, 0, NULL },
   { "show-c-function", 'p', 0, NULL },
+  { "patience", SVN_DIFF__OPT_PATIENCE, 0, NULL },
   /* ### For compatibility; we don't support the argument to -u, because
    * ### we don't have optional argument support. */
   { "unified", 'u', 0, NULL },
@@ -1295,6 +1405,9 @@ svn_diff_file_options_parse(svn_diff_file_options_t *options,
         case 'p':
           options->show_c_function = TRUE;
           break;
+        case SVN_DIFF__OPT_PATIENCE:
+          options->patience = TRUE;
+          break;
         case 'U':
           SVN_ERR(svn_cstring_atoi(&options->context_size, opt_arg));
           break;
@@ -1326,7 +1439,8 @@ svn_diff_file_diff_2(svn_diff_t **diff,
   baton.files[1].path = modified;
   baton.pool = svn_pool_create(pool);
 
-  SVN_ERR(svn_diff_diff_2(diff, &baton, &svn_diff__file_vtable, pool));
+  SVN_ERR(svn_diff__diff_2(diff, &baton, &svn_diff__file_vtable,
+                           options->patience, pool));
 
   svn_pool_destroy(baton.pool);
   return SVN_NO_ERROR;
@@ -228,66 +228,31 @@ prepend_lcs(svn_diff__lcs_t *lcs, apr_off_t lines,
 }
 
 
-svn_diff__lcs_t *
-svn_diff__lcs(svn_diff__position_t *position_list1, /* pointer to tail (ring) */
-              svn_diff__position_t *position_list2, /* pointer to tail (ring) */
-              svn_diff__token_index_t *token_counts_list1, /* array of counts */
-              svn_diff__token_index_t *token_counts_list2, /* array of counts */
-              svn_diff__token_index_t num_tokens,
-              apr_off_t prefix_lines,
-              apr_off_t suffix_lines,
-              apr_pool_t *pool)
+/* Run the O(NP) algorithm on the (non-empty) position rings POSITION_LIST1
+ * and POSITION_LIST2, both pointing to the tail of their ring.  TOKEN_COUNTS
+ * are used to skip tokens that do not occur in the other file at all, and
+ * UNIQUE_COUNT[i] must be the number of positions in ring i that will be
+ * skipped that way.
+ *
+ * Return the chain of matches found, in reverse order (i.e. the last match
+ * first) and without the EOF sentinel.  Allocations are made in POOL.
+ */
+static svn_diff__lcs_t *
+lcs_ring(svn_diff__position_t *position_list1,
+         svn_diff__position_t *position_list2,
+         svn_diff__token_index_t *token_counts[2],
+         svn_diff__token_index_t unique_count[2],
+         apr_pool_t *pool)
 {
   apr_off_t length[2];
-  svn_diff__token_index_t *token_counts[2];
-  svn_diff__token_index_t unique_count[2];
-  svn_diff__token_index_t token_index;
   svn_diff__snake_t *fp;
   apr_off_t d;
   apr_off_t k;
   apr_off_t p = 0;
-  svn_diff__lcs_t *lcs, *lcs_freelist = NULL;
+  svn_diff__lcs_t *lcs_freelist = NULL;
 
   svn_diff__position_t sentinel_position[2];
 
-  /* Since EOF is always a sync point we tack on an EOF link
-   * with sentinel positions
-   */
-  lcs = apr_palloc(pool, sizeof(*lcs));
-  lcs->position[0] = apr_pcalloc(pool, sizeof(*lcs->position[0]));
-  lcs->position[0]->offset = position_list1
-                             ? position_list1->offset + suffix_lines + 1
-                             : prefix_lines + suffix_lines + 1;
-  lcs->position[1] = apr_pcalloc(pool, sizeof(*lcs->position[1]));
-  lcs->position[1]->offset = position_list2
-                             ? position_list2->offset + suffix_lines + 1
-                             : prefix_lines + suffix_lines + 1;
-  lcs->length = 0;
-  lcs->refcount = 1;
-  lcs->next = NULL;
-
-  if (position_list1 == NULL || position_list2 == NULL)
-    {
-      if (suffix_lines)
-        lcs = prepend_lcs(lcs, suffix_lines,
-                          lcs->position[0]->offset - suffix_lines,
-                          lcs->position[1]->offset - suffix_lines,
-                          pool);
-      if (prefix_lines)
-        lcs = prepend_lcs(lcs, prefix_lines, 1, 1, pool);
-
-      return lcs;
-    }
-
-  unique_count[1] = unique_count[0] = 0;
-  for (token_index = 0; token_index < num_tokens; token_index++)
-    {
-      if (token_counts_list1[token_index] == 0)
-        unique_count[1] += token_counts_list2[token_index];
-      if (token_counts_list2[token_index] == 0)
-        unique_count[0] += token_counts_list1[token_index];
-    }
-
   /* Calculate lengths M and N of the sequences to be compared. Do not
    * count tokens unique to one file, as those are ignored in __snake.
    */
@@ -313,12 +278,10 @@ svn_diff__lcs(svn_diff__position_t *position_list1, /* pointer to tail (ring) */
   sentinel_position[0].next = position_list1->next;
   position_list1->next = &sentinel_position[0];
   sentinel_position[0].offset = position_list1->offset + 1;
-  token_counts[0] = token_counts_list1;
 
   sentinel_position[1].next = position_list2->next;
   position_list2->next = &sentinel_position[1];
   sentinel_position[1].offset = position_list2->offset + 1;
-  token_counts[1] = token_counts_list2;
 
   /* Negative indices will not be used elsewhere
    */
@@ -355,21 +318,356 @@ svn_diff__lcs(svn_diff__position_t *position_list1, /* pointer to tail (ring) */
     }
   while (fp[0].position[1] != &sentinel_position[1]);
 
+  position_list1->next = sentinel_position[0].next;
+  position_list2->next = sentinel_position[1].next;
+
+  return fp[0].lcs;
+}
+
+
+/* Allocate the EOF sentinel lcs for the position rings POSITION_LIST1 and
+ * POSITION_LIST2 (either of which may be NULL), taking PREFIX_LINES and
+ * SUFFIX_LINES into account.  Allocate it in POOL. */
+static svn_diff__lcs_t *
+eof_lcs(svn_diff__position_t *position_list1,
+        svn_diff__position_t *position_list2,
+        apr_off_t prefix_lines,
+        apr_off_t suffix_lines,
+        apr_pool_t *pool)
+{
+  svn_diff__lcs_t *lcs;
+
+  lcs = apr_palloc(pool, sizeof(*lcs));
+  lcs->position[0] = apr_pcalloc(pool, sizeof(*lcs->position[0]));
+  lcs->position[0]->offset = position_list1
+                             ? position_list1->offset + suffix_lines + 1
+                             : prefix_lines + suffix_lines + 1;
+  lcs->position[1] = apr_pcalloc(pool, sizeof(*lcs->position[1]));
+  lcs->position[1]->offset = position_list2
+                             ? position_list2->offset + suffix_lines + 1
+                             : prefix_lines + suffix_lines + 1;
+  lcs->length = 0;
+  lcs->refcount = 1;
+  lcs->next = NULL;
+
+  return lcs;
+}
+
+
+/* Link the reversed match chain REVERSED_LCS in front of the EOF sentinel
+ * EOF_LCS, add the identical PREFIX_LINES and SUFFIX_LINES and return the
+ * chain in forward order.  Allocate in POOL. */
+static svn_diff__lcs_t *
+finish_lcs(svn_diff__lcs_t *eof_lcs,
+           svn_diff__lcs_t *reversed_lcs,
+           apr_off_t prefix_lines,
+           apr_off_t suffix_lines,
+           apr_pool_t *pool)
+{
+  svn_diff__lcs_t *lcs = eof_lcs;
+
   if (suffix_lines)
-    lcs->next = prepend_lcs(fp[0].lcs, suffix_lines,
+    lcs->next = prepend_lcs(reversed_lcs, suffix_lines,
                             lcs->position[0]->offset - suffix_lines,
                             lcs->position[1]->offset - suffix_lines,
                             pool);
   else
-    lcs->next = fp[0].lcs;
+    lcs->next = reversed_lcs;
 
   lcs = svn_diff__lcs_reverse(lcs);
 
-  position_list1->next = sentinel_position[0].next;
-  position_list2->next = sentinel_position[1].next;
-
   if (prefix_lines)
     return prepend_lcs(lcs, prefix_lines, 1, 1, pool);
   else
     return lcs;
 }
+
+
+svn_diff__lcs_t *
+svn_diff__lcs(svn_diff__position_t *position_list1, /* pointer to tail (ring) */
+              svn_diff__position_t *position_list2, /* pointer to tail (ring) */
+              svn_diff__token_index_t *token_counts_list1, /* array of counts */
+              svn_diff__token_index_t *token_counts_list2, /* array of counts */
+              svn_diff__token_index_t num_tokens,
+              apr_off_t prefix_lines,
+              apr_off_t suffix_lines,
+              apr_pool_t *pool)
+{
+  svn_diff__token_index_t *token_counts[2];
+  svn_diff__token_index_t unique_count[2];
+  svn_diff__token_index_t token_index;
+  svn_diff__lcs_t *lcs;
+
+  /* Since EOF is always a sync point we tack on an EOF link
+   * with sentinel positions
+   */
+  lcs = eof_lcs(position_list1, position_list2, prefix_lines, suffix_lines,
+                pool);
+
+  if (position_list1 == NULL || position_list2 == NULL)
+    return finish_lcs(lcs, NULL, prefix_lines, suffix_lines, pool);
+
+  unique_count[1] = unique_count[0] = 0;
+  for (token_index = 0; token_index < num_tokens; token_index++)
+    {
+      if (token_counts_list1[token_index] == 0)
+        unique_count[1] += token_counts_list2[token_index];
+      if (token_counts_list2[token_index] == 0)
+        unique_count[0] += token_counts_list1[token_index];
+    }
+
+  token_counts[0] = token_counts_list1;
+  token_counts[1] = token_counts_list2;
+
+  return finish_lcs(lcs,
+                    lcs_ring(position_list1, position_list2,
+                             token_counts, unique_count, pool),
+                    prefix_lines, suffix_lines, pool);
+}
+
+
+/* Return TRUE if a match starting at POSITION0 and POSITION1 directly
+ * follows the match LCS in both files. */
+static APR_INLINE svn_boolean_t
+lcs_adjacent(const svn_diff__lcs_t *lcs,
+             const svn_diff__position_t *position0,
+             const svn_diff__position_t *position1)
+{
+  return lcs->position[0]->offset + lcs->length == position0->offset
+         && lcs->position[1]->offset + lcs->length == position1->offset;
+}
+
+/* Count the positions in the ring POSITION_LIST whose token does not occur
+ * in the other file at all, according to OTHER_TOKEN_COUNTS. */
+static svn_diff__token_index_t
+count_unmatchable(svn_diff__position_t *position_list,
+                  const svn_diff__token_index_t *other_token_counts)
+{
+  svn_diff__token_index_t count = 0;
+  svn_diff__position_t *position = position_list;
+
+  do
+    {
+      position = position->next;
+      if (other_token_counts[position->token_index] == 0)
+        count++;
+    }
+  while (position != position_list);
+
+  return count;
+}
+
+/* A token that occurs exactly once in each file.  We store the predecessors
+ * of the matching positions, because the ranges between two anchors must
+ * be turned into rings of their own. */
+typedef struct patience_match_t
+{
+  svn_diff__position_t *before[2];
+
+  /* Index of the previous match in the increasing sequence ending here,
+   * or -1. */
+  svn_diff__token_index_t previous;
+} patience_match_t;
+
+svn_diff__lcs_t *
+svn_diff__lcs_patience(svn_diff__position_t *position_list1,
+                       svn_diff__position_t *position_list2,
+                       svn_diff__token_index_t *token_counts_list1,
+                       svn_diff__token_index_t *token_counts_list2,
+                       svn_diff__token_index_t num_tokens,
+                       apr_off_t prefix_lines,
+                       apr_off_t suffix_lines,
+                       apr_pool_t *pool)
+{
+  svn_diff__token_index_t *token_counts[2];
+  svn_diff__position_t *position_list[2];
+  svn_diff__position_t **before2;
+  svn_diff__position_t *before;
+  patience_match_t *matches;
+  svn_diff__token_index_t *tails;
+  svn_diff__token_index_t match_count;
+  svn_diff__token_index_t anchor_count;
+  patience_match_t **anchors;
+  svn_diff__token_index_t i, j;
+  svn_diff__position_t *previous_anchor[2];
+  svn_diff__lcs_t *lcs = NULL;
+  svn_diff__lcs_t *eof;
+
+  if (position_list1 == NULL || position_list2 == NULL)
+    return svn_diff__lcs(position_list1, position_list2,
+                         token_counts_list1, token_counts_list2, num_tokens,
+                         prefix_lines, suffix_lines, pool);
+
+  token_counts[0] = token_counts_list1;
+  token_counts[1] = token_counts_list2;
+  position_list[0] = position_list1;
+  position_list[1] = position_list2;
+
+  /* Remember where each token that is unique in both files sits in the
+   * modified file. */
+  before2 = apr_pcalloc(pool, num_tokens * sizeof(*before2));
+  before = position_list2;
+  do
+    {
+      svn_diff__token_index_t token_index = before->next->token_index;
+
+      if (token_counts_list1[token_index] == 1
+          && token_counts_list2[token_index] == 1)
+        before2[token_index] = before;
+
+      before = before->next;
+    }
+  while (before != position_list2);
+
+  /* Collect those matches in the order of the original file and compute
+   * the longest sequence that is also increasing in the modified file,
+   * using patience sorting.  TAILS[j] is the match ending the best known
+   * increasing sequence of length j+1. */
+  matches = apr_palloc(pool, num_tokens * sizeof(*matches));
+  tails = apr_palloc(pool, num_tokens * sizeof(*tails));
+  match_count = 0;
+  anchor_count = 0;
+  before = position_list1;
+  do
+    {
+      svn_diff__token_index_t token_index = before->next->token_index;
+
+      if (before2[token_index])
+        {
+          patience_match_t *match = &matches[match_count];
+          apr_off_t offset = before2[token_index]->next->offset;
+          svn_diff__token_index_t low = 0;
+          svn_diff__token_index_t high = anchor_count;
+
+          while (low < high)
+            {
+              svn_diff__token_index_t mid = low + (high - low) / 2;
+
+              if (matches[tails[mid]].before[1]->next->offset < offset)
+                low = mid + 1;
+              else
+                high = mid;
+            }
+
+          match->before[0] = before;
+          match->before[1] = before2[token_index];
+          match->previous = low > 0 ? tails[low - 1] : -1;
+          tails[low] = match_count;
+          if (low == anchor_count)
+            anchor_count++;
+
+          match_count++;
+        }
+
+      before = before->next;
+    }
+  while (before != position_list1);
+
+  /* Without anchors there is nothing to gain. */
+  if (anchor_count == 0)
+    return svn_diff__lcs(position_list1, position_list2,
+                         token_counts_list1, token_counts_list2, num_tokens,
+                         prefix_lines, suffix_lines, pool);
+
+  /* Put the anchors in order. */
+  anchors = apr_palloc(pool, anchor_count * sizeof(*anchors));
+  j = anchor_count;
+  for (i = tails[anchor_count - 1]; i >= 0; i = matches[i].previous)
+    anchors[--j] = &matches[i];
+
+  eof = eof_lcs(position_list1, position_list2, prefix_lines, suffix_lines,
+                pool);
+
+  /* Walk the anchors, running the O(NP) algorithm on the gaps before each
+   * of them and after the last one.  LCS collects the matches in reverse
+   * order, like lcs_ring() does. */
+  previous_anchor[0] = previous_anchor[1] = NULL;
+  for (i = 0; i <= anchor_count; i++)
+    {
+      svn_diff__position_t *gap_start[2];
+      svn_diff__position_t *gap_end[2];
+      svn_boolean_t gap_empty = FALSE;
+
+      for (j = 0; j < 2; j++)
+        {
+          gap_start[j] = previous_anchor[j]
+                         ? previous_anchor[j]->next
+                         : position_list[j]->next;
+          gap_end[j] = i < anchor_count
+                       ? anchors[i]->before[j]
+                       : position_list[j];
+
+          if (previous_anchor[j] == gap_end[j]
+              || (previous_anchor[j] == NULL && i < anchor_count
+                  && gap_end[j] == position_list[j]))
+            gap_empty = TRUE;
+        }
+
+      if (! gap_empty)
+        {
+          svn_diff__position_t *saved_next[2];
+          svn_diff__token_index_t unique_count[2];
+          svn_diff__lcs_t *gap_lcs;
+
+          /* Temporarily close each gap into a ring of its own. */
+          for (j = 0; j < 2; j++)
+            {
+              saved_next[j] = gap_end[j]->next;
+              gap_end[j]->next = gap_start[j];
+            }
+
+          unique_count[0] = count_unmatchable(gap_end[0], token_counts[1]);
+          unique_count[1] = count_unmatchable(gap_end[1], token_counts[0]);
+          gap_lcs = lcs_ring(gap_end[0], gap_end[1], token_counts,
+                             unique_count, pool);
+
+          for (j = 0; j < 2; j++)
+            gap_end[j]->next = saved_next[j];
+
+          if (gap_lcs)
+            {
+              svn_diff__lcs_t *first = gap_lcs;
+
+              while (first->next)
+                first = first->next;
+
+              if (lcs && lcs_adjacent(lcs, first->position[0],
+                                      first->position[1]))
+                {
+                  first->position[0] = lcs->position[0];
+                  first->position[1] = lcs->position[1];
+                  first->length += lcs->length;
+                  first->next = lcs->next;
+                }
+              else
+                first->next = lcs;
+
+              lcs = gap_lcs;
+            }
+        }
+
+      if (i == anchor_count)
+        break;
+
+      previous_anchor[0] = anchors[i]->before[0]->next;
+      previous_anchor[1] = anchors[i]->before[1]->next;
+
+      if (lcs && lcs_adjacent(lcs, previous_anchor[0], previous_anchor[1]))
+        {
+          lcs->length++;
+        }
+      else
+        {
+          svn_diff__lcs_t *anchor_lcs = apr_palloc(pool, sizeof(*anchor_lcs));
+
+          anchor_lcs->position[0] = previous_anchor[0];
+          anchor_lcs->position[1] = previous_anchor[1];
+          anchor_lcs->length = 1;
+          anchor_lcs->refcount = 1;
+          anchor_lcs->next = lcs;
+          lcs = anchor_lcs;
+        }
+    }
+
+  return finish_lcs(eof, lcs, prefix_lines, suffix_lines, pool);
+}
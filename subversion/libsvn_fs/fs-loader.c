@@ -1806,6 +1806,19 @@ svn_fs_get_uuid(svn_fs_t *fs, const char **uuid, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_fs__get_instance_id(const char **instance_id,
+                        svn_fs_t *fs,
+                        apr_pool_t *result_pool)
+{
+  if (fs->vtable->get_instance_id)
+    return svn_error_trace(fs->vtable->get_instance_id(instance_id, fs,
+                                                       result_pool));
+
+  *instance_id = NULL;
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_fs_set_uuid(svn_fs_t *fs, const char *uuid, apr_pool_t *pool)
 {
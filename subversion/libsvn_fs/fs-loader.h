@@ -267,6 +267,9 @@ typedef struct fs_vtable_t
                         void *cancel_baton,
                         apr_pool_t *result_pool,
                         apr_pool_t *scratch_pool);
+  svn_error_t *(*get_instance_id)(const char **instance_id,
+                                  svn_fs_t *fs,
+                                  apr_pool_t *result_pool);
 } fs_vtable_t;
 
 
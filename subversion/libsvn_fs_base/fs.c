@@ -575,7 +575,8 @@ static fs_vtable_t fs_vtable = {
   base_bdb_verify_root,
   base_bdb_freeze,
   base_bdb_set_errcall,
-  NULL /* ioctl */
+  NULL /* ioctl */,
+  NULL /* get_instance_id */
 };
 
 /* Where the format number is stored. */
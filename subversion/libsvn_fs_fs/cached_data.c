@@ -32,6 +32,8 @@
 #include "private/svn_sorts_private.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_temp_serializer.h"
+#include "private/svn_thread_pool.h"
+#include "private/svn_waitable_counter.h"
 
 #include "fs_fs.h"
 #include "id.h"
@@ -1165,6 +1167,10 @@ svn_fs_fs__rep_chain_length(int *chain_length,
   return SVN_NO_ERROR;
 }
 
+/* Look-ahead buffer of windows being reconstructed concurrently.
+   See implementation for details. */
+typedef struct read_ahead_t read_ahead_t;
+
 struct rep_read_baton
 {
   /* The FS from which we're reading. */
@@ -1227,6 +1233,10 @@ struct rep_read_baton
   /* Pool used to store file handles and other data that is persistent
      for the entire stream read. */
   apr_pool_t *filehandle_pool;
+
+  /* If not NULL, all further chunks are being reconstructed by worker
+     threads and delivered through this look-ahead buffer. */
+  read_ahead_t *read_ahead;
 };
 
 /* Set window key in *KEY to address the window described by RS.
@@ -1422,6 +1432,28 @@ set_cached_combined_window(svn_stringbuf_t *window,
   return SVN_NO_ERROR;
 }
 
+/* Prefetch at most this many bytes from each rep in a delta chain.
+   Reconstruction reads all reps of the chain in parallel window by
+   window, so only the first few windows of each rep are needed soon. */
+#define MAX_PREFETCH_SIZE (4 * SVN_DELTA_WINDOW_SIZE)
+
+/* If RS had to be read from disk, ask the OS to read the beginning of
+   its data in the background.  This allows the reads for all reps of a
+   delta chain to overlap instead of paying one synchronous seek per
+   chain link when we later read the windows one by one. */
+static void
+prefetch_rep(rep_state_t *rs)
+{
+  /* If the rep header came from the cache, the file is not open yet
+     and the data is likely cached, too.  We also know the start
+     offset only if we read the header. */
+  if (   rs->sfile->rfile
+      && rs->start != -1
+      && SVN_IS_VALID_REVNUM(rs->revision))
+    svn_io__file_prefetch(rs->sfile->rfile->file, rs->start,
+                          MIN(rs->size, MAX_PREFETCH_SIZE));
+}
+
 /* Build an array of rep_state structures in *LIST giving the delta
    reps from first_rep to a plain-text or self-compressed rep.  Set
    *SRC_STATE to the plain-text rep we find at the end of the chain,
@@ -1501,6 +1533,19 @@ build_rep_list(apr_array_header_t **list,
     }
   svn_pool_destroy(iterpool);
 
+  /* A chain with more than one rep to read from disk would otherwise
+     cost one synchronous seek per link. */
+  if ((*list)->nelts + (*src_state && !is_cached ? 1 : 0) > 1)
+    {
+      int i;
+
+      for (i = 0; i < (*list)->nelts; ++i)
+        prefetch_rep(APR_ARRAY_IDX(*list, i, rep_state_t *));
+
+      if (*src_state && !is_cached)
+        prefetch_rep(*src_state);
+    }
+
   return SVN_NO_ERROR;
 }
 
@@ -1534,6 +1579,7 @@ rep_read_get_baton(struct rep_read_baton **rb_p,
   b->fulltext_cache = NULL;
   b->fulltext_delivered = 0;
   b->current_fulltext = NULL;
+  b->read_ahead = NULL;
 
   /* Save our output baton. */
   *rb_p = b;
@@ -1672,78 +1718,98 @@ skip_plain_window(rep_state_t *rs,
   return SVN_NO_ERROR;
 }
 
-/* Get the undeltified window that is a result of combining all deltas
-   from the current desired representation identified in *RB with its
-   base representation.  Store the window in *RESULT. */
+/* Read the delta windows of chunk CHUNK_INDEX from the reps in RB's delta
+   chain and return them in *WINDOWS, starting with the one of the rep we
+   want to reconstruct.  Stop early if one of them does not depend on its
+   predecessors.  Set *SOURCE to the base text of the last window in
+   *WINDOWS or to NULL if there is none.  Advance the chunk index of all
+   rep states that we read from.
+
+   Allocate the result in RESULT_POOL and use SCRATCH_POOL for
+   temporaries. */
 static svn_error_t *
-get_combined_window(svn_stringbuf_t **result,
-                    struct rep_read_baton *rb)
+read_window_chain(apr_array_header_t **windows,
+                  svn_stringbuf_t **source,
+                  struct rep_read_baton *rb,
+                  int chunk_index,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
 {
-  apr_pool_t *pool, *new_pool, *window_pool;
-  int i;
-  apr_array_header_t *windows;
-  svn_stringbuf_t *source, *buf = rb->base_window;
-  rep_state_t *rs;
+  svn_txdelta_window_t *window = NULL;
   apr_pool_t *iterpool;
+  int i;
 
   /* Read all windows that we need to combine. This is fine because
      the size of each window is relatively small (100kB) and skip-
      delta limits the number of deltas in a chain to well under 100.
      Stop early if one of them does not depend on its predecessors. */
-  window_pool = svn_pool_create(rb->pool);
-  windows = apr_array_make(window_pool, 0, sizeof(svn_txdelta_window_t *));
-  iterpool = svn_pool_create(rb->pool);
+  *windows = apr_array_make(result_pool, 0, sizeof(svn_txdelta_window_t *));
+  iterpool = svn_pool_create(scratch_pool);
   for (i = 0; i < rb->rs_list->nelts; ++i)
     {
-      svn_txdelta_window_t *window;
+      rep_state_t *rs = APR_ARRAY_IDX(rb->rs_list, i, rep_state_t *);
 
       svn_pool_clear(iterpool);
-
-      rs = APR_ARRAY_IDX(rb->rs_list, i, rep_state_t *);
-      SVN_ERR(read_delta_window(&window, rb->chunk_index, rs, window_pool,
+      SVN_ERR(read_delta_window(&window, chunk_index, rs, result_pool,
                                 iterpool));
+      rs->chunk_index++;
 
-      APR_ARRAY_PUSH(windows, svn_txdelta_window_t *) = window;
+      APR_ARRAY_PUSH(*windows, svn_txdelta_window_t *) = window;
       if (window->src_ops == 0)
-        {
-          ++i;
-          break;
-        }
+        break;
     }
+  svn_pool_destroy(iterpool);
 
-  /* Combine in the windows from the other delta reps. */
-  pool = svn_pool_create(rb->pool);
-  for (--i; i >= 0; --i)
+  /* Maybe, we've got a PLAIN start representation.  If we do, read
+     as much data from it as the needed for the txdelta window's source
+     view.
+     Note that we may have short-cut reading the delta chain -- in which
+     case SRC_OPS is 0 and it might not be a PLAIN rep. */
+  *source = rb->base_window;
+  if (*source == NULL && rb->src_state != NULL)
     {
-      svn_txdelta_window_t *window;
+      /* Even if we don't need the source rep now, we still must keep
+       * its read offset in sync with what we might need for the next
+       * window. */
+      if (window->src_ops)
+        SVN_ERR(read_plain_window(source, rb->src_state, window->sview_len,
+                                  result_pool, scratch_pool));
+      else
+        SVN_ERR(skip_plain_window(rb->src_state, window->sview_len));
+    }
 
-      svn_pool_clear(iterpool);
+  return SVN_NO_ERROR;
+}
 
-      rs = APR_ARRAY_IDX(rb->rs_list, i, rep_state_t *);
-      window = APR_ARRAY_IDX(windows, i, svn_txdelta_window_t *);
+/* Apply the delta WINDOWS returned by read_window_chain() in reverse
+   order, using SOURCE as the base text of the last one.  Store the
+   undeltified text of the first window in *RESULT, allocated in
+   RESULT_POOL.
 
-      /* Maybe, we've got a PLAIN start representation.  If we do, read
-         as much data from it as the needed for the txdelta window's source
-         view.
-         Note that BUF / SOURCE may only be NULL in the first iteration.
-         Also note that we may have short-cut reading the delta chain --
-         in which case SRC_OPS is 0 and it might not be a PLAIN rep. */
-      source = buf;
-      if (source == NULL && rb->src_state != NULL)
-        {
-          /* Even if we don't need the source rep now, we still must keep
-           * its read offset in sync with what we might need for the next
-           * window. */
-          if (window->src_ops)
-            SVN_ERR(read_plain_window(&source, rb->src_state,
-                                      window->sview_len,
-                                      pool, iterpool));
-          else
-            SVN_ERR(skip_plain_window(rb->src_state, window->sview_len));
-        }
+   If CACHE_RS_LIST is not NULL, it contains the rep states that WINDOWS
+   have been read from and we will put the intermediate results into
+   the combined window cache, where applicable.  Otherwise, this function
+   does not access any shared state and may be run in any thread. */
+static svn_error_t *
+combine_windows(svn_stringbuf_t **result,
+                const apr_array_header_t *windows,
+                svn_stringbuf_t *source,
+                const apr_array_header_t *cache_rs_list,
+                apr_pool_t *result_pool)
+{
+  apr_pool_t *pool = NULL;
+  svn_stringbuf_t *buf = source;
+  int i;
+
+  for (i = windows->nelts - 1; i >= 0; --i)
+    {
+      svn_txdelta_window_t *window
+        = APR_ARRAY_IDX(windows, i, svn_txdelta_window_t *);
+      apr_pool_t *new_pool;
 
       /* Combine this window with the current one. */
-      new_pool = svn_pool_create(rb->pool);
+      source = buf;
+      new_pool = svn_pool_create(result_pool);
       buf = svn_stringbuf_create_ensure(window->tview_len, new_pool);
       buf->len = window->tview_len;
 
@@ -1757,21 +1823,287 @@ get_combined_window(svn_stringbuf_t **result,
       /* Cache windows only if the whole rep content could be read as a
          single chunk.  Only then will no other chunk need a deeper RS
          list than the cached chunk. */
-      if (   (rb->chunk_index == 0) && (rs->current == rs->size)
-          && SVN_IS_VALID_REVNUM(rs->revision))
-        SVN_ERR(set_cached_combined_window(buf, rs, new_pool));
-
-      rs->chunk_index++;
+      if (cache_rs_list)
+        {
+          rep_state_t *rs = APR_ARRAY_IDX(cache_rs_list, i, rep_state_t *);
+          if (   (rs->current == rs->size)
+              && SVN_IS_VALID_REVNUM(rs->revision))
+            SVN_ERR(set_cached_combined_window(buf, rs, new_pool));
+        }
 
       /* Cycle pools so that we only need to hold three windows at a time. */
-      svn_pool_destroy(pool);
+      if (pool)
+        svn_pool_destroy(pool);
       pool = new_pool;
     }
-  svn_pool_destroy(iterpool);
 
+  *result = buf;
+  return SVN_NO_ERROR;
+}
+
+/* Get the undeltified window that is a result of combining all deltas
+   from the current desired representation identified in *RB with its
+   base representation.  Store the window in *RESULT. */
+static svn_error_t *
+get_combined_window(svn_stringbuf_t **result,
+                    struct rep_read_baton *rb)
+{
+  apr_array_header_t *windows;
+  svn_stringbuf_t *source;
+  apr_pool_t *window_pool = svn_pool_create(rb->pool);
+
+  SVN_ERR(read_window_chain(&windows, &source, rb, rb->chunk_index,
+                            window_pool, window_pool));
+  SVN_ERR(combine_windows(result, windows, source,
+                          rb->chunk_index == 0 ? rb->rs_list : NULL,
+                          rb->pool));
   svn_pool_destroy(window_pool);
 
-  *result = buf;
+  return SVN_NO_ERROR;
+}
+
+/* Concurrent reconstruction of large reps.
+ *
+ * Combining the windows of a long delta chain is CPU-bound.  For large
+ * reps, we read the windows of the next few chunks in the reader's
+ * thread - that is where all FS, file and cache access happens - and
+ * let worker threads combine them while the reader consumes the
+ * previous chunks.
+ */
+
+/* Only use read-ahead for reps with at least this expanded size. */
+#define READ_AHEAD_MIN_SIZE (16 * SVN_DELTA_WINDOW_SIZE)
+
+/* One chunk of a rep to be reconstructed by a worker thread. */
+typedef struct window_job_t
+{
+  /* Delta windows and base text as returned by read_window_chain(). */
+  apr_array_header_t *windows;
+  svn_stringbuf_t *source;
+
+  /* The undeltified chunk and the error we got while creating it. */
+  svn_stringbuf_t *result;
+  svn_error_t *err;
+
+  /* Private pool for all of the above.  It is used by only one thread
+   * at a time. */
+  apr_pool_t *pool;
+
+  /* Becomes 1 once the job has been processed. */
+  svn_waitable_counter_t *done;
+} window_job_t;
+
+struct read_ahead_t
+{
+#if APR_HAS_THREADS
+  /* Worker threads to reconstruct the chunks. */
+  apr_thread_pool_t *thread_pool;
+#endif
+
+  /* Ring buffer of CAPACITY jobs. */
+  window_job_t *jobs;
+  int capacity;
+
+  /* Index of the oldest job in JOBS, i.e. the one to deliver next, and
+   * the number of jobs that have been queued but not released, yet. */
+  int first;
+  int count;
+
+  /* Chunk index of the next chunk to queue. */
+  int next_chunk;
+
+  /* If set, the reader currently uses the result of the job at FIRST. */
+  svn_boolean_t delivering;
+};
+
+/* Reconstruct the chunk described by JOB. */
+static void
+process_window_job(window_job_t *job)
+{
+  job->err = svn_error_trace(combine_windows(&job->result, job->windows,
+                                             job->source, NULL, job->pool));
+
+  /* As soon as the increment call returns, JOB may be reused by the
+     reader.  There is no way to report an error from here; the reader
+     would rather hang when waiting for JOB. */
+  svn_error_clear(svn_waitable_counter__increment(job->done));
+}
+
+#if APR_HAS_THREADS
+
+/* Thread-pool task processing the window_job_t given by DATA. */
+static void * APR_THREAD_FUNC
+window_job_task(apr_thread_t *tid,
+                void *data)
+{
+  process_window_job(data);
+  return NULL;
+}
+
+#endif
+
+/* Wait for all jobs in the read_ahead_t given by DATA to finish and
+   release their pools.  Must be run as a pre-cleanup hook of the pool
+   that contains DATA. */
+static apr_status_t
+read_ahead_pre_cleanup(void *data)
+{
+  read_ahead_t *ra = data;
+  int i;
+
+  for (i = 0; i < ra->count; ++i)
+    {
+      window_job_t *job = &ra->jobs[(ra->first + i) % ra->capacity];
+      svn_error_clear(svn_waitable_counter__wait_for(job->done, 1));
+    }
+
+  for (i = 0; i < ra->capacity; ++i)
+    {
+      svn_error_clear(ra->jobs[i].err);
+      svn_pool_destroy(ra->jobs[i].pool);
+    }
+
+  return APR_SUCCESS;
+}
+
+/* If the remainder of the rep read through RB is large enough and
+   read-ahead has been enabled for its FS, set up RB->READ_AHEAD. */
+static svn_error_t *
+auto_start_read_ahead(struct rep_read_baton *rb)
+{
+  fs_fs_data_t *ffd = rb->fs->fsap_data;
+  rep_state_t *rs = APR_ARRAY_IDX(rb->rs_list, 0, rep_state_t *);
+  apr_pool_t *pool = rb->filehandle_pool;
+  read_ahead_t *ra;
+  int i;
+
+  if (   ffd->read_ahead == 0
+      || rb->len < READ_AHEAD_MIN_SIZE
+      || rs->current == rs->size)
+    return SVN_NO_ERROR;
+
+#if APR_HAS_THREADS
+  {
+    apr_thread_pool_t *thread_pool;
+
+    /* Not being able to start threads is not fatal.  We simply read the
+       rep without read-ahead then. */
+    svn_error_t *err = svn_thread_pool__get(&thread_pool, pool);
+    if (err)
+      {
+        svn_error_clear(err);
+        return SVN_NO_ERROR;
+      }
+
+    ra = apr_pcalloc(pool, sizeof(*ra));
+    ra->thread_pool = thread_pool;
+  }
+#else
+  return SVN_NO_ERROR;
+#endif
+
+  ra->capacity = ffd->read_ahead;
+  ra->jobs = apr_pcalloc(pool, ra->capacity * sizeof(*ra->jobs));
+  ra->next_chunk = rb->chunk_index;
+
+  /* To be able to process each job in a separate thread, they must use
+   * separate, thread-safe pools.  Allocating a root pool achieves
+   * exactly that. */
+  for (i = 0; i < ra->capacity; ++i)
+    {
+      ra->jobs[i].pool = svn_pool_create(NULL);
+      SVN_ERR(svn_waitable_counter__create(&ra->jobs[i].done, pool));
+    }
+
+  /* Workers must be done with the jobs before the counters get cleaned
+     up and before RB->BASE_WINDOW becomes invalid. */
+  apr_pool_pre_cleanup_register(pool, ra, read_ahead_pre_cleanup);
+  rb->read_ahead = ra;
+
+  return SVN_NO_ERROR;
+}
+
+/* Read the windows of the next chunk of the rep read through RB and hand
+   them over to a worker thread.  Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+queue_read_ahead(struct rep_read_baton *rb,
+                 apr_pool_t *scratch_pool)
+{
+  read_ahead_t *ra = rb->read_ahead;
+  window_job_t *job = &ra->jobs[(ra->first + ra->count) % ra->capacity];
+
+  svn_pool_clear(job->pool);
+  job->result = NULL;
+  job->err = SVN_NO_ERROR;
+
+  SVN_ERR(read_window_chain(&job->windows, &job->source, rb,
+                            ra->next_chunk, job->pool, scratch_pool));
+  ra->next_chunk++;
+
+  SVN_ERR(svn_waitable_counter__reset(job->done));
+
+#if APR_HAS_THREADS
+  {
+    apr_status_t status = apr_thread_pool_push(ra->thread_pool,
+                                               window_job_task,
+                                               job, 0, NULL);
+    if (status)
+      return svn_error_wrap_apr(status, _("Can't push task"));
+  }
+#else
+  process_window_job(job);
+#endif
+
+  ra->count++;
+
+  return SVN_NO_ERROR;
+}
+
+/* Return the next undeltified chunk of the rep read through RB in
+   *RESULT, using RB->READ_AHEAD.  Set *RESULT to NULL at the end of
+   the rep.  Keep up to RB->READ_AHEAD->CAPACITY chunks in flight. */
+static svn_error_t *
+get_read_ahead_window(svn_stringbuf_t **result,
+                      struct rep_read_baton *rb)
+{
+  fs_fs_data_t *ffd = rb->fs->fsap_data;
+  read_ahead_t *ra = rb->read_ahead;
+  rep_state_t *rs = APR_ARRAY_IDX(rb->rs_list, 0, rep_state_t *);
+  window_job_t *job;
+
+  /* The reader is done with the previous result. */
+  if (ra->delivering)
+    {
+      ra->first = (ra->first + 1) % ra->capacity;
+      ra->count--;
+      ra->delivering = FALSE;
+    }
+
+  /* Keep the workers busy. */
+  while (ra->count < ra->capacity && rs->current < rs->size)
+    SVN_ERR(queue_read_ahead(rb, rb->pool));
+
+  if (ra->count == 0)
+    {
+      *result = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  job = &ra->jobs[ra->first];
+  SVN_ERR(svn_waitable_counter__wait_for(job->done, 1));
+  ra->delivering = TRUE;
+
+  if (job->err)
+    {
+      svn_error_t *err = job->err;
+      job->err = SVN_NO_ERROR;
+
+      return svn_error_trace(err);
+    }
+
+  *result = job->result;
+  svn_atomic_inc(&ffd->read_ahead_chunks);
+
   return SVN_NO_ERROR;
 }
 
@@ -1877,12 +2209,26 @@ get_contents_from_windows(struct rep_read_baton *rb,
         {
           svn_stringbuf_t *sbuf = NULL;
 
-          rs = APR_ARRAY_IDX(rb->rs_list, 0, rep_state_t *);
-          if (rs->current == rs->size)
-            break;
+          /* Once we are past the first chunk, large reps may be
+             reconstructed concurrently. */
+          if (rb->chunk_index > 0 && !rb->read_ahead)
+            SVN_ERR(auto_start_read_ahead(rb));
 
           /* Get more buffered data by evaluating a chunk. */
-          SVN_ERR(get_combined_window(&sbuf, rb));
+          if (rb->read_ahead)
+            {
+              SVN_ERR(get_read_ahead_window(&sbuf, rb));
+              if (sbuf == NULL)
+                break;
+            }
+          else
+            {
+              rs = APR_ARRAY_IDX(rb->rs_list, 0, rep_state_t *);
+              if (rs->current == rs->size)
+                break;
+
+              SVN_ERR(get_combined_window(&sbuf, rb));
+            }
 
           rb->chunk_index++;
           rb->buf_len = sbuf->len;
@@ -2455,6 +2801,69 @@ delta_read_md5_digest(void *baton)
   return drb->md5_digest;
 }
 
+/* Baton used when reading the raw svndiff data of a representation. */
+typedef struct raw_svndiff_baton_t
+{
+  rep_state_t *rs;
+  apr_off_t remaining;   /* Number of bytes left to read. */
+  apr_pool_t *pool;      /* For error messages. */
+} raw_svndiff_baton_t;
+
+/* This implements the svn_read_fn_t interface. */
+static svn_error_t *
+read_raw_svndiff(void *baton,
+                 char *buffer,
+                 apr_size_t *len)
+{
+  raw_svndiff_baton_t *rb = baton;
+
+  if ((apr_off_t)*len > rb->remaining)
+    *len = (apr_size_t)rb->remaining;
+
+  SVN_ERR(svn_io_file_read_full2(rb->rs->sfile->rfile->file, buffer, *len,
+                                 NULL, NULL, rb->pool));
+  rb->remaining -= *len;
+
+  return SVN_NO_ERROR;
+}
+
+/* This implements the svn_txdelta__svndiff_func_t interface.
+ * Return the on-disk svndiff data of the delta without parsing it. */
+static svn_error_t *
+delta_read_svndiff(svn_stream_t **svndiff,
+                   void *baton,
+                   int max_version,
+                   apr_pool_t *pool)
+{
+  struct delta_read_baton *drb = baton;
+  rep_state_t *rs = drb->rs;
+  raw_svndiff_baton_t *rb;
+
+  SVN_ERR(auto_open_shared_file(rs->sfile));
+  SVN_ERR(auto_set_start_offset(rs, pool));
+  SVN_ERR(auto_read_diff_version(rs, pool));
+
+  if (rs->ver > max_version)
+    {
+      *svndiff = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  /* The representation is a single svndiff stream, header included. */
+  SVN_ERR(rs_aligned_seek(rs, NULL, rs->start, pool));
+
+  rb = apr_pcalloc(pool, sizeof(*rb));
+  rb->rs = rs;
+  rb->remaining = rs->size;
+  rb->pool = pool;
+
+  *svndiff = svn_stream_create(rb, pool);
+  svn_stream_set_read2(*svndiff, NULL /* only full read support */,
+                       read_raw_svndiff);
+
+  return SVN_NO_ERROR;
+}
+
 /* Return a txdelta stream for on-disk representation REP_STATE
  * of TARGET.  Allocate the result in POOL.
  */
@@ -2468,8 +2877,9 @@ get_storaged_delta_stream(rep_state_t *rep_state,
   drb->rs = rep_state;
   memcpy(drb->md5_digest, target->data_rep->md5_digest,
          sizeof(drb->md5_digest));
-  return svn_txdelta_stream_create(drb, delta_read_next_window,
-                                   delta_read_md5_digest, pool);
+  return svn_txdelta__stream_create_stored(drb, delta_read_next_window,
+                                           delta_read_md5_digest,
+                                           delta_read_svndiff, pool);
 }
 
 svn_error_t *
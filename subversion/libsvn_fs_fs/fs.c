@@ -329,11 +329,40 @@ fs_ioctl(svn_fs_t *fs, svn_fs_ioctl_code_t ctlcode,
           *output_p = NULL;
           return SVN_NO_ERROR;
         }
+      else if (ctlcode.code == SVN_FS_FS__IOCTL_BULK_LOAD_CHECKPOINT.code)
+        {
+          SVN_ERR(svn_fs_fs__bulk_load_checkpoint(fs, scratch_pool));
+
+          *output_p = NULL;
+          return SVN_NO_ERROR;
+        }
+      else if (ctlcode.code == SVN_FS_FS__IOCTL_READ_AHEAD_STATS.code)
+        {
+          fs_fs_data_t *ffd = fs->fsap_data;
+          svn_fs_fs__ioctl_read_ahead_stats_output_t *output
+            = apr_pcalloc(result_pool, sizeof(*output));
+
+          output->chunks = svn_atomic_read(&ffd->read_ahead_chunks);
+          *output_p = output;
+          return SVN_NO_ERROR;
+        }
     }
 
   return svn_error_create(SVN_ERR_FS_UNRECOGNIZED_IOCTL_CODE, NULL, NULL);
 }
 
+/* This implements the fs_vtable_t.get_instance_id() API. */
+static svn_error_t *
+fs_get_instance_id(const char **instance_id,
+                   svn_fs_t *fs,
+                   apr_pool_t *result_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  *instance_id = apr_pstrdup(result_pool, ffd->instance_id);
+  return SVN_NO_ERROR;
+}
+
 /* The vtable associated with a specific open filesystem. */
 static fs_vtable_t fs_vtable = {
   svn_fs_fs__youngest_rev,
@@ -359,7 +388,8 @@ static fs_vtable_t fs_vtable = {
   svn_fs_fs__verify_root,
   fs_freeze,
   fs_set_errcall,
-  fs_ioctl
+  fs_ioctl,
+  fs_get_instance_id
 };
 
 
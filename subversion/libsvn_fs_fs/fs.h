@@ -347,6 +347,14 @@ typedef struct fs_fs_data_t
    * (not just the one bit that we need, atm). */
   svn_boolean_t use_block_read;
 
+  /* Number of delta windows to reconstruct concurrently ahead of the
+   * reader when reading large file contents.  0 disables read-ahead. */
+  int read_ahead;
+
+  /* Number of chunks delivered through read-ahead so far.
+   * See SVN_FS_FS__IOCTL_READ_AHEAD_STATS. */
+  svn_atomic_t read_ahead_chunks;
+
   /* The revision that was youngest, last time we checked. */
   svn_revnum_t youngest_rev_cache;
 
@@ -514,6 +522,18 @@ typedef struct fs_fs_data_t
   /* Ensure that all filesystem changes are written to disk. */
   svn_boolean_t flush_to_disk;
 
+  /* Defer flushes and rep-cache.db updates to checkpoints.
+   * See SVN_FS_CONFIG_FSFS_BULK_LOAD. */
+  svn_boolean_t bulk_load;
+
+  /* In bulk-load mode, all revisions up to this one have been flushed
+   * to disk.  SVN_INVALID_REVNUM before the first commit. */
+  svn_revnum_t bulk_load_synced_rev;
+
+  /* In bulk-load mode, TRUE while the SQLite transaction that collects
+   * the rep-cache.db entries since the last checkpoint is open. */
+  svn_boolean_t rep_cache_txn_open;
+
   /* Pointer to svn_fs_open. */
   svn_error_t *(*svn_fs_open_)(svn_fs_t **, const char *, apr_hash_t *,
                                apr_pool_t *, apr_pool_t *);
@@ -48,6 +48,7 @@
 #include "private/svn_io_private.h"
 #include "private/svn_string_private.h"
 #include "private/svn_subr_private.h"
+#include "private/svn_thread_pool.h"
 #include "../libsvn_fs/fs-loader.h"
 
 /* The default maximum number of files per directory to store in the
@@ -1167,6 +1168,7 @@ static svn_error_t *
 read_global_config(svn_fs_t *fs)
 {
   fs_fs_data_t *ffd = fs->fsap_data;
+  const char *read_ahead;
 
   ffd->use_block_read = svn_hash__get_bool(fs->config,
                                            SVN_FS_CONFIG_FSFS_BLOCK_READ,
@@ -1175,6 +1177,28 @@ read_global_config(svn_fs_t *fs)
                                            SVN_FS_CONFIG_NO_FLUSH_TO_DISK,
                                            FALSE);
 
+  ffd->bulk_load = svn_hash__get_bool(fs->config,
+                                      SVN_FS_CONFIG_FSFS_BULK_LOAD,
+                                      FALSE);
+  ffd->bulk_load_synced_rev = SVN_INVALID_REVNUM;
+#ifdef SVN_ON_POSIX
+  /* Bulk loads flush the new revisions at checkpoints instead.
+   * Elsewhere, we can't flush directories, so keep flushing as usual. */
+  if (ffd->bulk_load)
+    ffd->flush_to_disk = FALSE;
+#endif
+
+  read_ahead = svn_hash__get_cstring(fs->config,
+                                     SVN_FS_CONFIG_FSFS_READ_AHEAD, "0");
+  SVN_ERR(svn_cstring_atoi(&ffd->read_ahead, read_ahead));
+  if (ffd->read_ahead < 0)
+    ffd->read_ahead = 0;
+
+  /* Each pending window keeps its own pool and reconstructed chunk.  More
+     windows than the workers can ever process only waste memory. */
+  if (ffd->read_ahead > SVN_THREAD_POOL__MAX_THREADS * 2)
+    ffd->read_ahead = SVN_THREAD_POOL__MAX_THREADS * 2;
+
   /* Ignore the user-specified larger block size if we don't use block-read.
      Defaulting to 4k gives us the same access granularity in format 7 as in
      older formats. */
@@ -142,6 +142,7 @@ svn_fs_fs__close_rep_cache(svn_fs_t *fs)
       SVN_ERR(svn_sqlite__close(ffd->rep_cache_db));
       ffd->rep_cache_db = NULL;
       ffd->rep_cache_db_opened = 0;
+      ffd->rep_cache_txn_open = FALSE;
     }
 
   return SVN_NO_ERROR;
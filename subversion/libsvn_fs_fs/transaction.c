@@ -3954,6 +3954,9 @@ write_reps_to_cache(svn_fs_t *fs,
   return SVN_NO_ERROR;
 }
 
+/* In bulk-load mode, create a checkpoint after that many new revisions. */
+#define BULK_LOAD_CHECKPOINT_REVS 1000
+
 svn_error_t *
 svn_fs_fs__commit(svn_revnum_t *new_rev_p,
                   svn_fs_t *fs,
@@ -3980,6 +3983,11 @@ svn_fs_fs__commit(svn_revnum_t *new_rev_p,
       cb.reps_pool = NULL;
     }
 
+  /* Revisions that existed before the first bulk-load commit don't need
+     another flush. */
+  if (ffd->bulk_load && !SVN_IS_VALID_REVNUM(ffd->bulk_load_synced_rev))
+    SVN_ERR(svn_fs_fs__youngest_rev(&ffd->bulk_load_synced_rev, fs, pool));
+
   SVN_ERR(svn_fs_fs__with_write_lock(fs, commit_body, &cb, pool));
 
   /* At this point, *NEW_REV_P has been set, so errors below won't affect
@@ -3999,9 +4007,22 @@ svn_fs_fs__commit(svn_revnum_t *new_rev_p,
       /* ### A commit that touches thousands of files will starve other
              (reader/writer) commits for the duration of the below call.
              Maybe write in batches? */
-      SVN_ERR(svn_sqlite__begin_transaction(ffd->rep_cache_db));
+      /* In bulk-load mode, the transaction stays open until the next
+         checkpoint.  Later commits on this connection will still see
+         the new entries. */
+      if (!ffd->rep_cache_txn_open)
+        SVN_ERR(svn_sqlite__begin_transaction(ffd->rep_cache_db));
+
       err = write_reps_to_cache(fs, cb.reps_to_cache, pool);
-      err = svn_sqlite__finish_transaction(ffd->rep_cache_db, err);
+      if (ffd->bulk_load && !err)
+        {
+          ffd->rep_cache_txn_open = TRUE;
+        }
+      else
+        {
+          ffd->rep_cache_txn_open = FALSE;
+          err = svn_sqlite__finish_transaction(ffd->rep_cache_db, err);
+        }
 
       if (svn_error_find_cause(err, SVN_ERR_SQLITE_ROLLBACK_FAILED))
         {
@@ -4016,6 +4037,102 @@ svn_fs_fs__commit(svn_revnum_t *new_rev_p,
         return svn_error_trace(err);
     }
 
+  if (   ffd->bulk_load
+      && *new_rev_p - ffd->bulk_load_synced_rev >= BULK_LOAD_CHECKPOINT_REVS)
+    SVN_ERR(svn_fs_fs__bulk_load_checkpoint(fs, pool));
+
+  return SVN_NO_ERROR;
+}
+
+#ifdef SVN_ON_POSIX
+/* Flush the file or directory at PATH to disk.
+ * Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+flush_path(const char *path,
+           apr_pool_t *scratch_pool)
+{
+  apr_file_t *file;
+
+  SVN_ERR(svn_io_file_open(&file, path, APR_READ, APR_OS_DEFAULT,
+                           scratch_pool));
+  SVN_ERR(svn_io_file_flush_to_disk(file, scratch_pool));
+  SVN_ERR(svn_io_file_close(file, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+#endif
+
+svn_error_t *
+svn_fs_fs__bulk_load_checkpoint(svn_fs_t *fs,
+                                apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_revnum_t youngest;
+
+  if (!ffd->bulk_load || !SVN_IS_VALID_REVNUM(ffd->bulk_load_synced_rev))
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_fs_fs__youngest_rev(&youngest, fs, scratch_pool));
+
+#ifdef SVN_ON_POSIX
+  {
+    apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+    apr_hash_t *dirs = apr_hash_make(scratch_pool);
+    apr_hash_index_t *hi;
+    svn_revnum_t rev;
+
+    /* The new rev and revprop files.  Remember their shard directories,
+       which need to be flushed as well because of the new entries. */
+    for (rev = ffd->bulk_load_synced_rev + 1; rev <= youngest; ++rev)
+      {
+        const char *path;
+
+        svn_pool_clear(iterpool);
+
+        /* Packing flushes the pack files itself. */
+        if (!svn_fs_fs__is_packed_rev(fs, rev))
+          {
+            path = svn_fs_fs__path_rev_absolute(fs, rev, iterpool);
+            SVN_ERR(flush_path(path, iterpool));
+            path = svn_dirent_dirname(path, scratch_pool);
+            svn_hash_sets(dirs, path, path);
+          }
+
+        if (!svn_fs_fs__is_packed_revprop(fs, rev))
+          {
+            path = svn_fs_fs__path_revprops(fs, rev, iterpool);
+            SVN_ERR(flush_path(path, iterpool));
+            path = svn_dirent_dirname(path, scratch_pool);
+            svn_hash_sets(dirs, path, path);
+          }
+      }
+
+    for (hi = apr_hash_first(scratch_pool, dirs); hi; hi = apr_hash_next(hi))
+      {
+        svn_pool_clear(iterpool);
+        SVN_ERR(flush_path(apr_hash_this_key(hi), iterpool));
+      }
+
+    /* Finally, the 'current' file and its directory entry. */
+    SVN_ERR(flush_path(svn_fs_fs__path_current(fs, iterpool), iterpool));
+    SVN_ERR(flush_path(fs->path, iterpool));
+
+    svn_pool_destroy(iterpool);
+  }
+#endif
+
+  /* Commit the rep-cache.db entries collected since the last checkpoint.
+     This must come last: later commits will share the reps listed there,
+     so they must not refer to revisions that might not be on disk. */
+  if (ffd->rep_cache_txn_open)
+    {
+      ffd->rep_cache_txn_open = FALSE;
+      SVN_ERR(svn_sqlite__finish_transaction(ffd->rep_cache_db,
+                                             SVN_NO_ERROR));
+    }
+
+  ffd->bulk_load_synced_rev = youngest;
+
   return SVN_NO_ERROR;
 }
 
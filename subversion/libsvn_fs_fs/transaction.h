@@ -220,6 +220,13 @@ svn_fs_fs__commit(svn_revnum_t *new_rev_p,
                   svn_fs_txn_t *txn,
                   apr_pool_t *pool);
 
+/* If FS is in bulk-load mode, commit the pending rep-cache.db entries and
+   flush all revisions committed since the last checkpoint to disk.
+   Otherwise, do nothing.  Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__bulk_load_checkpoint(svn_fs_t *fs,
+                                apr_pool_t *scratch_pool);
+
 /* Set *NAMES_P to an array of names which are all the active
    transactions in filesystem FS.  Allocate the array from POOL. */
 svn_error_t *
@@ -287,6 +287,18 @@ x_begin_txn(svn_fs_txn_t **txn_p,
 
 
 
+/* This implements the fs_vtable_t.get_instance_id() API. */
+static svn_error_t *
+x_get_instance_id(const char **instance_id,
+                  svn_fs_t *fs,
+                  apr_pool_t *result_pool)
+{
+  svn_fs_x__data_t *ffd = fs->fsap_data;
+
+  *instance_id = apr_pstrdup(result_pool, ffd->instance_id);
+  return SVN_NO_ERROR;
+}
+
 /* The vtable associated with a specific open filesystem. */
 static fs_vtable_t fs_vtable = {
   svn_fs_x__youngest_rev,
@@ -312,7 +324,8 @@ static fs_vtable_t fs_vtable = {
   svn_fs_x__verify_root,
   x_freeze,
   x_set_errcall,
-  NULL /* ioctl */
+  NULL /* ioctl */,
+  x_get_instance_id
 };
 
 
@@ -1383,6 +1383,131 @@ svn_ra_fetch_file_contents(svn_ra_session_t *session,
                                               scratch_pool);
 }
 
+svn_error_t *
+svn_ra__stat_many(svn_ra_session_t *session,
+                  const apr_array_header_t *paths,
+                  svn_revnum_t revision,
+                  svn_ra__stat_receiver_t receiver,
+                  void *receiver_baton,
+                  apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool;
+  int i;
+
+  for (i = 0; i < paths->nelts; i++)
+    SVN_ERR_ASSERT(svn_relpath_is_canonical(APR_ARRAY_IDX(paths, i,
+                                                          const char *)));
+
+  if (session->vtable->stat_many)
+    {
+      svn_error_t *err = session->vtable->stat_many(session, paths, revision,
+                                                    receiver, receiver_baton,
+                                                    scratch_pool);
+      if (!err || err->apr_err != SVN_ERR_RA_NOT_IMPLEMENTED)
+        return svn_error_trace(err);
+
+      svn_error_clear(err);
+    }
+
+  /* Fallback for legacy servers. */
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < paths->nelts; i++)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+      svn_dirent_t *dirent;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_ra_stat(session, path, revision, &dirent, iterpool));
+      SVN_ERR(receiver(receiver_baton, path, dirent, iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_ra__get_files(svn_ra_session_t *session,
+                  const apr_array_header_t *paths,
+                  svn_revnum_t revision,
+                  svn_boolean_t want_props,
+                  svn_ra__file_stream_func_t stream_func,
+                  svn_ra__file_receiver_t receiver,
+                  void *baton,
+                  apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool;
+  int i;
+
+  for (i = 0; i < paths->nelts; i++)
+    SVN_ERR_ASSERT(svn_relpath_is_canonical(APR_ARRAY_IDX(paths, i,
+                                                          const char *)));
+
+  if (session->vtable->get_files)
+    {
+      svn_error_t *err = session->vtable->get_files(session, paths, revision,
+                                                    want_props, stream_func,
+                                                    receiver, baton,
+                                                    scratch_pool);
+      if (!err || err->apr_err != SVN_ERR_RA_NOT_IMPLEMENTED)
+        return svn_error_trace(err);
+
+      svn_error_clear(err);
+    }
+
+  /* Fallback for legacy servers. */
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < paths->nelts; i++)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+      svn_stream_t *stream = NULL;
+      svn_revnum_t fetched_rev;
+      apr_hash_t *props = NULL;
+
+      svn_pool_clear(iterpool);
+      if (stream_func)
+        SVN_ERR(stream_func(&stream, baton, path, iterpool, iterpool));
+
+      SVN_ERR(svn_ra_get_file(session, path, revision, stream, &fetched_rev,
+                              want_props ? &props : NULL, iterpool));
+      if (stream)
+        SVN_ERR(svn_stream_close(stream));
+
+      SVN_ERR(receiver(baton, path, fetched_rev, props, iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_ra__get_file_blame(svn_ra_session_t *session,
+                       const char *path,
+                       svn_revnum_t start,
+                       svn_revnum_t end,
+                       const svn_diff_file_options_t *diff_options,
+                       svn_ra__blame_rev_func_t rev_func,
+                       svn_ra__blame_chunk_func_t chunk_func,
+                       void *baton,
+                       svn_stream_t *contents,
+                       apr_pool_t *scratch_pool)
+{
+  SVN_ERR_ASSERT(svn_relpath_is_canonical(path));
+  SVN_ERR_ASSERT(SVN_IS_VALID_REVNUM(start) && SVN_IS_VALID_REVNUM(end)
+                 && start <= end);
+
+  if (!session->vtable->get_file_blame)
+    return svn_error_create(SVN_ERR_RA_NOT_IMPLEMENTED, NULL, NULL);
+
+  return svn_error_trace(session->vtable->get_file_blame(session, path,
+                                                         start, end,
+                                                         diff_options,
+                                                         rev_func,
+                                                         chunk_func,
+                                                         baton,
+                                                         contents,
+                                                         scratch_pool));
+}
+
 svn_error_t *
 svn_ra__get_commit_ev2(svn_editor_t **editor,
                        svn_ra_session_t *session,
@@ -352,6 +352,41 @@ typedef struct svn_ra__vtable_t {
                                       svn_stream_t *stream,
                                       apr_pool_t *scratch_pool);
 
+  /* See svn_ra__stat_many().  May be NULL or return
+     SVN_ERR_RA_NOT_IMPLEMENTED, in which case libsvn_ra falls back
+     to calling stat() for each path. */
+  svn_error_t *(*stat_many)(svn_ra_session_t *session,
+                            const apr_array_header_t *paths,
+                            svn_revnum_t revision,
+                            svn_ra__stat_receiver_t receiver,
+                            void *receiver_baton,
+                            apr_pool_t *scratch_pool);
+
+  /* See svn_ra__get_files().  May be NULL or return
+     SVN_ERR_RA_NOT_IMPLEMENTED, in which case libsvn_ra falls back
+     to calling get_file() for each path. */
+  svn_error_t *(*get_files)(svn_ra_session_t *session,
+                            const apr_array_header_t *paths,
+                            svn_revnum_t revision,
+                            svn_boolean_t want_props,
+                            svn_ra__file_stream_func_t stream_func,
+                            svn_ra__file_receiver_t receiver,
+                            void *baton,
+                            apr_pool_t *scratch_pool);
+
+  /* See svn_ra__get_file_blame().  May be NULL or return
+     SVN_ERR_RA_NOT_IMPLEMENTED. */
+  svn_error_t *(*get_file_blame)(svn_ra_session_t *session,
+                                 const char *path,
+                                 svn_revnum_t start,
+                                 svn_revnum_t end,
+                                 const svn_diff_file_options_t *diff_options,
+                                 svn_ra__blame_rev_func_t rev_func,
+                                 svn_ra__blame_chunk_func_t chunk_func,
+                                 void *baton,
+                                 svn_stream_t *contents,
+                                 apr_pool_t *scratch_pool);
+
   /* Experimental support below here */
 
   /* See svn_ra__register_editor_shim_callbacks() */
@@ -1948,6 +1948,9 @@ static const svn_ra__vtable_t ra_local_vtable =
   NULL /* set_svn_ra_open */,
   svn_ra_local__list ,
   svn_ra_local__fetch_file_contents,
+  NULL /* stat_many */,
+  NULL /* get_files */,
+  NULL /* get_file_blame */,
   svn_ra_local__register_editor_shim_callbacks,
   svn_ra_local__get_commit_ev2,
   NULL /* replay_range_ev2 */
@@ -397,3 +397,280 @@ svn_ra_serf__get_file_revs(svn_ra_session_t *ra_session,
 
   return SVN_NO_ERROR;
 }
+
+
+/*
+ * The states of our XML parsing for a file-blame-report.
+ */
+typedef enum file_blame_state_e {
+  FILE_BLAME_REPORT = XML_STATE_INITIAL + 1,
+  BLAME_REV,
+  BLAME_REV_PROP,
+  BLAME_LINES,
+  BLAME_CONTENTS
+} file_blame_state_e;
+
+
+typedef struct file_blame_context_t {
+  /* parameters set by our caller */
+  const char *path;
+  svn_revnum_t start;
+  svn_revnum_t end;
+  const svn_diff_file_options_t *diff_options;
+
+  /* callbacks and their baton */
+  svn_ra__blame_rev_func_t rev_func;
+  svn_ra__blame_chunk_func_t chunk_func;
+  void *baton;
+
+  /* The revision properties of the BLAME_REV being parsed.  */
+  apr_hash_t *rev_props;
+
+  /* Where to write the file contents, and the decoder while we're in the
+     BLAME_CONTENTS state.  */
+  svn_stream_t *contents;
+  svn_stream_t *stream;
+
+} file_blame_context_t;
+
+
+static const svn_ra_serf__xml_transition_t file_blame_ttable[] = {
+  { INITIAL, S_, "file-blame-report", FILE_BLAME_REPORT,
+    FALSE, { NULL }, FALSE },
+
+  { FILE_BLAME_REPORT, S_, "blame-rev", BLAME_REV,
+    FALSE, { "path", "rev", NULL }, TRUE },
+
+  { BLAME_REV, S_, "rev-prop", BLAME_REV_PROP,
+    TRUE, { "name", "?encoding", NULL }, TRUE },
+
+  { FILE_BLAME_REPORT, S_, "blame-lines", BLAME_LINES,
+    FALSE, { "line-start", "?rev", NULL }, TRUE },
+
+  { FILE_BLAME_REPORT, S_, "contents", BLAME_CONTENTS,
+    FALSE, { NULL }, TRUE },
+
+  { 0 }
+};
+
+/* Conforms to svn_ra_serf__xml_opened_t  */
+static svn_error_t *
+file_blame_opened(svn_ra_serf__xml_estate_t *xes,
+                  void *baton,
+                  int entered_state,
+                  const svn_ra_serf__dav_props_t *tag,
+                  apr_pool_t *scratch_pool)
+{
+  file_blame_context_t *fb_ctx = baton;
+
+  if (entered_state == BLAME_REV)
+    {
+      fb_ctx->rev_props = apr_hash_make(svn_ra_serf__xml_state_pool(xes));
+    }
+  else if (entered_state == BLAME_CONTENTS)
+    {
+      apr_pool_t *state_pool = svn_ra_serf__xml_state_pool(xes);
+
+      /* The caller owns FB_CTX->CONTENTS.  */
+      fb_ctx->stream = svn_base64_decode(svn_stream_disown(fb_ctx->contents,
+                                                           state_pool),
+                                         state_pool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Conforms to svn_ra_serf__xml_closed_t  */
+static svn_error_t *
+file_blame_closed(svn_ra_serf__xml_estate_t *xes,
+                  void *baton,
+                  int leaving_state,
+                  const svn_string_t *cdata,
+                  apr_hash_t *attrs,
+                  apr_pool_t *scratch_pool)
+{
+  file_blame_context_t *fb_ctx = baton;
+
+  if (leaving_state == BLAME_REV_PROP)
+    {
+      apr_pool_t *state_pool = apr_hash_pool_get(fb_ctx->rev_props);
+      const char *name = apr_pstrdup(state_pool,
+                                     svn_hash_gets(attrs, "name"));
+      const char *encoding = svn_hash_gets(attrs, "encoding");
+      const svn_string_t *value;
+
+      if (encoding && strcmp(encoding, "base64") == 0)
+        value = svn_base64_decode_string(cdata, state_pool);
+      else
+        value = svn_string_dup(cdata, state_pool);
+
+      svn_hash_sets(fb_ctx->rev_props, name, value);
+    }
+  else if (leaving_state == BLAME_REV)
+    {
+      svn_revnum_t rev;
+
+      SVN_ERR(svn_revnum_parse(&rev, svn_hash_gets(attrs, "rev"), NULL));
+      SVN_ERR(fb_ctx->rev_func(fb_ctx->baton, svn_hash_gets(attrs, "path"),
+                               rev, fb_ctx->rev_props, scratch_pool));
+    }
+  else if (leaving_state == BLAME_LINES)
+    {
+      const char *rev_str = svn_hash_gets(attrs, "rev");
+      svn_revnum_t rev = SVN_INVALID_REVNUM;
+      apr_int64_t line_start;
+
+      SVN_ERR(svn_cstring_atoi64(&line_start,
+                                 svn_hash_gets(attrs, "line-start")));
+      if (rev_str)
+        SVN_ERR(svn_revnum_parse(&rev, rev_str, NULL));
+
+      SVN_ERR(fb_ctx->chunk_func(fb_ctx->baton, line_start, rev,
+                                 scratch_pool));
+    }
+  else if (leaving_state == BLAME_CONTENTS)
+    {
+      SVN_ERR(svn_stream_close(fb_ctx->stream));
+      fb_ctx->stream = NULL;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Conforms to svn_ra_serf__xml_cdata_t  */
+static svn_error_t *
+file_blame_cdata(svn_ra_serf__xml_estate_t *xes,
+                 void *baton,
+                 int current_state,
+                 const char *data,
+                 apr_size_t len,
+                 apr_pool_t *scratch_pool)
+{
+  file_blame_context_t *fb_ctx = baton;
+
+  if (current_state == BLAME_CONTENTS)
+    {
+      SVN_ERR(svn_stream_write(fb_ctx->stream, data, &len));
+      /* Ignore the returned LEN value.  */
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_ra_serf__request_body_delegate_t */
+static svn_error_t *
+create_file_blame_body(serf_bucket_t **body_bkt,
+                       void *baton,
+                       serf_bucket_alloc_t *alloc,
+                       apr_pool_t *pool /* request pool */,
+                       apr_pool_t *scratch_pool)
+{
+  serf_bucket_t *buckets;
+  file_blame_context_t *fb_ctx = baton;
+  const svn_diff_file_options_t *diff_options = fb_ctx->diff_options;
+
+  buckets = serf_bucket_aggregate_create(alloc);
+
+  svn_ra_serf__add_open_tag_buckets(buckets, alloc,
+                                    "S:file-blame-report",
+                                    "xmlns:S", SVN_XML_NAMESPACE,
+                                    SVN_VA_NULL);
+
+  svn_ra_serf__add_tag_buckets(buckets,
+                               "S:start-revision",
+                               apr_ltoa(pool, fb_ctx->start),
+                               alloc);
+
+  svn_ra_serf__add_tag_buckets(buckets,
+                               "S:end-revision", apr_ltoa(pool, fb_ctx->end),
+                               alloc);
+
+  if (diff_options)
+    {
+      if (diff_options->ignore_space == svn_diff_file_ignore_space_change)
+        svn_ra_serf__add_tag_buckets(buckets, "S:ignore-space", "change",
+                                     alloc);
+      else if (diff_options->ignore_space == svn_diff_file_ignore_space_all)
+        svn_ra_serf__add_tag_buckets(buckets, "S:ignore-space", "all",
+                                     alloc);
+
+      if (diff_options->ignore_eol_style)
+        svn_ra_serf__add_empty_tag_buckets(buckets, alloc,
+                                           "S:ignore-eol-style", SVN_VA_NULL);
+
+      if (diff_options->patience)
+        svn_ra_serf__add_empty_tag_buckets(buckets, alloc,
+                                           "S:patience", SVN_VA_NULL);
+    }
+
+  svn_ra_serf__add_tag_buckets(buckets,
+                               "S:path", fb_ctx->path,
+                               alloc);
+
+  svn_ra_serf__add_close_tag_buckets(buckets, alloc,
+                                     "S:file-blame-report");
+
+  *body_bkt = buckets;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_ra_serf__get_file_blame(svn_ra_session_t *ra_session,
+                            const char *path,
+                            svn_revnum_t start,
+                            svn_revnum_t end,
+                            const svn_diff_file_options_t *diff_options,
+                            svn_ra__blame_rev_func_t rev_func,
+                            svn_ra__blame_chunk_func_t chunk_func,
+                            void *baton,
+                            svn_stream_t *contents,
+                            apr_pool_t *scratch_pool)
+{
+  file_blame_context_t *fb_ctx;
+  svn_ra_serf__session_t *session = ra_session->priv;
+  svn_ra_serf__handler_t *handler;
+  svn_ra_serf__xml_context_t *xmlctx;
+  const char *req_url;
+
+  if (!session->supports_file_blame)
+    return svn_error_create(SVN_ERR_RA_NOT_IMPLEMENTED, NULL,
+                            _("Server does not support file-blame-report"));
+
+  fb_ctx = apr_pcalloc(scratch_pool, sizeof(*fb_ctx));
+  fb_ctx->path = path;
+  fb_ctx->start = start;
+  fb_ctx->end = end;
+  fb_ctx->diff_options = diff_options;
+  fb_ctx->rev_func = rev_func;
+  fb_ctx->chunk_func = chunk_func;
+  fb_ctx->baton = baton;
+  fb_ctx->contents = contents;
+
+  /* START is never greater than END here, so END is the peg revision. */
+  SVN_ERR(svn_ra_serf__get_stable_url(&req_url, NULL /* latest_revnum */,
+                                      session,
+                                      NULL /* url */, end,
+                                      scratch_pool, scratch_pool));
+
+  xmlctx = svn_ra_serf__xml_context_create(file_blame_ttable,
+                                           file_blame_opened,
+                                           file_blame_closed,
+                                           file_blame_cdata,
+                                           fb_ctx,
+                                           scratch_pool);
+  handler = svn_ra_serf__create_expat_handler(session, xmlctx, NULL,
+                                              scratch_pool);
+
+  handler->method = "REPORT";
+  handler->path = req_url;
+  handler->body_type = "text/xml";
+  handler->body_delegate = create_file_blame_body;
+  handler->body_delegate_baton = fb_ctx;
+
+  SVN_ERR(svn_ra_serf__context_run_one(handler, scratch_pool));
+
+  if (handler->sline.code != 200)
+    return svn_error_trace(svn_ra_serf__unexpected_status(handler));
+
+  return SVN_NO_ERROR;
+}
@@ -38,6 +38,7 @@
 #include "svn_dirent_uri.h"
 
 #include "private/svn_dav_protocol.h"
+#include "private/svn_ra_private.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_editor.h"
 
@@ -273,6 +274,9 @@ struct svn_ra_serf__session_t {
    * to a successful PUT request. */
   svn_boolean_t supports_put_result_checksum;
 
+  /* Indicates whether the server supports the file-blame-report. */
+  svn_boolean_t supports_file_blame;
+
   apr_interval_time_t conn_latency;
 };
 
@@ -1321,6 +1325,19 @@ svn_ra_serf__get_file_revs(svn_ra_session_t *session,
                            void *handler_baton,
                            apr_pool_t *pool);
 
+/* Implements svn_ra__vtable_t.get_file_blame(). */
+svn_error_t *
+svn_ra_serf__get_file_blame(svn_ra_session_t *session,
+                            const char *path,
+                            svn_revnum_t start,
+                            svn_revnum_t end,
+                            const svn_diff_file_options_t *diff_options,
+                            svn_ra__blame_rev_func_t rev_func,
+                            svn_ra__blame_chunk_func_t chunk_func,
+                            void *baton,
+                            svn_stream_t *contents,
+                            apr_pool_t *scratch_pool);
+
 /* Implements svn_ra__vtable_t.get_dated_revision(). */
 svn_error_t *
 svn_ra_serf__get_dated_revision(svn_ra_session_t *session,
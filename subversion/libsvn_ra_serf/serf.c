@@ -764,6 +764,7 @@ ra_serf_dup_session(svn_ra_session_t *new_session,
   /* supports_svndiff1 */
   /* supports_svndiff2 */
   /* supports_put_result_checksum */
+  /* supports_file_blame */
   /* conn_latency */
 
   new_sess->context = serf_context_create(result_pool);
@@ -1070,6 +1071,9 @@ static const svn_ra__vtable_t serf_vtable = {
   NULL /* set_svn_ra_open */,
   svn_ra_serf__list,
   svn_ra_serf__fetch_file_contents,
+  NULL /* stat_many */,
+  NULL /* get_files */,
+  svn_ra_serf__get_file_blame,
   svn_ra_serf__register_editor_shim_callbacks,
   NULL /* commit_ev2 */,
   NULL /* replay_range_ev2 */
@@ -65,7 +65,9 @@ struct svn_ra_serf__xml_context_t {
   svn_ra_serf__xml_cdata_t cdata_cb;
   void *baton;
 
-  /* Linked list of free states.  */
+  /* Linked list of free states.  States are recycled through this list
+     and keep their (cleared) state pool, so a long response only ever
+     allocates as many states as its maximum element depth.  */
   svn_ra_serf__xml_estate_t *free_states;
 
 #ifdef SVN_DEBUG
@@ -110,7 +112,8 @@ struct svn_ra_serf__xml_estate_t {
      this tag is closed?  */
   svn_boolean_t custom_close;
 
-  /* A pool may be constructed for this state.  */
+  /* A pool may be constructed for this state.  It is cleared when the
+     state is popped and is kept when the state is recycled.  */
   apr_pool_t *state_pool;
 
   /* The namespaces extent for this state/element. This will start with
@@ -442,13 +445,12 @@ void svn_ra_serf__add_tag_buckets(serf_bucket_t *agg_bucket, const char *tag,
   svn_ra_serf__add_close_tag_buckets(agg_bucket, bkt_alloc, tag);
 }
 
-/* Return a pool for XES to use for self-alloc (and other specifics).  */
+/* Return the pool of the initial state above XES.  It lives as long as
+   the parsing context and is used to allocate the states themselves.  */
 static apr_pool_t *
-xes_pool(const svn_ra_serf__xml_estate_t *xes)
+root_pool(const svn_ra_serf__xml_estate_t *xes)
 {
-  /* Move up through parent states looking for one with a pool. This
-     will always terminate since the initial state has a pool.  */
-  while (xes->state_pool == NULL)
+  while (xes->prev != NULL)
     xes = xes->prev;
   return xes->state_pool;
 }
@@ -457,8 +459,10 @@ xes_pool(const svn_ra_serf__xml_estate_t *xes)
 static void
 ensure_pool(svn_ra_serf__xml_estate_t *xes)
 {
+  /* State pools are never children of other state pools: a recycled
+     state must not lose its pool when some outer state is popped.  */
   if (xes->state_pool == NULL)
-    xes->state_pool = svn_pool_create(xes_pool(xes));
+    xes->state_pool = svn_pool_create(root_pool(xes));
 }
 
 
@@ -639,7 +643,6 @@ xml_cb_start(svn_ra_serf__xml_context_t *xmlctx,
   svn_ra_serf__xml_estate_t *current = xmlctx->current;
   svn_ra_serf__dav_props_t elemname;
   const svn_ra_serf__xml_transition_t *scan;
-  apr_pool_t *new_pool;
   svn_ra_serf__xml_estate_t *new_xes;
 
   /* If we're waiting for an element to close, then just ignore all
@@ -690,34 +693,58 @@ xml_cb_start(svn_ra_serf__xml_context_t *xmlctx,
 
   /* Found a transition. Make it happen.  */
 
-  /* ### todo. push state  */
+  /* Take a state from the free list, or allocate a new one next to the
+     initial state.  */
+  if (xmlctx->free_states)
+    {
+      new_xes = xmlctx->free_states;
+      xmlctx->free_states = new_xes->prev;
+    }
+  else
+    {
+      new_xes = apr_pcalloc(root_pool(current), sizeof(*new_xes));
+      /* STATE_POOL remains NULL until needed.  */
+    }
 
-  /* ### how to use free states?  */
-  /* This state should be allocated in the extent pool. If we will be
-     collecting information for this state, then construct a subpool.
+  new_xes->prev = current;
+  new_xes->state = scan->to_state;
+  new_xes->custom_close = scan->custom_close;
+  new_xes->attrs = NULL;
+  new_xes->cdata = NULL;
 
-     ### potentially optimize away the subpool if none of the
-     ### attributes are present. subpools are cheap, tho...  */
-  new_pool = xes_pool(current);
-  if (scan->collect_cdata || scan->collect_attrs[0])
+  /* Start with the parent's namespace set.  */
+  new_xes->ns_list = current->ns_list;
+
+  /* A specific transition matched ELEMNAME exactly, so we can use the
+     names from the transition table.  Only wildcard matches need a copy
+     of the parser's strings.  */
+  if (*scan->name == '*')
+    {
+      ensure_pool(new_xes);
+      new_xes->tag.name = apr_pstrdup(new_xes->state_pool, elemname.name);
+      new_xes->tag.xmlns = apr_pstrdup(new_xes->state_pool, elemname.xmlns);
+    }
+  else
     {
-      new_pool = svn_pool_create(new_pool);
+      new_xes->tag.name = scan->name;
+      new_xes->tag.xmlns = scan->ns;
+    }
 
-      /* Prep the new state.  */
-      new_xes = apr_pcalloc(new_pool, sizeof(*new_xes));
-      new_xes->state_pool = new_pool;
+  if (scan->collect_cdata || scan->collect_attrs[0])
+    {
+      ensure_pool(new_xes);
 
       /* If we're supposed to collect cdata, then set up a buffer for
          this. The existence of this buffer will instruct our cdata
          callback to collect the cdata.  */
       if (scan->collect_cdata)
-        new_xes->cdata = svn_stringbuf_create_empty(new_pool);
+        new_xes->cdata = svn_stringbuf_create_empty(new_xes->state_pool);
 
       if (scan->collect_attrs[0] != NULL)
         {
           const char *const *saveattr = &scan->collect_attrs[0];
 
-          new_xes->attrs = apr_hash_make(new_pool);
+          new_xes->attrs = apr_hash_make(new_xes->state_pool);
           for (; *saveattr != NULL; ++saveattr)
             {
               const char *name;
@@ -733,37 +760,28 @@ xml_cb_start(svn_ra_serf__xml_context_t *xmlctx,
                   name = *saveattr;
                   value = svn_xml_get_attr_value(name, attrs);
                   if (value == NULL)
-                    return svn_error_createf(
+                    {
+                      /* Put the state back; it was never pushed.  */
+                      new_xes->prev = xmlctx->free_states;
+                      xmlctx->free_states = new_xes;
+                      svn_pool_clear(new_xes->state_pool);
+
+                      return svn_error_createf(
                                 SVN_ERR_XML_ATTRIB_NOT_FOUND,
                                 NULL,
                                 _("Missing XML attribute '%s' on '%s' element"),
                                 name, scan->name);
+                    }
                 }
 
               if (value)
                 svn_hash_sets(new_xes->attrs, name,
-                              apr_pstrdup(new_pool, value));
+                              apr_pstrdup(new_xes->state_pool, value));
             }
         }
     }
-  else
-    {
-      /* Prep the new state.  */
-      new_xes = apr_pcalloc(new_pool, sizeof(*new_xes));
-      /* STATE_POOL remains NULL.  */
-    }
-
-  /* Some basic copies to set up the new estate.  */
-  new_xes->state = scan->to_state;
-  new_xes->tag.name = apr_pstrdup(new_pool, elemname.name);
-  new_xes->tag.xmlns = apr_pstrdup(new_pool, elemname.xmlns);
-  new_xes->custom_close = scan->custom_close;
-
-  /* Start with the parent's namespace set.  */
-  new_xes->ns_list = current->ns_list;
 
   /* The new state is prepared. Make it current.  */
-  new_xes->prev = current;
   xmlctx->current = new_xes;
 
   if (xmlctx->opened_cb)
@@ -817,19 +835,16 @@ xml_cb_end(svn_ra_serf__xml_context_t *xmlctx,
       svn_pool_clear(xmlctx->scratch_pool);
     }
 
-  /* Pop the state.  */
+  /* Pop the state and put it on the free list for reuse.  */
   xmlctx->current = xes->prev;
-
-  /* ### not everything should go on the free state list. XES may go
-     ### away with the state pool.  */
   xes->prev = xmlctx->free_states;
   xmlctx->free_states = xes;
 
-  /* If there is a STATE_POOL, then toss it. This will get rid of as much
-     memory as possible. Potentially the XES (if we didn't create a pool
-     right away, then XES may be in a parent pool).  */
+  /* If there is a STATE_POOL, then empty it. Everything allocated for
+     this state goes away, but the pool is kept for the next element
+     that reuses XES.  */
   if (xes->state_pool)
-    svn_pool_destroy(xes->state_pool);
+    svn_pool_clear(xes->state_pool);
 
   return SVN_NO_ERROR;
 }
@@ -1437,6 +1437,41 @@ parse_iproplist(apr_array_header_t **inherited_props,
   return SVN_NO_ERROR;
 }
 
+/* Read file contents from CONN, i.e. a sequence of strings terminated by
+ * an empty one, and write them to STREAM.  If CHECKSUM_CTX is not NULL,
+ * update it with the data.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+read_file_contents(svn_ra_svn_conn_t *conn,
+                   svn_stream_t *stream,
+                   svn_checksum_ctx_t *checksum_ctx,
+                   apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  while (1)
+    {
+      svn_ra_svn__item_t *item;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_ra_svn__read_item(conn, iterpool, &item));
+      if (item->kind != SVN_RA_SVN_STRING)
+        return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                _("Non-string as part of file contents"));
+      if (item->u.string.len == 0)
+        break;
+
+      if (checksum_ctx)
+        SVN_ERR(svn_checksum_update(checksum_ctx, item->u.string.data,
+                                    item->u.string.len));
+
+      if (stream)
+        SVN_ERR(svn_stream_write(stream, item->u.string.data,
+                                 &item->u.string.len));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *get_file(svn_ra_session_t *session, const char *path,
                              svn_revnum_t rev, svn_stream_t *stream,
                              svn_revnum_t *fetched_rev,
@@ -1448,8 +1483,7 @@ static svn_error_t *get_file(svn_ra_session_t *session, const char *path,
   svn_ra_svn__list_t *proplist;
   const char *expected_digest;
   svn_checksum_t *expected_checksum = NULL;
-  svn_checksum_ctx_t *checksum_ctx;
-  apr_pool_t *iterpool;
+  svn_checksum_ctx_t *checksum_ctx = NULL;
 
   path = reparent_path(session, path, pool);
   SVN_ERR(svn_ra_svn__write_cmd_get_file(conn, pool, path, rev,
@@ -1476,28 +1510,7 @@ static svn_error_t *get_file(svn_ra_session_t *session, const char *path,
     }
 
   /* Read the file's contents. */
-  iterpool = svn_pool_create(pool);
-  while (1)
-    {
-      svn_ra_svn__item_t *item;
-
-      svn_pool_clear(iterpool);
-      SVN_ERR(svn_ra_svn__read_item(conn, iterpool, &item));
-      if (item->kind != SVN_RA_SVN_STRING)
-        return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
-                                _("Non-string as part of file contents"));
-      if (item->u.string.len == 0)
-        break;
-
-      if (expected_checksum)
-        SVN_ERR(svn_checksum_update(checksum_ctx, item->u.string.data,
-                                    item->u.string.len));
-
-      SVN_ERR(svn_stream_write(stream, item->u.string.data,
-                               &item->u.string.len));
-    }
-  svn_pool_destroy(iterpool);
-
+  SVN_ERR(read_file_contents(conn, stream, checksum_ctx, pool));
   SVN_ERR(svn_stream_close(stream));
 
   SVN_ERR(svn_ra_svn__read_cmd_response(conn, pool, ""));
@@ -2139,6 +2152,35 @@ static svn_error_t *handle_unsupported_cmd(svn_error_t *err,
 }
 
 
+/* Parse the dirent tuple LIST of a stat response into *DIRENT,
+ * allocated in POOL. */
+static svn_error_t *
+parse_stat_dirent(svn_dirent_t **dirent,
+                  svn_ra_svn__list_t *list,
+                  apr_pool_t *pool)
+{
+  const char *kind, *cdate, *cauthor;
+  svn_boolean_t has_props;
+  svn_revnum_t crev;
+  apr_uint64_t size;
+  svn_dirent_t *the_dirent;
+
+  SVN_ERR(svn_ra_svn__parse_tuple(list, "wnbr(?c)(?c)",
+                                  &kind, &size, &has_props,
+                                  &crev, &cdate, &cauthor));
+
+  the_dirent = svn_dirent_create(pool);
+  the_dirent->kind = svn_node_kind_from_word(kind);
+  the_dirent->size = size;/* FIXME: svn_filesize_t */
+  the_dirent->has_props = has_props;
+  the_dirent->created_rev = crev;
+  SVN_ERR(svn_time_from_cstring(&the_dirent->time, cdate, pool));
+  the_dirent->last_author = cauthor;
+
+  *dirent = the_dirent;
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *ra_svn_stat(svn_ra_session_t *session,
                                 const char *path, svn_revnum_t rev,
                                 svn_dirent_t **dirent, apr_pool_t *pool)
@@ -2146,7 +2188,6 @@ static svn_error_t *ra_svn_stat(svn_ra_session_t *session,
   svn_ra_svn__session_baton_t *sess_baton = session->priv;
   svn_ra_svn_conn_t *conn = sess_baton->conn;
   svn_ra_svn__list_t *list = NULL;
-  svn_dirent_t *the_dirent;
 
   path = reparent_path(session, path, pool);
   SVN_ERR(svn_ra_svn__write_cmd_stat(conn, pool, path, rev));
@@ -2155,30 +2196,9 @@ static svn_error_t *ra_svn_stat(svn_ra_session_t *session,
   SVN_ERR(svn_ra_svn__read_cmd_response(conn, pool, "(?l)", &list));
 
   if (! list)
-    {
-      *dirent = NULL;
-    }
+    *dirent = NULL;
   else
-    {
-      const char *kind, *cdate, *cauthor;
-      svn_boolean_t has_props;
-      svn_revnum_t crev;
-      apr_uint64_t size;
-
-      SVN_ERR(svn_ra_svn__parse_tuple(list, "wnbr(?c)(?c)",
-                                      &kind, &size, &has_props,
-                                      &crev, &cdate, &cauthor));
-
-      the_dirent = svn_dirent_create(pool);
-      the_dirent->kind = svn_node_kind_from_word(kind);
-      the_dirent->size = size;/* FIXME: svn_filesize_t */
-      the_dirent->has_props = has_props;
-      the_dirent->created_rev = crev;
-      SVN_ERR(svn_time_from_cstring(&the_dirent->time, cdate, pool));
-      the_dirent->last_author = cauthor;
-
-      *dirent = the_dirent;
-    }
+    SVN_ERR(parse_stat_dirent(dirent, list, pool));
 
   return SVN_NO_ERROR;
 }
@@ -3289,6 +3309,325 @@ static svn_error_t *ra_svn_fetch_file_contents(svn_ra_session_t *session,
   return SVN_NO_ERROR;
 }
 
+/* Write the start of the batched command CMD_NAME including the list of
+ * PATHS to the connection of SESSION.  The caller has to write the
+ * remaining parameters, starting with "!)".  Use SCRATCH_POOL for
+ * temporary allocations. */
+static svn_error_t *
+write_batched_cmd_paths(svn_ra_session_t *session,
+                        const char *cmd_name,
+                        const apr_array_header_t *paths,
+                        apr_pool_t *scratch_pool)
+{
+  svn_ra_svn__session_baton_t *sess_baton = session->priv;
+  svn_ra_svn_conn_t *conn = sess_baton->conn;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
+
+  SVN_ERR(svn_ra_svn__write_tuple(conn, scratch_pool, "w((!", cmd_name));
+  for (i = 0; i < paths->nelts; i++)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_ra_svn__write_cstring(conn, iterpool,
+                                        reparent_path(session, path,
+                                                      iterpool)));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Return the next entry of a batched response on CONN in *LIST and set
+ * *IS_DONE if there are no more entries.  Allocate *LIST in POOL. */
+static svn_error_t *
+read_batched_entry(svn_ra_svn__list_t **list,
+                   svn_boolean_t *is_done,
+                   svn_ra_svn_conn_t *conn,
+                   apr_pool_t *pool)
+{
+  svn_ra_svn__item_t *item;
+
+  SVN_ERR(svn_ra_svn__read_item(conn, pool, &item));
+  *is_done = is_done_response(item);
+  if (*is_done)
+    return SVN_NO_ERROR;
+
+  if (item->kind != SVN_RA_SVN_LIST)
+    return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                            _("Batched response entry not a list"));
+
+  *list = &item->u.list;
+  return SVN_NO_ERROR;
+}
+
+/* Return an error if the server sent more entries than we asked for. */
+static svn_error_t *
+check_batched_count(int received,
+                    const apr_array_header_t *paths)
+{
+  if (received >= paths->nelts)
+    return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                            _("Too many entries in batched response"));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *ra_svn_stat_many(svn_ra_session_t *session,
+                                     const apr_array_header_t *paths,
+                                     svn_revnum_t rev,
+                                     svn_ra__stat_receiver_t receiver,
+                                     void *receiver_baton,
+                                     apr_pool_t *scratch_pool)
+{
+  svn_ra_svn__session_baton_t *sess_baton = session->priv;
+  svn_ra_svn_conn_t *conn = sess_baton->conn;
+  apr_pool_t *iterpool;
+  svn_error_t *err = SVN_NO_ERROR;
+  int received = 0;
+
+  if (!svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_BATCHED_FETCH))
+    return svn_error_create(SVN_ERR_RA_NOT_IMPLEMENTED, NULL,
+                            _("Server does not support 'stat-many'"));
+
+  SVN_ERR(write_batched_cmd_paths(session, "stat-many", paths,
+                                  scratch_pool));
+  SVN_ERR(svn_ra_svn__write_tuple(conn, scratch_pool, "!)(?r))", rev));
+  SVN_ERR(handle_auth_request(sess_baton, scratch_pool));
+
+  /* Process the entries as they come in.  Once the receiver failed,
+     keep draining the response to leave the connection in a sane state. */
+  iterpool = svn_pool_create(scratch_pool);
+  while (1)
+    {
+      svn_ra_svn__list_t *entry, *dirent_list;
+      const char *path;
+      svn_dirent_t *dirent = NULL;
+      svn_boolean_t is_done;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(read_batched_entry(&entry, &is_done, conn, iterpool));
+      if (is_done)
+        break;
+
+      SVN_ERR(check_batched_count(received, paths));
+      SVN_ERR(svn_ra_svn__parse_tuple(entry, "c(?l)", &path, &dirent_list));
+      if (dirent_list)
+        SVN_ERR(parse_stat_dirent(&dirent, dirent_list, iterpool));
+
+      /* Report the path as the caller passed it in. */
+      if (!err)
+        err = receiver(receiver_baton,
+                       APR_ARRAY_IDX(paths, received, const char *),
+                       dirent, iterpool);
+      ++received;
+    }
+  svn_pool_destroy(iterpool);
+
+  return svn_error_compose_create(
+           err, svn_ra_svn__read_cmd_response(conn, scratch_pool, ""));
+}
+
+static svn_error_t *ra_svn_get_file_blame(
+                        svn_ra_session_t *session,
+                        const char *path,
+                        svn_revnum_t start,
+                        svn_revnum_t end,
+                        const svn_diff_file_options_t *diff_options,
+                        svn_ra__blame_rev_func_t rev_func,
+                        svn_ra__blame_chunk_func_t chunk_func,
+                        void *baton,
+                        svn_stream_t *contents,
+                        apr_pool_t *scratch_pool)
+{
+  svn_ra_svn__session_baton_t *sess_baton = session->priv;
+  svn_ra_svn_conn_t *conn = sess_baton->conn;
+  apr_pool_t *iterpool;
+  svn_error_t *err = SVN_NO_ERROR;
+  svn_error_t *response_err;
+  svn_diff_file_ignore_space_t ignore_space = svn_diff_file_ignore_space_none;
+  svn_boolean_t ignore_eol_style = FALSE;
+  svn_boolean_t patience = FALSE;
+
+  if (!svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_FILE_BLAME))
+    return svn_error_create(SVN_ERR_RA_NOT_IMPLEMENTED, NULL,
+                            _("Server does not support 'get-file-blame'"));
+
+  if (diff_options)
+    {
+      ignore_space = diff_options->ignore_space;
+      ignore_eol_style = diff_options->ignore_eol_style;
+      patience = diff_options->patience;
+    }
+
+  path = reparent_path(session, path, scratch_pool);
+  SVN_ERR(svn_ra_svn__write_tuple(conn, scratch_pool, "w(crrnbb)",
+                                  "get-file-blame", path, start, end,
+                                  (apr_uint64_t)ignore_space,
+                                  ignore_eol_style, patience));
+  SVN_ERR(handle_auth_request(sess_baton, scratch_pool));
+
+  /* Process the entries as they come in.  Once a callback failed, keep
+     draining the response to leave the connection in a sane state. */
+  iterpool = svn_pool_create(scratch_pool);
+  while (1)
+    {
+      svn_ra_svn__list_t *entry;
+      const char *kind;
+      svn_boolean_t is_done;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(read_batched_entry(&entry, &is_done, conn, iterpool));
+      if (is_done)
+        break;
+
+      SVN_ERR(svn_ra_svn__parse_tuple(entry, "w", &kind));
+      if (strcmp(kind, "rev") == 0)
+        {
+          const char *rev_path;
+          svn_revnum_t rev;
+          svn_ra_svn__list_t *rev_proplist;
+          apr_hash_t *rev_props;
+
+          SVN_ERR(svn_ra_svn__parse_tuple(entry, "wcrl", &kind, &rev_path,
+                                          &rev, &rev_proplist));
+          SVN_ERR(svn_ra_svn__parse_proplist(rev_proplist, iterpool,
+                                             &rev_props));
+          if (!err)
+            err = rev_func(baton, rev_path, rev, rev_props, iterpool);
+        }
+      else if (strcmp(kind, "lines") == 0)
+        {
+          apr_uint64_t line_start;
+          svn_revnum_t rev;
+
+          SVN_ERR(svn_ra_svn__parse_tuple(entry, "wn(?r)", &kind,
+                                          &line_start, &rev));
+          if (!err)
+            err = chunk_func(baton, (apr_int64_t)line_start, rev,
+                             iterpool);
+        }
+      else
+        return svn_error_createf(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                 _("Unknown get-file-blame entry '%s'"),
+                                 kind);
+    }
+  svn_pool_destroy(iterpool);
+
+  /* No contents follow a failure response. */
+  response_err = svn_ra_svn__read_cmd_response(conn, scratch_pool, "");
+  if (response_err)
+    return svn_error_compose_create(err, response_err);
+
+  /* Read the text that the line numbers refer to. */
+  SVN_ERR(read_file_contents(conn, err ? NULL : contents, NULL,
+                             scratch_pool));
+  return svn_error_compose_create(
+           err, svn_ra_svn__read_cmd_response(conn, scratch_pool, ""));
+}
+
+static svn_error_t *ra_svn_get_files(svn_ra_session_t *session,
+                                     const apr_array_header_t *paths,
+                                     svn_revnum_t rev,
+                                     svn_boolean_t want_props,
+                                     svn_ra__file_stream_func_t stream_func,
+                                     svn_ra__file_receiver_t receiver,
+                                     void *baton,
+                                     apr_pool_t *scratch_pool)
+{
+  svn_ra_svn__session_baton_t *sess_baton = session->priv;
+  svn_ra_svn_conn_t *conn = sess_baton->conn;
+  apr_pool_t *iterpool;
+  svn_error_t *err = SVN_NO_ERROR;
+  int received = 0;
+
+  if (!svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_BATCHED_FETCH))
+    return svn_error_create(SVN_ERR_RA_NOT_IMPLEMENTED, NULL,
+                            _("Server does not support 'get-files'"));
+
+  SVN_ERR(write_batched_cmd_paths(session, "get-files", paths,
+                                  scratch_pool));
+  SVN_ERR(svn_ra_svn__write_tuple(conn, scratch_pool, "!)(?r)bb)", rev,
+                                  want_props, stream_func != NULL));
+  SVN_ERR(handle_auth_request(sess_baton, scratch_pool));
+
+  /* Process the files as they come in.  After the first error, keep
+     reading (but not processing) the remaining data to leave the
+     connection in a sane state. */
+  iterpool = svn_pool_create(scratch_pool);
+  while (1)
+    {
+      svn_ra_svn__list_t *entry, *proplist;
+      const char *path, *expected_digest;
+      svn_revnum_t fetched_rev;
+      apr_hash_t *props = NULL;
+      svn_stream_t *stream = NULL;
+      svn_checksum_ctx_t *checksum_ctx = NULL;
+      svn_checksum_t *expected_checksum = NULL;
+      svn_boolean_t is_done;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(read_batched_entry(&entry, &is_done, conn, iterpool));
+      if (is_done)
+        break;
+
+      SVN_ERR(check_batched_count(received, paths));
+      SVN_ERR(svn_ra_svn__parse_tuple(entry, "c(?c)rl", &path,
+                                      &expected_digest, &fetched_rev,
+                                      &proplist));
+      path = APR_ARRAY_IDX(paths, received, const char *);
+      ++received;
+
+      if (!err && want_props)
+        err = svn_ra_svn__parse_proplist(proplist, iterpool, &props);
+
+      if (!stream_func)
+        {
+          if (!err)
+            err = receiver(baton, path, fetched_rev, props, iterpool);
+          continue;
+        }
+
+      if (!err)
+        err = stream_func(&stream, baton, path, iterpool, iterpool);
+      if (!err && stream && expected_digest)
+        {
+          err = svn_checksum_parse_hex(&expected_checksum, svn_checksum_md5,
+                                       expected_digest, iterpool);
+          checksum_ctx = svn_checksum_ctx_create(svn_checksum_md5, iterpool);
+        }
+
+      /* Contents always have to be read, even if we don't process them. */
+      SVN_ERR(read_file_contents(conn, err ? NULL : stream,
+                                 err ? NULL : checksum_ctx, iterpool));
+      if (err)
+        continue;
+
+      if (stream)
+        err = svn_stream_close(stream);
+
+      if (!err && expected_checksum)
+        {
+          svn_checksum_t *checksum;
+
+          err = svn_checksum_final(&checksum, checksum_ctx, iterpool);
+          if (!err && !svn_checksum_match(checksum, expected_checksum))
+            err = svn_checksum_mismatch_err(expected_checksum, checksum,
+                                            scratch_pool,
+                                            _("Checksum mismatch for '%s'"),
+                                            path);
+        }
+
+      if (!err)
+        err = receiver(baton, path, fetched_rev, props, iterpool);
+    }
+  svn_pool_destroy(iterpool);
+
+  return svn_error_compose_create(
+           err, svn_ra_svn__read_cmd_response(conn, scratch_pool, ""));
+}
+
 static const svn_ra__vtable_t ra_svn_vtable = {
   svn_ra_svn_version,
   ra_svn_get_description,
@@ -3330,6 +3669,9 @@ static const svn_ra__vtable_t ra_svn_vtable = {
   NULL /* ra_set_svn_ra_open */,
   ra_svn_list,
   ra_svn_fetch_file_contents,
+  ra_svn_stat_many,
+  ra_svn_get_files,
+  ra_svn_get_file_blame,
   ra_svn_register_editor_shim_callbacks,
   NULL /* commit_ev2 */,
   NULL /* replay_range_ev2 */
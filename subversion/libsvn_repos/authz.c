@@ -1011,6 +1011,21 @@ create_user_authz(authz_full_t *authz,
 
 /*** Lookup. ***/
 
+/* The CURRENT node list and rights in lookup_state_t for one parent
+ * path of the previous lookup. */
+typedef struct lookup_level_t
+{
+  /* Length of the parent path this level applies to. */
+  apr_size_t path_len;
+
+  /* Rights that apply at that path. */
+  limited_rights_t rights;
+
+  /* Nodes applying to that path.  This array is owned by the level and
+   * gets recycled when the level is overwritten. */
+  apr_array_header_t *nodes;
+} lookup_level_t;
+
 /* Reusable lookup state object. It is easy to pass to functions and
  * recycling it between lookups saves significant setup costs. */
 typedef struct lookup_state_t
@@ -1036,6 +1051,18 @@ typedef struct lookup_state_t
   /* Rights that apply at PARENT_PATH, if PARENT_PATH is not empty. */
   limited_rights_t parent_rights;
 
+  /* Stack of lookup_level_t, one for each parent of the previous lookup's
+   * path, with the root at index 0 and PARENT_PATH at the top.  CURRENT
+   * is the NODES array of the top element.  A new lookup may continue
+   * from the deepest of these that is also a parent of its path, i.e.
+   * sibling paths and paths in sibling sub-trees don't have to walk
+   * their common parents again. */
+  apr_array_header_t *levels;
+
+  /* Number of elements in LEVELS' buffer, including those beyond NELTS,
+   * whose NODES arrays have been allocated and can be reused. */
+  int allocated_levels;
+
 } lookup_state_t;
 
 /* Constructor for lookup_state_t. */
@@ -1045,7 +1072,7 @@ create_lookup_state(apr_pool_t *result_pool)
   lookup_state_t *state = apr_pcalloc(result_pool, sizeof(*state));
 
   state->next = apr_array_make(result_pool, 4, sizeof(node_t *));
-  state->current = apr_array_make(result_pool, 4, sizeof(node_t *));
+  state->levels = apr_array_make(result_pool, 8, sizeof(lookup_level_t));
 
   /* Virtually all path segments should fit into this buffer.  If they
    * don't, the buffer gets automatically reallocated.
@@ -1062,6 +1089,46 @@ create_lookup_state(apr_pool_t *result_pool)
   return state;
 }
 
+/* Make CURRENT in STATE the node list for PARENT_PATH and record the
+ * current rights as its parent rights.  The level is added on top of
+ * the first DEPTH entries of STATE->LEVELS. */
+static void
+push_lookup_level(lookup_state_t *state,
+                  int depth)
+{
+  lookup_level_t *level;
+  apr_array_header_t *temp;
+
+  /* Keep the level arrays allocated as we go up and down the tree.
+   * Only allocate new ones beyond the deepest level used so far. */
+  if (depth < state->allocated_levels)
+    {
+      level = &APR_ARRAY_IDX(state->levels, depth, lookup_level_t);
+      state->levels->nelts = depth + 1;
+    }
+  else
+    {
+      state->levels->nelts = state->allocated_levels;
+      level = apr_array_push(state->levels);
+      level->nodes = apr_array_make(state->levels->pool, 4,
+                                    sizeof(node_t *));
+      ++state->allocated_levels;
+    }
+
+  /* NEXT becomes the node list of this level and the level's old array
+   * becomes the scratch array. */
+  temp = level->nodes;
+  level->nodes = state->next;
+  state->next = temp;
+  apr_array_clear(state->next);
+
+  level->path_len = state->parent_path->len;
+  level->rights = state->rights;
+
+  state->current = level->nodes;
+  state->parent_rights = state->rights;
+}
+
 /* Clear the current contents of STATE and re-initialize it for ROOT.
  * Check whether we can reuse a previous parent path lookup to shorten
  * the current PATH walk.  Return the full or remaining portion of
@@ -1071,28 +1138,54 @@ init_lockup_state(lookup_state_t *state,
                   node_t *root,
                   const char *path)
 {
-  apr_size_t len = strlen(path);
-  if (   (len > state->parent_path->len)
-      && state->parent_path->len
-      && (path[state->parent_path->len] == '/')
-      && !memcmp(path, state->parent_path->data, state->parent_path->len))
+  apr_size_t common = 0;
+  apr_size_t path_len = strlen(path);
+  int depth;
+
+  /* lookup() ignores trailing '/', so we must not resume at a level that
+   * is PATH itself plus a trailing '/'. */
+  while (path_len && path[path_len - 1] == '/')
+    --path_len;
+
+  /* Length of the common prefix of PATH and the previous PARENT_PATH. */
+  while (   common < state->parent_path->len
+         && common < path_len
+         && path[common] == state->parent_path->data[common])
+    ++common;
+
+  /* Find the deepest parent of the previous lookup that is also a parent
+   * of PATH.  Level 0 is ROOT itself, which we simply set up again. */
+  for (depth = state->levels->nelts - 1; depth > 0; --depth)
     {
-      /* The PARENT_PATH of the previous lookup is actually a parent path
-       * of PATH.  The CURRENT node list already matches the parent path
-       * and we only have to set the correct rights info. */
-      state->rights = state->parent_rights;
+      const lookup_level_t *level
+        = &APR_ARRAY_IDX(state->levels, depth, lookup_level_t);
 
-      /* Tell the caller where to proceed. */
-      return path + state->parent_path->len;
+      if (   level->path_len <= common
+          && level->path_len < path_len
+          && path[level->path_len] == '/')
+        {
+          /* The CURRENT node list of that level already matches the
+           * parent path and we only have to set the correct rights
+           * info. */
+          state->levels->nelts = depth + 1;
+          state->current = level->nodes;
+          state->parent_rights = level->rights;
+          state->rights = level->rights;
+          svn_stringbuf_chop(state->parent_path,
+                             state->parent_path->len - level->path_len);
+
+          /* Tell the caller where to proceed. */
+          return path + level->path_len;
+        }
     }
 
   /* Start lookup at ROOT for the full PATH. */
   state->rights = root->rights;
-  state->parent_rights = root->rights;
 
   apr_array_clear(state->next);
-  apr_array_clear(state->current);
-  APR_ARRAY_PUSH(state->current, node_t *) = root;
+  svn_stringbuf_setempty(state->parent_path);
+  APR_ARRAY_PUSH(state->next, node_t *) = root;
+  push_lookup_level(state, 0);
 
   /* Var-segment rules match empty segments as well */
   if (root->pattern_sub_nodes && root->pattern_sub_nodes->any_var)
@@ -1105,7 +1198,6 @@ init_lockup_state(lookup_state_t *state,
       APR_ARRAY_PUSH(state->current, node_t *) = node;
    }
 
-  svn_stringbuf_setempty(state->parent_path);
   svn_stringbuf_setempty(state->scratch_pad);
 
   return path;
@@ -1303,7 +1395,6 @@ lookup(lookup_state_t *state,
    * either tree or PATH. */
   while (state->current->nelts && path)
     {
-      apr_array_header_t *temp;
       int i;
       svn_stringbuf_t *segment = state->scratch_pad;
 
@@ -1397,12 +1488,8 @@ lookup(lookup_state_t *state,
        */
       if (path)
         {
-          temp = state->current;
-          state->current = state->next;
-          state->next = temp;
-
           /* In STATE, PARENT_PATH, PARENT_RIGHTS and CURRENT are now in sync. */
-          state->parent_rights = state->rights;
+          push_lookup_level(state, state->levels->nelts);
         }
     }
 
@@ -0,0 +1,543 @@
+/* blame.c : line attribution of repository files
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_pools.h>
+
+#include "svn_pools.h"
+#include "svn_error.h"
+#include "svn_fs.h"
+#include "svn_repos.h"
+
+#include "private/svn_cache.h"
+#include "private/svn_fs_private.h"
+#include "private/svn_repos_private.h"
+#include "private/svn_temp_serializer.h"
+#include "svn_private_config.h"
+
+#include "repos.h"
+
+
+
+/* A file version visited by svn_repos_get_file_revs2(). */
+typedef struct blame_location_t
+{
+  const char *path;
+  svn_revnum_t revision;
+} blame_location_t;
+
+/* The result of svn_repos__get_file_blame() as stored in the blame
+   cache. */
+typedef struct blame_result_t
+{
+  /* All file versions visited, oldest first. */
+  blame_location_t *versions;
+  int versions_count;
+
+  /* The attribution of the latest version, ordered by line number. */
+  svn_repos__blame_chunk_t *chunks;
+  int chunks_count;
+} blame_result_t;
+
+/* Implements svn_cache__serialize_func_t for blame_result_t. */
+static svn_error_t *
+serialize_blame_result(void **data,
+                       apr_size_t *data_len,
+                       void *in,
+                       apr_pool_t *pool)
+{
+  blame_result_t *result = in;
+  svn_temp_serializer__context_t *context;
+  svn_stringbuf_t *serialized;
+  int i;
+
+  context = svn_temp_serializer__init(result, sizeof(*result),
+                                      sizeof(*result)
+                                      + result->versions_count * 64
+                                      + result->chunks_count
+                                        * sizeof(*result->chunks),
+                                      pool);
+
+  svn_temp_serializer__push(context,
+                            (const void * const *)&result->versions,
+                            result->versions_count
+                              * sizeof(*result->versions));
+  for (i = 0; i < result->versions_count; ++i)
+    svn_temp_serializer__add_string(context, &result->versions[i].path);
+  svn_temp_serializer__pop(context);
+
+  svn_temp_serializer__add_leaf(context,
+                                (const void * const *)&result->chunks,
+                                result->chunks_count
+                                  * sizeof(*result->chunks));
+
+  serialized = svn_temp_serializer__get(context);
+  *data = serialized->data;
+  *data_len = serialized->len;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_cache__deserialize_func_t for blame_result_t. */
+static svn_error_t *
+deserialize_blame_result(void **out,
+                         void *data,
+                         apr_size_t data_len,
+                         apr_pool_t *pool)
+{
+  blame_result_t *result = data;
+  int i;
+
+  svn_temp_deserializer__resolve(result, (void **)&result->versions);
+  for (i = 0; i < result->versions_count; ++i)
+    svn_temp_deserializer__resolve(result->versions,
+                                   (void **)&result->versions[i].path);
+  svn_temp_deserializer__resolve(result, (void **)&result->chunks);
+  *out = result;
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *CACHE to the blame cache of REPOS, creating it if necessary.
+ * Set it to NULL if there is no membuffer cache to use or if the FS
+ * backend does not provide an instance ID.
+ *
+ * Like the log history cache, the entries never become invalid and are
+ * shared with all other svn_repos_t instances for the same repository.
+ *
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+get_blame_cache(svn_cache__t **cache,
+                svn_repos_t *repos,
+                apr_pool_t *scratch_pool)
+{
+  svn_membuffer_t *membuffer = svn_cache__get_global_membuffer_cache();
+
+  if (!repos->blame_cache && membuffer)
+    {
+      const char *uuid;
+      const char *instance_id;
+      const char *prefix;
+
+      SVN_ERR(svn_fs__get_instance_id(&instance_id, repos->fs,
+                                      scratch_pool));
+      if (!instance_id)
+        {
+          *cache = NULL;
+          return SVN_NO_ERROR;
+        }
+
+      SVN_ERR(svn_fs_get_uuid(repos->fs, &uuid, scratch_pool));
+      prefix = apr_pstrcat(scratch_pool, "repos-blame:", uuid, ":",
+                           instance_id, "/", repos->path, ":", SVN_VA_NULL);
+
+      SVN_ERR(svn_cache__create_membuffer_cache(
+                &repos->blame_cache, membuffer,
+                serialize_blame_result, deserialize_blame_result,
+                APR_HASH_KEY_STRING, prefix,
+                SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                FALSE, FALSE, repos->pool, scratch_pool));
+    }
+
+  *cache = repos->blame_cache;
+  return SVN_NO_ERROR;
+}
+
+/* Set *KEY to the key under which the blame of PATH in the revision of
+ * ROOT for the revision range starting at START and the options key
+ * OPTIONS_KEY is stored in the blame cache.
+ *
+ * The node-revision ID identifies the file contents and history.  The
+ * revision of the closest copy is needed, too: a lazily copied file has
+ * the same node-revision as its copy source, but its history starts with
+ * the copy.  Allocate *KEY in RESULT_POOL.
+ */
+static svn_error_t *
+blame_cache_key(const char **key,
+                svn_fs_root_t *root,
+                const char *path,
+                svn_revnum_t start,
+                const char *options_key,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  const svn_fs_id_t *id;
+  svn_fs_root_t *copy_root;
+  const char *copy_path;
+  svn_revnum_t copy_rev = SVN_INVALID_REVNUM;
+  svn_string_t *id_str;
+
+  SVN_ERR(svn_fs_node_id(&id, root, path, scratch_pool));
+  id_str = svn_fs_unparse_id(id, scratch_pool);
+  SVN_ERR(svn_fs_closest_copy(&copy_root, &copy_path, root, path,
+                              scratch_pool));
+  if (copy_root)
+    copy_rev = svn_fs_revision_root_revision(copy_root);
+
+  *key = apr_psprintf(result_pool, "%ld:%ld:%s:%s:%s",
+                      start, copy_rev, options_key, id_str->data, path);
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton for blame_file_rev_handler() and blame_window_handler(). */
+typedef struct blame_baton_t
+{
+  /* How to compare subsequent versions of the file. */
+  const svn_repos__blame_diff_t *diff;
+
+  /* All versions visited so far, as blame_location_t *.  Allocated in
+     MAINPOOL. */
+  apr_array_header_t *versions;
+
+  /* File containing the fulltext of the latest version processed so far.
+     NULL before the first version. */
+  const char *last_filename;
+
+  /* The file that the current delta is being applied to and the index of
+     its version in VERSIONS. */
+  const char *filename;
+  int version;
+
+  /* The delta application writing to FILENAME. */
+  svn_txdelta_window_handler_t apply_handler;
+  void *apply_baton;
+
+  /* Lives during the whole operation. */
+  apr_pool_t *mainpool;
+
+  /* Contains LAST_FILENAME. */
+  apr_pool_t *lastpool;
+
+  /* Contains FILENAME. */
+  apr_pool_t *currpool;
+} blame_baton_t;
+
+/* Implements svn_txdelta_window_handler_t.  Apply WINDOW to the version
+ * of the file being reconstructed for the blame_baton_t BATON and, once
+ * it is complete, update the blame for the changes made in it. */
+static svn_error_t *
+blame_window_handler(svn_txdelta_window_t *window,
+                     void *baton)
+{
+  blame_baton_t *bb = baton;
+  apr_pool_t *scratch_pool;
+  apr_pool_t *tmp_pool;
+
+  SVN_ERR(bb->apply_handler(window, bb->apply_baton));
+  if (window)
+    return SVN_NO_ERROR;
+
+  scratch_pool = svn_pool_create(bb->currpool);
+  SVN_ERR(bb->diff->add_file(bb->diff->baton, bb->last_filename,
+                             bb->filename, bb->version, scratch_pool));
+  svn_pool_destroy(scratch_pool);
+
+  /* Keep the fulltext around to apply the next delta to and to diff it
+     against the next version. */
+  bb->last_filename = bb->filename;
+  tmp_pool = bb->lastpool;
+  bb->lastpool = bb->currpool;
+  bb->currpool = tmp_pool;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_file_rev_handler_t.  Record the version of PATH in
+ * REVNUM in the blame_baton_t BATON and, if its contents changed, return
+ * a handler that reconstructs them from the delta against the previous
+ * version. */
+static svn_error_t *
+blame_file_rev_handler(void *baton,
+                       const char *path,
+                       svn_revnum_t revnum,
+                       apr_hash_t *rev_props,
+                       svn_boolean_t result_of_merge,
+                       svn_txdelta_window_handler_t *delta_handler,
+                       void **delta_baton,
+                       apr_array_header_t *prop_diffs,
+                       apr_pool_t *pool)
+{
+  blame_baton_t *bb = baton;
+  blame_location_t *location;
+  svn_stream_t *source;
+  svn_stream_t *target;
+
+  location = apr_palloc(bb->mainpool, sizeof(*location));
+  location->path = apr_pstrdup(bb->mainpool, path);
+  location->revision = revnum;
+  APR_ARRAY_PUSH(bb->versions, blame_location_t *) = location;
+
+  /* DELTA_HANDLER is only given if the contents changed.  Property-only
+     changes don't affect the blame. */
+  if (!delta_handler)
+    return SVN_NO_ERROR;
+
+  svn_pool_clear(bb->currpool);
+  if (bb->last_filename)
+    SVN_ERR(svn_stream_open_readonly(&source, bb->last_filename,
+                                     bb->currpool, pool));
+  else
+    source = svn_stream_empty(bb->currpool);
+
+  SVN_ERR(svn_stream_open_unique(&target, &bb->filename, NULL,
+                                 svn_io_file_del_on_pool_cleanup,
+                                 bb->currpool, pool));
+  bb->version = bb->versions->nelts - 1;
+
+  svn_txdelta_apply2(source, target, NULL, path, bb->currpool,
+                     &bb->apply_handler, &bb->apply_baton);
+  *delta_handler = blame_window_handler;
+  *delta_baton = bb;
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton for blame_authz_func(). */
+typedef struct blame_authz_baton_t
+{
+  /* The actual authz callback and its baton. */
+  svn_repos_authz_func_t authz_read_func;
+  void *authz_read_baton;
+
+  /* Set once AUTHZ_READ_FUNC denied access. */
+  svn_boolean_t denied;
+} blame_authz_baton_t;
+
+/* Implements svn_repos_authz_func_t.  Forward to the callback given in
+ * the blame_authz_baton_t BATON and remember whether it denied access. */
+static svn_error_t *
+blame_authz_func(svn_boolean_t *allowed,
+                 svn_fs_root_t *root,
+                 const char *path,
+                 void *baton,
+                 apr_pool_t *pool)
+{
+  blame_authz_baton_t *ab = baton;
+
+  SVN_ERR(ab->authz_read_func(allowed, root, path, ab->authz_read_baton,
+                              pool));
+  if (!*allowed)
+    ab->denied = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *RESULT to the blame of PATH from START to END in REPOS, comparing
+ * versions with DIFF.  Set *COMPLETE to FALSE if AUTHZ_READ_FUNC with
+ * AUTHZ_READ_BATON cut the history of PATH short and to TRUE otherwise.
+ * Allocate *RESULT in RESULT_POOL.
+ */
+static svn_error_t *
+compute_blame(blame_result_t **result,
+              svn_boolean_t *complete,
+              svn_repos_t *repos,
+              const char *path,
+              svn_revnum_t start,
+              svn_revnum_t end,
+              const svn_repos__blame_diff_t *diff,
+              svn_repos_authz_func_t authz_read_func,
+              void *authz_read_baton,
+              apr_pool_t *result_pool,
+              apr_pool_t *scratch_pool)
+{
+  blame_baton_t bb;
+  blame_authz_baton_t ab;
+  apr_array_header_t *chunks;
+  int i;
+
+  bb.diff = diff;
+  bb.versions = apr_array_make(scratch_pool, 16,
+                               sizeof(blame_location_t *));
+  bb.last_filename = NULL;
+  bb.mainpool = scratch_pool;
+  bb.lastpool = svn_pool_create(scratch_pool);
+  bb.currpool = svn_pool_create(scratch_pool);
+
+  ab.authz_read_func = authz_read_func;
+  ab.authz_read_baton = authz_read_baton;
+  ab.denied = FALSE;
+
+  /* Include the last revision before START, if any, so that we know
+     what was actually changed in START. */
+  SVN_ERR(svn_repos_get_file_revs2(repos, path, MAX(0, start - 1), end,
+                                   FALSE,
+                                   authz_read_func ? blame_authz_func : NULL,
+                                   &ab,
+                                   blame_file_rev_handler, &bb,
+                                   scratch_pool));
+  SVN_ERR(diff->get_chunks(&chunks, diff->baton, scratch_pool));
+
+  *result = apr_pcalloc(result_pool, sizeof(**result));
+  (*result)->versions_count = bb.versions->nelts;
+  (*result)->versions = apr_palloc(result_pool,
+                                   bb.versions->nelts
+                                     * sizeof(*(*result)->versions));
+  for (i = 0; i < bb.versions->nelts; ++i)
+    {
+      const blame_location_t *location
+        = APR_ARRAY_IDX(bb.versions, i, const blame_location_t *);
+
+      (*result)->versions[i].path = apr_pstrdup(result_pool,
+                                                location->path);
+      (*result)->versions[i].revision = location->revision;
+    }
+
+  (*result)->chunks_count = chunks->nelts;
+  (*result)->chunks = apr_pmemdup(result_pool, chunks->elts,
+                                  chunks->nelts * chunks->elt_size);
+  *complete = !ab.denied;
+
+  svn_pool_destroy(bb.lastpool);
+  svn_pool_destroy(bb.currpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *READABLE to FALSE if AUTHZ_READ_FUNC with AUTHZ_READ_BATON denies
+ * read access to any of the versions in RESULT and to TRUE otherwise.
+ * Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+check_versions_readable(svn_boolean_t *readable,
+                        const blame_result_t *result,
+                        svn_fs_t *fs,
+                        svn_repos_authz_func_t authz_read_func,
+                        void *authz_read_baton,
+                        apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
+
+  *readable = TRUE;
+  for (i = result->versions_count - 1; i >= 0 && *readable; --i)
+    {
+      svn_fs_root_t *root;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_revision_root(&root, fs, result->versions[i].revision,
+                                   iterpool));
+      SVN_ERR(authz_read_func(readable, root, result->versions[i].path,
+                              authz_read_baton, iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos__get_file_blame(svn_repos_t *repos,
+                          const char *path,
+                          svn_revnum_t start,
+                          svn_revnum_t end,
+                          const svn_repos__blame_diff_t *diff,
+                          svn_repos_authz_func_t authz_read_func,
+                          void *authz_read_baton,
+                          svn_repos__blame_rev_func_t rev_func,
+                          svn_repos__blame_chunk_func_t chunk_func,
+                          void *baton,
+                          apr_pool_t *scratch_pool)
+{
+  blame_result_t *result = NULL;
+  svn_cache__t *cache;
+  const char *cache_key = NULL;
+  apr_pool_t *iterpool;
+  int i;
+
+  if (!SVN_IS_VALID_REVNUM(start) || !SVN_IS_VALID_REVNUM(end)
+      || start > end)
+    return svn_error_createf(SVN_ERR_INCORRECT_PARAMS, NULL,
+                             _("Invalid revision range r%ld:%ld for "
+                               "blaming '%s'"),
+                             start, end, path);
+
+  SVN_ERR(get_blame_cache(&cache, repos, scratch_pool));
+  if (cache)
+    {
+      svn_fs_root_t *root;
+      svn_boolean_t found;
+
+      SVN_ERR(svn_fs_revision_root(&root, repos->fs, end, scratch_pool));
+      SVN_ERR(blame_cache_key(&cache_key, root, path, start,
+                              diff->options_key, scratch_pool,
+                              scratch_pool));
+      SVN_ERR(svn_cache__get((void **)&result, &found, cache, cache_key,
+                             scratch_pool));
+
+      /* The cached result is only valid if authz would not have stopped
+         the history walk at any of its versions. */
+      if (found && authz_read_func)
+        {
+          svn_boolean_t readable;
+
+          SVN_ERR(check_versions_readable(&readable, result, repos->fs,
+                                          authz_read_func, authz_read_baton,
+                                          scratch_pool));
+          if (!readable)
+            result = NULL;
+        }
+    }
+
+  if (!result)
+    {
+      svn_boolean_t complete;
+
+      SVN_ERR(compute_blame(&result, &complete, repos, path, start, end,
+                            diff, authz_read_func, authz_read_baton,
+                            scratch_pool, scratch_pool));
+
+      /* Never cache a history that authz restrictions cut short. */
+      if (cache && complete)
+        SVN_ERR(svn_cache__set(cache, cache_key, result, scratch_pool));
+    }
+
+  /* Report the versions visited with their current revision properties,
+     then the blame for the latest version. */
+  SVN_ERR(svn_fs_refresh_revision_props(repos->fs, scratch_pool));
+
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < result->versions_count; ++i)
+    {
+      apr_hash_t *rev_props;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_repos_fs_revision_proplist(&rev_props, repos,
+                                             result->versions[i].revision,
+                                             authz_read_func,
+                                             authz_read_baton, iterpool));
+      SVN_ERR(rev_func(baton, result->versions[i].path,
+                       result->versions[i].revision, rev_props, iterpool));
+    }
+
+  for (i = 0; i < result->chunks_count; ++i)
+    {
+      const svn_repos__blame_chunk_t *chunk = &result->chunks[i];
+      svn_revnum_t revision = result->versions[chunk->version].revision;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(chunk_func(baton, chunk->line_start,
+                         revision >= start ? revision : SVN_INVALID_REVNUM,
+                         iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
@@ -45,6 +45,7 @@
 #include "private/svn_utf_private.h"
 #include "private/svn_cache.h"
 #include "private/svn_fspath.h"
+#include "private/svn_task.h"
 
 #define ARE_VALID_COPY_ARGS(p,r) ((p) && SVN_IS_VALID_REVNUM(r))
 
@@ -2021,37 +2022,16 @@ dump_filter_authz_func(svn_boolean_t *allowed,
 
 
 
-/* The main dumper. */
-svn_error_t *
-svn_repos_dump_fs4(svn_repos_t *repos,
-                   svn_stream_t *stream,
-                   svn_revnum_t start_rev,
-                   svn_revnum_t end_rev,
-                   svn_boolean_t incremental,
-                   svn_boolean_t use_deltas,
-                   svn_boolean_t include_revprops,
-                   svn_boolean_t include_changes,
-                   svn_repos_notify_func_t notify_func,
-                   void *notify_baton,
-                   svn_repos_dump_filter_func_t filter_func,
-                   void *filter_baton,
-                   svn_cancel_func_t cancel_func,
-                   void *cancel_baton,
+/* Make sure we catch up on the latest revprop changes in FS.  Replace
+   invalid *START_REV and *END_REV with the defaults, i.e. 0 and HEAD,
+   and validate the resulting range.  Use POOL for temporaries. */
+static svn_error_t *
+prepare_dump_range(svn_revnum_t *start_rev,
+                   svn_revnum_t *end_rev,
+                   svn_fs_t *fs,
                    apr_pool_t *pool)
 {
-  const svn_delta_editor_t *dump_editor;
-  void *dump_edit_baton = NULL;
-  svn_revnum_t rev;
-  svn_fs_t *fs = svn_repos_fs(repos);
-  apr_pool_t *iterpool = svn_pool_create(pool);
   svn_revnum_t youngest;
-  const char *uuid;
-  int version;
-  svn_boolean_t found_old_reference = FALSE;
-  svn_boolean_t found_old_mergeinfo = FALSE;
-  svn_repos_notify_t *notify;
-  svn_repos_authz_func_t authz_func;
-  dump_filter_baton_t authz_baton = {0};
 
   /* Make sure we catch up on the latest revprop changes.  This is the only
    * time we will refresh the revprop data in this query. */
@@ -2061,38 +2041,38 @@ svn_repos_dump_fs4(svn_repos_t *repos,
   SVN_ERR(svn_fs_youngest_rev(&youngest, fs, pool));
 
   /* Use default vals if necessary. */
-  if (! SVN_IS_VALID_REVNUM(start_rev))
-    start_rev = 0;
-  if (! SVN_IS_VALID_REVNUM(end_rev))
-    end_rev = youngest;
-  if (! stream)
-    stream = svn_stream_empty(pool);
+  if (! SVN_IS_VALID_REVNUM(*start_rev))
+    *start_rev = 0;
+  if (! SVN_IS_VALID_REVNUM(*end_rev))
+    *end_rev = youngest;
 
   /* Validate the revisions. */
-  if (start_rev > end_rev)
+  if (*start_rev > *end_rev)
     return svn_error_createf(SVN_ERR_REPOS_BAD_ARGS, NULL,
                              _("Start revision %ld"
                                " is greater than end revision %ld"),
-                             start_rev, end_rev);
-  if (end_rev > youngest)
+                             *start_rev, *end_rev);
+  if (*end_rev > youngest)
     return svn_error_createf(SVN_ERR_REPOS_BAD_ARGS, NULL,
                              _("End revision %ld is invalid "
                                "(youngest revision is %ld)"),
-                             end_rev, youngest);
+                             *end_rev, youngest);
 
-  /* We use read authz callback to implement dump filtering. If there is no
-   * read access for some node, it will be excluded from dump as well as
-   * references to it (e.g. copy source). */
-  if (filter_func)
-    {
-      authz_func = dump_filter_authz_func;
-      authz_baton.filter_func = filter_func;
-      authz_baton.filter_baton = filter_baton;
-    }
-  else
-    {
-      authz_func = NULL;
-    }
+  return SVN_NO_ERROR;
+}
+
+/* Write the "general" metadata of the dumpfile for FS to STREAM.  That is
+   the magic header with the dumpfile format version (which depends on
+   USE_DELTAS), followed by the repository UUID.  Use POOL for temporaries.
+ */
+static svn_error_t *
+write_dumpfile_header(svn_stream_t *stream,
+                      svn_fs_t *fs,
+                      svn_boolean_t use_deltas,
+                      apr_pool_t *pool)
+{
+  const char *uuid;
+  int version;
 
   /* Write out the UUID. */
   SVN_ERR(svn_fs_get_uuid(fs, &uuid, pool));
@@ -2108,6 +2088,48 @@ svn_repos_dump_fs4(svn_repos_t *repos,
   SVN_ERR(svn_repos__dump_magic_header_record(stream, version, pool));
   SVN_ERR(svn_repos__dump_uuid_header_record(stream, uuid, pool));
 
+  return SVN_NO_ERROR;
+}
+
+/* Write the revision and node records of revisions START_REV through
+   END_REV in REPOS to STREAM.
+
+   OLDEST_DUMPED_REV is the first revision of the whole dump, which may
+   be older than START_REV when dumping only a segment of it.  Unless
+   INCREMENTAL is set, that revision gets dumped as a full tree without
+   deltas.  References to revisions older than OLDEST_DUMPED_REV set
+   *FOUND_OLD_REFERENCE resp. *FOUND_OLD_MERGEINFO.
+
+   AUTHZ_FUNC with AUTHZ_BATON implements path filtering and may be NULL.
+   The other parameters are as for svn_repos_dump_fs4().  Use POOL for
+   temporaries. */
+static svn_error_t *
+dump_revisions(svn_stream_t *stream,
+               svn_repos_t *repos,
+               svn_revnum_t start_rev,
+               svn_revnum_t end_rev,
+               svn_revnum_t oldest_dumped_rev,
+               svn_boolean_t incremental,
+               svn_boolean_t use_deltas,
+               svn_boolean_t include_revprops,
+               svn_boolean_t include_changes,
+               svn_boolean_t *found_old_reference,
+               svn_boolean_t *found_old_mergeinfo,
+               svn_repos_notify_func_t notify_func,
+               void *notify_baton,
+               svn_repos_authz_func_t authz_func,
+               void *authz_baton,
+               svn_cancel_func_t cancel_func,
+               void *cancel_baton,
+               apr_pool_t *pool)
+{
+  const svn_delta_editor_t *dump_editor;
+  void *dump_edit_baton = NULL;
+  svn_revnum_t rev;
+  svn_fs_t *fs = svn_repos_fs(repos);
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_repos_notify_t *notify;
+
   /* Create a notify object that we can reuse in the loop. */
   if (notify_func)
     notify = svn_repos_notify_create(svn_repos_notify_dump_rev_end,
@@ -2127,7 +2149,7 @@ svn_repos_dump_fs4(svn_repos_t *repos,
 
       /* Write the revision record. */
       SVN_ERR(write_revision_record(stream, repos, rev, include_revprops,
-                                    authz_func, &authz_baton, iterpool));
+                                    authz_func, authz_baton, iterpool));
 
       /* When dumping revision 0, we just write out the revision record.
          The parser might want to use its properties.
@@ -2138,13 +2160,14 @@ svn_repos_dump_fs4(svn_repos_t *repos,
       /* Fetch the editor which dumps nodes to a file.  Regardless of
          what we've been told, don't use deltas for the first rev of a
          non-incremental dump. */
-      use_deltas_for_rev = use_deltas && (incremental || rev != start_rev);
+      use_deltas_for_rev = use_deltas
+                        && (incremental || rev != oldest_dumped_rev);
       SVN_ERR(get_dump_editor(&dump_editor, &dump_edit_baton, fs, rev,
-                              "", stream, &found_old_reference,
-                              &found_old_mergeinfo, NULL,
+                              "", stream, found_old_reference,
+                              found_old_mergeinfo, NULL,
                               notify_func, notify_baton,
-                              start_rev, use_deltas_for_rev, FALSE, FALSE,
-                              iterpool));
+                              oldest_dumped_rev, use_deltas_for_rev,
+                              FALSE, FALSE, iterpool));
 
       /* Drive the editor in one way or another. */
       SVN_ERR(svn_fs_revision_root(&to_root, fs, rev, iterpool));
@@ -2152,7 +2175,7 @@ svn_repos_dump_fs4(svn_repos_t *repos,
       /* If this is the first revision of a non-incremental dump,
          we're in for a full tree dump.  Otherwise, we want to simply
          replay the revision.  */
-      if ((rev == start_rev) && (! incremental))
+      if ((rev == oldest_dumped_rev) && (! incremental))
         {
           /* Compare against revision 0, so everything appears to be added. */
           svn_fs_root_t *from_root;
@@ -2160,7 +2183,7 @@ svn_repos_dump_fs4(svn_repos_t *repos,
           SVN_ERR(svn_repos_dir_delta2(from_root, "", "",
                                        to_root, "",
                                        dump_editor, dump_edit_baton,
-                                       authz_func, &authz_baton,
+                                       authz_func, authz_baton,
                                        FALSE, /* don't send text-deltas */
                                        svn_depth_infinity,
                                        FALSE, /* don't send entry props */
@@ -2172,7 +2195,7 @@ svn_repos_dump_fs4(svn_repos_t *repos,
           /* The normal case: compare consecutive revs. */
           SVN_ERR(svn_repos_replay2(to_root, "", SVN_INVALID_REVNUM, FALSE,
                                     dump_editor, dump_edit_baton,
-                                    authz_func, &authz_baton, iterpool));
+                                    authz_func, authz_baton, iterpool));
 
           /* While our editor close_edit implementation is a no-op, we still
              do this for completeness. */
@@ -2187,41 +2210,427 @@ svn_repos_dump_fs4(svn_repos_t *repos,
         }
     }
 
-  if (notify_func)
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Send the svn_repos_notify_dump_end notification to NOTIFY_FUNC with
+   NOTIFY_BATON, followed by the summary warnings for FOUND_OLD_REFERENCE
+   and FOUND_OLD_MERGEINFO.  Use SCRATCH_POOL for temporaries. */
+static void
+notify_dump_end(svn_boolean_t found_old_reference,
+                svn_boolean_t found_old_mergeinfo,
+                svn_repos_notify_func_t notify_func,
+                void *notify_baton,
+                apr_pool_t *scratch_pool)
+{
+  svn_repos_notify_t *notify;
+
+  /* Did we issue any warnings about references to revisions older than
+     the oldest dumped revision?  If so, then issue a final generic
+     warning, since the inline warnings already issued might easily be
+     missed. */
+
+  notify = svn_repos_notify_create(svn_repos_notify_dump_end, scratch_pool);
+  notify_func(notify_baton, notify, scratch_pool);
+
+  if (found_old_reference)
     {
-      /* Did we issue any warnings about references to revisions older than
-         the oldest dumped revision?  If so, then issue a final generic
-         warning, since the inline warnings already issued might easily be
-         missed. */
+      notify_warning(scratch_pool, notify_func, notify_baton,
+                     svn_repos_notify_warning_found_old_reference,
+                     _("The range of revisions dumped "
+                       "contained references to "
+                       "copy sources outside that "
+                       "range."));
+    }
 
-      notify = svn_repos_notify_create(svn_repos_notify_dump_end, iterpool);
-      notify_func(notify_baton, notify, iterpool);
+  /* Ditto if we issued any warnings about old revisions referenced
+     in dumped mergeinfo. */
+  if (found_old_mergeinfo)
+    {
+      notify_warning(scratch_pool, notify_func, notify_baton,
+                     svn_repos_notify_warning_found_old_mergeinfo,
+                     _("The range of revisions dumped "
+                       "contained mergeinfo "
+                       "which reference revisions outside "
+                       "that range."));
+    }
+}
 
-      if (found_old_reference)
-        {
-          notify_warning(iterpool, notify_func, notify_baton,
-                         svn_repos_notify_warning_found_old_reference,
-                         _("The range of revisions dumped "
-                           "contained references to "
-                           "copy sources outside that "
-                           "range."));
-        }
+/* The main dumper. */
+svn_error_t *
+svn_repos_dump_fs4(svn_repos_t *repos,
+                   svn_stream_t *stream,
+                   svn_revnum_t start_rev,
+                   svn_revnum_t end_rev,
+                   svn_boolean_t incremental,
+                   svn_boolean_t use_deltas,
+                   svn_boolean_t include_revprops,
+                   svn_boolean_t include_changes,
+                   svn_repos_notify_func_t notify_func,
+                   void *notify_baton,
+                   svn_repos_dump_filter_func_t filter_func,
+                   void *filter_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *pool)
+{
+  svn_fs_t *fs = svn_repos_fs(repos);
+  svn_boolean_t found_old_reference = FALSE;
+  svn_boolean_t found_old_mergeinfo = FALSE;
+  svn_repos_authz_func_t authz_func;
+  dump_filter_baton_t authz_baton = {0};
 
-      /* Ditto if we issued any warnings about old revisions referenced
-         in dumped mergeinfo. */
-      if (found_old_mergeinfo)
+  SVN_ERR(prepare_dump_range(&start_rev, &end_rev, fs, pool));
+  if (! stream)
+    stream = svn_stream_empty(pool);
+
+  /* We use read authz callback to implement dump filtering. If there is no
+   * read access for some node, it will be excluded from dump as well as
+   * references to it (e.g. copy source). */
+  if (filter_func)
+    {
+      authz_func = dump_filter_authz_func;
+      authz_baton.filter_func = filter_func;
+      authz_baton.filter_baton = filter_baton;
+    }
+  else
+    {
+      authz_func = NULL;
+    }
+
+  SVN_ERR(write_dumpfile_header(stream, fs, use_deltas, pool));
+  SVN_ERR(dump_revisions(stream, repos, start_rev, end_rev, start_rev,
+                         incremental, use_deltas, include_revprops,
+                         include_changes, &found_old_reference,
+                         &found_old_mergeinfo, notify_func, notify_baton,
+                         authz_func, &authz_baton, cancel_func, cancel_baton,
+                         pool));
+
+  if (notify_func)
+    notify_dump_end(found_old_reference, found_old_mergeinfo,
+                    notify_func, notify_baton, pool);
+
+  return SVN_NO_ERROR;
+}
+
+
+/*----------------------------------------------------------------------*/
+
+/* parallel dump */
+
+/* Maximum number of revisions per segment in a parallel dump.  Smaller
+   segments balance the load between the workers better, larger ones
+   reduce the per-segment overhead.  This does not limit the size of a
+   segment, as a single revision may be arbitrarily large. */
+#define DUMP_SEGMENT_MAX_REVS 1000
+
+/* Number of segments per job that a parallel dump processes in one
+   round.  Every segment in a round is buffered in a temporary file until
+   all earlier segments have been written to the output.  The next round
+   only starts after all of them have been written, which bounds the
+   number of open temporary files to this times the number of jobs. */
+#define DUMP_SEGMENTS_PER_JOB 4
+
+/* Parameters of a parallel dump.  They are shared by all worker threads
+   and must not be modified while the dump is running. */
+typedef struct parallel_dump_baton_t
+{
+  /* Where to open the repository and with which FS config. */
+  const char *repos_path;
+  apr_hash_t *fs_config;
+
+  /* Warning handler for the filesystem instances of the workers. */
+  svn_fs_warning_callback_t warning_func;
+  void *warning_baton;
+
+  /* The dump options, as passed to svn_repos__dump_fs_parallel(). */
+  svn_revnum_t start_rev;
+  svn_boolean_t incremental;
+  svn_boolean_t use_deltas;
+  svn_boolean_t include_revprops;
+  svn_boolean_t include_changes;
+
+  /* Dump filtering, may be NULL. */
+  svn_repos_authz_func_t authz_func;
+  dump_filter_baton_t *authz_baton;
+
+  /* Split the revision range into segments of at most that many
+     revisions. */
+  svn_revnum_t segment_size;
+} parallel_dump_baton_t;
+
+/* Process baton of a parallel dump task.  Covers revisions START_REV
+   through END_REV. */
+typedef struct dump_segment_t
+{
+  const parallel_dump_baton_t *params;
+  svn_revnum_t start_rev;
+  svn_revnum_t end_rev;
+} dump_segment_t;
+
+/* The result of a dump_segment_t task. */
+typedef struct dump_segment_result_t
+{
+  /* The dumpfile records of the segment.  The file gets deleted together
+     with the result pool. */
+  apr_file_t *file;
+
+  /* Notifications sent while dumping the segment, in that order.
+     Elements are svn_repos_notify_t *. */
+  apr_array_header_t *notifications;
+
+  svn_boolean_t found_old_reference;
+  svn_boolean_t found_old_mergeinfo;
+} dump_segment_result_t;
+
+/* Output baton of the parallel dump. */
+typedef struct dump_output_baton_t
+{
+  svn_stream_t *stream;
+  svn_repos_notify_func_t notify_func;
+  void *notify_baton;
+  svn_boolean_t found_old_reference;
+  svn_boolean_t found_old_mergeinfo;
+} dump_output_baton_t;
+
+/* Implements svn_repos_notify_func_t.  Append a copy of NOTIFY to the
+   notifications array in BATON, a dump_segment_result_t. */
+static void
+record_notification(void *baton,
+                    const svn_repos_notify_t *notify,
+                    apr_pool_t *scratch_pool)
+{
+  dump_segment_result_t *result = baton;
+  apr_pool_t *pool = result->notifications->pool;
+  svn_repos_notify_t *copy = apr_pmemdup(pool, notify, sizeof(*notify));
+
+  copy->warning_str = apr_pstrdup(pool, notify->warning_str);
+  APR_ARRAY_PUSH(result->notifications, svn_repos_notify_t *) = copy;
+}
+
+/* Implements svn_task__thread_context_constructor_t.  Open a separate
+   svn_repos_t instance for the worker thread as described by
+   CONTEXT_BATON, a parallel_dump_baton_t. */
+static svn_error_t *
+open_dump_repos(void **thread_context,
+                void *context_baton,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  const parallel_dump_baton_t *params = context_baton;
+  svn_repos_t *repos;
+
+  SVN_ERR(svn_repos_open3(&repos, params->repos_path, params->fs_config,
+                          result_pool, scratch_pool));
+  svn_fs_set_warning_func(svn_repos_fs(repos), params->warning_func,
+                          params->warning_baton);
+  *thread_context = repos;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__process_func_t.  If the dump_segment_t in
+   PROCESS_BATON is larger than the segment size, split it into sub-tasks.
+   Otherwise, dump it into a temporary file using the svn_repos_t given by
+   THREAD_CONTEXT. */
+static svn_error_t *
+dump_segment(void **result,
+             svn_task__t *task,
+             void *thread_context,
+             void *process_baton,
+             svn_cancel_func_t cancel_func,
+             void *cancel_baton,
+             apr_pool_t *result_pool,
+             apr_pool_t *scratch_pool)
+{
+  const dump_segment_t *segment = process_baton;
+  const parallel_dump_baton_t *params = segment->params;
+  dump_segment_result_t *segment_result;
+  svn_stream_t *stream;
+  apr_off_t offset = 0;
+
+  if (segment->end_rev - segment->start_rev >= params->segment_size)
+    {
+      svn_revnum_t rev;
+      for (rev = segment->start_rev;
+           rev <= segment->end_rev;
+           rev += params->segment_size)
         {
-          notify_warning(iterpool, notify_func, notify_baton,
-                         svn_repos_notify_warning_found_old_mergeinfo,
-                         _("The range of revisions dumped "
-                           "contained mergeinfo "
-                           "which reference revisions outside "
-                           "that range."));
+          apr_pool_t *sub_task_pool = svn_task__create_process_pool(task);
+          dump_segment_t *sub_segment = apr_palloc(sub_task_pool,
+                                                   sizeof(*sub_segment));
+          sub_segment->params = params;
+          sub_segment->start_rev = rev;
+          sub_segment->end_rev = MIN(segment->end_rev,
+                                     rev + params->segment_size - 1);
+
+          SVN_ERR(svn_task__add_similar(task, sub_task_pool, NULL,
+                                        sub_segment));
         }
+
+      *result = NULL;
+      return SVN_NO_ERROR;
     }
 
+  segment_result = apr_pcalloc(result_pool, sizeof(*segment_result));
+  segment_result->notifications
+    = apr_array_make(result_pool, 0, sizeof(svn_repos_notify_t *));
+  SVN_ERR(svn_io_open_unique_file3(&segment_result->file, NULL, NULL,
+                                   svn_io_file_del_on_pool_cleanup,
+                                   result_pool, scratch_pool));
+
+  /* All segments refer to the start of the whole dump, so that the
+     output is the same as in a serial dump. */
+  stream = svn_stream_from_aprfile2(segment_result->file, TRUE,
+                                    scratch_pool);
+  SVN_ERR(dump_revisions(stream, thread_context,
+                         segment->start_rev, segment->end_rev,
+                         params->start_rev, params->incremental,
+                         params->use_deltas, params->include_revprops,
+                         params->include_changes,
+                         &segment_result->found_old_reference,
+                         &segment_result->found_old_mergeinfo,
+                         record_notification, segment_result,
+                         params->authz_func, params->authz_baton,
+                         cancel_func, cancel_baton, scratch_pool));
+  SVN_ERR(svn_stream_close(stream));
+
+  /* Rewind, so the output function can simply copy the contents. */
+  SVN_ERR(svn_io_file_seek(segment_result->file, APR_SET, &offset,
+                           scratch_pool));
+
+  *result = segment_result;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__output_func_t.  Append the dump_segment_result_t
+   RESULT to the stream in OUTPUT_BATON, a dump_output_baton_t, and
+   replay the notifications recorded for it. */
+static svn_error_t *
+write_segment(svn_task__t *task,
+              void *result,
+              void *output_baton,
+              svn_cancel_func_t cancel_func,
+              void *cancel_baton,
+              apr_pool_t *result_pool,
+              apr_pool_t *scratch_pool)
+{
+  dump_segment_result_t *segment_result = result;
+  dump_output_baton_t *output = output_baton;
+  svn_stream_t *contents;
+  int i;
+
+  contents = svn_stream_from_aprfile2(segment_result->file, TRUE,
+                                      scratch_pool);
+  SVN_ERR(svn_stream_copy3(contents, svn_stream_disown(output->stream,
+                                                       scratch_pool),
+                           cancel_func, cancel_baton, scratch_pool));
+
+  if (output->notify_func)
+    for (i = 0; i < segment_result->notifications->nelts; ++i)
+      output->notify_func(output->notify_baton,
+                          APR_ARRAY_IDX(segment_result->notifications, i,
+                                        svn_repos_notify_t *),
+                          scratch_pool);
+
+  output->found_old_reference |= segment_result->found_old_reference;
+  output->found_old_mergeinfo |= segment_result->found_old_mergeinfo;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos__dump_fs_parallel(svn_repos_t *repos,
+                            apr_hash_t *fs_config,
+                            svn_fs_warning_callback_t warning_func,
+                            void *warning_baton,
+                            svn_stream_t *stream,
+                            svn_revnum_t start_rev,
+                            svn_revnum_t end_rev,
+                            svn_boolean_t incremental,
+                            svn_boolean_t use_deltas,
+                            svn_boolean_t include_revprops,
+                            svn_boolean_t include_changes,
+                            int jobs,
+                            svn_repos_notify_func_t notify_func,
+                            void *notify_baton,
+                            svn_repos_dump_filter_func_t filter_func,
+                            void *filter_baton,
+                            svn_cancel_func_t cancel_func,
+                            void *cancel_baton,
+                            apr_pool_t *pool)
+{
+  svn_fs_t *fs = svn_repos_fs(repos);
+  parallel_dump_baton_t params = { 0 };
+  dump_filter_baton_t authz_baton = { 0 };
+  dump_output_baton_t output = { 0 };
+  dump_segment_t root_segment;
+  svn_revnum_t revisions, round_size, rev;
+  apr_pool_t *iterpool;
+
+  SVN_ERR(prepare_dump_range(&start_rev, &end_rev, fs, pool));
+  if (! stream)
+    stream = svn_stream_empty(pool);
+
+  params.repos_path = svn_repos_path(repos, pool);
+  params.fs_config = fs_config;
+  params.warning_func = warning_func;
+  params.warning_baton = warning_baton;
+  params.start_rev = start_rev;
+  params.incremental = incremental;
+  params.use_deltas = use_deltas;
+  params.include_revprops = include_revprops;
+  params.include_changes = include_changes;
+
+  /* Dump filtering works the same way as in svn_repos_dump_fs4(). */
+  if (filter_func)
+    {
+      authz_baton.filter_func = filter_func;
+      authz_baton.filter_baton = filter_baton;
+      params.authz_func = dump_filter_authz_func;
+      params.authz_baton = &authz_baton;
+    }
+
+  /* Give every job a few segments to balance the load between them. */
+  jobs = MAX(jobs, 1);
+  revisions = end_rev - start_rev + 1;
+  params.segment_size = MAX(1, MIN(DUMP_SEGMENT_MAX_REVS,
+                                   revisions
+                                     / (DUMP_SEGMENTS_PER_JOB * jobs)));
+  round_size = params.segment_size * DUMP_SEGMENTS_PER_JOB * jobs;
+
+  output.stream = stream;
+  output.notify_func = notify_func;
+  output.notify_baton = notify_baton;
+
+  root_segment.params = &params;
+
+  /* Only the first segment starts with the dumpfile header. */
+  SVN_ERR(write_dumpfile_header(stream, fs, use_deltas, pool));
+
+  /* svn_task__run() keeps all results until they can be written in
+     order, so a slow segment would let the temporary files of all later
+     ones pile up.  Dump the range in rounds to keep that bounded. */
+  iterpool = svn_pool_create(pool);
+  for (rev = start_rev; rev <= end_rev; rev += round_size)
+    {
+      svn_pool_clear(iterpool);
+
+      root_segment.start_rev = rev;
+      root_segment.end_rev = MIN(end_rev, rev + round_size - 1);
+      SVN_ERR(svn_task__run(jobs, dump_segment, &root_segment,
+                            write_segment, &output,
+                            open_dump_repos, &params,
+                            cancel_func, cancel_baton, iterpool, iterpool));
+    }
   svn_pool_destroy(iterpool);
 
+  if (notify_func)
+    notify_dump_end(output.found_old_reference, output.found_old_mergeinfo,
+                    notify_func, notify_baton, pool);
+
   return SVN_NO_ERROR;
 }
 
@@ -28,6 +28,7 @@
 #include "svn_compat.h"
 #include "svn_private_config.h"
 #include "svn_hash.h"
+#include "svn_cache_config.h"
 #include "svn_pools.h"
 #include "svn_error.h"
 #include "svn_path.h"
@@ -41,9 +42,14 @@
 #include "private/svn_fspath.h"
 #include "private/svn_fs_private.h"
 #include "private/svn_mergeinfo_private.h"
+#include "private/svn_mutex.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_sorts_private.h"
+#include "private/svn_thread_pool.h"
 #include "private/svn_string_private.h"
+#include "private/svn_cache.h"
+#include "private/svn_temp_serializer.h"
+#include "private/svn_waitable_counter.h"
 
 
 /* This is a mere convenience struct such that we don't need to pass that
@@ -56,6 +62,20 @@ typedef struct log_callbacks_t
   void *revision_receiver_baton;
   svn_repos_authz_func_t authz_read_func;
   void *authz_read_baton;
+
+  /* Memoized per-revision mergeinfo changes.  NULL unless we are
+     including merged revisions. */
+  struct mergeinfo_changes_index_t *mergeinfo_index;
+
+  /* The repository's history cache, see get_history_cache().
+     May be NULL. */
+  svn_cache__t *history_cache;
+
+  /* Filesystem path and config to open further instances of the
+     repository's filesystem for worker threads.  If FS_PATH is NULL,
+     all histories will be traced by the calling thread. */
+  const char *fs_path;
+  apr_hash_t *fs_config;
 } log_callbacks_t;
 
 
@@ -423,12 +443,744 @@ struct path_info
   svn_fs_history_t *hist;
   apr_pool_t *newpool;
   apr_pool_t *oldpool;
+
+  /* If not NULL, worker threads trace the history of this path ahead of
+     time and HIST will be NULL.  See get_prefetched_history(). */
+  struct history_prefetch_t *prefetch;
 };
 
+/* A history step as stored in the history cache. */
+typedef struct history_location_t
+{
+  /* SVN_INVALID_REVNUM if there is no further history. */
+  svn_revnum_t revision;
+
+  /* NULL if there is no further history. */
+  const char *path;
+} history_location_t;
+
+/* Implements svn_cache__serialize_func_t for history_location_t. */
+static svn_error_t *
+serialize_history_location(void **data,
+                           apr_size_t *data_len,
+                           void *in,
+                           apr_pool_t *pool)
+{
+  history_location_t *location = in;
+  svn_temp_serializer__context_t *context;
+  svn_stringbuf_t *serialized;
+
+  context = svn_temp_serializer__init(location, sizeof(*location),
+                                      sizeof(*location) + 64, pool);
+  svn_temp_serializer__add_string(context, &location->path);
+  serialized = svn_temp_serializer__get(context);
+
+  *data = serialized->data;
+  *data_len = serialized->len;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_cache__deserialize_func_t for history_location_t. */
+static svn_error_t *
+deserialize_history_location(void **out,
+                             void *data,
+                             apr_size_t data_len,
+                             apr_pool_t *pool)
+{
+  history_location_t *location = data;
+  svn_temp_deserializer__resolve(location, (void **)&location->path);
+  *out = location;
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *CACHE to the history cache of REPOS, creating it if necessary.
+ * Set it to NULL if there is no membuffer cache to use or if the FS
+ * backend does not provide an instance ID.
+ *
+ * History steps never change once the respective revisions have been
+ * committed and new commits will only add new keys.  So, the cache will
+ * be shared with all other svn_repos_t instances for the same repository
+ * and there is no need to ever invalidate entries.  Like the FSFS caches,
+ * the key prefix contains the FS instance ID such that a repository
+ * re-created at the same path and with the same UUID (e.g. by a dump /
+ * load cycle) will not see the entries of its predecessor.
+ *
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+get_history_cache(svn_cache__t **cache,
+                  svn_repos_t *repos,
+                  apr_pool_t *scratch_pool)
+{
+  svn_membuffer_t *membuffer = svn_cache__get_global_membuffer_cache();
+
+  if (!repos->history_cache && membuffer)
+    {
+      const char *uuid;
+      const char *instance_id;
+      const char *prefix;
+
+      SVN_ERR(svn_fs__get_instance_id(&instance_id, repos->fs,
+                                      scratch_pool));
+      if (!instance_id)
+        {
+          *cache = NULL;
+          return SVN_NO_ERROR;
+        }
+
+      SVN_ERR(svn_fs_get_uuid(repos->fs, &uuid, scratch_pool));
+      prefix = apr_pstrcat(scratch_pool, "repos-history:", uuid, ":",
+                           instance_id, "/", repos->path, ":", SVN_VA_NULL);
+
+      SVN_ERR(svn_cache__create_membuffer_cache(
+                &repos->history_cache, membuffer,
+                serialize_history_location, deserialize_history_location,
+                APR_HASH_KEY_STRING, prefix,
+                SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                FALSE, FALSE, repos->pool, scratch_pool));
+    }
+
+  *cache = repos->history_cache;
+  return SVN_NO_ERROR;
+}
+
+/* Release the history object that INFO keeps open, if any. */
+static void
+close_history(struct path_info *info)
+{
+  if (info->hist)
+    {
+      svn_pool_destroy(info->newpool);
+      svn_pool_destroy(info->oldpool);
+      info->hist = NULL;
+      info->newpool = NULL;
+      info->oldpool = NULL;
+    }
+}
+
+/* If INFO->PATH at INFO->HISTORY_REV is not readable according to the
+ * optional AUTHZ_READ_FUNC with AUTHZ_READ_BATON, set INFO->DONE.
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+check_history_readable(struct path_info *info,
+                       svn_fs_t *fs,
+                       svn_repos_authz_func_t authz_read_func,
+                       void *authz_read_baton,
+                       apr_pool_t *scratch_pool)
+{
+  if (authz_read_func)
+    {
+      svn_fs_root_t *history_root;
+      svn_boolean_t readable;
+      SVN_ERR(svn_fs_revision_root(&history_root, fs,
+                                   info->history_rev,
+                                   scratch_pool));
+      SVN_ERR(authz_read_func(&readable, history_root,
+                              info->path->data,
+                              authz_read_baton,
+                              scratch_pool));
+      if (! readable)
+        info->done = TRUE;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Return the key under which the history step following INFO->PATH at
+ * INFO->HISTORY_REV is stored in the history cache.  STRICT is the same
+ * as for get_history().  Allocate the result in RESULT_POOL.
+ */
+static const char *
+history_cache_key(const struct path_info *info,
+                  svn_boolean_t strict,
+                  apr_pool_t *result_pool)
+{
+  /* The first step starts at the peg revision, which may not be a
+     history location itself.  Only the following steps start at the
+     location reported before. */
+  return apr_psprintf(result_pool, "%c%c%ld:%s",
+                      strict ? 's' : 'c',
+                      info->first_time ? 'f' : 'n',
+                      info->history_rev, info->path->data);
+}
+
+/*** Parallel history tracing.
+ *
+ * Most of the time spent on a log request with many target paths goes
+ * into svn_fs_history_prev2() and the history of any path is independent
+ * from that of all the others.  So, worker threads may trace the
+ * histories ahead of time in batches of HISTORY_BATCH_SIZE locations,
+ * each thread using its own filesystem instance.
+ *
+ * For every path, we keep two batches: the one that the main thread is
+ * currently consuming and the one that a worker fills in the meantime.
+ * The main thread still consumes the locations in history order, does
+ * all authz checks and decides which revisions to report.  The log
+ * output is therefore exactly the same as without worker threads.
+ */
+
+/* Minimum number of log targets for tracing their histories on worker
+   threads. */
+#define PARALLEL_HISTORY_MIN_PATHS 4
+
+/* Maximum number of paths per history_tracer_t whose histories get
+   traced on worker threads.  Like with MAX_OPEN_HISTORIES, the histories
+   of all further paths get traced by the main thread. */
+#define MAX_PREFETCHED_HISTORIES 256
+
+/* Maximum number of history locations that a worker fetches in one go. */
+#define HISTORY_BATCH_SIZE 32
+
+/* Forward declaration. */
+typedef struct history_tracer_t history_tracer_t;
+
+/* A batch of consecutive history locations of a single path. */
+typedef struct history_batch_t
+{
+  /* The location to start from.  If FIRST_TIME is set, this is a log
+     target at its peg revision.  Otherwise, it is the last location
+     found by the previous batch for the same path. */
+  const char *path;
+  svn_revnum_t revision;
+  svn_boolean_t first_time;
+
+  /* The history locations found, as history_location_t elements, and
+     the error we got while tracing them. */
+  apr_array_header_t *locations;
+  svn_error_t *err;
+
+  /* If set, there is no history beyond LOCATIONS. */
+  svn_boolean_t exhausted;
+
+  /* If set, there is no need to trace further history, either because
+     it has been EXHAUSTED or because the last element in LOCATIONS is
+     older than the log range. */
+  svn_boolean_t last;
+
+  /* Private pool for all of the above.  It is used by only one thread
+     at a time. */
+  apr_pool_t *pool;
+
+  /* Set while the batch is handed to or processed by a worker. */
+  svn_boolean_t queued;
+
+  /* Becomes 1 once the batch has been processed. */
+  svn_waitable_counter_t *done;
+
+  /* Shared state of all batches of the log request. */
+  history_tracer_t *tracer;
+} history_batch_t;
+
+/* Look-ahead buffer for the history of a single path. */
+typedef struct history_prefetch_t
+{
+  /* The batch being consumed and the batch being filled. */
+  history_batch_t batches[2];
+
+  /* Index of the batch in BATCHES being consumed. */
+  int current;
+
+  /* Index of the next location in that batch to deliver. */
+  int next;
+} history_prefetch_t;
+
+/* A filesystem instance used by worker threads. */
+typedef struct tracer_fs_t
+{
+  svn_fs_t *fs;
+
+  /* Root pool containing this structure and FS. */
+  apr_pool_t *pool;
+
+  /* Next idle instance. */
+  struct tracer_fs_t *next;
+} tracer_fs_t;
+
+/* State shared by all batches of a log request. */
+struct history_tracer_t
+{
+  /* How to open further instances of the repository's filesystem. */
+  const char *fs_path;
+  apr_hash_t *fs_config;
+
+  /* Options as passed to get_history(). */
+  svn_boolean_t strict;
+  svn_revnum_t start;
+
+  /* Linked list of filesystem instances that are not being used by any
+     worker.  Guarded by MUTEX. */
+  tracer_fs_t *idle_fs;
+  svn_mutex__t *mutex;
+
+  /* All history_prefetch_t * of this log request. */
+  apr_array_header_t *prefetches;
+
+#if APR_HAS_THREADS
+  /* Worker threads to trace the histories. */
+  apr_thread_pool_t *thread_pool;
+#endif
+};
+
+/* Take an idle filesystem instance from TRACER and return it in *FS.
+   Set *FS to NULL if there is none. */
+static svn_error_t *
+pop_idle_fs(tracer_fs_t **fs,
+            history_tracer_t *tracer)
+{
+  *fs = tracer->idle_fs;
+  if (*fs)
+    tracer->idle_fs = (*fs)->next;
+
+  return SVN_NO_ERROR;
+}
+
+/* Return FS to the list of idle filesystem instances in TRACER. */
+static svn_error_t *
+push_idle_fs(history_tracer_t *tracer,
+             tracer_fs_t *fs)
+{
+  fs->next = tracer->idle_fs;
+  tracer->idle_fs = fs;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_fs_warning_callback_t, ignoring the warnings of the
+   filesystem instances used by worker threads.  Like the repository's
+   own instance, they only warn about cache and lock cleanup failures,
+   which don't affect the log output. */
+static void
+ignore_fs_warnings(void *baton,
+                   svn_error_t *err)
+{
+}
+
+/* Set *FS to a filesystem instance for exclusive use by the calling
+   thread.  Reuse an idle instance from TRACER, if available. */
+static svn_error_t *
+acquire_fs(tracer_fs_t **fs,
+           history_tracer_t *tracer)
+{
+  SVN_MUTEX__WITH_LOCK(tracer->mutex, pop_idle_fs(fs, tracer));
+
+  if (! *fs)
+    {
+      /* Each instance gets its own root pool, so that any thread may
+         use it. */
+      apr_pool_t *pool = svn_pool_create(NULL);
+      svn_error_t *err;
+
+      *fs = apr_pcalloc(pool, sizeof(**fs));
+      (*fs)->pool = pool;
+
+      err = svn_fs_open2(&(*fs)->fs, tracer->fs_path, tracer->fs_config,
+                         pool, pool);
+      if (err)
+        {
+          *fs = NULL;
+          svn_pool_destroy(pool);
+          return svn_error_trace(err);
+        }
+
+      /* The default warning handler aborts the process. */
+      svn_fs_set_warning_func((*fs)->fs, ignore_fs_warnings, NULL);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Fill BATCH->LOCATIONS by tracing the history from the start location
+   given in BATCH, using FS. */
+static svn_error_t *
+trace_history_batch(history_batch_t *batch,
+                    svn_fs_t *fs)
+{
+  history_tracer_t *tracer = batch->tracer;
+  apr_pool_t *scratch_pool = svn_pool_create(batch->pool);
+  apr_pool_t *pools[2];
+  svn_fs_root_t *root;
+  svn_fs_history_t *hist;
+  history_location_t *location = NULL;
+  int k = 0;
+
+  /* Every history object requires its predecessor to still be valid.
+     So, alternate between two pools. */
+  pools[0] = svn_pool_create(scratch_pool);
+  pools[1] = svn_pool_create(scratch_pool);
+
+  /* Same logic as in get_history() for a path without open history. */
+  SVN_ERR(svn_fs_revision_root(&root, fs, batch->revision, scratch_pool));
+  SVN_ERR(svn_fs_node_history2(&hist, root, batch->path, pools[k],
+                               pools[k]));
+  SVN_ERR(svn_fs_history_prev2(&hist, hist, ! tracer->strict, pools[k],
+                               pools[k]));
+  if (hist && ! batch->first_time)
+    {
+      k = 1 - k;
+      SVN_ERR(svn_fs_history_prev2(&hist, hist, ! tracer->strict,
+                                   pools[k], pools[k]));
+    }
+
+  while (hist)
+    {
+      const char *path;
+
+      location = apr_array_push(batch->locations);
+      SVN_ERR(svn_fs_history_location(&path, &location->revision, hist,
+                                      pools[k]));
+      location->path = apr_pstrdup(batch->pool, path);
+
+      /* The caller will stop at this location or continue with the
+         next batch. */
+      if (   location->revision < tracer->start
+          || batch->locations->nelts == HISTORY_BATCH_SIZE)
+        break;
+
+      k = 1 - k;
+      svn_pool_clear(pools[k]);
+      SVN_ERR(svn_fs_history_prev2(&hist, hist, ! tracer->strict,
+                                   pools[k], pools[k]));
+    }
+
+  batch->exhausted = (hist == NULL);
+  batch->last = batch->exhausted || location->revision < tracer->start;
+
+  svn_pool_destroy(scratch_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Return FS, acquired by acquire_fs(), to TRACER. */
+static svn_error_t *
+release_fs(history_tracer_t *tracer,
+           tracer_fs_t *fs)
+{
+  SVN_MUTEX__WITH_LOCK(tracer->mutex, push_idle_fs(tracer, fs));
+
+  return SVN_NO_ERROR;
+}
+
+/* Process BATCH, i.e. trace its history and notify the waiting reader.
+   This is the only function to be run by worker threads. */
+static void
+process_history_batch(history_batch_t *batch)
+{
+  history_tracer_t *tracer = batch->tracer;
+  tracer_fs_t *fs;
+
+  batch->err = acquire_fs(&fs, tracer);
+  if (! batch->err)
+    batch->err = svn_error_compose_create(trace_history_batch(batch,
+                                                              fs->fs),
+                                          release_fs(tracer, fs));
+
+  /* As soon as the increment call returns, BATCH may be reused by the
+     reader.  There is no way to report an error from here; the reader
+     would rather hang when waiting for BATCH. */
+  svn_error_clear(svn_waitable_counter__increment(batch->done));
+}
+
+#if APR_HAS_THREADS
+
+/* Thread-pool task processing the history_batch_t given by DATA. */
+static void * APR_THREAD_FUNC
+history_batch_task(apr_thread_t *tid,
+                   void *data)
+{
+  process_history_batch(data);
+  return NULL;
+}
+
+#endif
+
+/* Wait for all batches of the history_tracer_t given by DATA to finish
+   and release their pools as well as all filesystem instances.  Must be
+   run as a pre-cleanup hook of the pool that contains DATA. */
+static apr_status_t
+history_tracer_pre_cleanup(void *data)
+{
+  history_tracer_t *tracer = data;
+  int i, k;
+
+  for (i = 0; i < tracer->prefetches->nelts; ++i)
+    {
+      history_prefetch_t *prefetch
+        = APR_ARRAY_IDX(tracer->prefetches, i, history_prefetch_t *);
+
+      for (k = 0; k < 2; ++k)
+        {
+          history_batch_t *batch = &prefetch->batches[k];
+          if (batch->queued)
+            svn_error_clear(svn_waitable_counter__wait_for(batch->done, 1));
+
+          svn_error_clear(batch->err);
+          svn_pool_destroy(batch->pool);
+        }
+    }
+
+  /* No worker is running anymore, so all instances are idle. */
+  while (tracer->idle_fs)
+    {
+      tracer_fs_t *fs = tracer->idle_fs;
+      tracer->idle_fs = fs->next;
+      svn_pool_destroy(fs->pool);
+    }
+
+  return APR_SUCCESS;
+}
+
+/* Set *TRACER to a new history tracer for a log request with the
+   filesystem at FS_PATH, to be opened with FS_CONFIG.  STRICT and
+   START are the same as for get_history().  Set *TRACER to NULL if
+   there is no threading support.  Allocate the result in RESULT_POOL.
+
+   Worker threads may use the tracer until RESULT_POOL gets cleaned up. */
+static svn_error_t *
+create_history_tracer(history_tracer_t **tracer,
+                      const char *fs_path,
+                      apr_hash_t *fs_config,
+                      svn_boolean_t strict,
+                      svn_revnum_t start,
+                      apr_pool_t *result_pool)
+{
+  *tracer = NULL;
+
+#if APR_HAS_THREADS
+  {
+    apr_thread_pool_t *thread_pool;
+
+    /* Not being able to start threads is not fatal.  We simply trace all
+       histories in this thread then. */
+    svn_error_t *err = svn_thread_pool__get(&thread_pool, result_pool);
+    if (err)
+      {
+        svn_error_clear(err);
+        return SVN_NO_ERROR;
+      }
+
+    *tracer = apr_pcalloc(result_pool, sizeof(**tracer));
+    (*tracer)->thread_pool = thread_pool;
+  }
+#else
+  return SVN_NO_ERROR;
+#endif
+
+  /* Worker instances must not use FSFS read-ahead.  It would push more
+     tasks to the same thread pool and block on them, which deadlocks
+     once all threads are tracing histories. */
+  if (fs_config && svn_hash_gets(fs_config, SVN_FS_CONFIG_FSFS_READ_AHEAD))
+    {
+      fs_config = apr_hash_copy(result_pool, fs_config);
+      svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_READ_AHEAD, NULL);
+    }
+
+  (*tracer)->fs_path = fs_path;
+  (*tracer)->fs_config = fs_config;
+  (*tracer)->strict = strict;
+  (*tracer)->start = start;
+  (*tracer)->idle_fs = NULL;
+  (*tracer)->prefetches = apr_array_make(result_pool, 16,
+                                         sizeof(history_prefetch_t *));
+  SVN_ERR(svn_mutex__init(&(*tracer)->mutex, TRUE, result_pool));
+
+  /* Workers must be done before the batch counters and the mutex get
+     cleaned up. */
+  apr_pool_pre_cleanup_register(result_pool, *tracer,
+                                history_tracer_pre_cleanup);
+
+  return SVN_NO_ERROR;
+}
+
+/* Reset BATCH and hand it to a worker thread to trace the history
+   starting at PATH in REVISION.  FIRST_TIME has the same meaning as
+   in struct path_info. */
+static svn_error_t *
+queue_history_batch(history_batch_t *batch,
+                    const char *path,
+                    svn_revnum_t revision,
+                    svn_boolean_t first_time)
+{
+  batch->queued = FALSE;
+  svn_pool_clear(batch->pool);
+
+  batch->path = apr_pstrdup(batch->pool, path);
+  batch->revision = revision;
+  batch->first_time = first_time;
+  batch->locations = apr_array_make(batch->pool, HISTORY_BATCH_SIZE,
+                                    sizeof(history_location_t));
+  batch->err = SVN_NO_ERROR;
+  batch->exhausted = FALSE;
+  batch->last = FALSE;
+
+  SVN_ERR(svn_waitable_counter__reset(batch->done));
+
+#if APR_HAS_THREADS
+  {
+    apr_status_t status = apr_thread_pool_push(batch->tracer->thread_pool,
+                                               history_batch_task,
+                                               batch, 0, NULL);
+    if (status)
+      return svn_error_wrap_apr(status, _("Can't push task"));
+  }
+#else
+  process_history_batch(batch);
+#endif
+
+  batch->queued = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+/* Wait for BATCH to be processed and return the error it encountered,
+   if any. */
+static svn_error_t *
+wait_for_history_batch(history_batch_t *batch)
+{
+  svn_error_t *err;
+
+  SVN_ERR(svn_waitable_counter__wait_for(batch->done, 1));
+  err = batch->err;
+  batch->err = SVN_NO_ERROR;
+
+  return svn_error_trace(err);
+}
+
+/* Let worker threads of TRACER trace the history of INFO->PATH starting
+   at INFO->HISTORY_REV.  Allocate the look-ahead buffer in RESULT_POOL. */
+static svn_error_t *
+start_prefetch(struct path_info *info,
+               history_tracer_t *tracer,
+               apr_pool_t *result_pool)
+{
+  history_prefetch_t *prefetch = apr_pcalloc(result_pool, sizeof(*prefetch));
+  int i;
+
+  for (i = 0; i < 2; ++i)
+    {
+      history_batch_t *batch = &prefetch->batches[i];
+      SVN_ERR(svn_waitable_counter__create(&batch->done, result_pool));
+      batch->tracer = tracer;
+    }
+
+  /* To be able to process each batch in a separate thread, they must use
+   * separate, thread-safe pools.  Allocating a root pool achieves
+   * exactly that. */
+  for (i = 0; i < 2; ++i)
+    prefetch->batches[i].pool = svn_pool_create(NULL);
+
+  APR_ARRAY_PUSH(tracer->prefetches, history_prefetch_t *) = prefetch;
+  info->prefetch = prefetch;
+
+  return svn_error_trace(queue_history_batch(&prefetch->batches[0],
+                                             info->path->data,
+                                             info->history_rev, TRUE));
+}
+
+/* Set *LOCATION to the next history location traced for PREFETCH or to
+   NULL if there is no further history. */
+static svn_error_t *
+next_prefetched_location(const history_location_t **location,
+                         history_prefetch_t *prefetch)
+{
+  history_batch_t *batch = &prefetch->batches[prefetch->current];
+  SVN_ERR(wait_for_history_batch(batch));
+
+  if (prefetch->next == batch->locations->nelts)
+    {
+      if (batch->last)
+        {
+          *location = NULL;
+          return SVN_NO_ERROR;
+        }
+
+      /* Switch to the batch that has been filled in the meantime. */
+      prefetch->current = 1 - prefetch->current;
+      prefetch->next = 0;
+
+      batch = &prefetch->batches[prefetch->current];
+      SVN_ERR(wait_for_history_batch(batch));
+
+      if (batch->locations->nelts == 0)
+        {
+          *location = NULL;
+          return SVN_NO_ERROR;
+        }
+    }
+
+  /* Keep the worker busy while we consume the current batch. */
+  if (prefetch->next == 0 && ! batch->last)
+    {
+      const history_location_t *last
+        = &APR_ARRAY_IDX(batch->locations, batch->locations->nelts - 1,
+                         history_location_t);
+      SVN_ERR(queue_history_batch(&prefetch->batches[1 - prefetch->current],
+                                  last->path, last->revision, FALSE));
+    }
+
+  *location = &APR_ARRAY_IDX(batch->locations, prefetch->next,
+                             history_location_t);
+  prefetch->next++;
+
+  return SVN_NO_ERROR;
+}
+
+/* Like get_history() but for INFO->PREFETCH being set. */
+static svn_error_t *
+get_prefetched_history(struct path_info *info,
+                       svn_fs_t *fs,
+                       svn_cache__t *history_cache,
+                       svn_boolean_t strict,
+                       svn_repos_authz_func_t authz_read_func,
+                       void *authz_read_baton,
+                       svn_revnum_t start,
+                       apr_pool_t *scratch_pool)
+{
+  const history_location_t *location;
+
+  SVN_ERR(next_prefetched_location(&location, info->prefetch));
+
+  /* Let future requests benefit from the work done by the workers. */
+  if (history_cache)
+    {
+      history_location_t end_of_history;
+      end_of_history.revision = SVN_INVALID_REVNUM;
+      end_of_history.path = NULL;
+
+      SVN_ERR(svn_cache__set(history_cache,
+                             history_cache_key(info, strict, scratch_pool),
+                             location ? (void *)location : &end_of_history,
+                             scratch_pool));
+    }
+
+  info->first_time = FALSE;
+
+  /* If this history item predates our START revision then
+     don't fetch any more for this path. */
+  if (! location || location->revision < start)
+    {
+      info->done = TRUE;
+      return SVN_NO_ERROR;
+    }
+
+  svn_stringbuf_set(info->path, location->path);
+  info->history_rev = location->revision;
+
+  /* Is the history item readable?  If not, done with path. */
+  return svn_error_trace(check_history_readable(info, fs, authz_read_func,
+                                                authz_read_baton,
+                                                scratch_pool));
+}
+
 /* Advance to the next history for the path.
  *
- * If INFO->HIST is not NULL we do this using that existing history object,
- * otherwise we open a new one.
+ * If INFO->PREFETCH is set, take the next step from there.  Otherwise,
+ * if HISTORY_CACHE is not NULL and contains the next step, use that.
+ * Otherwise, if INFO->HIST is not NULL we do this using that existing
+ * history object, otherwise we open a new one.  Add the result to
+ * HISTORY_CACHE.
  *
  * If no more history is available or the history revision is less
  * (earlier) than START, or the history is not available due
@@ -444,6 +1196,7 @@ struct path_info
 static svn_error_t *
 get_history(struct path_info *info,
             svn_fs_t *fs,
+            svn_cache__t *history_cache,
             svn_boolean_t strict,
             svn_repos_authz_func_t authz_read_func,
             void *authz_read_baton,
@@ -455,6 +1208,44 @@ get_history(struct path_info *info,
   svn_fs_history_t *hist;
   apr_pool_t *subpool;
   const char *path;
+  const char *cache_key = NULL;
+  history_location_t location;
+
+  if (info->prefetch)
+    return svn_error_trace(get_prefetched_history(info, fs, history_cache,
+                                                  strict, authz_read_func,
+                                                  authz_read_baton, start,
+                                                  scratch_pool));
+
+  if (history_cache)
+    {
+      history_location_t *cached;
+      svn_boolean_t found;
+
+      cache_key = history_cache_key(info, strict, scratch_pool);
+      SVN_ERR(svn_cache__get((void **)&cached, &found, history_cache,
+                             cache_key, scratch_pool));
+      if (found)
+        {
+          /* The open history object, if any, is now behind. */
+          close_history(info);
+          info->first_time = FALSE;
+
+          if (! cached->path || cached->revision < start)
+            {
+              info->done = TRUE;
+              return SVN_NO_ERROR;
+            }
+
+          svn_stringbuf_set(info->path, cached->path);
+          info->history_rev = cached->revision;
+
+          return svn_error_trace(check_history_readable(info, fs,
+                                                        authz_read_func,
+                                                        authz_read_baton,
+                                                        scratch_pool));
+        }
+    }
 
   if (info->hist)
     {
@@ -488,6 +1279,14 @@ get_history(struct path_info *info,
 
   if (! hist)
     {
+      if (history_cache)
+        {
+          location.revision = SVN_INVALID_REVNUM;
+          location.path = NULL;
+          SVN_ERR(svn_cache__set(history_cache, cache_key, &location,
+                                 scratch_pool));
+        }
+
       svn_pool_destroy(subpool);
       if (info->oldpool)
         svn_pool_destroy(info->oldpool);
@@ -501,6 +1300,14 @@ get_history(struct path_info *info,
 
   svn_stringbuf_set(info->path, path);
 
+  if (history_cache)
+    {
+      location.revision = info->history_rev;
+      location.path = path;
+      SVN_ERR(svn_cache__set(history_cache, cache_key, &location,
+                             scratch_pool));
+    }
+
   /* If this history item predates our START revision then
      don't fetch any more for this path. */
   if (info->history_rev < start)
@@ -513,19 +1320,8 @@ get_history(struct path_info *info,
     }
 
   /* Is the history item readable?  If not, done with path. */
-  if (authz_read_func)
-    {
-      svn_boolean_t readable;
-      SVN_ERR(svn_fs_revision_root(&history_root, fs,
-                                   info->history_rev,
-                                   scratch_pool));
-      SVN_ERR(authz_read_func(&readable, history_root,
-                              info->path->data,
-                              authz_read_baton,
-                              scratch_pool));
-      if (! readable)
-        info->done = TRUE;
-    }
+  SVN_ERR(check_history_readable(info, fs, authz_read_func,
+                                 authz_read_baton, scratch_pool));
 
   if (! info->hist)
     {
@@ -555,6 +1351,7 @@ static svn_error_t *
 check_history(svn_boolean_t *changed,
               struct path_info *info,
               svn_fs_t *fs,
+              svn_cache__t *history_cache,
               svn_revnum_t current,
               svn_boolean_t strict,
               svn_repos_authz_func_t authz_read_func,
@@ -579,7 +1376,7 @@ check_history(svn_boolean_t *changed,
      then set *CHANGED to true and get the next history
      rev where this path was changed. */
   *changed = TRUE;
-  return get_history(info, fs, strict, authz_read_func,
+  return get_history(info, fs, history_cache, strict, authz_read_func,
                      authz_read_baton, start, result_pool, scratch_pool);
 }
 
@@ -869,12 +1666,123 @@ fs_mergeinfo_changed(svn_mergeinfo_catalog_t *deleted_mergeinfo_catalog,
 }
 
 
+/* The mergeinfo changes of a single revision as reported by
+   fs_mergeinfo_changed(). */
+typedef struct mergeinfo_changes_t
+{
+  svn_mergeinfo_catalog_t deleted;
+  svn_mergeinfo_catalog_t added;
+} mergeinfo_changes_t;
+
+/* Index of the mergeinfo changes per revision, populated on demand.
+
+   When including merged revisions, the same revisions get visited many
+   times: once along the natural history of the log targets and again for
+   every merge source history that overlaps them.  The changes in a given
+   revision do not depend on the paths we are interested in, so there is
+   no point in re-reading and re-parsing the svn:mergeinfo properties
+   each time. */
+typedef struct mergeinfo_changes_index_t
+{
+  /* Revisions known to not contain any mergeinfo changes.  That is the
+     vast majority, so don't waste a hash entry on each of them. */
+  svn_bit_array__t *unchanged;
+
+  /* svn_revnum_t -> mergeinfo_changes_t *, for all other revisions
+     that we have processed so far. */
+  apr_hash_t *changes;
+
+  /* Pool to allocate the index and all cached data in. */
+  apr_pool_t *pool;
+} mergeinfo_changes_index_t;
+
+/* Return a new, empty mergeinfo change index allocated in RESULT_POOL.
+   We expect revisions up to YOUNGEST. */
+static mergeinfo_changes_index_t *
+mergeinfo_changes_index_create(svn_revnum_t youngest,
+                               apr_pool_t *result_pool)
+{
+  mergeinfo_changes_index_t *index = apr_pcalloc(result_pool,
+                                                 sizeof(*index));
+  index->unchanged = svn_bit_array__create(youngest, result_pool);
+  index->changes = svn_hash__make(result_pool);
+  index->pool = result_pool;
+
+  return index;
+}
+
+/* Like fs_mergeinfo_changed but return cached data from INDEX, if
+   available, and add the results to INDEX otherwise.  The catalogs
+   returned are shared and must not be modified by the caller.
+
+   If INDEX is NULL, this simply calls fs_mergeinfo_changed. */
+static svn_error_t *
+get_mergeinfo_changed(svn_mergeinfo_catalog_t *deleted_mergeinfo_catalog,
+                      svn_mergeinfo_catalog_t *added_mergeinfo_catalog,
+                      mergeinfo_changes_index_t *index,
+                      svn_fs_t *fs,
+                      svn_revnum_t rev,
+                      apr_pool_t *result_pool,
+                      apr_pool_t *scratch_pool)
+{
+  mergeinfo_changes_t *changes;
+  svn_revnum_t *key;
+
+  if (!index)
+    return svn_error_trace(fs_mergeinfo_changed(deleted_mergeinfo_catalog,
+                                                added_mergeinfo_catalog,
+                                                fs, rev, result_pool,
+                                                scratch_pool));
+
+  /* Known to be empty? */
+  if (svn_bit_array__get(index->unchanged, rev))
+    {
+      *deleted_mergeinfo_catalog = svn_hash__make(result_pool);
+      *added_mergeinfo_catalog = svn_hash__make(result_pool);
+      return SVN_NO_ERROR;
+    }
+
+  /* Already processed? */
+  changes = apr_hash_get(index->changes, &rev, sizeof(rev));
+  if (changes)
+    {
+      *deleted_mergeinfo_catalog = changes->deleted;
+      *added_mergeinfo_catalog = changes->added;
+      return SVN_NO_ERROR;
+    }
+
+  /* Cache miss.  Errors will not be cached, i.e. we simply try again
+     the next time around. */
+  changes = apr_palloc(index->pool, sizeof(*changes));
+  SVN_ERR(fs_mergeinfo_changed(&changes->deleted, &changes->added,
+                               fs, rev, index->pool, scratch_pool));
+
+  if (   apr_hash_count(changes->deleted) == 0
+      && apr_hash_count(changes->added) == 0)
+    {
+      svn_bit_array__set(index->unchanged, rev, TRUE);
+    }
+  else
+    {
+      key = apr_pmemdup(index->pool, &rev, sizeof(*key));
+      apr_hash_set(index->changes, key, sizeof(*key), changes);
+    }
+
+  *deleted_mergeinfo_catalog = changes->deleted;
+  *added_mergeinfo_catalog = changes->added;
+
+  return SVN_NO_ERROR;
+}
+
+
 /* Determine what (if any) mergeinfo for PATHS was modified in
    revision REV, returning the differences for added mergeinfo in
-   *ADDED_MERGEINFO and deleted mergeinfo in *DELETED_MERGEINFO. */
+   *ADDED_MERGEINFO and deleted mergeinfo in *DELETED_MERGEINFO.
+   Use INDEX to look up the per-revision changes; it may be NULL. */
 static svn_error_t *
 get_combined_mergeinfo_changes(svn_mergeinfo_t *added_mergeinfo,
                                svn_mergeinfo_t *deleted_mergeinfo,
+                               mergeinfo_changes_index_t *index,
                                svn_fs_t *fs,
                                const apr_array_header_t *paths,
                                svn_revnum_t rev,
@@ -901,10 +1809,10 @@ get_combined_mergeinfo_changes(svn_mergeinfo_t *added_mergeinfo,
     return SVN_NO_ERROR;
 
   /* Fetch the mergeinfo changes for REV. */
-  err = fs_mergeinfo_changed(&deleted_mergeinfo_catalog,
-                             &added_mergeinfo_catalog,
-                             fs, rev,
-                             scratch_pool, scratch_pool);
+  err = get_mergeinfo_changed(&deleted_mergeinfo_catalog,
+                              &added_mergeinfo_catalog,
+                              index, fs, rev,
+                              scratch_pool, scratch_pool);
   if (err)
     {
       if (err->apr_err == SVN_ERR_MERGEINFO_PARSE_ERROR)
@@ -1382,12 +2290,19 @@ send_log(svn_revnum_t rev,
 #define MAX_OPEN_HISTORIES 32
 
 /* Get the histories for PATHS, and store them in *HISTORIES.
+   HISTORY_CACHE may be NULL, see get_history().
+
+   If FS_PATH is not NULL and there are enough PATHS, let worker threads
+   trace the histories.  They will open FS_PATH with FS_CONFIG.
 
    If IGNORE_MISSING_LOCATIONS is set, don't treat requests for bogus
    repository locations as fatal -- just ignore them.  */
 static svn_error_t *
 get_path_histories(apr_array_header_t **histories,
                    svn_fs_t *fs,
+                   svn_cache__t *history_cache,
+                   const char *fs_path,
+                   apr_hash_t *fs_config,
                    const apr_array_header_t *paths,
                    svn_revnum_t hist_start,
                    svn_revnum_t hist_end,
@@ -1399,8 +2314,9 @@ get_path_histories(apr_array_header_t **histories,
 {
   svn_fs_root_t *root;
   apr_pool_t *iterpool;
+  history_tracer_t *tracer = NULL;
   svn_error_t *err;
-  int i;
+  int i, k;
 
   /* Create a history object for each path so we can walk through
      them all at the same time until we have all changes or LIMIT
@@ -1415,6 +2331,10 @@ get_path_histories(apr_array_header_t **histories,
 
   SVN_ERR(svn_fs_revision_root(&root, fs, hist_end, pool));
 
+  if (fs_path && paths->nelts >= PARALLEL_HISTORY_MIN_PATHS)
+    SVN_ERR(create_history_tracer(&tracer, fs_path, fs_config,
+                                  strict_node_history, hist_start, pool));
+
   iterpool = svn_pool_create(pool);
   for (i = 0; i < paths->nelts; i++)
     {
@@ -1436,6 +2356,31 @@ get_path_histories(apr_array_header_t **histories,
       info->done = FALSE;
       info->history_rev = hist_end;
       info->first_time = TRUE;
+      info->prefetch = NULL;
+
+      /* Let the workers trace the history unless it has been cached.
+         We get their first result below, after queuing all paths. */
+      if (tracer && i < MAX_PREFETCHED_HISTORIES)
+        {
+          svn_boolean_t cached = FALSE;
+          if (history_cache)
+            SVN_ERR(svn_cache__has_key(&cached, history_cache,
+                                       history_cache_key(info,
+                                                         strict_node_history,
+                                                         iterpool),
+                                       iterpool));
+
+          if (! cached)
+            {
+              info->hist = NULL;
+              info->oldpool = NULL;
+              info->newpool = NULL;
+
+              SVN_ERR(start_prefetch(info, tracer, pool));
+              APR_ARRAY_PUSH(*histories, struct path_info *) = info;
+              continue;
+            }
+        }
 
       if (i < MAX_OPEN_HISTORIES)
         {
@@ -1461,7 +2406,7 @@ get_path_histories(apr_array_header_t **histories,
           info->newpool = NULL;
         }
 
-      err = get_history(info, fs,
+      err = get_history(info, fs, history_cache,
                         strict_node_history,
                         authz_read_func, authz_read_baton,
                         hist_start, pool, iterpool);
@@ -1477,6 +2422,36 @@ get_path_histories(apr_array_header_t **histories,
       SVN_ERR(err);
       APR_ARRAY_PUSH(*histories, struct path_info *) = info;
     }
+
+  /* Get the first step for all prefetched histories. */
+  for (i = 0, k = 0; i < (*histories)->nelts; i++)
+    {
+      struct path_info *info = APR_ARRAY_IDX(*histories, i,
+                                             struct path_info *);
+      svn_pool_clear(iterpool);
+
+      if (info->prefetch)
+        {
+          err = get_history(info, fs, history_cache,
+                            strict_node_history,
+                            authz_read_func, authz_read_baton,
+                            hist_start, pool, iterpool);
+          if (err
+              && ignore_missing_locations
+              && (err->apr_err == SVN_ERR_FS_NOT_FOUND ||
+                  err->apr_err == SVN_ERR_FS_NOT_DIRECTORY ||
+                  err->apr_err == SVN_ERR_FS_NO_SUCH_REVISION))
+            {
+              svn_error_clear(err);
+              continue;
+            }
+          SVN_ERR(err);
+        }
+
+      APR_ARRAY_IDX(*histories, k++, struct path_info *) = info;
+    }
+  (*histories)->nelts = k;
+
   svn_pool_destroy(iterpool);
 
   return SVN_NO_ERROR;
@@ -2006,7 +2981,9 @@ do_logs(svn_fs_t *fs,
      about all the revisions in the range -- only the ones in which
      one of our paths was changed.  So let's go figure out which
      revisions contain real changes to at least one of our paths.  */
-  SVN_ERR(get_path_histories(&histories, fs, paths, hist_start, hist_end,
+  SVN_ERR(get_path_histories(&histories, fs, callbacks->history_cache,
+                             callbacks->fs_path, callbacks->fs_config,
+                             paths, hist_start, hist_end,
                              strict_node_history, ignore_missing_locations,
                              callbacks->authz_read_func,
                              callbacks->authz_read_baton, pool));
@@ -2032,7 +3009,8 @@ do_logs(svn_fs_t *fs,
           svn_pool_clear(iterpool2);
 
           /* Check history for this path in current rev. */
-          SVN_ERR(check_history(&changed, info, fs, current,
+          SVN_ERR(check_history(&changed, info, fs,
+                                callbacks->history_cache, current,
                                 strict_node_history,
                                 callbacks->authz_read_func,
                                 callbacks->authz_read_baton,
@@ -2069,6 +3047,7 @@ do_logs(svn_fs_t *fs,
                 }
               SVN_ERR(get_combined_mergeinfo_changes(&added_mergeinfo,
                                                      &deleted_mergeinfo,
+                                                     callbacks->mergeinfo_index,
                                                      fs, cur_paths,
                                                      current,
                                                      iterpool, iterpool));
@@ -2326,6 +3305,22 @@ svn_repos_get_logs5(svn_repos_t *repos,
   callbacks.revision_receiver_baton = revision_receiver_baton;
   callbacks.authz_read_func = authz_read_func;
   callbacks.authz_read_baton = authz_read_baton;
+  callbacks.mergeinfo_index = NULL;
+  SVN_ERR(get_history_cache(&callbacks.history_cache, repos, scratch_pool));
+
+  /* Worker threads must be enabled explicitly.  Their filesystem
+     instances share the process-wide cache, so that cache must be
+     thread-safe.  Berkeley DB environments should not be opened more
+     than once per process, so we don't trace histories on worker
+     threads for them. */
+  if (   !svn_hash__get_bool(repos->fs_config, SVN_REPOS_CONFIG_PARALLEL_LOG,
+                            FALSE)
+      || svn_cache_config_get()->single_threaded
+      || (repos->fs_type && strcmp(repos->fs_type, SVN_FS_TYPE_BDB) == 0))
+    callbacks.fs_path = NULL;
+  else
+    callbacks.fs_path = svn_fs_path(fs, scratch_pool);
+  callbacks.fs_config = repos->fs_config;
 
   if (revprops)
     {
@@ -2452,6 +3447,9 @@ svn_repos_get_logs5(svn_repos_t *repos,
                                              authz_read_baton,
                                              scratch_pool, subpool));
       svn_pool_destroy(subpool);
+
+      callbacks.mergeinfo_index = mergeinfo_changes_index_create(head,
+                                                                 scratch_pool);
     }
 
   return do_logs(repos->fs, paths, paths_history_mergeinfo, NULL, NULL,
@@ -36,38 +36,60 @@
 
 #include "private/svn_dep_compat.h"
 #include "private/svn_fspath.h"
+#include "private/svn_sorts_private.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_string_private.h"
 
 #define NUM_CACHED_SOURCE_ROOTS 4
 
-/* Theory of operation: we write report operations out to a spill-buffer
-   as we receive them.  When the report is finished, we read the
-   operations back out again, using them to guide the progression of
-   the delta between the source and target revs.
-
-   Spill-buffer content format: we use a simple ad-hoc format to store the
-   report operations.  Each report operation is the concatenation of
-   the following ("+/-" indicates the single character '+' or '-';
-   <length> and <revnum> are written out as decimal strings):
-
-     +/-                      '-' marks the end of the report
-     If previous is +:
-       <length>:<bytes>       Length-counted path string
-       +/-                    '+' indicates the presence of link_path
-       If previous is +:
-         <length>:<bytes>     Length-counted link_path string
-       +/-                    '+' indicates presence of revnum
-       If previous is +:
-         <revnum>:            Revnum of set_path or link_path
-       +/-                    '+' indicates depth other than svn_depth_infinity
-       If previous is +:
-         <depth>:             "X","E","F","M" =>
-                                 svn_depth_{exclude,empty,files,immediates}
-       +/-                    '+' indicates start_empty field set
-       +/-                    '+' indicates presence of lock_token field.
-       If previous is +:
-         <length>:<bytes>     Length-counted lock_token string
+/* Every RESTART_INTERVAL-th record in the report store holds a full path.
+   See below. */
+#define RESTART_INTERVAL 16
+
+/* Reports of up to this many bytes are kept in memory and get sorted.
+   Beyond that, the report log is spilled to a temp file. */
+#define REPORT_MEMORY_LIMIT (4 * 1024 * 1024)
+
+/* Flags stored in the report records. */
+#define RECORD_HAS_LINK_PATH   0x01
+#define RECORD_HAS_REV         0x02
+#define RECORD_START_EMPTY     0x04
+#define RECORD_HAS_LOCK_TOKEN  0x08
+
+/* Theory of operation: we append report operations to a compact
+   log as we receive them.  When the report is finished, we sort them
+   into depth-first path order and pack them into the report store.
+   We then read the operations back out of the store, using them to
+   guide the progression of the delta between the source and target
+   revs.
+
+   The log is a spill buffer, so its memory usage is bounded by
+   REPORT_MEMORY_LIMIT.  If the report is larger than that, we do not
+   sort it but read the operations back from the log in the order we
+   received them.  Clients send their reports in depth-first order
+   anyway.
+
+   Report content format: each report operation is a record made of
+   the following fields.  Numbers are written with svn__encode_uint().
+
+     <shared>                 Number of leading path bytes shared with
+                              the previous record
+     <length><bytes>\0        Remaining part of the path
+     <flags>                  RECORD_* flags in bits 0 to 3, the depth
+                              minus svn_depth_exclude in bits 4 to 7
+     If RECORD_HAS_REV:
+       <revnum>               Revnum of set_path or link_path
+     If RECORD_HAS_LINK_PATH:
+       <length><bytes>\0      Link path
+     If RECORD_HAS_LOCK_TOKEN:
+       <length><bytes>\0      Lock token
+
+   In the log, <shared> is always 0 and each record is preceded by its
+   length.  In the store, <shared> is 0 only for every RESTART_INTERVAL-th
+   record.  Because the paths are sorted,
+   all operations below a given path form a contiguous range of
+   records, and we can skip over them with a binary search on the full
+   paths at those restart points.
 
    Terminology: for brevity, this file frequently uses the prefixes
    "s_" for source, "t_" for target, and "e_" for editor.  Also, to
@@ -75,9 +97,7 @@
    "anchor and operand", rather than the usual "anchor and target". */
 
 /* Describes the state of a working copy subtree, as given by a
-   report.  Because we keep a lookahead pathinfo, we need to allocate
-   each one of these things in a subpool of the report baton and free
-   it when done. */
+   report. */
 typedef struct path_info_t
 {
   const char *path;            /* path, munged to be anchor-relative */
@@ -86,9 +106,28 @@ typedef struct path_info_t
   svn_depth_t depth;           /* Depth of this path, meaningless for files */
   svn_boolean_t start_empty;   /* Meaningless for delete_path */
   const char *lock_token;      /* NULL if no token */
-  apr_pool_t *pool;            /* Container pool */
 } path_info_t;
 
+/* The finished report: sorted and prefix-compressed report records,
+   or a stream reading the spilled log, together with the current read
+   position. */
+typedef struct report_store_t
+{
+  svn_stringbuf_t *data;          /* all records, NULL if spilled */
+  apr_array_header_t *restarts;   /* apr_size_t offsets of the records
+                                     at restart points within DATA */
+  int count;                      /* total number of records */
+
+  int next;                       /* index of the next record to read */
+  apr_size_t next_offset;         /* offset of that record within DATA */
+
+  svn_stream_t *log_stream;       /* reads the spilled log, or NULL */
+  svn_stringbuf_t *record;        /* the record read last from LOG_STREAM */
+
+  svn_stringbuf_t *path;          /* path of the record read last */
+  path_info_t info;               /* storage for the record read last */
+} report_store_t;
+
 /* Describes the standard revision properties that are relevant for
    reports.  Since a particular revision will often show up more than
    once in the report, we cache these properties for the time of the
@@ -128,11 +167,18 @@ typedef struct report_baton_t
   svn_repos_authz_func_t authz_read_func;
   void *authz_read_baton;
 
-  /* The spill-buffer holding the report. */
-  svn_spillbuf_reader_t *reader;
+  /* The report operations in the order we received them, a buffer to
+     encode one of them and the pool these live in. */
+  svn_spillbuf_t *report_log;
+  svn_stringbuf_t *record_buf;
+  apr_pool_t *log_pool;
+
+  /* The report, once it is finished. */
+  report_store_t store;
 
   /* For the actual editor drive, we'll need a lookahead path info
-     entry, a cache of FS roots, and a pool to store them. */
+     entry, a cache of FS roots, and a pool to store them.  LOOKAHEAD
+     points into STORE or is NULL at the end of the report. */
   path_info_t *lookahead;
   svn_fs_root_t *t_root;
   svn_fs_root_t *s_roots[NUM_CACHED_SOURCE_ROOTS];
@@ -164,165 +210,341 @@ static svn_error_t *delta_dirs(report_baton_t *b, svn_revnum_t s_rev,
                                svn_depth_t requested_depth,
                                apr_pool_t *pool);
 
-/* --- READING PREVIOUSLY STORED REPORT INFORMATION --- */
+/* --- ENCODING AND DECODING REPORT RECORDS --- */
 
-static svn_error_t *
-read_number(apr_uint64_t *num, svn_spillbuf_reader_t *reader, apr_pool_t *pool)
+/* Append NUM to BUF. */
+static void
+append_number(svn_stringbuf_t *buf, apr_uint64_t num)
 {
-  char c;
+  unsigned char bytes[SVN__MAX_ENCODED_UINT_LEN];
+  unsigned char *end = svn__encode_uint(bytes, num);
 
-  *num = 0;
-  while (1)
-    {
-      SVN_ERR(svn_spillbuf__reader_getc(&c, reader, pool));
-      if (c == ':')
-        break;
-      *num = *num * 10 + (c - '0');
-    }
-  return SVN_NO_ERROR;
+  svn_stringbuf_appendbytes(buf, (const char *)bytes, end - bytes);
+}
+
+/* Append the first LEN bytes of STR to BUF. */
+static void
+append_string(svn_stringbuf_t *buf, const char *str, apr_size_t len)
+{
+  append_number(buf, len);
+  svn_stringbuf_appendbytes(buf, str, len);
+  svn_stringbuf_appendbyte(buf, '\0');
+}
+
+/* Append a report record for INFO to BUF, omitting the first SHARED
+   bytes of its path. */
+static void
+append_record(svn_stringbuf_t *buf, const path_info_t *info,
+              apr_size_t shared)
+{
+  /* The depth may be svn_depth_exclude, which is negative. */
+  unsigned char flags
+    = (unsigned char)((info->depth - svn_depth_exclude) << 4);
+
+  if (info->link_path)
+    flags |= RECORD_HAS_LINK_PATH;
+  if (SVN_IS_VALID_REVNUM(info->rev))
+    flags |= RECORD_HAS_REV;
+  if (info->start_empty)
+    flags |= RECORD_START_EMPTY;
+  if (info->lock_token)
+    flags |= RECORD_HAS_LOCK_TOKEN;
+
+  append_number(buf, shared);
+  append_string(buf, info->path + shared, strlen(info->path + shared));
+  svn_stringbuf_appendbyte(buf, flags);
+  if (flags & RECORD_HAS_REV)
+    append_number(buf, info->rev);
+  if (flags & RECORD_HAS_LINK_PATH)
+    append_string(buf, info->link_path, strlen(info->link_path));
+  if (flags & RECORD_HAS_LOCK_TOKEN)
+    append_string(buf, info->lock_token, strlen(info->lock_token));
+}
+
+/* Return the number at *P and advance *P behind it. */
+static apr_uint64_t
+read_number(const unsigned char **p)
+{
+  apr_uint64_t num;
+
+  /* We wrote the data ourselves, so it is well-formed. */
+  *p = svn__decode_uint(&num, *p, *p + SVN__MAX_ENCODED_UINT_LEN);
+  return num;
+}
+
+/* Return the string at *P, set *LEN to its length and advance *P behind
+   it.  The result points into the buffer. */
+static const char *
+read_string(apr_size_t *len, const unsigned char **p)
+{
+  const char *str;
+
+  *len = (apr_size_t)read_number(p);
+  str = (const char *)*p;
+  *p += *len + 1;
+  return str;
+}
+
+/* Return the full path of the record at P, which must not share a path
+   prefix with its predecessor. */
+static const char *
+record_path(const unsigned char *p)
+{
+  apr_size_t len;
+
+  SVN_ERR_ASSERT_NO_RETURN(read_number(&p) == 0);
+  return read_string(&len, &p);
+}
+
+/* Read the record at P into *INFO and return a pointer to the next
+   record.  PATH must contain the path of the previous record and will
+   be updated to the path of this one.  INFO->PATH will point to PATH's
+   data; all other strings point into the buffer. */
+static const unsigned char *
+read_record(path_info_t *info, svn_stringbuf_t *path, const unsigned char *p)
+{
+  apr_size_t shared = (apr_size_t)read_number(&p);
+  apr_size_t len;
+  const char *suffix = read_string(&len, &p);
+  unsigned char flags;
+
+  svn_stringbuf_chop(path, path->len - shared);
+  svn_stringbuf_appendbytes(path, suffix, len);
+  info->path = path->data;
+
+  flags = *p++;
+  info->depth = (svn_depth_t)((flags >> 4) + svn_depth_exclude);
+  info->start_empty = (flags & RECORD_START_EMPTY) != 0;
+  info->rev = (flags & RECORD_HAS_REV)
+            ? (svn_revnum_t)read_number(&p)
+            : SVN_INVALID_REVNUM;
+  info->link_path = (flags & RECORD_HAS_LINK_PATH)
+                  ? read_string(&len, &p)
+                  : NULL;
+  info->lock_token = (flags & RECORD_HAS_LOCK_TOKEN)
+                   ? read_string(&len, &p)
+                   : NULL;
+
+  return p;
 }
 
+/* Compare the log records pointed to by A and B by their paths in
+   depth-first order, keeping records of the same path in the order
+   they have been reported. */
+static int
+compare_records(const void *a, const void *b)
+{
+  const unsigned char *lhs = *(const unsigned char * const *)a;
+  const unsigned char *rhs = *(const unsigned char * const *)b;
+  int diff = svn_path_compare_paths(record_path(lhs), record_path(rhs));
+
+  if (diff)
+    return diff;
+
+  return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+}
+
+/* Sort the records in B->REPORT_LOG and pack them into B->STORE,
+   allocated in RESULT_POOL.  Release the log afterwards.  If the log
+   has been spilled to disk, prepare B->STORE to read it back as is. */
 static svn_error_t *
-read_string(const char **str, svn_spillbuf_reader_t *reader, apr_pool_t *pool)
+build_report_store(report_baton_t *b, apr_pool_t *result_pool)
 {
-  apr_uint64_t len;
-  apr_size_t size;
-  apr_size_t amt;
-  char *buf;
+  report_store_t *store = &b->store;
+  apr_array_header_t *records;
+  svn_stringbuf_t *log, *path, *prev_path;
+  const unsigned char *p, *end;
+  int i;
+
+  store->next = 0;
+  store->next_offset = 0;
+  store->path = svn_stringbuf_create_empty(result_pool);
+
+  if (svn_spillbuf__get_file(b->report_log))
+    {
+      store->data = NULL;
+      store->restarts = NULL;
+      store->count = 0;
+      store->log_stream = svn_stream__from_spillbuf(b->report_log,
+                                                    b->log_pool);
+      store->record = svn_stringbuf_create_empty(b->log_pool);
 
-  SVN_ERR(read_number(&len, reader, pool));
+      return SVN_NO_ERROR;
+    }
 
-  /* Len can never be less than zero.  But could len be so large that
-     len + 1 wraps around and we end up passing 0 to apr_palloc(),
-     thus getting a pointer to no storage?  Probably not (16 exabyte
-     string, anyone?) but let's be future-proof anyway. */
-  if (len + 1 < len || len + 1 > APR_SIZE_MAX)
+  store->log_stream = NULL;
+  store->record = NULL;
+
+  /* The log fits into memory.  Collect it into a single buffer. */
+  log = svn_stringbuf_create_ensure(
+          (apr_size_t)svn_spillbuf__get_size(b->report_log), b->log_pool);
+  while (TRUE)
     {
-      /* xgettext doesn't expand preprocessor definitions, so we must
-         pass translatable string to apr_psprintf() function to create
-         intermediate string with appropriate format specifier. */
-      return svn_error_createf(SVN_ERR_REPOS_BAD_REVISION_REPORT, NULL,
-                               apr_psprintf(pool,
-                                            _("Invalid length (%%%s) when "
-                                              "about to read a string"),
-                                            APR_UINT64_T_FMT),
-                               len);
+      const char *data;
+      apr_size_t len;
+
+      SVN_ERR(svn_spillbuf__read(&data, &len, b->report_log, b->log_pool));
+      if (data == NULL)
+        break;
+
+      svn_stringbuf_appendbytes(log, data, len);
     }
 
-  size = (apr_size_t)len;
-  buf = apr_palloc(pool, size+1);
-  if (size > 0)
+  records = apr_array_make(b->log_pool, 16, sizeof(const unsigned char *));
+  p = (const unsigned char *)log->data;
+  end = p + log->len;
+  while (p < end)
     {
-      SVN_ERR(svn_spillbuf__reader_read(&amt, reader, buf, size, pool));
-      SVN_ERR_ASSERT(amt == size);
+      apr_size_t len = (apr_size_t)read_number(&p);
+
+      APR_ARRAY_PUSH(records, const unsigned char *) = p;
+      p += len;
     }
-  buf[len] = 0;
-  *str = buf;
-  return SVN_NO_ERROR;
-}
 
-static svn_error_t *
-read_rev(svn_revnum_t *rev, svn_spillbuf_reader_t *reader, apr_pool_t *pool)
-{
-  char c;
-  apr_uint64_t num;
+  svn_sort__array(records, compare_records);
 
-  SVN_ERR(svn_spillbuf__reader_getc(&c, reader, pool));
-  if (c == '+')
+  store->data = svn_stringbuf_create_ensure(log->len, result_pool);
+  store->restarts = apr_array_make(result_pool,
+                                   records->nelts / RESTART_INTERVAL + 1,
+                                   sizeof(apr_size_t));
+  store->count = records->nelts;
+
+  path = svn_stringbuf_create_empty(b->log_pool);
+  prev_path = svn_stringbuf_create_empty(b->log_pool);
+  for (i = 0; i < records->nelts; ++i)
     {
-      SVN_ERR(read_number(&num, reader, pool));
-      *rev = (svn_revnum_t) num;
+      path_info_t info;
+      apr_size_t shared = 0;
+      svn_stringbuf_t *temp;
+
+      read_record(&info, path,
+                  APR_ARRAY_IDX(records, i, const unsigned char *));
+
+      if (i % RESTART_INTERVAL == 0)
+        APR_ARRAY_PUSH(store->restarts, apr_size_t) = store->data->len;
+      else
+        while (shared < prev_path->len
+               && info.path[shared] == prev_path->data[shared])
+          ++shared;
+
+      append_record(store->data, &info, shared);
+
+      temp = prev_path;
+      prev_path = path;
+      path = temp;
     }
-  else
-    *rev = SVN_INVALID_REVNUM;
+
+  svn_pool_destroy(b->log_pool);
+  b->log_pool = NULL;
+  b->report_log = NULL;
+  b->record_buf = NULL;
+
   return SVN_NO_ERROR;
 }
 
-/* Read a single character to set *DEPTH (having already read '+')
-   from READER.  PATH is the path to which the depth applies, and is
-   used for error reporting only. */
+/* Read the next record from the spilled log of B->store into
+   B->lookahead, or set it to NULL if we have reached the end of the
+   report. */
 static svn_error_t *
-read_depth(svn_depth_t *depth, svn_spillbuf_reader_t *reader, const char *path,
-           apr_pool_t *pool)
+read_log_record(report_baton_t *b)
 {
-  char c;
+  report_store_t *store = &b->store;
+  unsigned char bytes[SVN__MAX_ENCODED_UINT_LEN];
+  apr_uint64_t len;
+  apr_size_t i = 0;
+  apr_size_t amt;
 
-  SVN_ERR(svn_spillbuf__reader_getc(&c, reader, pool));
-  switch (c)
+  /* Read the record length, one byte at a time. */
+  do
     {
-    case 'X':
-      *depth = svn_depth_exclude;
-      break;
-    case 'E':
-      *depth = svn_depth_empty;
-      break;
-    case 'F':
-      *depth = svn_depth_files;
-      break;
-    case 'M':
-      *depth = svn_depth_immediates;
-      break;
-
-      /* Note that we do not tolerate explicit representation of
-         svn_depth_infinity here, because that's not how
-         write_path_info() writes it. */
-    default:
-      return svn_error_createf(SVN_ERR_REPOS_BAD_REVISION_REPORT, NULL,
-                               _("Invalid depth (%c) for path '%s'"), c, path);
+      amt = 1;
+      SVN_ERR(svn_stream_read_full(store->log_stream, (char *)&bytes[i],
+                                   &amt));
+      if (amt == 0)
+        {
+          SVN_ERR_ASSERT(i == 0);
+          b->lookahead = NULL;
+          return SVN_NO_ERROR;
+        }
     }
+  while ((bytes[i++] & 0x80) && i < sizeof(bytes));
+
+  svn__decode_uint(&len, bytes, bytes + i);
+  svn_stringbuf_setempty(store->record);
+  svn_stringbuf_ensure(store->record, (apr_size_t)len);
+
+  amt = (apr_size_t)len;
+  SVN_ERR(svn_stream_read_full(store->log_stream, store->record->data,
+                               &amt));
+  SVN_ERR_ASSERT(amt == len);
+  store->record->len = amt;
+  store->record->data[amt] = '\0';
+
+  read_record(&store->info, store->path,
+              (const unsigned char *)store->record->data);
+  b->lookahead = &store->info;
 
   return SVN_NO_ERROR;
 }
 
-/* Read a report operation *PI out of READER.  Set *PI to NULL if we
-   have reached the end of the report. */
+/* Read the next record from B->store into B->lookahead, or set it to
+   NULL if we have reached the end of the report. */
 static svn_error_t *
-read_path_info(path_info_t **pi,
-               svn_spillbuf_reader_t *reader,
-               apr_pool_t *pool)
+advance_lookahead(report_baton_t *b)
 {
-  char c;
+  report_store_t *store = &b->store;
+  const unsigned char *start;
+  const unsigned char *next;
+
+  if (store->log_stream)
+    return svn_error_trace(read_log_record(b));
 
-  SVN_ERR(svn_spillbuf__reader_getc(&c, reader, pool));
-  if (c == '-')
+  if (store->next == store->count)
     {
-      *pi = NULL;
+      b->lookahead = NULL;
       return SVN_NO_ERROR;
     }
 
-  *pi = apr_palloc(pool, sizeof(**pi));
-  SVN_ERR(read_string(&(*pi)->path, reader, pool));
-  SVN_ERR(svn_spillbuf__reader_getc(&c, reader, pool));
-  if (c == '+')
-    SVN_ERR(read_string(&(*pi)->link_path, reader, pool));
-  else
-    (*pi)->link_path = NULL;
-  SVN_ERR(read_rev(&(*pi)->rev, reader, pool));
-  SVN_ERR(svn_spillbuf__reader_getc(&c, reader, pool));
-  if (c == '+')
-    SVN_ERR(read_depth(&((*pi)->depth), reader, (*pi)->path, pool));
-  else
-    (*pi)->depth = svn_depth_infinity;
-  SVN_ERR(svn_spillbuf__reader_getc(&c, reader, pool));
-  (*pi)->start_empty = (c == '+');
-  SVN_ERR(svn_spillbuf__reader_getc(&c, reader, pool));
-  if (c == '+')
-    SVN_ERR(read_string(&(*pi)->lock_token, reader, pool));
-  else
-    (*pi)->lock_token = NULL;
-  (*pi)->pool = pool;
+  start = (const unsigned char *)store->data->data;
+  next = read_record(&store->info, store->path, start + store->next_offset);
+  store->next_offset = next - start;
+  store->next++;
+
+  b->lookahead = &store->info;
+
   return SVN_NO_ERROR;
 }
 
+/* Return a copy of INFO allocated in POOL. */
+static path_info_t *
+copy_path_info(const path_info_t *info, apr_pool_t *pool)
+{
+  path_info_t *copy = apr_pmemdup(pool, info, sizeof(*info));
+  copy->path = apr_pstrdup(pool, info->path);
+  copy->link_path = apr_pstrdup(pool, info->link_path);
+  copy->lock_token = apr_pstrdup(pool, info->lock_token);
+
+  return copy;
+}
+
+/* --- READING PREVIOUSLY STORED REPORT INFORMATION --- */
+
+/* Return true if PATH is a child of PREFIX (which has length PLEN). */
+static svn_boolean_t
+relevant_path(const char *path, const char *prefix, apr_size_t plen)
+{
+  return (strncmp(path, prefix, plen) == 0 &&
+          (!*prefix || path[plen] == '/'));
+}
+
 /* Return true if PI's path is a child of PREFIX (which has length PLEN). */
 static svn_boolean_t
 relevant(path_info_t *pi, const char *prefix, apr_size_t plen)
 {
-  return (pi && strncmp(pi->path, prefix, plen) == 0 &&
-          (!*prefix || pi->path[plen] == '/'));
+  return (pi && relevant_path(pi->path, prefix, plen));
 }
 
-/* Fetch the next pathinfo from B->reader for a descendant of
+/* Fetch the next pathinfo from B->store for a descendant of
    PREFIX.  If the next pathinfo is for an immediate child of PREFIX,
    set *ENTRY to the path component of the report information and
    *INFO to the path information for that entry.  If the next pathinfo
@@ -334,17 +556,13 @@ relevant(path_info_t *pi, const char *prefix, apr_size_t plen)
 
    At all times, B->lookahead is presumed to be the next pathinfo not
    yet returned as an immediate child, or NULL if we have reached the
-   end of the report.  Because we use a lookahead element, we can't
-   rely on the usual nested pool lifetimes, so allocate each pathinfo
-   in a subpool of the report baton's pool.  The caller should delete
-   (*INFO)->pool when it is done with the information. */
+   end of the report.  Allocate *ENTRY and *INFO in POOL. */
 static svn_error_t *
 fetch_path_info(report_baton_t *b, const char **entry, path_info_t **info,
                 const char *prefix, apr_pool_t *pool)
 {
   apr_size_t plen = strlen(prefix);
   const char *relpath, *sep;
-  apr_pool_t *subpool;
 
   if (!relevant(b->lookahead, prefix, plen))
     {
@@ -366,10 +584,9 @@ fetch_path_info(report_baton_t *b, const char **entry, path_info_t **info,
       else
         {
           /* This is an immediate child; return it and advance. */
-          *entry = relpath;
-          *info = b->lookahead;
-          subpool = svn_pool_create(b->pool);
-          SVN_ERR(read_path_info(&b->lookahead, b->reader, subpool));
+          *info = copy_path_info(b->lookahead, pool);
+          *entry = (*info)->path + (relpath - b->lookahead->path);
+          SVN_ERR(advance_lookahead(b));
         }
     }
   return SVN_NO_ERROR;
@@ -380,15 +597,50 @@ fetch_path_info(report_baton_t *b, const char **entry, path_info_t **info,
 static svn_error_t *
 skip_path_info(report_baton_t *b, const char *prefix)
 {
+  report_store_t *store = &b->store;
   apr_size_t plen = strlen(prefix);
-  apr_pool_t *subpool;
+  int first, lo, hi;
 
-  while (relevant(b->lookahead, prefix, plen))
+  if (!relevant(b->lookahead, prefix, plen))
+    return SVN_NO_ERROR;
+
+  /* In a sorted store, the relevant entries form a contiguous range,
+     starting with the lookahead.  Jump to the last restart point within
+     that range. */
+  if (store->restarts)
     {
-      svn_pool_destroy(b->lookahead->pool);
-      subpool = svn_pool_create(b->pool);
-      SVN_ERR(read_path_info(&b->lookahead, b->reader, subpool));
+      first = (store->next + RESTART_INTERVAL - 1) / RESTART_INTERVAL;
+      lo = first;
+      hi = store->restarts->nelts;
+      while (lo < hi)
+        {
+          int mid = lo + (hi - lo) / 2;
+          apr_size_t offset = APR_ARRAY_IDX(store->restarts, mid,
+                                            apr_size_t);
+          const unsigned char *record
+            = (const unsigned char *)store->data->data + offset;
+
+          if (relevant_path(record_path(record), prefix, plen))
+            lo = mid + 1;
+          else
+            hi = mid;
+        }
+
+      if (lo > first)
+        {
+          store->next = (lo - 1) * RESTART_INTERVAL;
+          store->next_offset = APR_ARRAY_IDX(store->restarts, lo - 1,
+                                             apr_size_t);
+        }
     }
+
+  /* Skip the remainder one by one. */
+  do
+    {
+      SVN_ERR(advance_lookahead(b));
+    }
+  while (relevant(b->lookahead, prefix, plen));
+
   return SVN_NO_ERROR;
 }
 
@@ -1218,7 +1470,6 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
               if (s_entries)
                 svn_hash_sets(s_entries, name, NULL);
 
-              svn_pool_destroy(info->pool);
               continue;
             }
 
@@ -1253,11 +1504,6 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
                  excluded and got deleted in repos. */
               && (! info || info->depth != svn_depth_exclude || t_entry))
             svn_hash_sets(s_entries, name, NULL);
-
-          /* pathinfo entries live in their own subpools due to lookahead,
-             so we need to clear each one out as we finish with it. */
-          if (info)
-            svn_pool_destroy(info->pool);
         }
 
       /* Remove any deleted entries.  Do this before processing the
@@ -1425,28 +1671,29 @@ static svn_error_t *
 finish_report(report_baton_t *b, apr_pool_t *pool)
 {
   path_info_t *info;
-  apr_pool_t *subpool;
   svn_revnum_t s_rev;
   int i;
 
-  /* Save our pool to manage the lookahead and fs_root cache with. */
+  /* Save our pool to manage the fs_root cache with. */
   b->pool = pool;
 
-  /* Add the end marker. */
-  SVN_ERR(svn_spillbuf__reader_write(b->reader, "-", 1, pool));
+  SVN_ERR(build_report_store(b, pool));
 
-  /* Read the first pathinfo from the report and verify that it is a top-level
-     set_path entry. */
-  SVN_ERR(read_path_info(&info, b->reader, pool));
-  if (!info || strcmp(info->path, b->s_operand) != 0
-      || info->link_path || !SVN_IS_VALID_REVNUM(info->rev))
+  /* The first pathinfo in the report must be a top-level set_path entry.
+     Sorting the report keeps the first top-level entry in front. */
+  SVN_ERR(advance_lookahead(b));
+  if (!b->lookahead || strcmp(b->lookahead->path, b->s_operand) != 0)
+    return svn_error_create(SVN_ERR_REPOS_BAD_REVISION_REPORT, NULL,
+                            _("Invalid report for top level of working copy"));
+
+  info = copy_path_info(b->lookahead, pool);
+  if (info->link_path || !SVN_IS_VALID_REVNUM(info->rev))
     return svn_error_create(SVN_ERR_REPOS_BAD_REVISION_REPORT, NULL,
                             _("Invalid report for top level of working copy"));
   s_rev = info->rev;
 
   /* Initialize the lookahead pathinfo. */
-  subpool = svn_pool_create(pool);
-  SVN_ERR(read_path_info(&b->lookahead, b->reader, subpool));
+  SVN_ERR(advance_lookahead(b));
 
   if (b->lookahead && strcmp(b->lookahead->path, b->s_operand) == 0)
     {
@@ -1463,8 +1710,8 @@ finish_report(report_baton_t *b, apr_pool_t *pool)
         {
           b->lookahead->depth = info->depth;
         }
-      info = b->lookahead;
-      SVN_ERR(read_path_info(&b->lookahead, b->reader, subpool));
+      info = copy_path_info(b->lookahead, pool);
+      SVN_ERR(advance_lookahead(b));
     }
 
   /* Open the target root and initialize the source root cache. */
@@ -1487,7 +1734,7 @@ finish_report(report_baton_t *b, apr_pool_t *pool)
 
 /* --- COLLECTING THE REPORT INFORMATION --- */
 
-/* Record a report operation into the spill buffer.  Return an error
+/* Record a report operation into the report log.  Return an error
    if DEPTH is svn_depth_unknown. */
 static svn_error_t *
 write_path_info(report_baton_t *b, const char *path, const char *lpath,
@@ -1495,39 +1742,40 @@ write_path_info(report_baton_t *b, const char *path, const char *lpath,
                 svn_boolean_t start_empty,
                 const char *lock_token, apr_pool_t *pool)
 {
-  const char *lrep, *rrep, *drep, *ltrep, *rep;
+  path_info_t info;
+
+  if (depth != svn_depth_exclude
+      && depth != svn_depth_empty
+      && depth != svn_depth_files
+      && depth != svn_depth_immediates
+      && depth != svn_depth_infinity)
+    return svn_error_createf(SVN_ERR_REPOS_BAD_ARGS, NULL,
+                             _("Unsupported report depth '%s'"),
+                             svn_depth_to_word(depth));
 
   /* Munge the path to be anchor-relative, so that we can use edit paths
      as report paths. */
-  path = svn_relpath_join(b->s_operand, path, pool);
+  info.path = svn_relpath_join(b->s_operand, path, pool);
+  info.link_path = lpath;
+  info.rev = rev;
+  info.depth = depth;
+  info.start_empty = start_empty;
+  info.lock_token = lock_token;
 
-  lrep = lpath ? apr_psprintf(pool, "+%" APR_SIZE_T_FMT ":%s",
-                              strlen(lpath), lpath) : "-";
-  rrep = (SVN_IS_VALID_REVNUM(rev)) ?
-    apr_psprintf(pool, "+%ld:", rev) : "-";
+  svn_stringbuf_setempty(b->record_buf);
+  append_record(b->record_buf, &info, 0);
 
-  if (depth == svn_depth_exclude)
-    drep = "+X";
-  else if (depth == svn_depth_empty)
-    drep = "+E";
-  else if (depth == svn_depth_files)
-    drep = "+F";
-  else if (depth == svn_depth_immediates)
-    drep = "+M";
-  else if (depth == svn_depth_infinity)
-    drep = "-";
-  else
-    return svn_error_createf(SVN_ERR_REPOS_BAD_ARGS, NULL,
-                             _("Unsupported report depth '%s'"),
-                             svn_depth_to_word(depth));
+  {
+    unsigned char len[SVN__MAX_ENCODED_UINT_LEN];
+    unsigned char *end = svn__encode_uint(len, b->record_buf->len);
 
-  ltrep = lock_token ? apr_psprintf(pool, "+%" APR_SIZE_T_FMT ":%s",
-                                    strlen(lock_token), lock_token) : "-";
-  rep = apr_psprintf(pool, "+%" APR_SIZE_T_FMT ":%s%s%s%s%c%s",
-                     strlen(path), path, lrep, rrep, drep,
-                     start_empty ? '+' : '-', ltrep);
-  return svn_error_trace(
-            svn_spillbuf__reader_write(b->reader, rep, strlen(rep), pool));
+    SVN_ERR(svn_spillbuf__write(b->report_log, (const char *)len,
+                                end - len, pool));
+  }
+
+  return svn_error_trace(svn_spillbuf__write(b->report_log,
+                                             b->record_buf->data,
+                                             b->record_buf->len, pool));
 }
 
 svn_error_t *
@@ -1631,9 +1879,12 @@ svn_repos_begin_report3(void **report_baton,
   b->authz_read_baton = authz_read_baton;
   b->revision_infos = svn_hash__make(pool);
   b->pool = pool;
-  b->reader = svn_spillbuf__reader_create(1000 /* blocksize */,
-                                          1000000 /* maxsize */,
-                                          pool);
+  b->log_pool = svn_pool_create(pool);
+  b->report_log = svn_spillbuf__create(16384 /* blocksize */,
+                                       REPORT_MEMORY_LIMIT /* maxsize */,
+                                       b->log_pool);
+  b->record_buf = svn_stringbuf_create_ensure(256, b->log_pool);
+  b->lookahead = NULL;
   b->repos_uuid = svn_string_create(uuid, pool);
 
   /* Hand reporter back to client. */
@@ -1180,6 +1180,8 @@ svn_repos_create(svn_repos_t **repos_p,
   SVN_ERR(lock_repos(repos, FALSE, FALSE, scratch_pool));
 
   /* Create an environment for the filesystem. */
+  if (fs_config)
+    repos->fs_config = apr_hash_copy(result_pool, fs_config);
   if ((err = svn_fs_create2(&repos->fs, repos->db_path, fs_config,
                             result_pool, scratch_pool)))
     {
@@ -1307,6 +1309,8 @@ get_repos(svn_repos_t **repos_p,
   SVN_ERR(lock_repos(repos, exclusive, nonblocking, result_pool));
 
   /* Open up the filesystem only after obtaining the lock. */
+  if (fs_config)
+    repos->fs_config = apr_hash_copy(result_pool, fs_config);
   if (open_fs)
     SVN_ERR(svn_fs_open2(&repos->fs, repos->db_path, fs_config,
                          result_pool, scratch_pool));
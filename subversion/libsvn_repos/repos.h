@@ -135,6 +135,10 @@ struct svn_repos_t
   /* The FS backend in use within this repository. */
   const char *fs_type;
 
+  /* The FS_CONFIG that the filesystem has been opened with.  Used to
+     open further instances of it, e.g. for worker threads.  May be NULL. */
+  apr_hash_t *fs_config;
+
   /* If non-null, a list of all the capabilities the client (on the
      current connection) has self-reported.  Each element is a
      'const char *', one of SVN_RA_CAPABILITY_*.
@@ -153,6 +157,16 @@ struct svn_repos_t
      those constants' addresses, therefore). */
   apr_hash_t *repository_capabilities;
 
+  /* Maps locations to the next step in their node history, as found by
+     svn_fs_history_prev2().  Created by svn_repos_get_logs5() on demand.
+     NULL if not created yet or if there is no membuffer cache. */
+  struct svn_cache__t *history_cache;
+
+  /* Maps node-revisions and revision ranges to their line attribution.
+     Created by svn_repos__get_file_blame() on demand.  NULL if not
+     created yet or if there is no membuffer cache. */
+  struct svn_cache__t *blame_cache;
+
   /* Pool from which this structure was allocated.  Also used for
      auxiliary repository-related data that requires a matching
      lifespan.  (As the svn_repos_t structure tends to be relatively
@@ -50,6 +50,34 @@
 static const char base64tab[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ" \
                                 "abcdefghijklmnopqrstuvwxyz0123456789+/";
 
+/* 12 bit value -> pair of base64 chars mapping table (2^12 entries of
+   two chars each).  Allows us to encode a three-byte group with only
+   two table lookups. */
+#define BASE64_PAIRS(c) \
+  c"A" c"B" c"C" c"D" c"E" c"F" c"G" c"H" c"I" c"J" c"K" c"L" c"M" \
+  c"N" c"O" c"P" c"Q" c"R" c"S" c"T" c"U" c"V" c"W" c"X" c"Y" c"Z" \
+  c"a" c"b" c"c" c"d" c"e" c"f" c"g" c"h" c"i" c"j" c"k" c"l" c"m" \
+  c"n" c"o" c"p" c"q" c"r" c"s" c"t" c"u" c"v" c"w" c"x" c"y" c"z" \
+  c"0" c"1" c"2" c"3" c"4" c"5" c"6" c"7" c"8" c"9" c"+" c"/"
+
+static const char base64pairs[] =
+  BASE64_PAIRS("A") BASE64_PAIRS("B") BASE64_PAIRS("C") BASE64_PAIRS("D")
+  BASE64_PAIRS("E") BASE64_PAIRS("F") BASE64_PAIRS("G") BASE64_PAIRS("H")
+  BASE64_PAIRS("I") BASE64_PAIRS("J") BASE64_PAIRS("K") BASE64_PAIRS("L")
+  BASE64_PAIRS("M") BASE64_PAIRS("N") BASE64_PAIRS("O") BASE64_PAIRS("P")
+  BASE64_PAIRS("Q") BASE64_PAIRS("R") BASE64_PAIRS("S") BASE64_PAIRS("T")
+  BASE64_PAIRS("U") BASE64_PAIRS("V") BASE64_PAIRS("W") BASE64_PAIRS("X")
+  BASE64_PAIRS("Y") BASE64_PAIRS("Z") BASE64_PAIRS("a") BASE64_PAIRS("b")
+  BASE64_PAIRS("c") BASE64_PAIRS("d") BASE64_PAIRS("e") BASE64_PAIRS("f")
+  BASE64_PAIRS("g") BASE64_PAIRS("h") BASE64_PAIRS("i") BASE64_PAIRS("j")
+  BASE64_PAIRS("k") BASE64_PAIRS("l") BASE64_PAIRS("m") BASE64_PAIRS("n")
+  BASE64_PAIRS("o") BASE64_PAIRS("p") BASE64_PAIRS("q") BASE64_PAIRS("r")
+  BASE64_PAIRS("s") BASE64_PAIRS("t") BASE64_PAIRS("u") BASE64_PAIRS("v")
+  BASE64_PAIRS("w") BASE64_PAIRS("x") BASE64_PAIRS("y") BASE64_PAIRS("z")
+  BASE64_PAIRS("0") BASE64_PAIRS("1") BASE64_PAIRS("2") BASE64_PAIRS("3")
+  BASE64_PAIRS("4") BASE64_PAIRS("5") BASE64_PAIRS("6") BASE64_PAIRS("7")
+  BASE64_PAIRS("8") BASE64_PAIRS("9") BASE64_PAIRS("+") BASE64_PAIRS("/");
+
 
 /* Binary input --> base64-encoded output */
 
@@ -85,6 +113,23 @@ encode_group(const unsigned char *in, char *out)
   out[3] = base64tab[part2 & 0x3f];
 }
 
+/* Like encode_group but use BASE64PAIRS to translate the input group
+   into two twelve-bit units only. */
+static APR_INLINE void
+encode_group_by_pairs(const unsigned char *in, char *out)
+{
+  apr_size_t group = ((apr_size_t)in[0] << 16)
+                   | ((apr_size_t)in[1] << 8)
+                   | in[2];
+  const char *pair0 = base64pairs + 2 * (group >> 12);
+  const char *pair1 = base64pairs + 2 * (group & 0xfff);
+
+  out[0] = pair0[0];
+  out[1] = pair0[1];
+  out[2] = pair1[0];
+  out[3] = pair1[1];
+}
+
 /* Base64-encode a line, i.e. BYTES_PER_LINE bytes from DATA into
    BASE64_LINELEN chars and append it to STR.  It does not assume that
    a new line char will be appended, though.
@@ -104,7 +149,7 @@ encode_line(svn_stringbuf_t *str, const char *data)
   /* We assume that BYTES_PER_LINE is a multiple of 3 and BASE64_LINELEN
      a multiple of 4. */
   for ( ; out != end; in += 3, out += 4)
-    encode_group(in, out);
+    encode_group_by_pairs(in, out);
 
   /* Expand and terminate the string. */
   *out = '\0';
@@ -432,7 +477,15 @@ decode_bytes(svn_stringbuf_t *str, const char *data, apr_size_t len,
          code path. */
       if ((*inbuflen == 0) && (end - p >= BASE64_LINELEN))
         if (decode_line(str, &p))
-          continue;
+          {
+            /* Lines are usually terminated by a single new line char.
+               Skip it right away instead of letting the next decode_line
+               call fail on it. */
+            if (p < end && *p == '\n')
+              ++p;
+
+            continue;
+          }
 
       /* A special case or decode_line encountered a special char. */
       if (*p == '=')
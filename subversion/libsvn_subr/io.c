@@ -4189,6 +4189,20 @@ svn_io_file_aligned_seek(apr_file_t *file,
   return SVN_NO_ERROR;
 }
 
+void
+svn_io__file_prefetch(apr_file_t *file,
+                      apr_off_t offset,
+                      apr_off_t length)
+{
+#if defined(POSIX_FADV_WILLNEED)
+  apr_os_file_t fd;
+
+  /* This is only a hint.  Failure is harmless and can be ignored. */
+  if (length > 0 && apr_os_file_get(&fd, file) == APR_SUCCESS)
+    (void)posix_fadvise(fd, offset, length, POSIX_FADV_WILLNEED);
+#endif
+}
+
 
 svn_error_t *
 svn_io_file_write(apr_file_t *file, const void *buf,
@@ -102,6 +102,39 @@ svn_log__get_file(const char *path, svn_revnum_t rev,
                       want_props ? " props" : "");
 }
 
+/* Return the URI-encoded PATHS, separated by spaces, allocated in POOL. */
+static const char *
+space_separated_paths(const apr_array_header_t *paths,
+                      apr_pool_t *pool)
+{
+  int i;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_stringbuf_t *result = svn_stringbuf_create_empty(pool);
+
+  for (i = 0; i < paths->nelts; i++)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+      svn_pool_clear(iterpool);
+      if (i != 0)
+        svn_stringbuf_appendcstr(result, " ");
+      svn_stringbuf_appendcstr(result, svn_path_uri_encode(path, iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  return result->data;
+}
+
+const char *
+svn_log__get_files(const apr_array_header_t *paths, svn_revnum_t rev,
+                   svn_boolean_t want_contents, svn_boolean_t want_props,
+                   apr_pool_t *pool)
+{
+  return apr_psprintf(pool, "get-files (%s) r%ld%s%s",
+                      space_separated_paths(paths, pool), rev,
+                      want_contents ? " text" : "",
+                      want_props ? " props" : "");
+}
+
 const char *
 svn_log__get_dir(const char *path, svn_revnum_t rev,
                  svn_boolean_t want_contents, svn_boolean_t want_props,
@@ -114,29 +147,22 @@ svn_log__get_dir(const char *path, svn_revnum_t rev,
                       want_props ? " props" : "");
 }
 
+const char *
+svn_log__stat_many(const apr_array_header_t *paths, svn_revnum_t rev,
+                   apr_pool_t *pool)
+{
+  return apr_psprintf(pool, "stat-many (%s) r%ld",
+                      space_separated_paths(paths, pool), rev);
+}
+
 const char *
 svn_log__get_mergeinfo(const apr_array_header_t *paths,
                        svn_mergeinfo_inheritance_t inherit,
                        svn_boolean_t include_descendants,
                        apr_pool_t *pool)
 {
-  int i;
-  apr_pool_t *iterpool = svn_pool_create(pool);
-  svn_stringbuf_t *space_separated_paths = svn_stringbuf_create_empty(pool);
-
-  for (i = 0; i < paths->nelts; i++)
-    {
-      const char *path = APR_ARRAY_IDX(paths, i, const char *);
-      svn_pool_clear(iterpool);
-      if (i != 0)
-        svn_stringbuf_appendcstr(space_separated_paths, " ");
-      svn_stringbuf_appendcstr(space_separated_paths,
-                               svn_path_uri_encode(path, iterpool));
-    }
-  svn_pool_destroy(iterpool);
-
   return apr_psprintf(pool, "get-mergeinfo (%s) %s%s",
-                      space_separated_paths->data,
+                      space_separated_paths(paths, pool),
                       svn_inheritance_to_word(inherit),
                       include_descendants ? " include-descendants" : "");
 }
@@ -306,6 +332,15 @@ svn_log__get_file_revs(const char *path, svn_revnum_t start, svn_revnum_t end,
                       log_include_merged_revisions(include_merged_revisions));
 }
 
+const char *
+svn_log__get_file_blame(const char *path,
+                        svn_revnum_t start, svn_revnum_t end,
+                        apr_pool_t *pool)
+{
+  return apr_psprintf(pool, "get-file-blame %s r%ld:%ld",
+                      svn_path_uri_encode(path, pool), start, end);
+}
+
 const char *
 svn_log__lock(apr_hash_t *targets,
               svn_boolean_t steal, apr_pool_t *pool)
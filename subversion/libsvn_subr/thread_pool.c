@@ -0,0 +1,97 @@
+/* thread_pool.c --- process-wide pool of worker threads.
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include "private/svn_atomic.h"
+#include "private/svn_thread_pool.h"
+
+#include "svn_private_config.h"
+
+#if APR_HAS_THREADS
+
+/* Number of microseconds that an unused thread remains in the pool before
+ * being terminated. */
+#define THREADPOOL_THREAD_IDLE_LIMIT 1000000
+
+/* The process-wide thread pool. */
+static apr_thread_pool_t *thread_pool = NULL;
+
+/* Keep track on whether we already created the THREAD_POOL . */
+static svn_atomic_t thread_pool_initialized = FALSE;
+
+/* Destructor function that implicitly cleans up any running threads
+   in the THREAD_POOL *once*.
+
+   Must be run as a pre-cleanup hook.
+ */
+static apr_status_t
+thread_pool_pre_cleanup(void *data)
+{
+  apr_thread_pool_t *tp = thread_pool;
+  if (!thread_pool)
+    return APR_SUCCESS;
+
+  thread_pool = NULL;
+  thread_pool_initialized = FALSE;
+
+  return apr_thread_pool_destroy(tp);
+}
+
+/* Implements svn_atomic__err_init_func_t, creating the THREAD_POOL. */
+static svn_error_t *
+create_thread_pool(void *baton,
+                   apr_pool_t *scratch_pool)
+{
+  /* The thread-pool must be allocated from a thread-safe pool and it
+     shall live as long as the process. */
+  apr_pool_t *pool = svn_pool_create(NULL);
+  apr_status_t status
+    = apr_thread_pool_create(&thread_pool, 0, SVN_THREAD_POOL__MAX_THREADS,
+                             pool);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't create thread pool"));
+
+  /* The cleanup must happen in the pre-cleanup hook.  Otherwise, the
+     sub-pools containing the thread objects would already be invalid. */
+  apr_pool_pre_cleanup_register(pool, NULL, thread_pool_pre_cleanup);
+
+  /* Let idle threads linger for a while in case more requests are
+     coming in. */
+  apr_thread_pool_idle_wait_set(thread_pool, THREADPOOL_THREAD_IDLE_LIMIT);
+
+  /* Don't queue requests unless we reached the worker thread limit. */
+  apr_thread_pool_threshold_set(thread_pool, 0);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_thread_pool__get(apr_thread_pool_t **result,
+                     apr_pool_t *scratch_pool)
+{
+  SVN_ERR(svn_atomic__init_once(&thread_pool_initialized, create_thread_pool,
+                                NULL, scratch_pool));
+  *result = thread_pool;
+
+  return SVN_NO_ERROR;
+}
+
+#endif
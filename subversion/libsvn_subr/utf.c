@@ -43,6 +43,7 @@
 
 #include "private/svn_utf_private.h"
 #include "private/svn_dep_compat.h"
+#include "private/svn_eol_private.h"
 #include "private/svn_string_private.h"
 #include "private/svn_mutex.h"
 
@@ -575,6 +576,27 @@ check_non_ascii(const char *data, apr_size_t len, apr_pool_t *pool)
 {
   const char *data_start = data;
 
+#if SVN_UNALIGNED_ACCESS_IS_OK
+
+  /* Skip printable ASCII one machine word at a time.  A byte in the
+     0x00 .. 0x7f range is >= 0x20 iff adding 0x60 sets its bit 7, and
+     it is not DEL iff XOR-ing it with 0x7f leaves a non-zero value.
+     Whitespace control chars are left to the byte-wise loop below. */
+  for (; len > sizeof(apr_uintptr_t)
+       ; data += sizeof(apr_uintptr_t), len -= sizeof(apr_uintptr_t))
+    {
+      apr_uintptr_t chunk = *(const apr_uintptr_t *)data;
+      apr_uintptr_t not_ctrl = chunk + (SVN__LOWER_7BITS_SET / 0x7f) * 0x60;
+      apr_uintptr_t not_del = chunk ^ SVN__LOWER_7BITS_SET;
+
+      not_del |= (not_del & SVN__LOWER_7BITS_SET) + SVN__LOWER_7BITS_SET;
+      if (   (chunk & SVN__BIT_7_SET)
+          || (not_ctrl & not_del & SVN__BIT_7_SET) != SVN__BIT_7_SET)
+        break;
+    }
+
+#endif
+
   for (; len > 0; --len, data++)
     {
       if ((! svn_ctype_isascii(*data))
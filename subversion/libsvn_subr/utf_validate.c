@@ -290,7 +290,12 @@ svn_utf__last_valid(const char *data, apr_size_t len)
       int category = octet_category[octet];
       state = machine[state][category];
       if (state == FSM_START)
-        start = data;
+        {
+          /* After an ASCII char, skip the rest of the ASCII run. */
+          if (octet < 0x80)
+            data = first_non_fsm_start_char(data, end - data);
+          start = data;
+        }
     }
   return start;
 }
@@ -320,6 +325,14 @@ svn_utf__is_valid(const char *data, apr_size_t len)
       unsigned char octet = *data++;
       int category = octet_category[octet];
       state = machine[state][category];
+      if (state == FSM_START)
+        {
+          /* After an ASCII char, skip the rest of the ASCII run. */
+          if (octet < 0x80)
+            data = first_non_fsm_start_char(data, end - data);
+        }
+      else if (state == FSM_ERROR)
+        return FALSE;
     }
   return state == FSM_START;
 }
@@ -408,7 +421,11 @@ svn_utf__last_valid2(const char *data, apr_size_t len)
           return start;
         }
       if (state == FSM_START)
-        start = data;
+        {
+          if (octet <= 0x7F)
+            data = first_non_fsm_start_char(data, end - data);
+          start = data;
+        }
     }
   return start;
 }
@@ -35,6 +35,7 @@
 
 #include "private/svn_utf_private.h"
 #include "private/svn_subr_private.h"
+#include "private/svn_eol_private.h"
 
 #ifdef SVN_HAVE_OLD_EXPAT
 #include <xmlparse.h>
@@ -132,6 +133,80 @@ svn_xml_is_xml_safe(const char *data, apr_size_t len)
 
 /*** XML escaping. ***/
 
+#if SVN_UNALIGNED_ACCESS_IS_OK
+
+/* Return a word that has bit 7 set in every octet of CHUNK except those
+   that equal C.  This is the test used by svn_eol__find_eol_start(). */
+static APR_INLINE apr_uintptr_t
+octet_test(apr_uintptr_t chunk, char c)
+{
+  apr_uintptr_t test = chunk ^ ((SVN__LOWER_7BITS_SET / 0x7f)
+                                * (unsigned char)c);
+
+  return test | ((test & SVN__LOWER_7BITS_SET) + SVN__LOWER_7BITS_SET);
+}
+
+#endif
+
+/* Return the first octet in DATA up to END that xml_escape_cdata()
+   has to quote, or END if there is none. */
+static const char *
+find_cdata_special(const char *data, const char *end)
+{
+#if SVN_UNALIGNED_ACCESS_IS_OK
+
+  /* Skip plain text one machine word at a time. */
+  for (; (apr_size_t)(end - data) >= sizeof(apr_uintptr_t)
+       ; data += sizeof(apr_uintptr_t))
+    {
+      apr_uintptr_t chunk = *(const apr_uintptr_t *)data;
+      apr_uintptr_t test = octet_test(chunk, '&') & octet_test(chunk, '<')
+                         & octet_test(chunk, '>') & octet_test(chunk, '\r');
+
+      if ((test & SVN__BIT_7_SET) != SVN__BIT_7_SET)
+        break;
+    }
+
+#endif
+
+  while (data < end && *data != '&' && *data != '<' && *data != '>'
+         && *data != '\r')
+    data++;
+
+  return data;
+}
+
+/* Return the first octet in DATA up to END that xml_escape_attr()
+   has to quote, or END if there is none. */
+static const char *
+find_attr_special(const char *data, const char *end)
+{
+#if SVN_UNALIGNED_ACCESS_IS_OK
+
+  /* Skip plain text one machine word at a time. */
+  for (; (apr_size_t)(end - data) >= sizeof(apr_uintptr_t)
+       ; data += sizeof(apr_uintptr_t))
+    {
+      apr_uintptr_t chunk = *(const apr_uintptr_t *)data;
+      apr_uintptr_t test = octet_test(chunk, '&') & octet_test(chunk, '<')
+                         & octet_test(chunk, '>') & octet_test(chunk, '"')
+                         & octet_test(chunk, '\'') & octet_test(chunk, '\r')
+                         & octet_test(chunk, '\n') & octet_test(chunk, '\t');
+
+      if ((test & SVN__BIT_7_SET) != SVN__BIT_7_SET)
+        break;
+    }
+
+#endif
+
+  while (data < end && *data != '&' && *data != '<' && *data != '>'
+         && *data != '"' && *data != '\'' && *data != '\r'
+         && *data != '\n' && *data != '\t')
+    data++;
+
+  return data;
+}
+
 /* ### ...?
  *
  * If *OUTSTR is @c NULL, set *OUTSTR to a new stringbuf allocated
@@ -161,9 +236,7 @@ xml_escape_cdata(svn_stringbuf_t **outstr,
          Also, any '\r' not followed by '\n' is converted to '\n'.  By
          golly, if we say we want to escape a '\r', we want to make
          sure it remains a '\r'!  */
-      q = p;
-      while (q < end && *q != '&' && *q != '<' && *q != '>' && *q != '\r')
-        q++;
+      q = find_cdata_special(p, end);
       svn_stringbuf_appendbytes(*outstr, p, q - p);
 
       /* We may already be a winner.  */
@@ -202,11 +275,7 @@ xml_escape_attr(svn_stringbuf_t **outstr,
     {
       /* Find a character which needs to be quoted and append bytes up
          to that point. */
-      q = p;
-      while (q < end && *q != '&' && *q != '<' && *q != '>'
-             && *q != '"' && *q != '\'' && *q != '\r'
-             && *q != '\n' && *q != '\t')
-        q++;
+      q = find_attr_special(p, end);
       svn_stringbuf_appendbytes(*outstr, p, q - p);
 
       /* We may already be a winner.  */
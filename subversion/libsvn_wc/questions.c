@@ -270,6 +270,21 @@ svn_wc__internal_file_modified_p(svn_boolean_t *modified_p,
                                  const char *local_abspath,
                                  svn_boolean_t exact_comparison,
                                  apr_pool_t *scratch_pool)
+{
+  return svn_error_trace(svn_wc__internal_file_modified_p2(modified_p, db,
+                                                           local_abspath,
+                                                           NULL,
+                                                           exact_comparison,
+                                                           scratch_pool));
+}
+
+svn_error_t *
+svn_wc__internal_file_modified_p2(svn_boolean_t *modified_p,
+                                  svn_wc__db_t *db,
+                                  const char *local_abspath,
+                                  const svn_io_dirent2_t *dirent,
+                                  svn_boolean_t exact_comparison,
+                                  apr_pool_t *scratch_pool)
 {
   svn_wc__db_status_t status;
   svn_node_kind_t kind;
@@ -278,7 +293,6 @@ svn_wc__internal_file_modified_p(svn_boolean_t *modified_p,
   apr_time_t recorded_mod_time;
   svn_boolean_t has_props;
   svn_boolean_t props_mod;
-  const svn_io_dirent2_t *dirent;
 
   /* Read the relevant info */
   SVN_ERR(svn_wc__db_read_info(&status, &kind, NULL, NULL, NULL, NULL, NULL,
@@ -301,8 +315,9 @@ svn_wc__internal_file_modified_p(svn_boolean_t *modified_p,
       return SVN_NO_ERROR;
     }
 
-  SVN_ERR(svn_io_stat_dirent2(&dirent, local_abspath, FALSE, TRUE,
-                              scratch_pool, scratch_pool));
+  if (!dirent)
+    SVN_ERR(svn_io_stat_dirent2(&dirent, local_abspath, FALSE, TRUE,
+                                scratch_pool, scratch_pool));
 
   if (dirent->kind != svn_node_file)
     {
@@ -471,9 +471,12 @@ assemble_status(svn_wc__internal_status_t **status,
           else
             {
               svn_error_t *err;
-              err = svn_wc__internal_file_modified_p(&text_modified_p,
-                                                     db, local_abspath,
-                                                     FALSE, scratch_pool);
+
+              /* DIRENT was read just now, so don't stat the file again. */
+              err = svn_wc__internal_file_modified_p2(&text_modified_p,
+                                                      db, local_abspath,
+                                                      dirent, FALSE,
+                                                      scratch_pool);
 
               if (err)
                 {
@@ -370,6 +370,19 @@ svn_wc__internal_file_modified_p(svn_boolean_t *modified_p,
                                  svn_boolean_t exact_comparison,
                                  apr_pool_t *scratch_pool);
 
+/* Like svn_wc__internal_file_modified_p(), but if DIRENT is not NULL,
+ * use it as the on-disk state of LOCAL_ABSPATH instead of calling
+ * svn_io_stat_dirent2().  DIRENT must include the file size and mtime,
+ * e.g. come from svn_io_get_dirents3() with ONLY_CHECK_TYPE not set.
+ */
+svn_error_t *
+svn_wc__internal_file_modified_p2(svn_boolean_t *modified_p,
+                                  svn_wc__db_t *db,
+                                  const char *local_abspath,
+                                  const svn_io_dirent2_t *dirent,
+                                  svn_boolean_t exact_comparison,
+                                  apr_pool_t *scratch_pool);
+
 
 /* Prepare to merge a file content change into the working copy.
 
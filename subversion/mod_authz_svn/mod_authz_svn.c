@@ -46,6 +46,7 @@
 #include "svn_repos.h"
 #include "svn_pools.h"
 #include "svn_dirent_uri.h"
+#include "svn_hash.h"
 #include "private/svn_fspath.h"
 
 /* The apache headers define these and they conflict with our definitions. */
@@ -110,6 +111,11 @@ typedef struct authz_svn_config_rec {
  * Configuration
  */
 
+/* The configurations of all locations that set AuthzSVNAccessFile to a
+ * local file.  Collected while reading the server configuration and
+ * NULL at any other time, e.g. while reading .htaccess files. */
+static apr_array_header_t *preload_confs = NULL;
+
 /* Implements the #create_dir_config method of Apache's #module vtable. */
 static void *
 create_authz_svn_dir_config(apr_pool_t *p, char *d)
@@ -173,6 +179,12 @@ AuthzSVNAccessFile_cmd(cmd_parms *cmd, void *config, const char *arg1)
   if (!conf->access_file)
     return apr_pstrcat(cmd->pool, "Invalid file path ", arg1, SVN_VA_NULL);
 
+  /* Remember local files for preloading them in the parent process. */
+  if (preload_confs
+      && !svn_path_is_url(conf->access_file)
+      && !svn_path_is_repos_relative_url(conf->access_file))
+    APR_ARRAY_PUSH(preload_confs, authz_svn_config_rec *) = conf;
+
   return NULL;
 }
 
@@ -1118,6 +1130,104 @@ force_authn(request_rec *r)
 }
 #endif
 
+/*
+ * Preloading
+ */
+
+/* Implements #svn_repos_authz_warning_func_t, logging to server BATON. */
+static void
+log_preload_warning(void *baton,
+                    const svn_error_t *err,
+                    apr_pool_t *scratch_pool)
+{
+  server_rec *s = baton;
+  char buf[256];
+
+  ap_log_error(APLOG_MARK, APLOG_WARNING, 0, s,
+               "mod_authz_svn: warning: %s",
+               svn_err_best_message(err, buf, sizeof(buf)));
+}
+
+/* Implements the #pre_config hook.  Start collecting access files. */
+static int
+start_preload(apr_pool_t *pconf, apr_pool_t *plog, apr_pool_t *ptemp)
+{
+  preload_confs = apr_array_make(pconf, 4, sizeof(authz_svn_config_rec *));
+  return OK;
+}
+
+/* Implements the #post_config hook.  Parse all local access files listed
+ * in PRELOAD_CONFS into the authz cache, referenced from PCONF.
+ *
+ * This runs in the parent process.  Child processes forked from it find
+ * the parsed rules in the cache when they read the unchanged files and
+ * share the memory copy-on-write, instead of each parsing the files on
+ * their own.  Files that change later are parsed by each child again.
+ * Failures are logged and otherwise ignored; the same file will be read
+ * and the error reported again when a request needs it. */
+static int
+finish_preload(apr_pool_t *pconf, apr_pool_t *plog, apr_pool_t *ptemp,
+               server_rec *s)
+{
+  apr_hash_t *done = apr_hash_make(ptemp);
+  svn_error_t *svn_err;
+  char buf[256];
+  int i;
+
+  if (!preload_confs)
+    return OK;
+
+  svn_err = svn_repos_authz_initialize(pconf);
+  for (i = 0; !svn_err && i < preload_confs->nelts; ++i)
+    {
+      const authz_svn_config_rec *conf
+        = APR_ARRAY_IDX(preload_confs, i, authz_svn_config_rec *);
+      const char *groups_file = conf->groups_file;
+      const char *key;
+      svn_authz_t *access_conf;
+
+      /* Only local files can be read before the repositories are open. */
+      if (groups_file
+          && (svn_path_is_url(groups_file)
+              || svn_path_is_repos_relative_url(groups_file)))
+        continue;
+
+      key = apr_pstrcat(ptemp, conf->access_file, "\n",
+                        groups_file ? groups_file : "", SVN_VA_NULL);
+      if (svn_hash_gets(done, key))
+        continue;
+      svn_hash_sets(done, key, key);
+
+      svn_err = svn_repos_authz_read4(&access_conf, conf->access_file,
+                                      groups_file, TRUE, NULL,
+                                      log_preload_warning, s,
+                                      pconf, ptemp);
+      if (svn_err)
+        {
+          ap_log_error(APLOG_MARK, APLOG_WARNING, 0, s,
+                       "mod_authz_svn: failed to preload '%s': %s",
+                       conf->access_file,
+                       svn_err_best_message(svn_err, buf, sizeof(buf)));
+          svn_error_clear(svn_err);
+          svn_err = SVN_NO_ERROR;
+        }
+    }
+
+  if (svn_err)
+    {
+      ap_log_error(APLOG_MARK, APLOG_WARNING, 0, s,
+                   "mod_authz_svn: failed to preload access files: %s",
+                   svn_err_best_message(svn_err, buf, sizeof(buf)));
+      svn_error_clear(svn_err);
+    }
+
+  /* Directives read from now on, i.e. from .htaccess files, won't be
+   * preloaded. */
+  preload_confs = NULL;
+
+  return OK;
+}
+
 /*
  * Module flesh
  */
@@ -1128,6 +1238,8 @@ register_hooks(apr_pool_t *p)
 {
   static const char * const mod_ssl[] = { "mod_ssl.c", NULL };
 
+  ap_hook_pre_config(start_preload, NULL, NULL, APR_HOOK_MIDDLE);
+  ap_hook_post_config(finish_preload, NULL, NULL, APR_HOOK_MIDDLE);
   ap_hook_access_checker(access_checker, NULL, NULL, APR_HOOK_LAST);
   /* Our check_user_id hook must be before any module which will return
    * HTTP_UNAUTHORIZED (mod_auth_basic, etc.), but after mod_ssl, to
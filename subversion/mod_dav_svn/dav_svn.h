@@ -705,6 +705,7 @@ static const dav_report_elem dav_svn__reports_list[] = {
   { SVN_XML_NAMESPACE, SVN_DAV__MERGEINFO_REPORT },
   { SVN_XML_NAMESPACE, SVN_DAV__INHERITED_PROPS_REPORT },
   { SVN_XML_NAMESPACE, "list-report" },
+  { SVN_XML_NAMESPACE, "file-blame-report" },
   { NULL, NULL },
 };
 
@@ -762,6 +763,11 @@ dav_svn__list_report(const dav_resource *resource,
                      const apr_xml_doc *doc,
                      dav_svn__output *output);
 
+dav_error *
+dav_svn__file_blame_report(const dav_resource *resource,
+                           const apr_xml_doc *doc,
+                           dav_svn__output *output);
+
 /*** posts/ ***/
 
 /* The various POST handlers, defined in posts/, and used by repos.c.  */
@@ -0,0 +1,383 @@
+/*
+ * file-blame.c: mod_dav_svn REPORT handler for transmitting the
+ *               line-by-line origin of a file
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#define APR_WANT_STRFUNC
+#include <apr_want.h> /* for strcmp() */
+
+#include "svn_types.h"
+#include "svn_xml.h"
+#include "svn_pools.h"
+#include "svn_base64.h"
+#include "svn_diff.h"
+#include "svn_props.h"
+#include "svn_dav.h"
+
+#include "private/svn_diff_private.h"
+#include "private/svn_log.h"
+#include "private/svn_fspath.h"
+#include "private/svn_repos_private.h"
+
+#include "../dav_svn.h"
+
+struct file_blame_baton {
+  /* this buffers the output for a bit and is automatically flushed,
+     at appropriate times, by the Apache filter system. */
+  apr_bucket_brigade *bb;
+
+  /* where to deliver the output */
+  dav_svn__output *output;
+
+  /* Whether we've written the <S:file-blame-report> header.  Allows for
+     lazy writes to support mod_dav-based error handling. */
+  svn_boolean_t needs_header;
+};
+
+/* Baton for blame_diff_add_file() and blame_diff_get_chunks(). */
+struct blame_diff_baton {
+  /* The blame for the latest version compared so far.  The revision
+     descriptors are the version indexes as ints. */
+  svn_diff__blame_chain_t *chain;
+
+  /* How to compare the versions. */
+  const svn_diff_file_options_t *options;
+};
+
+
+/* Implements svn_repos__blame_diff_t.add_file() using libsvn_diff.
+   This is the same as in svnserve. */
+static svn_error_t *
+blame_diff_add_file(void *baton,
+                    const char *last_file,
+                    const char *file,
+                    int version,
+                    apr_pool_t *scratch_pool)
+{
+  struct blame_diff_baton *db = baton;
+  int *rev = apr_palloc(db->chain->pool, sizeof(*rev));
+
+  *rev = version;
+  return svn_error_trace(svn_diff__blame_add_file(db->chain, last_file,
+                                                  file, rev, db->options,
+                                                  NULL, NULL,
+                                                  scratch_pool));
+}
+
+
+/* Implements svn_repos__blame_diff_t.get_chunks() using libsvn_diff. */
+static svn_error_t *
+blame_diff_get_chunks(apr_array_header_t **chunks,
+                      void *baton,
+                      apr_pool_t *result_pool)
+{
+  struct blame_diff_baton *db = baton;
+  const svn_diff__blame_chunk_t *walk;
+
+  *chunks = apr_array_make(result_pool, 16,
+                           sizeof(svn_repos__blame_chunk_t));
+  for (walk = db->chain->blame; walk; walk = walk->next)
+    {
+      svn_repos__blame_chunk_t *chunk = apr_array_push(*chunks);
+
+      chunk->line_start = walk->start;
+      chunk->version = *(const int *)walk->rev;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+
+/* If FBB->needs_header is true, send the "<S:file-blame-report>" start
+   tag and set FBB->needs_header to zero.  Else do nothing.
+   Like the one in file-revs.c. */
+static svn_error_t *
+maybe_send_header(struct file_blame_baton *fbb)
+{
+  if (fbb->needs_header)
+    {
+      SVN_ERR(dav_svn__brigade_puts(fbb->bb, fbb->output,
+                                    DAV_XML_HEADER DEBUG_CR
+                                    "<S:file-blame-report xmlns:S=\""
+                                    SVN_XML_NAMESPACE "\" "
+                                    "xmlns:D=\"DAV:\">" DEBUG_CR));
+      fbb->needs_header = FALSE;
+    }
+  return SVN_NO_ERROR;
+}
+
+
+/* This implements the svn_repos__blame_rev_func_t interface. */
+static svn_error_t *
+blame_rev_func(void *baton,
+               const char *path,
+               svn_revnum_t revision,
+               apr_hash_t *rev_props,
+               apr_pool_t *scratch_pool)
+{
+  struct file_blame_baton *fbb = baton;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_hash_index_t *hi;
+
+  SVN_ERR(maybe_send_header(fbb));
+
+  SVN_ERR(dav_svn__brigade_printf(fbb->bb, fbb->output,
+                                  "<S:blame-rev path=\"%s\" rev=\"%ld\">"
+                                  DEBUG_CR,
+                                  apr_xml_quote_string(scratch_pool, path, 1),
+                                  revision));
+
+  for (hi = apr_hash_first(scratch_pool, rev_props); hi;
+       hi = apr_hash_next(hi))
+    {
+      const char *name = apr_hash_this_key(hi);
+      const svn_string_t *val = apr_hash_this_val(hi);
+
+      svn_pool_clear(iterpool);
+      name = apr_xml_quote_string(iterpool, name, 1);
+      if (svn_xml_is_xml_safe(val->data, val->len))
+        {
+          svn_stringbuf_t *tmp = NULL;
+
+          svn_xml_escape_cdata_string(&tmp, val, iterpool);
+          SVN_ERR(dav_svn__brigade_printf(fbb->bb, fbb->output,
+                                          "<S:rev-prop name=\"%s\">%s"
+                                          "</S:rev-prop>" DEBUG_CR,
+                                          name, tmp->data));
+        }
+      else
+        {
+          val = svn_base64_encode_string2(val, TRUE, iterpool);
+          SVN_ERR(dav_svn__brigade_printf(fbb->bb, fbb->output,
+                                          "<S:rev-prop name=\"%s\" "
+                                          "encoding=\"base64\">%s"
+                                          "</S:rev-prop>" DEBUG_CR,
+                                          name, val->data));
+        }
+    }
+  svn_pool_destroy(iterpool);
+
+  return svn_error_trace(dav_svn__brigade_puts(fbb->bb, fbb->output,
+                                               "</S:blame-rev>" DEBUG_CR));
+}
+
+
+/* This implements the svn_repos__blame_chunk_func_t interface. */
+static svn_error_t *
+blame_chunk_func(void *baton,
+                 apr_int64_t line_start,
+                 svn_revnum_t revision,
+                 apr_pool_t *scratch_pool)
+{
+  struct file_blame_baton *fbb = baton;
+
+  SVN_ERR(maybe_send_header(fbb));
+
+  if (SVN_IS_VALID_REVNUM(revision))
+    return svn_error_trace(dav_svn__brigade_printf(
+                             fbb->bb, fbb->output,
+                             "<S:blame-lines line-start=\"%" APR_INT64_T_FMT
+                             "\" rev=\"%ld\"/>" DEBUG_CR,
+                             line_start, revision));
+  else
+    return svn_error_trace(dav_svn__brigade_printf(
+                             fbb->bb, fbb->output,
+                             "<S:blame-lines line-start=\"%" APR_INT64_T_FMT
+                             "\"/>" DEBUG_CR,
+                             line_start));
+}
+
+
+/* Send the contents of the file at ABS_PATH in REVISION of the repository
+   of RESOURCE as a base64-encoded <S:contents> element. */
+static svn_error_t *
+send_contents(struct file_blame_baton *fbb,
+              const dav_resource *resource,
+              const char *abs_path,
+              svn_revnum_t revision,
+              apr_pool_t *pool)
+{
+  svn_fs_root_t *root;
+  svn_stream_t *contents;
+
+  SVN_ERR(svn_fs_revision_root(&root, resource->info->repos->fs, revision,
+                               pool));
+  SVN_ERR(svn_fs_file_contents(&contents, root, abs_path, pool));
+
+  SVN_ERR(maybe_send_header(fbb));
+  SVN_ERR(dav_svn__brigade_puts(fbb->bb, fbb->output, "<S:contents>"));
+  SVN_ERR(svn_stream_copy3(contents,
+                           dav_svn__make_base64_output_stream(fbb->bb,
+                                                              fbb->output,
+                                                              pool),
+                           NULL, NULL, pool));
+  return svn_error_trace(dav_svn__brigade_puts(fbb->bb, fbb->output,
+                                               "</S:contents>" DEBUG_CR));
+}
+
+
+/* Respond to a client request for a REPORT of type file-blame-report for
+   the RESOURCE.  Get request body from DOC and send result to OUTPUT. */
+dav_error *
+dav_svn__file_blame_report(const dav_resource *resource,
+                           const apr_xml_doc *doc,
+                           dav_svn__output *output)
+{
+  svn_error_t *serr;
+  dav_error *derr = NULL;
+  apr_xml_elem *child;
+  int ns;
+  struct file_blame_baton fbb;
+  struct blame_diff_baton db;
+  svn_repos__blame_diff_t diff;
+  dav_svn__authz_read_baton arb;
+  const char *abs_path = NULL;
+  svn_diff_file_options_t *diff_options;
+
+  /* These get determined from the request document. */
+  svn_revnum_t start = SVN_INVALID_REVNUM;
+  svn_revnum_t end = SVN_INVALID_REVNUM;
+
+  /* Construct the authz read check baton. */
+  arb.r = resource->info->r;
+  arb.repos = resource->info->repos;
+
+  /* Sanity check. */
+  if (!resource->info->repos_path)
+    return dav_svn__new_error(resource->pool, HTTP_BAD_REQUEST, 0, 0,
+                              "The request does not specify a repository path");
+  ns = dav_svn__find_ns(doc->namespaces, SVN_XML_NAMESPACE);
+  if (ns == -1)
+    {
+      return dav_svn__new_error_svn(resource->pool, HTTP_BAD_REQUEST, 0, 0,
+                                    "The request does not contain the 'svn:' "
+                                    "namespace, so it is not going to have "
+                                    "certain required elements");
+    }
+
+  diff_options = svn_diff_file_options_create(resource->pool);
+
+  /* Get request information. */
+  for (child = doc->root->first_child; child != NULL; child = child->next)
+    {
+      /* if this element isn't one of ours, then skip it */
+      if (child->ns != ns)
+        continue;
+
+      if (strcmp(child->name, "start-revision") == 0)
+        start = SVN_STR_TO_REV(dav_xml_get_cdata(child, resource->pool, 1));
+      else if (strcmp(child->name, "end-revision") == 0)
+        end = SVN_STR_TO_REV(dav_xml_get_cdata(child, resource->pool, 1));
+      else if (strcmp(child->name, "ignore-space") == 0)
+        {
+          const char *word = dav_xml_get_cdata(child, resource->pool, 1);
+
+          if (strcmp(word, "change") == 0)
+            diff_options->ignore_space = svn_diff_file_ignore_space_change;
+          else if (strcmp(word, "all") == 0)
+            diff_options->ignore_space = svn_diff_file_ignore_space_all;
+          else if (strcmp(word, "none") != 0)
+            return dav_svn__new_error_svn(resource->pool, HTTP_BAD_REQUEST,
+                                          0, 0,
+                                          "Invalid ignore-space value");
+        }
+      else if (strcmp(child->name, "ignore-eol-style") == 0)
+        diff_options->ignore_eol_style = TRUE; /* presence indicates
+                                                  positivity */
+      else if (strcmp(child->name, "patience") == 0)
+        diff_options->patience = TRUE;
+      else if (strcmp(child->name, "path") == 0)
+        {
+          const char *rel_path = dav_xml_get_cdata(child, resource->pool, 0);
+          if ((derr = dav_svn__test_canonical(rel_path, resource->pool)))
+            return derr;
+
+          /* Force REL_PATH to be a relative path, not an fspath. */
+          rel_path = svn_relpath_canonicalize(rel_path, resource->pool);
+
+          /* Append the REL_PATH to the base FS path to get an
+             absolute repository path. */
+          abs_path = svn_fspath__join(resource->info->repos_path, rel_path,
+                                      resource->pool);
+        }
+      /* else unknown element; skip it */
+    }
+
+  /* Check that all parameters are present and valid. */
+  if (! abs_path || ! SVN_IS_VALID_REVNUM(end))
+    return dav_svn__new_error_svn(resource->pool, HTTP_BAD_REQUEST, 0, 0,
+                                  "Not all parameters passed");
+
+  fbb.bb = apr_brigade_create(resource->pool,
+                              dav_svn__output_get_bucket_alloc(output));
+  fbb.output = output;
+  fbb.needs_header = TRUE;
+
+  db.chain = svn_diff__blame_chain_create(resource->pool);
+  db.options = diff_options;
+  diff.add_file = blame_diff_add_file;
+  diff.get_chunks = blame_diff_get_chunks;
+  diff.options_key = apr_psprintf(resource->pool, "%d%c%c",
+                                  (int)diff_options->ignore_space,
+                                  diff_options->ignore_eol_style ? 'e' : '-',
+                                  diff_options->patience ? 'p' : '-');
+  diff.baton = &db;
+
+  /* blame_rev_func will send header first time it is called. */
+
+  /* Blame the file and send the result, followed by the text that the
+     line numbers refer to. */
+  serr = svn_repos__get_file_blame(resource->info->repos->repos,
+                                   abs_path, start, end, &diff,
+                                   dav_svn__authz_read_func(&arb), &arb,
+                                   blame_rev_func, blame_chunk_func, &fbb,
+                                   resource->pool);
+  if (! serr)
+    serr = send_contents(&fbb, resource, abs_path, end, resource->pool);
+
+  if (serr)
+    {
+      /* We don't 'goto cleanup' for the same reason as in
+         dav_svn__file_revs_report(). */
+      return (dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                   NULL, resource->pool));
+    }
+
+  if ((serr = dav_svn__brigade_puts(fbb.bb, fbb.output,
+                                    "</S:file-blame-report>" DEBUG_CR)))
+    {
+      derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                  "Error ending REPORT response",
+                                  resource->pool);
+      goto cleanup;
+    }
+
+ cleanup:
+
+  /* We've detected a 'high level' svn action to log. */
+  dav_svn__operational_log(resource->info,
+                           svn_log__get_file_blame(abs_path, start, end,
+                                                   resource->pool));
+
+  return dav_svn__final_flush_or_error(resource->info->r, fbb.bb, output,
+                                       derr, resource->pool);
+}
@@ -46,6 +46,7 @@
 
 #include "private/svn_cmdline_private.h"
 #include "private/svn_opt_private.h"
+#include "private/svn_repos_private.h"
 #include "private/svn_sorts_private.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_cmdline_private.h"
@@ -159,7 +160,9 @@ enum svnadmin__cmdline_options_t
     svnadmin__normalize_props,
     svnadmin__exclude,
     svnadmin__include,
-    svnadmin__glob
+    svnadmin__glob,
+    svnadmin__jobs,
+    svnadmin__bulk
   };
 
 /* Option codes and descriptions.
@@ -298,6 +301,17 @@ static const apr_getopt_option_t options_table[] =
         "                             Character '/' is not treated specially, so\n"
         "                             pattern /*/foo matches paths /a/foo and /a/b/foo.") },
 
+    {"jobs",          svnadmin__jobs, 1,
+     N_("use up to ARG threads to dump the revisions\n"
+        "                             (default: 1)")},
+
+    {"bulk",          svnadmin__bulk, 0,
+     N_("flush to disk and update the rep-cache only\n"
+        "                             every 1000 revisions (faster, but an\n"
+        "                             unclean shutdown can leave the repository\n"
+        "                             inconsistent until it has been recovered\n"
+        "                             and its rep-cache has been rebuilt)")},
+
     {NULL}
   };
 
@@ -382,9 +396,13 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "Using --exclude or --include gives results equivalent to authz-based\n"
     "path exclusions. In particular, when the source of a copy is\n"
     "excluded, the copy is transformed into an add (unlike in 'svndumpfilter').\n"
+    "\n"), N_(
+    "Using --jobs dumps segments of the revision range in parallel and\n"
+    "writes them to the output in order.  The segments are buffered in\n"
+    "temporary files.  The output is the same as without --jobs.\n"
    )},
   {'r', svnadmin__incremental, svnadmin__deltas, 'q', 'M', 'F',
-   svnadmin__exclude, svnadmin__include, svnadmin__glob },
+   svnadmin__exclude, svnadmin__include, svnadmin__glob, svnadmin__jobs },
   {{'F', N_("write to file ARG instead of stdout")}} },
 
   {"dump-revprops", subcommand_dump_revprops, {0}, {N_(
@@ -465,9 +483,17 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "one specified in the stream.  Progress feedback is sent to stdout.\n"
     "If --revision is specified, limit the loaded revisions to only those\n"
     "in the dump stream whose revision numbers match the specified range.\n"
+    "\n"), N_(
+    "Use --bulk for the initial load of large dumpfiles while no one else\n"
+    "accesses the repository.  It makes FSFS defer flushing the new\n"
+    "revisions to disk and updating the rep-cache until every 1000th\n"
+    "revision and the end of the load, and skips caching data that the\n"
+    "load will not read again.  If the system crashes or loses power\n"
+    "during such a load, the repository may be inconsistent until it has\n"
+    "been repaired with 'svnadmin recover' and 'svnadmin build-repcache'.\n"
    )},
    {'q', 'r', svnadmin__ignore_uuid, svnadmin__force_uuid,
-    svnadmin__ignore_dates,
+    svnadmin__ignore_dates, svnadmin__bulk,
     svnadmin__use_pre_commit_hook, svnadmin__use_post_commit_hook,
     svnadmin__parent_dir, svnadmin__normalize_props,
     svnadmin__bypass_prop_validation, 'M',
@@ -677,18 +703,18 @@ struct svnadmin_opt_state
   apr_array_header_t *exclude;                      /* --exclude */
   apr_array_header_t *include;                      /* --include */
   svn_boolean_t glob;                               /* --pattern */
+  int jobs;                                         /* --jobs */
+  svn_boolean_t bulk;                               /* --bulk */
 
   const char *config_dir;    /* Overriding Configuration Directory */
 };
 
 
-/* Helper to open a repository and set a warning func (so we don't
- * SEGFAULT when libsvn_fs's default handler gets run).  */
-static svn_error_t *
-open_repos(svn_repos_t **repos,
-           const char *path,
-           struct svnadmin_opt_state *opt_state,
-           apr_pool_t *pool)
+/* Return the FS configuration parameters to use with OPT_STATE,
+ * allocated in POOL.  */
+static apr_hash_t *
+get_fs_config(struct svnadmin_opt_state *opt_state,
+              apr_pool_t *pool)
 {
   /* Enable the "block-read" feature (where it applies)? */
   svn_boolean_t use_block_read
@@ -707,8 +733,29 @@ open_repos(svn_repos_t **repos,
   svn_hash_sets(fs_config, SVN_FS_CONFIG_NO_FLUSH_TO_DISK,
                            opt_state->no_flush_to_disk ? "1" : "0");
 
+  /* A bulk load writes lots of data that it never reads back.  Keep it
+     from pushing the data that it does need out of the caches. */
+  if (opt_state->bulk)
+    {
+      svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_BULK_LOAD, "1");
+      svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_FULLTEXTS, "0");
+      svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_REVPROPS, "0");
+    }
+
+  return fs_config;
+}
+
+/* Helper to open a repository and set a warning func (so we don't
+ * SEGFAULT when libsvn_fs's default handler gets run).  */
+static svn_error_t *
+open_repos(svn_repos_t **repos,
+           const char *path,
+           struct svnadmin_opt_state *opt_state,
+           apr_pool_t *pool)
+{
   /* now, open the requested repository */
-  SVN_ERR(svn_repos_open3(repos, path, fs_config, pool, pool));
+  SVN_ERR(svn_repos_open3(repos, path, get_fs_config(opt_state, pool),
+                          pool, pool));
   svn_fs_set_warning_func(svn_repos_fs(*repos), warning_func, NULL);
   return SVN_NO_ERROR;
 }
@@ -1480,14 +1527,27 @@ subcommand_dump(apr_getopt_t *os, void *baton, apr_pool_t *pool)
                                  "cannot be used simultaneously"));
     }
 
-  SVN_ERR(svn_repos_dump_fs4(repos, out_stream, lower, upper,
+  if (opt_state->jobs > 1)
+    SVN_ERR(svn_repos__dump_fs_parallel(
+                             repos, get_fs_config(opt_state, pool),
+                             warning_func, NULL,
+                             out_stream, lower, upper,
                              opt_state->incremental, opt_state->use_deltas,
-                             TRUE, TRUE,
+                             TRUE, TRUE, opt_state->jobs,
                              !opt_state->quiet ? repos_notify_handler : NULL,
                              feedback_stream,
                              filter_baton.prefixes ? dump_filter_func : NULL,
                              &filter_baton,
                              check_cancel, NULL, pool));
+  else
+    SVN_ERR(svn_repos_dump_fs4(repos, out_stream, lower, upper,
+                               opt_state->incremental, opt_state->use_deltas,
+                               TRUE, TRUE,
+                               !opt_state->quiet ? repos_notify_handler : NULL,
+                               feedback_stream,
+                               filter_baton.prefixes ? dump_filter_func : NULL,
+                               &filter_baton,
+                               check_cancel, NULL, pool));
 
   return SVN_NO_ERROR;
 }
@@ -1746,6 +1806,19 @@ subcommand_load(apr_getopt_t *os, void *baton, apr_pool_t *pool)
                            opt_state->quiet ? NULL : repos_notify_handler,
                            feedback_stream, check_cancel, NULL, pool);
 
+  /* Make the revisions loaded so far durable, even if the load failed.
+     Other backends don't support bulk loads and ignore the option. */
+  if (opt_state->bulk)
+    {
+      svn_error_t *err2 = svn_fs_ioctl(svn_repos_fs(repos),
+                                       SVN_FS_FS__IOCTL_BULK_LOAD_CHECKPOINT,
+                                       NULL, NULL, NULL, NULL, pool, pool);
+      if (err2 && err2->apr_err == SVN_ERR_FS_UNRECOGNIZED_IOCTL_CODE)
+        svn_error_clear(err2);
+      else
+        err = svn_error_compose_create(err, err2);
+    }
+
   if (svn_error_find_cause(err, SVN_ERR_BAD_PROPERTY_VALUE_EOL))
     {
       return svn_error_quick_wrap(err,
@@ -3285,6 +3358,9 @@ sub_main(int *exit_code,
       case svnadmin__no_flush_to_disk:
         opt_state.no_flush_to_disk = TRUE;
         break;
+      case svnadmin__bulk:
+        opt_state.bulk = TRUE;
+        break;
       case svnadmin__normalize_props:
         opt_state.normalize_props = TRUE;
         break;
@@ -3305,6 +3381,13 @@ sub_main(int *exit_code,
       case svnadmin__glob:
         opt_state.glob = TRUE;
         break;
+      case svnadmin__jobs:
+        SVN_ERR(svn_cstring_atoi(&opt_state.jobs, opt_arg));
+        if (opt_state.jobs < 1)
+          return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                   _("Invalid number of jobs '%s'"),
+                                   opt_arg);
+        break;
       default:
         {
           SVN_ERR(subcommand_help(NULL, NULL, pool));
@@ -3432,7 +3515,9 @@ sub_main(int *exit_code,
     svn_cache_config_t settings = *svn_cache_config_get();
 
     settings.cache_size = opt_state.memory_cache_size;
-    settings.single_threaded = TRUE;
+
+    /* 'dump --jobs' accesses the cache from several threads. */
+    settings.single_threaded = (opt_state.jobs <= 1);
 
     svn_cache_config_set(&settings);
   }
@@ -127,6 +127,10 @@ struct parse_baton
      SVN_INVALID_REVNUM if none have been loaded. */
   svn_revnum_t oldest_dumpstream_rev;
 
+  /* The youngest revision in the target repository, or
+     SVN_INVALID_REVNUM if we did not ask the server, yet. */
+  svn_revnum_t head_rev;
+
   /* An hash containing specific revision properties to skip while
      loading. */
   apr_hash_t *skip_revprops;
@@ -333,8 +337,12 @@ new_revision_record(void **revision_baton,
   if (rev_str)
     rb->rev = SVN_STR_TO_REV(rev_str);
 
-  SVN_ERR(svn_ra_get_latest_revnum(pb->session, &rb->head_rev_before_commit,
-                                   pool));
+  /* We hold the load lock, so the youngest revision only changes due to
+     our own commits.  Only ask the server once and track it afterwards
+     to save one round trip per revision. */
+  if (! SVN_IS_VALID_REVNUM(pb->head_rev))
+    SVN_ERR(svn_ra_get_latest_revnum(pb->session, &pb->head_rev, pool));
+  rb->head_rev_before_commit = pb->head_rev;
 
   /* FIXME: This is a lame fallback loading multiple segments of dump in
      several separate operations. It is highly susceptible to race conditions.
@@ -910,6 +918,7 @@ commit_callback(const svn_commit_info_t *commit_info,
 
   /* Add the mapping of the dumpstream revision to the committed revision. */
   set_revision_mapping(pb->rev_map, cb->rev, commit_info->revision);
+  pb->head_rev = commit_info->revision;
 
   /* If the incoming dump stream has non-contiguous revisions (e.g. from
      using svndumpfilter --drop-empty-revs without --renumber-revs) then
@@ -1139,6 +1148,7 @@ get_dumpstream_loader(svn_repos_parse_fns3_t **parser_p,
   parse_baton->rev_map = apr_hash_make(pool);
   parse_baton->last_rev_mapped = SVN_INVALID_REVNUM;
   parse_baton->oldest_dumpstream_rev = SVN_INVALID_REVNUM;
+  parse_baton->head_rev = SVN_INVALID_REVNUM;
   parse_baton->skip_revprops = skip_revprops;
   parse_baton->callbacks = &callbacks;
   parse_baton->cb_baton = parse_baton;
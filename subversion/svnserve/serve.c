@@ -47,13 +47,16 @@
 #include "svn_path.h"
 #include "svn_time.h"
 #include "svn_config.h"
+#include "svn_diff.h"
 #include "svn_props.h"
 #include "svn_mergeinfo.h"
 #include "svn_user.h"
 
+#include "private/svn_diff_private.h"
 #include "private/svn_log.h"
 #include "private/svn_mergeinfo_private.h"
 #include "private/svn_ra_svn_private.h"
+#include "private/svn_repos_private.h"
 #include "private/svn_fspath.h"
 
 #ifdef HAVE_UNISTD_H
@@ -1582,6 +1585,51 @@ commit(svn_ra_svn_conn_t *conn,
   return SVN_NO_ERROR;
 }
 
+/* Send CONTENTS over CONN as a series of strings, terminated by the
+   empty string, and close CONTENTS.  Return errors from reading CONTENTS
+   in *READ_ERR and errors from writing to CONN directly.  Use POOL for
+   temporary allocations. */
+static svn_error_t *
+send_file_contents(svn_error_t **read_err,
+                   svn_ra_svn_conn_t *conn,
+                   svn_stream_t *contents,
+                   apr_pool_t *pool)
+{
+  svn_string_t write_str;
+  char buf[4096];
+  apr_size_t len;
+  svn_error_t *err, *write_err;
+
+  err = SVN_NO_ERROR;
+  while (1)
+    {
+      len = sizeof(buf);
+      err = svn_stream_read_full(contents, buf, &len);
+      if (err)
+        break;
+      if (len > 0)
+        {
+          write_str.data = buf;
+          write_str.len = len;
+          SVN_ERR(svn_ra_svn__write_string(conn, pool, &write_str));
+        }
+      if (len < sizeof(buf))
+        {
+          err = svn_stream_close(contents);
+          break;
+        }
+    }
+  write_err = svn_ra_svn__write_cstring(conn, pool, "");
+  if (write_err)
+    {
+      svn_error_clear(err);
+      return write_err;
+    }
+
+  *read_err = err;
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 get_file(svn_ra_svn_conn_t *conn,
          apr_pool_t *pool,
@@ -1595,13 +1643,10 @@ get_file(svn_ra_svn_conn_t *conn,
   svn_stream_t *contents;
   apr_hash_t *props = NULL;
   apr_array_header_t *inherited_props;
-  svn_string_t write_str;
-  char buf[4096];
-  apr_size_t len;
   svn_boolean_t want_props, want_contents;
   apr_uint64_t wants_inherited_props;
   svn_checksum_t *checksum;
-  svn_error_t *err, *write_err;
+  svn_error_t *err;
   int i;
   authz_baton_t ab;
 
@@ -1679,31 +1724,7 @@ get_file(svn_ra_svn_conn_t *conn,
   /* Now send the file's contents. */
   if (want_contents)
     {
-      err = SVN_NO_ERROR;
-      while (1)
-        {
-          len = sizeof(buf);
-          err = svn_stream_read_full(contents, buf, &len);
-          if (err)
-            break;
-          if (len > 0)
-            {
-              write_str.data = buf;
-              write_str.len = len;
-              SVN_ERR(svn_ra_svn__write_string(conn, pool, &write_str));
-            }
-          if (len < sizeof(buf))
-            {
-              err = svn_stream_close(contents);
-              break;
-            }
-        }
-      write_err = svn_ra_svn__write_cstring(conn, pool, "");
-      if (write_err)
-        {
-          svn_error_clear(err);
-          return write_err;
-        }
+      SVN_ERR(send_file_contents(&err, conn, contents, pool));
       SVN_CMD_ERR(err);
       SVN_ERR(svn_ra_svn__write_cmd_response(conn, pool, ""));
     }
@@ -1711,6 +1732,194 @@ get_file(svn_ra_svn_conn_t *conn,
   return SVN_NO_ERROR;
 }
 
+/* Parse the array of path strings PATHS_LIST sent by the client.  Set
+ * *PATHS to the canonical relpaths and *FULL_PATHS to the respective
+ * absolute FS paths in the repository of B.  Allocate them in POOL.
+ */
+static svn_error_t *
+parse_path_list(apr_array_header_t **paths,
+                apr_array_header_t **full_paths,
+                server_baton_t *b,
+                svn_ra_svn__list_t *paths_list,
+                apr_pool_t *pool)
+{
+  int i;
+
+  *paths = apr_array_make(pool, paths_list->nelts, sizeof(const char *));
+  *full_paths = apr_array_make(pool, paths_list->nelts, sizeof(const char *));
+  for (i = 0; i < paths_list->nelts; i++)
+    {
+      svn_ra_svn__item_t *item = &SVN_RA_SVN__LIST_ITEM(paths_list, i);
+      const char *canonical_path;
+
+      if (item->kind != SVN_RA_SVN_STRING)
+        return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                _("Path is not a string"));
+      SVN_ERR(svn_relpath_canonicalize_safe(&canonical_path, NULL,
+                                            item->u.string.data, pool, pool));
+      APR_ARRAY_PUSH(*paths, const char *) = canonical_path;
+      APR_ARRAY_PUSH(*full_paths, const char *)
+        = svn_fspath__join(b->repository->fs_path->data, canonical_path,
+                           pool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Like must_have_access() for read access to all FULL_PATHS.
+ *
+ * There can only be one authentication exchange per command.  So, use
+ * it for the first path that we can't read with the current credentials.
+ * If some path is still not readable afterwards, return an error.
+ */
+static svn_error_t *
+must_have_read_access_to_all(svn_ra_svn_conn_t *conn,
+                             apr_pool_t *pool,
+                             server_baton_t *b,
+                             const apr_array_header_t *full_paths)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  const char *auth_path = NULL;
+  int i;
+
+  for (i = 0; i < full_paths->nelts; i++)
+    {
+      const char *full_path = APR_ARRAY_IDX(full_paths, i, const char *);
+
+      svn_pool_clear(iterpool);
+      if (! auth_path)
+        auth_path = full_path;
+      if (! lookup_access(iterpool, b, svn_authz_read, full_path, FALSE))
+        {
+          auth_path = full_path;
+          break;
+        }
+    }
+
+  SVN_ERR(must_have_access(conn, pool, b, svn_authz_read, auth_path, FALSE));
+
+  for (i = 0; i < full_paths->nelts; i++)
+    {
+      const char *full_path = APR_ARRAY_IDX(full_paths, i, const char *);
+
+      svn_pool_clear(iterpool);
+      if (! lookup_access(iterpool, b, svn_authz_read, full_path, FALSE))
+        return svn_error_create(SVN_ERR_RA_SVN_CMD_ERR,
+                                error_create_and_log(SVN_ERR_RA_NOT_AUTHORIZED,
+                                                     NULL, NULL, b),
+                                NULL);
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Send the get-files entry for the file at FULL_PATH in ROOT, followed by
+ * its contents if WANT_CONTENTS is set.  PATH is the path as requested
+ * by the client, REV the revision of ROOT and AB the authz baton to use.
+ * Use POOL for temporary allocations.
+ */
+static svn_error_t *
+send_file_entry(svn_ra_svn_conn_t *conn,
+                authz_baton_t *ab,
+                svn_fs_root_t *root,
+                const char *path,
+                const char *full_path,
+                svn_revnum_t rev,
+                svn_boolean_t want_props,
+                svn_boolean_t want_contents,
+                apr_pool_t *pool)
+{
+  svn_checksum_t *checksum;
+  apr_hash_t *props = NULL;
+  svn_stream_t *contents;
+  svn_error_t *err;
+
+  /* Fetch everything that might fail before starting the entry. */
+  SVN_ERR(svn_fs_file_checksum(&checksum, svn_checksum_md5, root,
+                               full_path, TRUE, pool));
+  if (want_props)
+    SVN_ERR(get_props(&props, NULL, ab, root, full_path, pool));
+  if (want_contents)
+    SVN_ERR(svn_fs_file_contents(&contents, root, full_path, pool));
+
+  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "c(?c)r(!", path,
+                                  svn_checksum_to_cstring_display(checksum,
+                                                                  pool),
+                                  rev));
+  SVN_ERR(svn_ra_svn__write_proplist(conn, pool, props));
+  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "!))"));
+
+  if (want_contents)
+    {
+      SVN_ERR(send_file_contents(&err, conn, contents, pool));
+      return svn_error_trace(err);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+get_files(svn_ra_svn_conn_t *conn,
+          apr_pool_t *pool,
+          svn_ra_svn__list_t *params,
+          void *baton)
+{
+  server_baton_t *b = baton;
+  svn_ra_svn__list_t *paths_list;
+  apr_array_header_t *paths, *full_paths;
+  svn_revnum_t rev;
+  svn_boolean_t want_props, want_contents;
+  svn_fs_root_t *root;
+  apr_pool_t *iterpool;
+  svn_error_t *err = SVN_NO_ERROR, *write_err;
+  int i;
+  authz_baton_t ab;
+
+  ab.server = b;
+  ab.conn = conn;
+
+  /* Parse arguments. */
+  SVN_ERR(svn_ra_svn__parse_tuple(params, "l(?r)bb", &paths_list, &rev,
+                                  &want_props, &want_contents));
+  SVN_ERR(parse_path_list(&paths, &full_paths, b, paths_list, pool));
+
+  /* Check authorizations */
+  SVN_ERR(must_have_read_access_to_all(conn, pool, b, full_paths));
+
+  if (!SVN_IS_VALID_REVNUM(rev))
+    SVN_CMD_ERR(svn_fs_youngest_rev(&rev, b->repository->fs, pool));
+
+  SVN_ERR(log_command(b, conn, pool, "%s",
+                      svn_log__get_files(full_paths, rev, want_contents,
+                                         want_props, pool)));
+
+  SVN_CMD_ERR(svn_fs_revision_root(&root, b->repository->fs, rev, pool));
+
+  /* Send the files one by one and stop at the first error. */
+  iterpool = svn_pool_create(pool);
+  for (i = 0; i < paths->nelts && !err; i++)
+    {
+      svn_pool_clear(iterpool);
+      err = send_file_entry(conn, &ab, root,
+                            APR_ARRAY_IDX(paths, i, const char *),
+                            APR_ARRAY_IDX(full_paths, i, const char *),
+                            rev, want_props, want_contents, iterpool);
+    }
+  svn_pool_destroy(iterpool);
+
+  /* Finish response. */
+  write_err = svn_ra_svn__write_word(conn, pool, "done");
+  if (write_err)
+    {
+      svn_error_clear(err);
+      return write_err;
+    }
+  SVN_CMD_ERR(err);
+
+  return svn_error_trace(svn_ra_svn__write_cmd_response(conn, pool, ""));
+}
+
 /* Translate all the words in DIRENT_FIELDS_LIST into the flags in
  * DIRENT_FIELDS_P.  If DIRENT_FIELDS_LIST is NULL, set all flags. */
 static svn_error_t *
@@ -2622,6 +2831,79 @@ stat_cmd(svn_ra_svn_conn_t *conn,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+stat_many(svn_ra_svn_conn_t *conn,
+          apr_pool_t *pool,
+          svn_ra_svn__list_t *params,
+          void *baton)
+{
+  server_baton_t *b = baton;
+  svn_ra_svn__list_t *paths_list;
+  apr_array_header_t *paths, *full_paths;
+  svn_revnum_t rev;
+  svn_fs_root_t *root;
+  apr_pool_t *iterpool;
+  svn_error_t *err = SVN_NO_ERROR, *write_err;
+  int i;
+
+  SVN_ERR(svn_ra_svn__parse_tuple(params, "l(?r)", &paths_list, &rev));
+  SVN_ERR(parse_path_list(&paths, &full_paths, b, paths_list, pool));
+
+  /* Check authorizations */
+  SVN_ERR(must_have_read_access_to_all(conn, pool, b, full_paths));
+
+  if (!SVN_IS_VALID_REVNUM(rev))
+    SVN_CMD_ERR(svn_fs_youngest_rev(&rev, b->repository->fs, pool));
+
+  SVN_ERR(log_command(b, conn, pool, "%s",
+                      svn_log__stat_many(full_paths, rev, pool)));
+
+  SVN_CMD_ERR(svn_fs_revision_root(&root, b->repository->fs, rev, pool));
+
+  /* Send one entry per path, in request order. */
+  iterpool = svn_pool_create(pool);
+  for (i = 0; i < paths->nelts; i++)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+      const char *full_path = APR_ARRAY_IDX(full_paths, i, const char *);
+      const char *cdate;
+      svn_dirent_t *dirent;
+
+      svn_pool_clear(iterpool);
+      err = svn_repos_stat(&dirent, root, full_path, iterpool);
+      if (err)
+        break;
+
+      if (dirent == NULL)
+        {
+          SVN_ERR(svn_ra_svn__write_tuple(conn, iterpool, "c()", path));
+          continue;
+        }
+
+      cdate = (dirent->time == (time_t) -1) ? NULL
+        : svn_time_to_cstring(dirent->time, iterpool);
+
+      SVN_ERR(svn_ra_svn__write_tuple(conn, iterpool, "c((wnbr(?c)(?c)))",
+                                      path,
+                                      svn_node_kind_to_word(dirent->kind),
+                                      (apr_uint64_t) dirent->size,
+                                      dirent->has_props, dirent->created_rev,
+                                      cdate, dirent->last_author));
+    }
+  svn_pool_destroy(iterpool);
+
+  /* Finish response. */
+  write_err = svn_ra_svn__write_word(conn, pool, "done");
+  if (write_err)
+    {
+      svn_error_clear(err);
+      return write_err;
+    }
+  SVN_CMD_ERR(err);
+
+  return svn_error_trace(svn_ra_svn__write_cmd_response(conn, pool, ""));
+}
+
 static svn_error_t *
 get_locations(svn_ra_svn_conn_t *conn,
               apr_pool_t *pool,
@@ -2948,6 +3230,184 @@ get_file_revs(svn_ra_svn_conn_t *conn,
   return SVN_NO_ERROR;
 }
 
+/* Baton for blame_diff_add_file() and blame_diff_get_chunks(). */
+typedef struct blame_diff_baton_t
+{
+  /* The blame for the latest version compared so far.  The revision
+     descriptors are the version indexes as ints. */
+  svn_diff__blame_chain_t *chain;
+
+  /* How to compare the versions. */
+  const svn_diff_file_options_t *options;
+} blame_diff_baton_t;
+
+/* Implements svn_repos__blame_diff_t.add_file() using libsvn_diff. */
+static svn_error_t *
+blame_diff_add_file(void *baton,
+                    const char *last_file,
+                    const char *file,
+                    int version,
+                    apr_pool_t *scratch_pool)
+{
+  blame_diff_baton_t *db = baton;
+  int *rev = apr_palloc(db->chain->pool, sizeof(*rev));
+
+  *rev = version;
+  return svn_error_trace(svn_diff__blame_add_file(db->chain, last_file,
+                                                  file, rev, db->options,
+                                                  NULL, NULL,
+                                                  scratch_pool));
+}
+
+/* Implements svn_repos__blame_diff_t.get_chunks() using libsvn_diff. */
+static svn_error_t *
+blame_diff_get_chunks(apr_array_header_t **chunks,
+                      void *baton,
+                      apr_pool_t *result_pool)
+{
+  blame_diff_baton_t *db = baton;
+  const svn_diff__blame_chunk_t *walk;
+
+  *chunks = apr_array_make(result_pool, 16,
+                           sizeof(svn_repos__blame_chunk_t));
+  for (walk = db->chain->blame; walk; walk = walk->next)
+    {
+      svn_repos__blame_chunk_t *chunk = apr_array_push(*chunks);
+
+      chunk->line_start = walk->start;
+      chunk->version = *(const int *)walk->rev;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* This implements svn_repos__blame_rev_func_t.  Send the get-file-blame
+   entry for a file version to the client connection given by BATON. */
+static svn_error_t *
+file_blame_rev(void *baton,
+               const char *path,
+               svn_revnum_t revision,
+               apr_hash_t *rev_props,
+               apr_pool_t *scratch_pool)
+{
+  svn_ra_svn_conn_t *conn = baton;
+
+  SVN_ERR(svn_ra_svn__write_tuple(conn, scratch_pool, "wcr(!", "rev",
+                                  path, revision));
+  SVN_ERR(svn_ra_svn__write_proplist(conn, scratch_pool, rev_props));
+  SVN_ERR(svn_ra_svn__write_tuple(conn, scratch_pool, "!)"));
+
+  return SVN_NO_ERROR;
+}
+
+/* This implements svn_repos__blame_chunk_func_t.  Send the get-file-blame
+   entry for a range of lines to the client connection given by BATON. */
+static svn_error_t *
+file_blame_lines(void *baton,
+                 apr_int64_t line_start,
+                 svn_revnum_t revision,
+                 apr_pool_t *scratch_pool)
+{
+  svn_ra_svn_conn_t *conn = baton;
+
+  return svn_error_trace(svn_ra_svn__write_tuple(conn, scratch_pool,
+                                                 "wn(?r)", "lines",
+                                                 (apr_uint64_t)line_start,
+                                                 revision));
+}
+
+static svn_error_t *
+get_file_blame(svn_ra_svn_conn_t *conn,
+               apr_pool_t *pool,
+               svn_ra_svn__list_t *params,
+               void *baton)
+{
+  server_baton_t *b = baton;
+  svn_error_t *err, *write_err;
+  svn_revnum_t start_rev, end_rev;
+  const char *path;
+  const char *full_path;
+  const char *canonical_path;
+  apr_uint64_t ignore_space;
+  svn_boolean_t ignore_eol_style;
+  svn_boolean_t patience;
+  svn_diff_file_options_t *diff_options;
+  blame_diff_baton_t db;
+  svn_repos__blame_diff_t diff;
+  svn_fs_root_t *root;
+  svn_stream_t *contents;
+  authz_baton_t ab;
+
+  ab.server = b;
+  ab.conn = conn;
+
+  /* Parse arguments. */
+  SVN_ERR(svn_ra_svn__parse_tuple(params, "crrnbb",
+                                  &path, &start_rev, &end_rev,
+                                  &ignore_space, &ignore_eol_style,
+                                  &patience));
+  SVN_ERR(svn_relpath_canonicalize_safe(&canonical_path, NULL, path,
+                                        pool, pool));
+  full_path = svn_fspath__join(b->repository->fs_path->data, canonical_path,
+                               pool);
+
+  /* Check authorizations */
+  SVN_ERR(must_have_access(conn, pool, b, svn_authz_read,
+                           full_path, FALSE));
+
+  SVN_ERR(log_command(b, conn, pool, "%s",
+                      svn_log__get_file_blame(full_path, start_rev, end_rev,
+                                              pool)));
+
+  diff_options = svn_diff_file_options_create(pool);
+  diff_options->ignore_eol_style = ignore_eol_style;
+  diff_options->patience = patience;
+  if (ignore_space > svn_diff_file_ignore_space_all)
+    err = svn_error_createf(SVN_ERR_INCORRECT_PARAMS, NULL,
+                            _("Invalid ignore-space value %"
+                              APR_UINT64_T_FMT),
+                            ignore_space);
+  else
+    {
+      diff_options->ignore_space = (svn_diff_file_ignore_space_t)ignore_space;
+
+      db.chain = svn_diff__blame_chain_create(pool);
+      db.options = diff_options;
+      diff.add_file = blame_diff_add_file;
+      diff.get_chunks = blame_diff_get_chunks;
+      diff.options_key = apr_psprintf(pool, "%d%c%c",
+                                      (int)diff_options->ignore_space,
+                                      ignore_eol_style ? 'e' : '-',
+                                      patience ? 'p' : '-');
+      diff.baton = &db;
+
+      err = svn_repos__get_file_blame(b->repository->repos, full_path,
+                                      start_rev, end_rev, &diff,
+                                      authz_check_access_cb_func(b), &ab,
+                                      file_blame_rev, file_blame_lines, conn,
+                                      pool);
+    }
+
+  write_err = svn_ra_svn__write_word(conn, pool, "done");
+  if (write_err)
+    {
+      svn_error_clear(err);
+      return write_err;
+    }
+  SVN_CMD_ERR(err);
+
+  /* Send the text that the line numbers refer to. */
+  SVN_CMD_ERR(svn_fs_revision_root(&root, b->repository->fs, end_rev, pool));
+  SVN_CMD_ERR(svn_fs_file_contents(&contents, root, full_path, pool));
+  SVN_ERR(svn_ra_svn__write_cmd_response(conn, pool, ""));
+
+  SVN_ERR(send_file_contents(&err, conn, contents, pool));
+  SVN_CMD_ERR(err);
+  SVN_ERR(svn_ra_svn__write_cmd_response(conn, pool, ""));
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 lock(svn_ra_svn_conn_t *conn,
      apr_pool_t *pool,
@@ -3790,6 +4250,7 @@ static const svn_ra_svn__cmd_entry_t main_commands[] = {
   { "rev-prop",        rev_prop },
   { "commit",          commit },
   { "get-file",        get_file },
+  { "get-files",       get_files },
   { "get-dir",         get_dir },
   { "update",          update },
   { "switch",          switch_cmd },
@@ -3799,9 +4260,11 @@ static const svn_ra_svn__cmd_entry_t main_commands[] = {
   { "log",             log_cmd },
   { "check-path",      check_path },
   { "stat",            stat_cmd },
+  { "stat-many",       stat_many },
   { "get-locations",   get_locations },
   { "get-location-segments",   get_location_segments },
   { "get-file-revs",   get_file_revs },
+  { "get-file-blame",  get_file_blame },
   { "lock",            lock },
   { "lock-many",       lock_many },
   { "unlock",          unlock },
@@ -4239,7 +4702,7 @@ construct_server_baton(server_baton_t **baton,
    * send an empty mechlist. */
   if (params->compression_level > 0)
     SVN_ERR(svn_ra_svn__write_cmd_response(conn, scratch_pool,
-                                           "nn()(wwwwwwwwwwwww)",
+                                           "nn()(wwwwwwwwwwwwwww)",
                                            (apr_uint64_t) 2, (apr_uint64_t) 2,
                                            SVN_RA_SVN_CAP_EDIT_PIPELINE,
                                            SVN_RA_SVN_CAP_SVNDIFF1,
@@ -4253,11 +4716,13 @@ construct_server_baton(server_baton_t **baton,
                                            SVN_RA_SVN_CAP_INHERITED_PROPS,
                                            SVN_RA_SVN_CAP_EPHEMERAL_TXNPROPS,
                                            SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE,
-                                           SVN_RA_SVN_CAP_LIST
+                                           SVN_RA_SVN_CAP_LIST,
+                                           SVN_RA_SVN_CAP_BATCHED_FETCH,
+                                           SVN_RA_SVN_CAP_FILE_BLAME
                                            ));
   else
     SVN_ERR(svn_ra_svn__write_cmd_response(conn, scratch_pool,
-                                           "nn()(wwwwwwwwwww)",
+                                           "nn()(wwwwwwwwwwwww)",
                                            (apr_uint64_t) 2, (apr_uint64_t) 2,
                                            SVN_RA_SVN_CAP_EDIT_PIPELINE,
                                            SVN_RA_SVN_CAP_ABSENT_ENTRIES,
@@ -4269,7 +4734,9 @@ construct_server_baton(server_baton_t **baton,
                                            SVN_RA_SVN_CAP_INHERITED_PROPS,
                                            SVN_RA_SVN_CAP_EPHEMERAL_TXNPROPS,
                                            SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE,
-                                           SVN_RA_SVN_CAP_LIST
+                                           SVN_RA_SVN_CAP_LIST,
+                                           SVN_RA_SVN_CAP_BATCHED_FETCH,
+                                           SVN_RA_SVN_CAP_FILE_BLAME
                                            ));
 
   /* Read client response, which we assume to be in version 2 format:
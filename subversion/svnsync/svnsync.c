@@ -1398,7 +1398,13 @@ replay_rev_finished(svn_revnum_t revision,
 
   rev_str = svn_string_createf(subpool, "%ld", revision);
 
-  /* Ok, we're done, bring the last-merged-rev property up to date. */
+  /* Ok, we're done, bring the last-merged-rev property up to date.
+
+     We leave the currently copying prop in place.  The next revision
+     will overwrite it anyway and do_synchronize() drops it at the end.
+     A currently copying prop equal to last-merged-rev is a consistent
+     state that the next sync run knows how to handle.  This saves one
+     round trip to the destination per revision. */
   SVN_ERR(svn_ra_change_rev_prop2(
            rb->to_session,
            0,
@@ -1407,14 +1413,6 @@ replay_rev_finished(svn_revnum_t revision,
            rev_str,
            subpool));
 
-  /* And finally drop the currently copying prop, since we're done
-     with this revision. */
-  SVN_ERR(svn_ra_change_rev_prop2(rb->to_session, 0,
-                                  SVNSYNC_PROP_CURRENTLY_COPYING,
-                                  rb->has_atomic_revprops_capability
-                                    ? &rev_str : NULL,
-                                  NULL, subpool));
-
   /* Notify the user that we copied revision properties. */
   if (! rb->sb->quiet)
     SVN_ERR(log_properties_copied(filtered_count > 0, revision, subpool));
@@ -1438,6 +1436,7 @@ do_synchronize(svn_ra_session_t *to_session,
   svn_revnum_t from_latest;
   svn_ra_session_t *from_session;
   svn_string_t *currently_copying;
+  const svn_string_t *rev_str;
   svn_revnum_t to_latest, copying, last_merged;
   svn_revnum_t start_revision, end_revision;
   replay_baton_t *rb;
@@ -1560,6 +1559,15 @@ do_synchronize(svn_ra_session_t *to_session,
                               0, TRUE, replay_rev_started,
                               replay_rev_finished, rb, pool));
 
+  /* Finally drop the currently copying prop that replay_rev_finished()
+     left behind, since we're done with the last revision. */
+  rev_str = svn_string_createf(pool, "%ld", rb->current_revision);
+  SVN_ERR(svn_ra_change_rev_prop2(to_session, 0,
+                                  SVNSYNC_PROP_CURRENTLY_COPYING,
+                                  rb->has_atomic_revprops_capability
+                                    ? &rev_str : NULL,
+                                  NULL, pool));
+
   SVN_ERR(log_properties_normalized(rb->normalized_rev_props_count
                                       + normalized_rev_props_count,
                                     rb->normalized_node_props_count,
@@ -4061,6 +4061,65 @@ def build_repcache(sbox):
   if new_rep_cache != rep_cache:
     raise svntest.Failure
 
+def dump_jobs(sbox):
+  "svnadmin dump --jobs"
+
+  sbox.build()
+  for i in range(12):
+    sbox.simple_append('iota', 'line %d\n' % i)
+    sbox.simple_propset('prop', 'value %d' % i, 'A/mu')
+    sbox.simple_commit()
+  sbox.simple_copy('A/B', 'A/B2')
+  sbox.simple_rm('A/D/G')
+  sbox.simple_commit()
+
+  # Parallel dumps must be identical to serial ones, including the
+  # progress output.  The full range of 15 revisions takes more than
+  # one round of segments with either number of jobs.
+  for args in [[], ['--incremental'], ['--deltas'],
+               ['--incremental', '--deltas'], ['-r', '3:HEAD'],
+               ['-r', '3:HEAD', '--incremental', '--deltas']]:
+    exit_code, expected_dump, expected_err = \
+      svntest.main.run_svnadmin('dump', sbox.repo_dir, *args)
+    svntest.verify.verify_exit_code(None, exit_code, 0)
+
+    for jobs in ['2', '3']:
+      exit_code, actual_dump, actual_err = \
+        svntest.main.run_svnadmin('dump', sbox.repo_dir, '--jobs', jobs,
+                                  *args)
+      svntest.verify.verify_exit_code(None, exit_code, 0)
+
+      if actual_dump != expected_dump or actual_err != expected_err:
+        raise svntest.Failure("Parallel dump with %s and %s jobs differs"
+                              % (args, jobs))
+
+def load_bulk(sbox):
+  "svnadmin load --bulk"
+
+  sbox.build(create_wc=False)
+  exit_code, dump, errput = svntest.main.run_svnadmin('dump', '--quiet',
+                                                      sbox.repo_dir)
+  svntest.verify.verify_exit_code(None, exit_code, 0)
+
+  # Load into a new repository and expect the same contents.
+  sbox2 = sbox.clone_dependent()
+  sbox2.build(create_wc=False, empty=True)
+  load_and_verify_dumpstream(sbox2, None, [], None, False, dump, '--bulk')
+  svntest.actions.run_and_verify_svnadmin(None, [], 'verify', '--quiet',
+                                          sbox2.repo_dir)
+
+  exit_code, dump2, errput = svntest.main.run_svnadmin('dump', '--quiet',
+                                                       sbox2.repo_dir)
+  svntest.verify.verify_exit_code(None, exit_code, 0)
+  svntest.verify.compare_dump_files(None, None, dump, dump2)
+
+  if svntest.main.is_fs_type_fsfs() and svntest.main.fs_has_rep_sharing() \
+     and svntest.main.python_sqlite_can_read_without_rowid():
+    # The deferred rep-cache.db transaction must have been committed.
+    if set(read_rep_cache(sbox2.repo_dir).keys()) \
+       != set(read_rep_cache(sbox.repo_dir).keys()):
+      raise svntest.Failure("rep-cache differs after bulk load")
+
 
 ########################################################################
 # Run the tests
@@ -4142,6 +4201,8 @@ test_list = [ None,
               dump_include_copied_directory,
               load_normalize_node_props,
               build_repcache,
+              dump_jobs,
+              load_bulk,
              ]
 
 if __name__ == '__main__':
@@ -587,6 +587,72 @@ def up_to_date_sync(sbox):
   svntest.actions.run_and_verify_svnsync([], [],
                                          "synchronize", dest_sbox.repo_url)
 
+def interrupted_sync(sbox):
+  "resume an interrupted sync"
+
+  sbox.build("svnsync-interrupted")
+
+  # r2 to r4: modify a file.
+  for i in range(2, 5):
+    sbox.simple_append('iota', 'line %d\n' % i)
+    sbox.simple_commit(message='r%d' % i)
+
+  exit_code, output, errput = svntest.main.run_svnlook("uuid", sbox.repo_dir)
+  src_uuid = output[0].strip()
+
+  dest_sbox = sbox.clone_dependent()
+  dest_sbox.build(create_wc=False, empty=True)
+  svntest.actions.enable_revprop_changes(dest_sbox.repo_dir)
+  run_init(dest_sbox.repo_url, sbox.repo_url)
+
+  # Let the sync fail when copying the revprops of r3, i.e. after r3
+  # has been committed to the mirror.
+  hook_path = svntest.main.get_pre_revprop_change_hook_path(dest_sbox.repo_dir)
+  svntest.main.create_python_hook_script(hook_path,
+                                         'import sys\n'
+                                         'if sys.argv[2] == "3":\n'
+                                         '  sys.exit(1)\n'
+                                         'sys.exit(0)\n')
+  run_sync(dest_sbox.repo_url, expected_error=svntest.verify.AnyOutput)
+
+  exit_code, output, errput = svntest.main.run_svnlook("youngest",
+                                                       dest_sbox.repo_dir)
+  if output != ['3\n']:
+    raise svntest.Failure("Mirror HEAD is %s, expected 3" % output)
+  expected_out = ['Source URL: %s\n' % sbox.repo_url,
+                  'Source Repository UUID: %s\n' % src_uuid,
+                  'Last Merged Revision: 2\n',
+                  ]
+  svntest.actions.run_and_verify_svnsync(expected_out, [],
+                                         "info", dest_sbox.repo_url)
+
+  # Resume.  This must complete r3, sync r4 and leave no trace of the
+  # revision being copied.
+  svntest.actions.enable_revprop_changes(dest_sbox.repo_dir)
+  run_sync(dest_sbox.repo_url)
+
+  exit_code, output, errput = svntest.main.run_svnlook("youngest",
+                                                       dest_sbox.repo_dir)
+  if output != ['4\n']:
+    raise svntest.Failure("Mirror HEAD is %s, expected 4" % output)
+  expected_out[2] = 'Last Merged Revision: 4\n'
+  svntest.actions.run_and_verify_svnsync(expected_out, [],
+                                         "info", dest_sbox.repo_url)
+
+  exit_code, output, errput = svntest.main.run_svnlook("proplist",
+                                                       "--revprop", "-r0",
+                                                       dest_sbox.repo_dir)
+  for line in output:
+    if 'svn:sync-currently-copying' in line:
+      raise svntest.Failure("svn:sync-currently-copying left behind")
+
+  # Both repositories should have the same revprops on r3.
+  for repo_dir in (sbox.repo_dir, dest_sbox.repo_dir):
+    exit_code, output, errput = svntest.main.run_svnlook("log", "-r3",
+                                                         repo_dir)
+    if output != ['r3\n']:
+      raise svntest.Failure("Unexpected log message %s for r3" % output)
+
 
 ########################################################################
 # Run the tests
@@ -625,6 +691,7 @@ test_list = [ None,
               fd_leak_sync_from_serf_to_local, # calls setrlimit
               mergeinfo_contains_r0,
               up_to_date_sync,
+              interrupted_sync,
              ]
 
 if __name__ == '__main__':
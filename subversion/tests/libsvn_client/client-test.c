@@ -1446,6 +1446,445 @@ test_copy_pin_externals_select_subtree(const svn_test_opts_t *opts, apr_pool_t *
   return SVN_NO_ERROR;
 }
 
+/* Set *OUTPUT to the diff of the local modifications in the working copy
+   at WC_ABSPATH as produced by the diff writer with the diff OPTIONS.
+   Let the writer use worker threads if PARALLEL is set. */
+static svn_error_t *
+get_wc_diff(svn_stringbuf_t **output,
+            const char *wc_abspath,
+            const apr_array_header_t *options,
+            svn_boolean_t use_git_diff_format,
+            svn_boolean_t parallel,
+            svn_client_ctx_t *ctx,
+            apr_pool_t *pool)
+{
+  svn_diff_tree_processor_t *diff_processor;
+  svn_client__diff_driver_info_t *ddi;
+
+  *output = svn_stringbuf_create_empty(pool);
+  SVN_ERR(svn_client__get_diff_writer_svn(&diff_processor, &ddi,
+                                          wc_abspath,
+                                          wc_abspath, wc_abspath,
+                                          options,
+                                          NULL /* relative_to_dir */,
+                                          FALSE /* no_diff_added */,
+                                          FALSE /* no_diff_deleted */,
+                                          FALSE /* show_copies_as_adds */,
+                                          FALSE /* ignore_content_type */,
+                                          FALSE /* ignore_properties */,
+                                          FALSE /* properties_only */,
+                                          use_git_diff_format,
+                                          TRUE /* pretty_print_mergeinfo */,
+                                          "UTF-8",
+                                          svn_stream_from_stringbuf(*output,
+                                                                    pool),
+                                          svn_stream_empty(pool),
+                                          ctx, pool));
+  if (parallel)
+    SVN_ERR(svn_client__diff_writer_parallelize(diff_processor, pool));
+
+  SVN_ERR(svn_wc__diff7(TRUE /* anchor_at_given_paths */,
+                        ctx->wc_ctx, wc_abspath, svn_depth_infinity,
+                        FALSE /* ignore_ancestry */, NULL /* changelists */,
+                        diff_processor, NULL, NULL, pool, pool));
+
+  return svn_error_trace(svn_client__diff_writer_flush(diff_processor,
+                                                       pool));
+}
+
+static svn_error_t *
+test_parallel_diff_writer(const svn_test_opts_t *opts,
+                          apr_pool_t *pool)
+{
+  static const char *files[] =
+    {
+      "iota", "A/mu", "A/B/lambda", "A/B/E/alpha", "A/B/E/beta",
+      "A/D/gamma", "A/D/G/pi", "A/D/G/rho", "A/D/G/tau",
+      "A/D/H/chi", "A/D/H/omega", "A/D/H/psi"
+    };
+  const char *repos_url;
+  const char *wc_path;
+  svn_opt_revision_t rev;
+  svn_opt_revision_t peg_rev;
+  svn_client_ctx_t *ctx;
+  apr_array_header_t *targets;
+  apr_array_header_t *options;
+  svn_stringbuf_t *serial, *parallel;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i, k;
+
+  /* Create a filesystem and repository containing the Greek tree. */
+  SVN_ERR(create_greek_repos(&repos_url, "test-parallel-diff-repos", opts,
+                             pool));
+
+  wc_path = svn_test_data_path("test-parallel-diff", pool);
+  SVN_ERR(svn_io_make_dir_recursively(wc_path, pool));
+  svn_test_add_dir_cleanup(wc_path);
+
+  wc_path = svn_dirent_join(wc_path, "test-parallel-diff-wc", pool);
+  SVN_ERR(svn_dirent_get_absolute(&wc_path, wc_path, pool));
+  SVN_ERR(svn_io_remove_dir2(wc_path, TRUE, NULL, NULL, pool));
+  rev.kind = svn_opt_revision_head;
+  peg_rev.kind = svn_opt_revision_unspecified;
+  SVN_ERR(svn_client_create_context(&ctx, pool));
+  SVN_ERR(svn_client_checkout4(NULL, repos_url, wc_path,
+                               &peg_rev, &rev, svn_depth_infinity,
+                               TRUE, FALSE,
+                               opts->wc_format_version,
+                               opts->store_pristine,
+                               ctx, pool));
+
+  /* r2: make all files large enough to be diffed by worker threads. */
+  for (i = 0; i < (int)(sizeof(files) / sizeof(files[0])); ++i)
+    {
+      svn_stringbuf_t *contents;
+
+      svn_pool_clear(iterpool);
+      contents = svn_stringbuf_create_empty(iterpool);
+      for (k = 0; k < 2000; ++k)
+        svn_stringbuf_appendcstr(contents,
+                                 apr_psprintf(iterpool, "%s line %d\n",
+                                              files[i], k));
+
+      SVN_ERR(svn_io_file_create(svn_dirent_join(wc_path, files[i],
+                                                 iterpool),
+                                 contents->data, iterpool));
+    }
+
+  targets = apr_array_make(pool, 1, sizeof(const char *));
+  APR_ARRAY_PUSH(targets, const char *) = wc_path;
+  SVN_ERR(svn_client_commit6(targets, svn_depth_infinity, FALSE, FALSE,
+                             TRUE, FALSE, FALSE, NULL, NULL, NULL, NULL,
+                             ctx, pool));
+
+  /* Local modifications: two hunks in most files, only whitespace and
+     a property in rho, text and a property in iota and a shrunk psi. */
+  for (i = 0; i < (int)(sizeof(files) / sizeof(files[0])); ++i)
+    {
+      svn_stringbuf_t *contents;
+      svn_boolean_t whitespace_only = (strcmp(files[i], "A/D/G/rho") == 0);
+
+      svn_pool_clear(iterpool);
+      contents = svn_stringbuf_create_empty(iterpool);
+      if (strcmp(files[i], "A/D/H/psi") == 0)
+        {
+          svn_stringbuf_appendcstr(contents, "psi is small now\n");
+        }
+      else
+        for (k = 0; k < 2000; ++k)
+          {
+            const char *format = "%s line %d\n";
+
+            if (whitespace_only && k == 50)
+              format = "%s line  %d\n";
+            else if (!whitespace_only && (k == 10 || k == 1500))
+              format = "%s changed line %d\n";
+
+            svn_stringbuf_appendcstr(contents,
+                                     apr_psprintf(iterpool, format,
+                                                  files[i], k));
+          }
+
+      SVN_ERR(svn_io_file_create(svn_dirent_join(wc_path, files[i],
+                                                 iterpool),
+                                 contents->data, iterpool));
+    }
+
+  for (i = 0; i < 2; ++i)
+    {
+      apr_array_clear(targets);
+      APR_ARRAY_PUSH(targets, const char *)
+        = svn_dirent_join(wc_path, i ? "iota" : "A/D/G/rho", pool);
+      SVN_ERR(svn_client_propset_local("prop",
+                                       svn_string_create("value", pool),
+                                       targets, svn_depth_empty, FALSE,
+                                       NULL, ctx, pool));
+    }
+
+  /* Ignoring whitespace, rho has no text diff but property changes. */
+  options = apr_array_make(pool, 1, sizeof(const char *));
+  APR_ARRAY_PUSH(options, const char *) = "-b";
+
+  /* The output must not depend on the worker threads. */
+  for (i = 0; i < 2; ++i)
+    {
+      svn_boolean_t use_git_diff_format = (i == 1);
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(get_wc_diff(&serial, wc_path, options, use_git_diff_format,
+                          FALSE, ctx, iterpool));
+      SVN_ERR(get_wc_diff(&parallel, wc_path, options, use_git_diff_format,
+                          TRUE, ctx, iterpool));
+
+      SVN_TEST_ASSERT(strstr(serial->data, "changed line 1500") != NULL);
+      SVN_TEST_ASSERT(strstr(serial->data, "Property changes on:") != NULL);
+      SVN_TEST_STRING_ASSERT(parallel->data, serial->data);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_export_tree(const svn_test_opts_t *opts,
+                 apr_pool_t *pool)
+{
+  const char *repos_url;
+  const char *export_path;
+  const char *cwd;
+  const char *relpath;
+  svn_opt_revision_t rev;
+  svn_opt_revision_t peg_rev;
+  svn_client_ctx_t *ctx;
+  svn_stringbuf_t *contents;
+  svn_node_kind_t kind;
+  svn_revnum_t result_rev;
+
+  SVN_ERR(create_greek_repos(&repos_url, "test-export-tree", opts, pool));
+
+  export_path = svn_test_data_path("test-export-tree-wc", pool);
+  SVN_ERR(svn_io_remove_dir2(export_path, TRUE, NULL, NULL, pool));
+  SVN_ERR(svn_io_make_dir_recursively(export_path, pool));
+  svn_test_add_dir_cleanup(export_path);
+  export_path = svn_dirent_join(export_path, "export", pool);
+
+  /* The editor derives all paths from the export root.  Make sure that
+     works for relative roots, too. */
+  SVN_ERR(svn_dirent_get_absolute(&cwd, "", pool));
+  relpath = svn_dirent_skip_ancestor(cwd, export_path);
+  if (relpath && *relpath)
+    export_path = relpath;
+
+  rev.kind = svn_opt_revision_head;
+  peg_rev.kind = svn_opt_revision_unspecified;
+  SVN_ERR(svn_client_create_context(&ctx, pool));
+  SVN_ERR(svn_client_export5(&result_rev, repos_url, export_path,
+                             &peg_rev, &rev, FALSE, FALSE, FALSE,
+                             svn_depth_infinity, NULL, ctx, pool));
+  SVN_TEST_INT_ASSERT(result_rev, 1);
+
+  SVN_ERR(svn_stringbuf_from_file2(&contents,
+                                   svn_dirent_join(export_path, "iota",
+                                                   pool),
+                                   pool));
+  SVN_TEST_STRING_ASSERT(contents->data, "This is the file 'iota'.\n");
+  SVN_ERR(svn_stringbuf_from_file2(&contents,
+                                   svn_dirent_join(export_path, "A/D/G/pi",
+                                                   pool),
+                                   pool));
+  SVN_TEST_STRING_ASSERT(contents->data, "This is the file 'pi'.\n");
+  SVN_ERR(svn_io_check_path(svn_dirent_join(export_path, "A/C", pool),
+                            &kind, pool));
+  SVN_TEST_ASSERT(kind == svn_node_dir);
+
+  /* Overwriting an existing export must accept the existing dirs. */
+  SVN_ERR(svn_io_remove_file2(svn_dirent_join(export_path, "A/mu", pool),
+                              FALSE, pool));
+  SVN_ERR(svn_client_export5(NULL, repos_url, export_path,
+                             &peg_rev, &rev, TRUE, FALSE, FALSE,
+                             svn_depth_infinity, NULL, ctx, pool));
+  SVN_ERR(svn_stringbuf_from_file2(&contents,
+                                   svn_dirent_join(export_path, "A/mu",
+                                                   pool),
+                                   pool));
+  SVN_TEST_STRING_ASSERT(contents->data, "This is the file 'mu'.\n");
+
+  /* But a file where a dir should go is still an obstruction. */
+  SVN_ERR(svn_io_remove_dir2(svn_dirent_join(export_path, "A/B/E", pool),
+                             FALSE, NULL, NULL, pool));
+  SVN_ERR(svn_io_file_create(svn_dirent_join(export_path, "A/B/E", pool),
+                             "obstruction\n", pool));
+  SVN_TEST_ASSERT_ERROR(svn_client_export5(NULL, repos_url, export_path,
+                                           &peg_rev, &rev, TRUE, FALSE,
+                                           FALSE, svn_depth_infinity, NULL,
+                                           ctx, pool),
+                        SVN_ERR_WC_NOT_WORKING_COPY);
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_auth_provider_t.first_credentials.  Count the sessions
+   that ask for a username in the int at PROVIDER_BATON. */
+static svn_error_t *
+count_username_first_creds(void **credentials,
+                           void **iter_baton,
+                           void *provider_baton,
+                           apr_hash_t *parameters,
+                           const char *realmstring,
+                           apr_pool_t *pool)
+{
+  int *count = provider_baton;
+  svn_auth_cred_username_t *creds = apr_pcalloc(pool, sizeof(*creds));
+
+  ++*count;
+  creds->username = "jrandom";
+  creds->may_save = FALSE;
+  *credentials = creds;
+  *iter_baton = NULL;
+
+  return SVN_NO_ERROR;
+}
+
+static const svn_auth_provider_t count_username_provider =
+  {
+    SVN_AUTH_CRED_USERNAME,
+    count_username_first_creds,
+    NULL,
+    NULL
+  };
+
+/* Check out the working copy at URL to WC_PATH, processing externals
+   unless IGNORE_EXTERNALS is set.  Set *SESSIONS to the number of RA
+   sessions that fetched data for it. */
+static svn_error_t *
+checkout_counting_sessions(int *sessions,
+                           const char *url,
+                           const char *wc_path,
+                           svn_boolean_t ignore_externals,
+                           const svn_test_opts_t *opts,
+                           apr_pool_t *pool)
+{
+  svn_client_ctx_t *ctx;
+  svn_auth_provider_object_t *provider;
+  apr_array_header_t *providers;
+  svn_opt_revision_t rev;
+  svn_opt_revision_t peg_rev;
+
+  *sessions = 0;
+  provider = apr_pcalloc(pool, sizeof(*provider));
+  provider->vtable = &count_username_provider;
+  provider->provider_baton = sessions;
+  providers = apr_array_make(pool, 1, sizeof(provider));
+  APR_ARRAY_PUSH(providers, svn_auth_provider_object_t *) = provider;
+
+  SVN_ERR(svn_client_create_context(&ctx, pool));
+  svn_auth_open(&ctx->auth_baton, providers, pool);
+
+  rev.kind = svn_opt_revision_head;
+  peg_rev.kind = svn_opt_revision_unspecified;
+  SVN_ERR(svn_client_checkout4(NULL, url, wc_path, &peg_rev, &rev,
+                               svn_depth_infinity, ignore_externals, FALSE,
+                               opts->wc_format_version,
+                               opts->store_pristine,
+                               ctx, pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_externals_reuse_ra_session(const svn_test_opts_t *opts,
+                                apr_pool_t *pool)
+{
+  const char *repos_url;
+  const char *wc_path;
+  const svn_string_t *propval;
+  svn_client_ctx_t *ctx;
+  int plain_sessions, externals_sessions;
+  svn_node_kind_t kind;
+
+  SVN_ERR(create_greek_repos(&repos_url, "test-externals-reuse-session",
+                             opts, pool));
+
+  wc_path = svn_test_data_path("test-externals-reuse-session-wc", pool);
+  SVN_ERR(svn_io_remove_dir2(wc_path, TRUE, NULL, NULL, pool));
+  SVN_ERR(svn_io_make_dir_recursively(wc_path, pool));
+  svn_test_add_dir_cleanup(wc_path);
+  SVN_ERR(svn_dirent_get_absolute(&wc_path, wc_path, pool));
+
+  /* Several externals from the defining repository. */
+  SVN_ERR(svn_client_create_context(&ctx, pool));
+  propval = svn_string_create("^/A/B ext_B\n"
+                              "^/A/D/G ext_G\n"
+                              "^/A/D/H/psi ext_psi\n", pool);
+  SVN_ERR(svn_client_propset_remote(SVN_PROP_EXTERNALS, propval,
+                                    apr_pstrcat(pool, repos_url, "/A/C",
+                                                SVN_VA_NULL),
+                                    TRUE, 1, NULL, NULL, NULL, ctx, pool));
+
+  SVN_ERR(checkout_counting_sessions(&plain_sessions, repos_url,
+                                     svn_dirent_join(wc_path, "plain", pool),
+                                     TRUE, opts, pool));
+  SVN_ERR(checkout_counting_sessions(&externals_sessions, repos_url,
+                                     svn_dirent_join(wc_path, "externals",
+                                                     pool),
+                                     FALSE, opts, pool));
+
+  SVN_ERR(svn_io_check_path(svn_dirent_join(wc_path,
+                                            "externals/A/C/ext_psi", pool),
+                            &kind, pool));
+  SVN_TEST_ASSERT(kind == svn_node_file);
+
+  /* All externals must have been fetched through the session of the
+     checkout itself. */
+  SVN_TEST_ASSERT(plain_sessions > 0);
+  SVN_TEST_INT_ASSERT(externals_sessions, plain_sessions);
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *KIND to the node kind of RELPATH in HEAD of the repository at
+   REPOS_URL. */
+static svn_error_t *
+check_repos_path(svn_node_kind_t *kind,
+                 const char *repos_url,
+                 const char *relpath,
+                 svn_client_ctx_t *ctx,
+                 apr_pool_t *pool)
+{
+  svn_ra_session_t *ra_session;
+
+  SVN_ERR(svn_client_open_ra_session2(&ra_session, repos_url, NULL,
+                                      ctx, pool, pool));
+  return svn_error_trace(svn_ra_check_path(ra_session, relpath,
+                                           SVN_INVALID_REVNUM, kind, pool));
+}
+
+static svn_error_t *
+test_delete_urls(const svn_test_opts_t *opts,
+                 apr_pool_t *pool)
+{
+  const char *repos_url;
+  svn_client_ctx_t *ctx;
+  apr_array_header_t *targets;
+  svn_node_kind_t kind;
+
+  SVN_ERR(create_greek_repos(&repos_url, "test-delete-urls", opts, pool));
+  SVN_ERR(svn_client_create_context(&ctx, pool));
+
+  /* One missing URL makes the whole deletion fail. */
+  targets = apr_array_make(pool, 3, sizeof(const char *));
+  APR_ARRAY_PUSH(targets, const char *)
+    = apr_pstrcat(pool, repos_url, "/A/mu", SVN_VA_NULL);
+  APR_ARRAY_PUSH(targets, const char *)
+    = apr_pstrcat(pool, repos_url, "/A/no-such-file", SVN_VA_NULL);
+  APR_ARRAY_PUSH(targets, const char *)
+    = apr_pstrcat(pool, repos_url, "/iota", SVN_VA_NULL);
+  SVN_TEST_ASSERT_ERROR(svn_client_delete4(targets, FALSE, FALSE, NULL,
+                                           NULL, NULL, ctx, pool),
+                        SVN_ERR_FS_NOT_FOUND);
+
+  SVN_ERR(check_repos_path(&kind, repos_url, "A/mu", ctx, pool));
+  SVN_TEST_ASSERT(kind == svn_node_file);
+
+  /* Delete files and a directory at once. */
+  APR_ARRAY_IDX(targets, 1, const char *)
+    = apr_pstrcat(pool, repos_url, "/A/D/G", SVN_VA_NULL);
+  SVN_ERR(svn_client_delete4(targets, FALSE, FALSE, NULL, NULL, NULL,
+                             ctx, pool));
+
+  SVN_ERR(check_repos_path(&kind, repos_url, "A/mu", ctx, pool));
+  SVN_TEST_ASSERT(kind == svn_node_none);
+  SVN_ERR(check_repos_path(&kind, repos_url, "A/D/G", ctx, pool));
+  SVN_TEST_ASSERT(kind == svn_node_none);
+  SVN_ERR(check_repos_path(&kind, repos_url, "iota", ctx, pool));
+  SVN_TEST_ASSERT(kind == svn_node_none);
+  SVN_ERR(check_repos_path(&kind, repos_url, "A/D/gamma", ctx, pool));
+  SVN_TEST_ASSERT(kind == svn_node_file);
+
+  return SVN_NO_ERROR;
+}
+
 /* ========================================================================== */
 
 
@@ -1474,6 +1913,14 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test svn_client_copy7 with externals_to_pin"),
     SVN_TEST_OPTS_PASS(test_copy_pin_externals_select_subtree,
                        "pin externals on selected subtrees only"),
+    SVN_TEST_OPTS_PASS(test_parallel_diff_writer,
+                       "test diff writer with worker threads"),
+    SVN_TEST_OPTS_PASS(test_export_tree,
+                       "test exporting a tree from the repository"),
+    SVN_TEST_OPTS_PASS(test_externals_reuse_ra_session,
+                       "test reusing RA sessions for externals"),
+    SVN_TEST_OPTS_PASS(test_delete_urls,
+                       "test deleting several URLs at once"),
     SVN_TEST_NULL
   };
 
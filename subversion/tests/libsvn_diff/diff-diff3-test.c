@@ -28,6 +28,7 @@
 #include "svn_pools.h"
 #include "svn_utf.h"
 
+#include "private/svn_diff_private.h"
 #include "private/svn_string_private.h"
 
 /* Used to terminate lines in large multi-line string literals. */
@@ -3065,6 +3066,646 @@ three_way_double_add(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+test_two_way_patience(apr_pool_t *pool)
+{
+  svn_diff_file_options_t *diff_opts = svn_diff_file_options_create(pool);
+  apr_array_header_t *args = apr_array_make(pool, 1, sizeof(const char *));
+
+  APR_ARRAY_PUSH(args, const char *) = "--patience";
+  SVN_ERR(svn_diff_file_options_parse(diff_opts, args, pool));
+  SVN_TEST_ASSERT(diff_opts->patience);
+
+  /* The default algorithm matches up the braces and reports two changed
+     lines.  Patience diff anchors on the unique line "b" and reports the
+     block "a" as moved below it. */
+  SVN_ERR(two_way_diff("patience1", "patience2",
+                       "a\n"
+                       "{\n"
+                       "}\n"
+                       "b\n"
+                       "{\n"
+                       "}\n",
+
+                       "b\n"
+                       "{\n"
+                       "}\n"
+                       "a\n"
+                       "{\n"
+                       "}\n",
+
+                       "--- patience1"    NL
+                       "+++ patience2"    NL
+                       "@@ -1,6 +1,6 @@"  NL
+                       "-a\n"
+                       "-{\n"
+                       "-}\n"
+                       " b\n"
+                       " {\n"
+                       " }\n"
+                       "+a\n"
+                       "+{\n"
+                       "+}\n",
+                       diff_opts, pool));
+
+  /* Without any line that is unique to both files, we get the same
+     result as with the default algorithm. */
+  SVN_ERR(two_way_diff("patience3", "patience4",
+                       "x\n"
+                       "y\n"
+                       "x\n",
+
+                       "x\n"
+                       "x\n",
+
+                       "--- patience3"    NL
+                       "+++ patience4"    NL
+                       "@@ -1,3 +1,2 @@"  NL
+                       " x\n"
+                       "-y\n"
+                       " x\n",
+                       diff_opts, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* The blame chain update as it used to be done in libsvn_client, one
+   hunk at a time.  svn_diff__blame_add_file() must yield the same
+   per-line attribution. */
+
+/* Baton for ref_blame_output_modified(). */
+typedef struct ref_blame_baton_t
+{
+  svn_diff__blame_chain_t *chain;
+  const void *rev;
+} ref_blame_baton_t;
+
+static void
+ref_blame_destroy(svn_diff__blame_chain_t *chain,
+                  svn_diff__blame_chunk_t *blame)
+{
+  blame->next = chain->avail;
+  chain->avail = blame;
+}
+
+static svn_diff__blame_chunk_t *
+ref_blame_find(svn_diff__blame_chunk_t *blame,
+               apr_off_t off)
+{
+  svn_diff__blame_chunk_t *prev = NULL;
+  while (blame)
+    {
+      if (blame->start > off) break;
+      prev = blame;
+      blame = blame->next;
+    }
+  return prev;
+}
+
+static void
+ref_blame_adjust(svn_diff__blame_chunk_t *blame,
+                 apr_off_t adjust)
+{
+  while (blame)
+    {
+      blame->start += adjust;
+      blame = blame->next;
+    }
+}
+
+static void
+ref_blame_delete_range(svn_diff__blame_chain_t *chain,
+                       apr_off_t start,
+                       apr_off_t length)
+{
+  svn_diff__blame_chunk_t *first = ref_blame_find(chain->blame, start);
+  svn_diff__blame_chunk_t *last = ref_blame_find(chain->blame,
+                                                 start + length);
+  svn_diff__blame_chunk_t *tail = last->next;
+
+  if (first != last)
+    {
+      svn_diff__blame_chunk_t *walk = first->next;
+      while (walk != last)
+        {
+          svn_diff__blame_chunk_t *next = walk->next;
+          ref_blame_destroy(chain, walk);
+          walk = next;
+        }
+      first->next = last;
+      last->start = start;
+      if (first->start == start)
+        {
+          *first = *last;
+          ref_blame_destroy(chain, last);
+          last = first;
+        }
+    }
+
+  if (tail && tail->start == last->start + length)
+    {
+      *last = *tail;
+      ref_blame_destroy(chain, tail);
+      tail = last->next;
+    }
+
+  ref_blame_adjust(tail, -length);
+}
+
+static void
+ref_blame_insert_range(svn_diff__blame_chain_t *chain,
+                       const void *rev,
+                       apr_off_t start,
+                       apr_off_t length)
+{
+  svn_diff__blame_chunk_t *point = ref_blame_find(chain->blame, start);
+  svn_diff__blame_chunk_t *insert;
+
+  if (point->start == start)
+    {
+      insert = svn_diff__blame_chunk_create(chain, point->rev,
+                                            point->start + length);
+      point->rev = rev;
+      insert->next = point->next;
+      point->next = insert;
+    }
+  else
+    {
+      svn_diff__blame_chunk_t *middle;
+      middle = svn_diff__blame_chunk_create(chain, rev, start);
+      insert = svn_diff__blame_chunk_create(chain, point->rev,
+                                            start + length);
+      middle->next = insert;
+      insert->next = point->next;
+      point->next = middle;
+    }
+  ref_blame_adjust(insert->next, length);
+}
+
+/* Implements svn_diff_output_fns_t.output_diff_modified. */
+static svn_error_t *
+ref_blame_output_modified(void *baton,
+                          apr_off_t original_start,
+                          apr_off_t original_length,
+                          apr_off_t modified_start,
+                          apr_off_t modified_length,
+                          apr_off_t latest_start,
+                          apr_off_t latest_length)
+{
+  ref_blame_baton_t *b = baton;
+
+  if (original_length)
+    ref_blame_delete_range(b->chain, modified_start, original_length);
+
+  if (modified_length)
+    ref_blame_insert_range(b->chain, b->rev, modified_start,
+                           modified_length);
+
+  return SVN_NO_ERROR;
+}
+
+/* Return the revision that CHAIN blames for token LINE. */
+static const void *
+blame_line_rev(const svn_diff__blame_chain_t *chain,
+               apr_off_t line)
+{
+  const svn_diff__blame_chunk_t *blame = chain->blame;
+
+  while (blame->next && blame->next->start <= line)
+    blame = blame->next;
+
+  return blame->rev;
+}
+
+static svn_error_t *
+test_blame_chain(apr_pool_t *pool)
+{
+  static const int revs[30] = { 0 };
+  static const svn_diff_output_fns_t ref_output_fns =
+    { NULL, ref_blame_output_modified };
+  const char *filenames[2];
+  svn_diff__blame_chain_t *chain = svn_diff__blame_chain_create(pool);
+  svn_diff__blame_chain_t *ref_chain = svn_diff__blame_chain_create(pool);
+  svn_diff_file_options_t *diff_options
+    = svn_diff_file_options_create(pool);
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  filenames[0] = svn_test_data_path("blame1", pool);
+  filenames[1] = svn_test_data_path("blame2", pool);
+
+  seed_val();
+
+  /* Few distinct lines in short blocks make for many small, overlapping
+     changes between revisions. */
+  for (i = 0; i < (int)(sizeof(revs) / sizeof(revs[0])); ++i)
+    {
+      const char *last_file = i ? filenames[(i - 1) % 2] : NULL;
+      const char *cur_file = filenames[i % 2];
+      svn_stringbuf_t *contents;
+      apr_off_t lines, line;
+      apr_size_t k;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(make_random_file(cur_file, 100, 140, 8, 4, i % 3, iterpool));
+
+      SVN_ERR(svn_diff__blame_add_file(chain, last_file, cur_file, &revs[i],
+                                       diff_options, NULL, NULL, iterpool));
+
+      if (last_file)
+        {
+          svn_diff_t *diff;
+          ref_blame_baton_t baton;
+
+          baton.chain = ref_chain;
+          baton.rev = &revs[i];
+          SVN_ERR(svn_diff_file_diff_2(&diff, last_file, cur_file,
+                                       diff_options, iterpool));
+          SVN_ERR(svn_diff_output2(diff, &baton, &ref_output_fns,
+                                   NULL, NULL));
+        }
+      else
+        {
+          ref_chain->blame = svn_diff__blame_chunk_create(ref_chain,
+                                                          &revs[i], 0);
+        }
+
+      /* Compare the attribution of every line. */
+      SVN_ERR(svn_stringbuf_from_file2(&contents, cur_file, iterpool));
+      lines = 0;
+      for (k = 0; k < contents->len; ++k)
+        if (contents->data[k] == '\n' || k + 1 == contents->len)
+          ++lines;
+
+      for (line = 0; line < lines; ++line)
+        if (blame_line_rev(chain, line) != blame_line_rev(ref_chain, line))
+          return svn_error_createf(SVN_ERR_TEST_FAILED, NULL,
+                                   "blame of line %d differs in revision %d"
+                                   " (seed: %u)",
+                                   (int)line, i, diff_diff3_seed);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton for the eol_check_* output functions. */
+typedef struct eol_check_baton_t
+{
+  /* The lines of the original and the modified file, including EOLs. */
+  const apr_array_header_t *lines[2];
+
+  /* Number of lines covered so far in either file. */
+  apr_off_t covered[2];
+
+  /* Number of lines removed plus the number of lines added. */
+  apr_off_t changed;
+} eol_check_baton_t;
+
+/* Implements svn_diff_output_fns_t.output_common.  Verify that the
+   range is the continuation of the previous one and that the lines are
+   actually identical. */
+static svn_error_t *
+eol_check_common(void *baton,
+                 apr_off_t original_start,
+                 apr_off_t original_length,
+                 apr_off_t modified_start,
+                 apr_off_t modified_length,
+                 apr_off_t latest_start,
+                 apr_off_t latest_length)
+{
+  eol_check_baton_t *b = baton;
+  apr_off_t k;
+
+  SVN_TEST_ASSERT(original_start == b->covered[0]);
+  SVN_TEST_ASSERT(modified_start == b->covered[1]);
+  SVN_TEST_ASSERT(original_length == modified_length);
+  SVN_TEST_ASSERT(original_start + original_length <= b->lines[0]->nelts);
+  SVN_TEST_ASSERT(modified_start + modified_length <= b->lines[1]->nelts);
+
+  for (k = 0; k < original_length; ++k)
+    SVN_TEST_STRING_ASSERT(APR_ARRAY_IDX(b->lines[1], modified_start + k,
+                                         const char *),
+                           APR_ARRAY_IDX(b->lines[0], original_start + k,
+                                         const char *));
+
+  b->covered[0] += original_length;
+  b->covered[1] += modified_length;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_diff_output_fns_t.output_diff_modified.  Verify that
+   the range is the continuation of the previous one. */
+static svn_error_t *
+eol_check_modified(void *baton,
+                   apr_off_t original_start,
+                   apr_off_t original_length,
+                   apr_off_t modified_start,
+                   apr_off_t modified_length,
+                   apr_off_t latest_start,
+                   apr_off_t latest_length)
+{
+  eol_check_baton_t *b = baton;
+
+  SVN_TEST_ASSERT(original_start == b->covered[0]);
+  SVN_TEST_ASSERT(modified_start == b->covered[1]);
+
+  b->covered[0] += original_length;
+  b->covered[1] += modified_length;
+  b->changed += original_length + modified_length;
+
+  return SVN_NO_ERROR;
+}
+
+/* Walk DIFF between the ORIGINAL and MODIFIED lines, check that it is
+   consistent with them and return the number of changed lines in
+   *CHANGED. */
+static svn_error_t *
+eol_check_diff(apr_off_t *changed,
+               svn_diff_t *diff,
+               const apr_array_header_t *original,
+               const apr_array_header_t *modified)
+{
+  static const svn_diff_output_fns_t eol_check_fns =
+    { eol_check_common, eol_check_modified };
+  eol_check_baton_t baton = { { NULL } };
+
+  baton.lines[0] = original;
+  baton.lines[1] = modified;
+  SVN_ERR(svn_diff_output2(diff, &baton, &eol_check_fns, NULL, NULL));
+
+  SVN_TEST_ASSERT(baton.covered[0] == original->nelts);
+  SVN_TEST_ASSERT(baton.covered[1] == modified->nelts);
+
+  *changed = baton.changed;
+  return SVN_NO_ERROR;
+}
+
+/* Return a line of up to MAX_LEN random letters and a random EOL
+   allocated in POOL.  Mostly \n if LF_MOSTLY is set. */
+static const char *
+make_random_eol_line(apr_uint32_t max_len,
+                     svn_boolean_t lf_mostly,
+                     apr_pool_t *pool)
+{
+  static const char *const eols[] = { "\n", "\r", "\r\n" };
+  apr_uint32_t len = range_rand(0, max_len);
+  char *line = apr_palloc(pool, len + 3);
+  const char *eol;
+  apr_uint32_t k;
+
+  for (k = 0; k < len; ++k)
+    line[k] = (char)('a' + range_rand(0, 2));
+
+  if (lf_mostly && range_rand(0, 7))
+    eol = eols[0];
+  else
+    eol = eols[range_rand(0, 2)];
+
+  /* An empty line ending in \n would join a preceding \r into a CRLF. */
+  if (len == 0 && eol[0] == '\n')
+    eol = eols[2];
+
+  strcpy(line + len, eol);
+  return line;
+}
+
+/* Join LINES into a single string allocated in POOL. */
+static svn_string_t *
+join_lines(const apr_array_header_t *lines,
+           apr_pool_t *pool)
+{
+  svn_stringbuf_t *result = svn_stringbuf_create_empty(pool);
+  int i;
+
+  for (i = 0; i < lines->nelts; ++i)
+    svn_stringbuf_appendcstr(result, APR_ARRAY_IDX(lines, i, const char *));
+
+  return svn_stringbuf__morph_into_string(result);
+}
+
+/* The word-wise prefix and suffix scanning in diff_file.c counts lines
+   without looking at each byte.  Diff files with mixed \n, \r and \r\n
+   EOLs at all offsets relative to the machine word boundaries, and with
+   changes close to either end of the data, and check the results against
+   the diff of the same data in memory, which does not scan for identical
+   prefixes and suffixes. */
+static svn_error_t *
+test_eol_word_boundaries(apr_pool_t *pool)
+{
+  const char *filenames[2];
+  svn_diff_file_options_t *diff_options
+    = svn_diff_file_options_create(pool);
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  filenames[0] = svn_test_data_path("eol-word-boundaries-original", pool);
+  filenames[1] = svn_test_data_path("eol-word-boundaries-modified", pool);
+
+  seed_val();
+
+  for (i = 0; i < 500; ++i)
+    {
+      apr_array_header_t *original, *modified;
+      svn_string_t *original_data, *modified_data;
+      svn_diff_t *diff;
+      apr_off_t file_changed, mem_changed;
+      svn_boolean_t lf_mostly = (i % 2 == 0);
+      apr_uint32_t max_len = 2 * sizeof(apr_uintptr_t) + 1;
+      apr_uint32_t edits;
+      int k;
+
+      svn_pool_clear(iterpool);
+
+      original = apr_array_make(iterpool, 64, sizeof(const char *));
+      for (k = range_rand(1, 60); k > 0; --k)
+        APR_ARRAY_PUSH(original, const char *)
+          = make_random_eol_line(max_len, lf_mostly, iterpool);
+
+      /* Change text or EOLs of a few lines, or add or remove lines.
+         Edits near either end are as likely as in the middle. */
+      modified = apr_array_copy(iterpool, original);
+      for (edits = range_rand(0, 3); edits > 0; --edits)
+        {
+          int pos;
+
+          switch (range_rand(0, 3))
+            {
+              case 0:
+                pos = range_rand(0, modified->nelts);
+                APR_ARRAY_PUSH(modified, const char *) = NULL;
+                memmove(&APR_ARRAY_IDX(modified, pos + 1, const char *),
+                        &APR_ARRAY_IDX(modified, pos, const char *),
+                        (modified->nelts - pos - 1) * sizeof(const char *));
+                APR_ARRAY_IDX(modified, pos, const char *)
+                  = make_random_eol_line(max_len, lf_mostly, iterpool);
+                break;
+
+              case 1:
+                if (modified->nelts > 1)
+                  {
+                    pos = range_rand(0, modified->nelts - 1);
+                    memmove(&APR_ARRAY_IDX(modified, pos, const char *),
+                            &APR_ARRAY_IDX(modified, pos + 1, const char *),
+                            (modified->nelts - pos - 1)
+                              * sizeof(const char *));
+                    --modified->nelts;
+                  }
+                break;
+
+              default:
+                pos = range_rand(0, modified->nelts - 1);
+                APR_ARRAY_IDX(modified, pos, const char *)
+                  = make_random_eol_line(max_len, lf_mostly, iterpool);
+                break;
+            }
+        }
+
+      /* Sometimes, let the data end without an EOL. */
+      for (k = 0; k < 2; ++k)
+        {
+          apr_array_header_t *lines = k ? modified : original;
+          const char *last = APR_ARRAY_IDX(lines, lines->nelts - 1,
+                                           const char *);
+          apr_size_t len = strcspn(last, "\r\n");
+
+          if (len && range_rand(0, 3) == 0)
+            APR_ARRAY_IDX(lines, lines->nelts - 1, const char *)
+              = apr_pstrndup(iterpool, last, len);
+        }
+
+      original_data = join_lines(original, iterpool);
+      modified_data = join_lines(modified, iterpool);
+
+      SVN_ERR(make_file(filenames[0], original_data->data, iterpool));
+      SVN_ERR(make_file(filenames[1], modified_data->data, iterpool));
+
+      SVN_ERR(svn_diff_file_diff_2(&diff, filenames[0], filenames[1],
+                                   diff_options, iterpool));
+      SVN_ERR(eol_check_diff(&file_changed, diff, original, modified));
+
+      SVN_ERR(svn_diff_mem_string_diff(&diff, original_data, modified_data,
+                                       diff_options, iterpool));
+      SVN_ERR(eol_check_diff(&mem_changed, diff, original, modified));
+
+      if (file_changed != mem_changed)
+        return svn_error_createf(SVN_ERR_TEST_FAILED, NULL,
+                                 "file diff changes %d lines, memory diff "
+                                 "%d lines in iteration %d (seed: %u)",
+                                 (int)file_changed, (int)mem_changed, i,
+                                 diff_diff3_seed);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Create FILENAME with CONTENTS and make it read-only if READ_ONLY is
+   set.  Replace any existing file of that name. */
+static svn_error_t *
+make_file_with_perms(const char *filename,
+                     const svn_string_t *contents,
+                     svn_boolean_t read_only,
+                     apr_pool_t *pool)
+{
+  SVN_ERR(svn_io_remove_file2(filename, TRUE, pool));
+  SVN_ERR(make_file(filename, contents->data, pool));
+  if (read_only)
+    SVN_ERR(svn_io_set_file_read_only(filename, FALSE, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Read-only files of up to APR_MMAP_LIMIT bytes get mapped into memory
+   as a whole.  Diff such files that span several chunks, with changes
+   anywhere, and compare the results with those for writable copies,
+   which are read chunk by chunk. */
+static svn_error_t *
+test_mapped_files(apr_pool_t *pool)
+{
+  const char *mapped[2];
+  const char *chunked[2];
+  svn_diff_file_options_t *diff_options
+    = svn_diff_file_options_create(pool);
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  mapped[0] = svn_test_data_path("mapped-original", pool);
+  mapped[1] = svn_test_data_path("mapped-modified", pool);
+  chunked[0] = svn_test_data_path("chunked-original", pool);
+  chunked[1] = svn_test_data_path("chunked-modified", pool);
+
+  seed_val();
+
+  for (i = 0; i < 5; ++i)
+    {
+      apr_array_header_t *original, *modified;
+      svn_string_t *original_data, *modified_data;
+      svn_diff_t *diff;
+      apr_off_t mapped_changed, chunked_changed;
+      apr_size_t size = 0;
+      int k;
+
+      svn_pool_clear(iterpool);
+
+      /* Between two and four chunks of CHUNK_SIZE (1 << 17) bytes. */
+      original = apr_array_make(iterpool, 8192, sizeof(const char *));
+      for (k = range_rand(1 << 18, 1 << 19); size < (apr_size_t)k; )
+        {
+          const char *line = make_random_eol_line(60, TRUE, iterpool);
+
+          APR_ARRAY_PUSH(original, const char *) = line;
+          size += strlen(line);
+        }
+
+      modified = apr_array_copy(iterpool, original);
+      for (k = 0; k < 10; ++k)
+        APR_ARRAY_IDX(modified, range_rand(0, modified->nelts - 1),
+                      const char *)
+          = make_random_eol_line(60, TRUE, iterpool);
+
+      original_data = join_lines(original, iterpool);
+      modified_data = join_lines(modified, iterpool);
+
+      SVN_ERR(make_file_with_perms(mapped[0], original_data, TRUE,
+                                   iterpool));
+      SVN_ERR(make_file_with_perms(mapped[1], modified_data, TRUE,
+                                   iterpool));
+      SVN_ERR(make_file_with_perms(chunked[0], original_data, FALSE,
+                                   iterpool));
+      SVN_ERR(make_file_with_perms(chunked[1], modified_data, FALSE,
+                                   iterpool));
+
+      SVN_ERR(svn_diff_file_diff_2(&diff, mapped[0], mapped[1],
+                                   diff_options, iterpool));
+      SVN_ERR(eol_check_diff(&mapped_changed, diff, original, modified));
+
+      SVN_ERR(svn_diff_file_diff_2(&diff, chunked[0], chunked[1],
+                                   diff_options, iterpool));
+      SVN_ERR(eol_check_diff(&chunked_changed, diff, original, modified));
+
+      if (mapped_changed != chunked_changed)
+        return svn_error_createf(SVN_ERR_TEST_FAILED, NULL,
+                                 "mapped diff changes %d lines, chunked "
+                                 "diff %d lines in iteration %d (seed: %u)",
+                                 (int)mapped_changed, (int)chunked_changed,
+                                 i, diff_diff3_seed);
+
+      /* Mixing both kinds of datasources must not matter either. */
+      SVN_ERR(svn_diff_file_diff_2(&diff, mapped[0], chunked[1],
+                                   diff_options, iterpool));
+      SVN_ERR(eol_check_diff(&mapped_changed, diff, original, modified));
+      SVN_TEST_ASSERT(mapped_changed == chunked_changed);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 /* ========================================================================== */
 
 
@@ -3109,6 +3750,14 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "2-way issue #3362 test v2"),
     SVN_TEST_XFAIL2(three_way_double_add,
                    "3-way merge, double add"),
+    SVN_TEST_PASS2(test_two_way_patience,
+                   "2-way diff with the patience algorithm"),
+    SVN_TEST_PASS2(test_blame_chain,
+                   "blame chain updates match per-hunk updates"),
+    SVN_TEST_PASS2(test_eol_word_boundaries,
+                   "prefix and suffix scanning with mixed EOLs"),
+    SVN_TEST_PASS2(test_mapped_files,
+                   "diff of files mapped into memory"),
     SVN_TEST_NULL
   };
 
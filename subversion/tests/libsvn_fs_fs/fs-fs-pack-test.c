@@ -36,7 +36,9 @@
 #include "svn_pools.h"
 #include "svn_props.h"
 #include "svn_fs.h"
+#include "private/svn_fs_fs_private.h"
 #include "private/svn_string_private.h"
+#include "private/svn_thread_pool.h"
 
 #include "../svn_test_fs.h"
 
@@ -1888,6 +1890,103 @@ large_delta_against_plain(const svn_test_opts_t *opts,
 
 #undef REPO_NAME
 
+/* ------------------------------------------------------------------------ */
+
+#define REPO_NAME "test-repo-read_ahead_large_file"
+
+static svn_error_t *
+read_ahead_large_file(const svn_test_opts_t *opts,
+                      apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *root;
+  svn_revnum_t rev;
+  svn_stringbuf_t *contents, *contents_read;
+  apr_size_t i;
+  int k;
+  apr_hash_t *fs_config;
+  fs_fs_data_t *ffd;
+  svn_fs_fs__ioctl_read_ahead_stats_output_t *stats;
+  void *stats_void;
+
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL, NULL);
+
+  SVN_ERR(svn_test__create_fs(&fs, REPO_NAME, opts, pool));
+
+  /* Construct a file that spans many txdelta windows. */
+  contents = svn_stringbuf_create_empty(pool);
+  for (i = 0; contents->len < 3 * 1024 * 1024; ++i)
+    svn_stringbuf_appendcstr(contents,
+                             apr_psprintf(pool, "line %d\n", (int)i));
+
+  /* Revision 1: add the file. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+  SVN_ERR(svn_fs_make_file(root, "foo", pool));
+  SVN_ERR(svn_test__set_file_contents(root, "foo", contents->data, pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+
+  /* Revisions 2 to 5: build a delta chain with changes all over the
+   * file. */
+  for (k = 0; k < 4; ++k)
+    {
+      for (i = k; i < contents->len; i += 50000)
+        contents->data[i] = (char)('a' + k);
+
+      SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+      SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+      SVN_ERR(svn_test__set_file_contents(root, "foo", contents->data,
+                                          pool));
+      SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+    }
+
+  /* Read it with read-ahead enabled.  To make sure we actually read from
+   * disk, use a new FS instance with disjoint caches. */
+  fs_config = apr_hash_make(pool);
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_NS,
+                           svn_uuid_generate(pool));
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_READ_AHEAD, "3");
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, fs_config, pool, pool));
+  ffd = fs->fsap_data;
+  SVN_TEST_INT_ASSERT(ffd->read_ahead, 3);
+
+  SVN_ERR(svn_fs_revision_root(&root, fs, rev, pool));
+  SVN_ERR(svn_test__get_file_contents(root, "foo", &contents_read, pool));
+  SVN_TEST_ASSERT(contents_read->len == contents->len);
+  SVN_TEST_ASSERT(memcmp(contents_read->data, contents->data,
+                         contents->len) == 0);
+
+  /* The chunks must actually have been produced by the read-ahead code. */
+  SVN_ERR(svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_READ_AHEAD_STATS, NULL,
+                       &stats_void, NULL, NULL, pool, pool));
+  stats = stats_void;
+#if APR_HAS_THREADS
+  SVN_TEST_ASSERT(stats->chunks > 0);
+#else
+  SVN_TEST_ASSERT(stats->chunks == 0);
+#endif
+
+  /* Excessive read-ahead settings get limited. */
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_NS,
+                           svn_uuid_generate(pool));
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_READ_AHEAD, "100000");
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, fs_config, pool, pool));
+  ffd = fs->fsap_data;
+  SVN_TEST_INT_ASSERT(ffd->read_ahead, SVN_THREAD_POOL__MAX_THREADS * 2);
+
+  SVN_ERR(svn_fs_revision_root(&root, fs, rev, pool));
+  SVN_ERR(svn_test__get_file_contents(root, "foo", &contents_read, pool));
+  SVN_TEST_ASSERT(contents_read->len == contents->len);
+  SVN_TEST_ASSERT(memcmp(contents_read->data, contents->data,
+                         contents->len) == 0);
+
+  return SVN_NO_ERROR;
+}
+
+#undef REPO_NAME
+
 
 
 /* The test table.  */
@@ -1943,6 +2042,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "pack with limited memory for metadata"),
     SVN_TEST_OPTS_PASS(large_delta_against_plain,
                        "large deltas against PLAIN, issue #4658"),
+    SVN_TEST_OPTS_PASS(read_ahead_large_file,
+                       "read large deltified file with read-ahead"),
     SVN_TEST_NULL
   };
 
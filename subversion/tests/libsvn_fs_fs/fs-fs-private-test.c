@@ -29,6 +29,7 @@
 #include "svn_pools.h"
 #include "svn_props.h"
 #include "svn_fs.h"
+#include "svn_delta.h"
 
 #include "private/svn_string_private.h"
 #include "private/svn_fs_fs_private.h"
@@ -36,6 +37,7 @@
 
 #include "../../libsvn_fs_fs/index.h"
 #include "../../libsvn_fs_fs/rep-cache.h"
+#include "../../libsvn_fs_fs/util.h"
 #include "../../libsvn_fs/fs-loader.h"
 
 #include "../svn_test_fs.h"
@@ -499,6 +501,137 @@ build_rep_cache(const svn_test_opts_t *opts, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* ------------------------------------------------------------------------ */
+
+/* Return a file content of roughly 200kB, i.e. spanning multiple delta
+ * windows, and use VARIANT to modify some of its lines.  Allocate the
+ * result in POOL. */
+static const char *
+make_delta_test_contents(int variant,
+                         apr_pool_t *pool)
+{
+  svn_stringbuf_t *contents = svn_stringbuf_create_empty(pool);
+  int i;
+
+  for (i = 0; i < 20000; ++i)
+    svn_stringbuf_appendcstr(contents,
+                             apr_psprintf(pool, "line %d.%d\n", i,
+                                          i % 997 == 0 ? variant : 0));
+
+  return contents->data;
+}
+
+/* Return the offset of the first occurrence of the LEN bytes at DATA in
+ * HAYSTACK or -1, if there is none. */
+static apr_int64_t
+find_data(const svn_stringbuf_t *haystack,
+          const char *data,
+          apr_size_t len)
+{
+  apr_size_t i;
+
+  for (i = 0; i + len <= haystack->len; ++i)
+    if (memcmp(haystack->data + i, data, len) == 0)
+      return i;
+
+  return -1;
+}
+
+static svn_error_t *
+forward_stored_svndiff(const svn_test_opts_t *opts,
+                       apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root, *root1, *root2;
+  svn_revnum_t rev;
+  const char *contents1 = make_delta_test_contents(1, pool);
+  const char *contents2 = make_delta_test_contents(2, pool);
+  svn_stringbuf_t *rev_contents;
+  apr_int64_t offset;
+  int stored_version;
+  int version;
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this will test FSFS repositories only");
+
+  /* Two revisions of the same file.  The second one will be stored as
+   * a delta against the first. */
+  SVN_ERR(svn_test__create_fs2(&fs, "test-repo-forward-stored-svndiff",
+                               opts, NULL, pool));
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_fs_make_file(txn_root, "file", pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "file", contents1, pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "file", contents2, pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+
+  SVN_ERR(svn_fs_revision_root(&root1, fs, rev - 1, pool));
+  SVN_ERR(svn_fs_revision_root(&root2, fs, rev, pool));
+
+  /* The file's delta is the only svndiff data in the revision file. */
+  SVN_ERR(svn_stringbuf_from_file2(&rev_contents,
+                                   svn_fs_fs__path_rev_absolute(fs, rev,
+                                                                pool),
+                                   pool));
+  offset = find_data(rev_contents, "\nSVN", 4);
+  SVN_TEST_ASSERT(offset >= 0
+                  && (apr_size_t)offset + 4 < rev_contents->len);
+  stored_version = rev_contents->data[offset + 4];
+
+  /* Whether the stored svndiff data gets forwarded or re-encoded depends
+   * on the requested format version.  The result must be the same. */
+  for (version = 0; version <= 2; ++version)
+    {
+      svn_txdelta_stream_t *delta_stream;
+      svn_txdelta_window_handler_t handler;
+      void *handler_baton;
+      svn_stringbuf_t *svndiff = svn_stringbuf_create_empty(pool);
+      svn_stringbuf_t *result = svn_stringbuf_create_empty(pool);
+      svn_stream_t *stream;
+      apr_size_t len;
+
+      SVN_ERR(svn_fs_get_file_delta_stream(&delta_stream, root1, "file",
+                                           root2, "file", pool));
+      svn_txdelta_to_svndiff3(&handler, &handler_baton,
+                              svn_stream_from_stringbuf(svndiff, pool),
+                              version, SVN_DELTA_COMPRESSION_LEVEL_DEFAULT,
+                              pool);
+      SVN_ERR(svn_txdelta_send_txstream(delta_stream, handler,
+                                        handler_baton, pool));
+      SVN_TEST_ASSERT(svndiff->len > 4 && svndiff->data[3] <= version);
+
+      /* Versions that can hold the stored data get the exact bytes from
+       * the revision file.  Older ones get re-encoded. */
+      if (version >= stored_version)
+        SVN_TEST_ASSERT(find_data(rev_contents, svndiff->data,
+                                  svndiff->len) == offset + 1);
+      else
+        SVN_TEST_ASSERT(svndiff->data[3] == version);
+
+      /* Apply the svndiff data to the first revision. */
+      svn_txdelta_apply(svn_stream_from_string(svn_string_create(contents1,
+                                                                 pool),
+                                               pool),
+                        svn_stream_from_stringbuf(result, pool),
+                        NULL, NULL, pool, &handler, &handler_baton);
+      stream = svn_txdelta_parse_svndiff(handler, handler_baton, TRUE, pool);
+      len = svndiff->len;
+      SVN_ERR(svn_stream_write(stream, svndiff->data, &len));
+      SVN_ERR(svn_stream_close(stream));
+
+      SVN_TEST_STRING_ASSERT(result->data, contents2);
+    }
+
+  return SVN_NO_ERROR;
+}
+
 
 
 /* The test table.  */
@@ -516,6 +649,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "load the P2L index"),
     SVN_TEST_OPTS_PASS(build_rep_cache,
                        "build the representation cache"),
+    SVN_TEST_OPTS_PASS(forward_stored_svndiff,
+                       "send stored deltas as svndiff"),
     SVN_TEST_NULL
   };
 
@@ -36,10 +36,13 @@
 #include "svn_cmdline.h"
 #include "svn_dirent_uri.h"
 #include "svn_hash.h"
+#include "svn_props.h"
 
 #include "../svn_test.h"
 #include "../svn_test_fs.h"
 #include "../../libsvn_ra_local/ra_local.h"
+#include "../../libsvn_ra/ra_loader.h"
+#include "private/svn_ra_private.h"
 
 /*-------------------------------------------------------------------*/
 
@@ -1912,6 +1915,391 @@ test_get_deleted_rev_errors(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Baton for the batched request receivers.  Records the paths reported
+   and what has been reported for them. */
+typedef struct batch_baton_t
+{
+  apr_array_header_t *paths;
+  apr_array_header_t *kinds;
+  apr_pool_t *pool;
+} batch_baton_t;
+
+/* Implements svn_ra__stat_receiver_t. */
+static svn_error_t *
+stat_many_receiver(void *baton,
+                   const char *path,
+                   const svn_dirent_t *dirent,
+                   apr_pool_t *scratch_pool)
+{
+  batch_baton_t *b = baton;
+
+  APR_ARRAY_PUSH(b->paths, const char *) = apr_pstrdup(b->pool, path);
+  APR_ARRAY_PUSH(b->kinds, svn_node_kind_t) = dirent ? dirent->kind
+                                                     : svn_node_none;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_ra__file_stream_func_t. */
+static svn_error_t *
+get_files_stream(svn_stream_t **stream,
+                 void *baton,
+                 const char *path,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  *stream = svn_stream_empty(result_pool);
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_ra__file_receiver_t. */
+static svn_error_t *
+get_files_receiver(void *baton,
+                   const char *path,
+                   svn_revnum_t fetched_rev,
+                   apr_hash_t *props,
+                   apr_pool_t *scratch_pool)
+{
+  batch_baton_t *b = baton;
+
+  SVN_TEST_ASSERT(fetched_rev == 1);
+  SVN_TEST_ASSERT(props != NULL);
+
+  APR_ARRAY_PUSH(b->paths, const char *) = apr_pstrdup(b->pool, path);
+  APR_ARRAY_PUSH(b->kinds, svn_node_kind_t) = svn_node_file;
+  return SVN_NO_ERROR;
+}
+
+/* Run batched stat and get-file requests against the tree created by
+   commit_tree() in SESSION and verify the results. */
+static svn_error_t *
+check_batched_requests(svn_ra_session_t *session,
+                       apr_pool_t *pool)
+{
+  apr_array_header_t *paths = apr_array_make(pool, 4, sizeof(const char *));
+  batch_baton_t b;
+  svn_error_t *err;
+
+  b.pool = pool;
+  b.paths = apr_array_make(pool, 4, sizeof(const char *));
+  b.kinds = apr_array_make(pool, 4, sizeof(svn_node_kind_t));
+
+  APR_ARRAY_PUSH(paths, const char *) = "A/B/f";
+  APR_ARRAY_PUSH(paths, const char *) = "A/no-such-path";
+  APR_ARRAY_PUSH(paths, const char *) = "A/BB";
+  SVN_ERR(svn_ra__stat_many(session, paths, 1, stat_many_receiver, &b,
+                            pool));
+
+  SVN_TEST_INT_ASSERT(b.paths->nelts, 3);
+  SVN_TEST_STRING_ASSERT(APR_ARRAY_IDX(b.paths, 0, const char *), "A/B/f");
+  SVN_TEST_STRING_ASSERT(APR_ARRAY_IDX(b.paths, 1, const char *),
+                         "A/no-such-path");
+  SVN_TEST_STRING_ASSERT(APR_ARRAY_IDX(b.paths, 2, const char *), "A/BB");
+  SVN_TEST_ASSERT(APR_ARRAY_IDX(b.kinds, 0, svn_node_kind_t)
+                  == svn_node_file);
+  SVN_TEST_ASSERT(APR_ARRAY_IDX(b.kinds, 1, svn_node_kind_t)
+                  == svn_node_none);
+  SVN_TEST_ASSERT(APR_ARRAY_IDX(b.kinds, 2, svn_node_kind_t)
+                  == svn_node_dir);
+
+  apr_array_clear(paths);
+  apr_array_clear(b.paths);
+  apr_array_clear(b.kinds);
+  APR_ARRAY_PUSH(paths, const char *) = "A/B/g";
+  APR_ARRAY_PUSH(paths, const char *) = "A/BB/f";
+  SVN_ERR(svn_ra__get_files(session, paths, SVN_INVALID_REVNUM, TRUE,
+                            get_files_stream, get_files_receiver, &b, pool));
+
+  SVN_TEST_INT_ASSERT(b.paths->nelts, 2);
+  SVN_TEST_STRING_ASSERT(APR_ARRAY_IDX(b.paths, 0, const char *), "A/B/g");
+  SVN_TEST_STRING_ASSERT(APR_ARRAY_IDX(b.paths, 1, const char *), "A/BB/f");
+
+  /* Directories are an error and the session remains usable afterwards. */
+  apr_array_clear(b.paths);
+  APR_ARRAY_PUSH(paths, const char *) = "A/BB";
+  err = svn_ra__get_files(session, paths, 1, TRUE, NULL,
+                          get_files_receiver, &b, pool);
+  SVN_TEST_ASSERT(err != SVN_NO_ERROR);
+  svn_error_clear(err);
+  SVN_TEST_INT_ASSERT(b.paths->nelts, 2);
+
+  apr_array_clear(b.paths);
+  apr_array_clear(b.kinds);
+  SVN_ERR(svn_ra__stat_many(session, paths, 1, stat_many_receiver, &b,
+                            pool));
+  SVN_TEST_INT_ASSERT(b.paths->nelts, 3);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+batched_requests(const svn_test_opts_t *opts,
+                 apr_pool_t *pool)
+{
+  svn_ra_session_t *session;
+
+  SVN_ERR(make_and_open_repos(&session, "batched_requests", opts, pool));
+  SVN_ERR(commit_tree(session, pool));
+
+  return svn_error_trace(check_batched_requests(session, pool));
+}
+
+/* Like batched_requests but always talks to svnserve, so that the
+   stat-many and get-files commands are used instead of the fallback. */
+static svn_error_t *
+batched_requests_tunnel(const svn_test_opts_t *opts,
+                        apr_pool_t *pool)
+{
+  tunnel_baton_t *tb = apr_pcalloc(pool, sizeof(*tb));
+  apr_pool_t *scratch_pool = svn_pool_create(pool);
+  const char *url;
+  svn_ra_callbacks2_t *cbtable;
+  svn_ra_session_t *session;
+  const char tunnel_repos_name[] = "test-repo-batched-tunnel";
+  apr_array_header_t *paths = apr_array_make(pool, 2, sizeof(const char *));
+  batch_baton_t b;
+
+  tb->magic = TUNNEL_MAGIC;
+
+  SVN_ERR(svn_test__create_repos(NULL, tunnel_repos_name, opts, scratch_pool));
+
+  /* Immediately close the repository to avoid race condition with svnserve
+     (and then the cleanup code) with BDB when our pool is cleared. */
+  svn_pool_clear(scratch_pool);
+
+  url = apr_pstrcat(pool, "svn+test://localhost/", tunnel_repos_name,
+                    SVN_VA_NULL);
+  SVN_ERR(svn_ra_create_callbacks(&cbtable, pool));
+  cbtable->check_tunnel_func = check_tunnel;
+  cbtable->open_tunnel_func = open_tunnel;
+  cbtable->tunnel_baton = tb;
+  SVN_ERR(svn_cmdline_create_auth_baton2(&cbtable->auth_baton,
+                                         TRUE  /* non_interactive */,
+                                         "jrandom", "rayjandom",
+                                         NULL,
+                                         TRUE  /* no_auth_cache */,
+                                         FALSE /* trust_server_cert */,
+                                         FALSE, FALSE, FALSE, FALSE,
+                                         NULL, NULL, NULL, pool));
+
+  SVN_ERR(svn_ra_open5(&session, NULL, NULL, url, NULL, cbtable, NULL, NULL,
+                       scratch_pool));
+  SVN_ERR(commit_tree(session, scratch_pool));
+
+  /* Call ra_svn directly first, so that a missing server-side command
+     does not go unnoticed behind the fallback. */
+  b.pool = pool;
+  b.paths = apr_array_make(pool, 2, sizeof(const char *));
+  b.kinds = apr_array_make(pool, 2, sizeof(svn_node_kind_t));
+  APR_ARRAY_PUSH(paths, const char *) = "A/B/f";
+  APR_ARRAY_PUSH(paths, const char *) = "A/BB";
+  SVN_ERR(session->vtable->stat_many(session, paths, 1, stat_many_receiver,
+                                     &b, pool));
+  SVN_TEST_INT_ASSERT(b.paths->nelts, 2);
+  SVN_TEST_ASSERT(APR_ARRAY_IDX(b.kinds, 1, svn_node_kind_t)
+                  == svn_node_dir);
+
+  apr_array_clear(paths);
+  APR_ARRAY_PUSH(paths, const char *) = "A/B/g";
+  APR_ARRAY_PUSH(paths, const char *) = "A/BB/f";
+  SVN_ERR(session->vtable->get_files(session, paths, 1, TRUE,
+                                     get_files_stream, get_files_receiver,
+                                     &b, pool));
+  SVN_TEST_INT_ASSERT(b.paths->nelts, 4);
+  SVN_TEST_STRING_ASSERT(APR_ARRAY_IDX(b.paths, 3, const char *), "A/BB/f");
+
+  SVN_ERR(check_batched_requests(session, scratch_pool));
+
+  svn_pool_destroy(scratch_pool);
+  SVN_TEST_ASSERT(tb->open_count == 0);
+  return SVN_NO_ERROR;
+}
+
+/* Baton for blame_rev_func() and blame_chunk_func(). */
+typedef struct blame_baton_t
+{
+  apr_pool_t *pool;
+
+  /* The revisions of the reported versions, space-separated. */
+  svn_stringbuf_t *versions;
+
+  /* Line starts as apr_int64_t and revisions as svn_revnum_t. */
+  apr_array_header_t *starts;
+  apr_array_header_t *revs;
+} blame_baton_t;
+
+/* Implements svn_ra__blame_rev_func_t. */
+static svn_error_t *
+blame_rev_func(void *baton,
+               const char *path,
+               svn_revnum_t revision,
+               apr_hash_t *rev_props,
+               apr_pool_t *scratch_pool)
+{
+  blame_baton_t *b = baton;
+
+  SVN_TEST_STRING_ASSERT(path, "/iota");
+  SVN_TEST_ASSERT(svn_hash_gets(rev_props, SVN_PROP_REVISION_DATE));
+
+  svn_stringbuf_appendcstr(b->versions,
+                           apr_psprintf(scratch_pool, "%s%ld",
+                                        b->versions->len ? " " : "",
+                                        revision));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_ra__blame_chunk_func_t. */
+static svn_error_t *
+blame_chunk_func(void *baton,
+                 apr_int64_t line_start,
+                 svn_revnum_t revision,
+                 apr_pool_t *scratch_pool)
+{
+  blame_baton_t *b = baton;
+
+  APR_ARRAY_PUSH(b->starts, apr_int64_t) = line_start;
+  APR_ARRAY_PUSH(b->revs, svn_revnum_t) = revision;
+
+  return SVN_NO_ERROR;
+}
+
+/* Blame PATH in SESSION from START to END through the RA vtable and
+   compare the reported versions with EXPECTED_VERSIONS, the result with
+   the COUNT ranges given by EXPECTED_STARTS and EXPECTED_REVS and the
+   returned file contents with EXPECTED_CONTENTS. */
+static svn_error_t *
+check_file_blame(svn_ra_session_t *session,
+                 const char *path,
+                 svn_revnum_t start,
+                 svn_revnum_t end,
+                 const char *expected_versions,
+                 const apr_int64_t *expected_starts,
+                 const svn_revnum_t *expected_revs,
+                 int count,
+                 const char *expected_contents,
+                 apr_pool_t *pool)
+{
+  blame_baton_t b;
+  svn_stringbuf_t *contents = svn_stringbuf_create_empty(pool);
+  int i;
+
+  b.pool = pool;
+  b.versions = svn_stringbuf_create_empty(pool);
+  b.starts = apr_array_make(pool, count, sizeof(apr_int64_t));
+  b.revs = apr_array_make(pool, count, sizeof(svn_revnum_t));
+
+  /* Call the RA layer directly, so that a missing server-side command
+     does not go unnoticed behind a client-side fallback. */
+  SVN_ERR(session->vtable->get_file_blame(session, path, start, end, NULL,
+                                          blame_rev_func, blame_chunk_func,
+                                          &b,
+                                          svn_stream_from_stringbuf(contents,
+                                                                    pool),
+                                          pool));
+
+  SVN_TEST_STRING_ASSERT(b.versions->data, expected_versions);
+  SVN_TEST_INT_ASSERT(b.starts->nelts, count);
+  for (i = 0; i < count; ++i)
+    {
+      SVN_TEST_INT_ASSERT(APR_ARRAY_IDX(b.starts, i, apr_int64_t),
+                          expected_starts[i]);
+      SVN_TEST_INT_ASSERT(APR_ARRAY_IDX(b.revs, i, svn_revnum_t),
+                          expected_revs[i]);
+    }
+  SVN_TEST_STRING_ASSERT(contents->data, expected_contents);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+file_blame_tunnel(const svn_test_opts_t *opts,
+                  apr_pool_t *pool)
+{
+  tunnel_baton_t *tb = apr_pcalloc(pool, sizeof(*tb));
+  apr_pool_t *scratch_pool = svn_pool_create(pool);
+  const char *url;
+  svn_ra_callbacks2_t *cbtable;
+  svn_ra_session_t *session;
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev = 0;
+  const char tunnel_repos_name[] = "test-repo-file-blame-tunnel";
+  static const apr_int64_t all_starts[] = { 0, 1 };
+  static const svn_revnum_t all_revs[] = { 2, 3 };
+  static const svn_revnum_t latest_revs[] = { SVN_INVALID_REVNUM, 3 };
+  static const char iota_contents[] = "line 1\nline two\nline 3\n";
+
+  tb->magic = TUNNEL_MAGIC;
+
+  /* r1: greek tree, r2: two lines in iota,
+     r3: change the second line and add a third one. */
+  SVN_ERR(svn_test__create_repos(&repos, tunnel_repos_name, opts,
+                                 scratch_pool));
+  fs = svn_repos_fs(repos);
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, scratch_pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, scratch_pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, scratch_pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                  scratch_pool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, scratch_pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, scratch_pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "iota",
+                                      "line 1\nline 2\n", scratch_pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                  scratch_pool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, scratch_pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, scratch_pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "iota", iota_contents,
+                                      scratch_pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                  scratch_pool));
+
+  /* Immediately close the repository to avoid race condition with svnserve
+     (and then the cleanup code) with BDB when our pool is cleared. */
+  svn_pool_clear(scratch_pool);
+
+  url = apr_pstrcat(pool, "svn+test://localhost/", tunnel_repos_name,
+                    SVN_VA_NULL);
+  SVN_ERR(svn_ra_create_callbacks(&cbtable, pool));
+  cbtable->check_tunnel_func = check_tunnel;
+  cbtable->open_tunnel_func = open_tunnel;
+  cbtable->tunnel_baton = tb;
+  SVN_ERR(svn_cmdline_create_auth_baton2(&cbtable->auth_baton,
+                                         TRUE  /* non_interactive */,
+                                         "jrandom", "rayjandom",
+                                         NULL,
+                                         TRUE  /* no_auth_cache */,
+                                         FALSE /* trust_server_cert */,
+                                         FALSE, FALSE, FALSE, FALSE,
+                                         NULL, NULL, NULL, pool));
+
+  SVN_ERR(svn_ra_open5(&session, NULL, NULL, url, NULL, cbtable, NULL, NULL,
+                       scratch_pool));
+
+  SVN_ERR(check_file_blame(session, "iota", 1, 3, "1 2 3",
+                           all_starts, all_revs, 2, iota_contents,
+                           scratch_pool));
+  SVN_ERR(check_file_blame(session, "iota", 3, 3, "2 3",
+                           all_starts, latest_revs, 2, iota_contents,
+                           scratch_pool));
+
+  /* The session remains usable after an error. */
+  SVN_TEST_ASSERT_ANY_ERROR(check_file_blame(session, "A", 1, 3, "",
+                                             NULL, NULL, 0, "",
+                                             scratch_pool));
+  SVN_ERR(check_file_blame(session, "iota", 2, 3, "1 2 3",
+                           all_starts, all_revs, 2, iota_contents,
+                           scratch_pool));
+
+  svn_pool_destroy(scratch_pool);
+  SVN_TEST_ASSERT(tb->open_count == 0);
+  return SVN_NO_ERROR;
+}
+
 
 /* The test table.  */
 
@@ -1952,6 +2340,12 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test get-deleted-rev no delete"),
     SVN_TEST_OPTS_PASS(test_get_deleted_rev_errors,
                        "test get-deleted-rev errors"),
+    SVN_TEST_OPTS_PASS(batched_requests,
+                       "test batched stat and get-file requests"),
+    SVN_TEST_OPTS_PASS(batched_requests_tunnel,
+                       "test batched requests over a tunnel"),
+    SVN_TEST_OPTS_PASS(file_blame_tunnel,
+                       "test server-side blame over a tunnel"),
     SVN_TEST_NULL
   };
 
@@ -511,6 +511,104 @@ reposful_reposless_stanzas_inherit(apr_pool_t *pool)
    return SVN_NO_ERROR;
 }
 
+/* Look up many paths in an order that makes every lookup start from a
+ * different parent of the previous one and compare the results with
+ * lookups that start from scratch. */
+static svn_error_t *
+lookup_reuses_parents(apr_pool_t *pool)
+{
+  const char rules[] =
+    "[/]"                     NL
+    "* = r"                   NL
+    ""                        NL
+    "[/A]"                    NL
+    "userA = rw"              NL
+    ""                        NL
+    "[/A/B/C]"                NL
+    "* ="                     NL
+    ""                        NL
+    "[/A/B/C/D]"              NL
+    "userA = r"               NL
+    ""                        NL
+    "[:glob:/**/secret*]"     NL
+    "* ="                     NL
+    ""                        NL
+    "[:glob:/A/*/x]"          NL
+    "userA ="                 NL
+    ""                        NL
+    "[:glob:/A/B/*]"          NL
+    "userA = r"               NL;
+
+  static const char *const paths[] = {
+    "/A/B/C/D/E", "/A/B/C/D", "/A/B/C/X", "/A/B/x", "/A/B/C/D/secret1",
+    "/A/B/Y/secret", "/A/B/Y/public", "/A/Q/x", "/A/Q/x/y", "/A",
+    "/A/B/C/D/E/F/G", "/A/B/C", "/B/secret", "/B/C/D", "/A/B/C/D/E/F",
+    "/A//B/C/D", "/A/B/", "/", NULL
+  };
+  static const svn_repos_authz_access_t required[] = {
+    svn_authz_read, svn_authz_write, svn_authz_read | svn_authz_recursive,
+    svn_authz_write | svn_authz_recursive
+  };
+
+  svn_authz_t *authz;
+  svn_boolean_t granted;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int r, i, k;
+
+  SVN_ERR(svn_repos_authz_parse2(&authz,
+                                 svn_stream_from_string(
+                                   svn_string_create(rules, pool), pool),
+                                 NULL, NULL, NULL, pool, pool));
+
+  for (r = 0; r < sizeof(required) / sizeof(required[0]); ++r)
+    for (k = 0; k < 3; ++k)
+      for (i = 0; paths[i]; ++i)
+        {
+          /* Walk the list forward, backward and in strides. */
+          int idx = k == 0 ? i
+                  : k == 1 ? (int)(sizeof(paths) / sizeof(paths[0])) - 2 - i
+                  : (i * 7) % (int)(sizeof(paths) / sizeof(paths[0]) - 1);
+          svn_authz_t *fresh;
+          svn_boolean_t expected;
+
+          svn_pool_clear(iterpool);
+          SVN_ERR(svn_repos_authz_parse2(&fresh,
+                                         svn_stream_from_string(
+                                           svn_string_create(rules, iterpool),
+                                           iterpool),
+                                         NULL, NULL, NULL,
+                                         iterpool, iterpool));
+
+          SVN_ERR(svn_repos_authz_check_access(authz, "repo", paths[idx],
+                                               "userA", required[r],
+                                               &granted, iterpool));
+          SVN_ERR(svn_repos_authz_check_access(fresh, "repo", paths[idx],
+                                               "userA", required[r],
+                                               &expected, iterpool));
+          if (granted != expected)
+            return svn_error_createf(SVN_ERR_TEST_FAILED, NULL,
+                                     "Access %d to '%s' is %d, expected %d",
+                                     required[r], paths[idx], granted,
+                                     expected);
+        }
+
+  /* A trailing '/' must not add an empty segment when resuming at a
+   * parent of the previous path.  The last glob rule would match it. */
+  SVN_ERR(svn_repos_authz_check_access(authz, "repo", "/A/B/C/D", "userA",
+                                       svn_authz_read, &granted, pool));
+  SVN_TEST_ASSERT(granted);
+  SVN_ERR(svn_repos_authz_check_access(authz, "repo", "/A/B/", "userA",
+                                       svn_authz_write, &granted, pool));
+  SVN_TEST_ASSERT(granted);
+  SVN_ERR(svn_repos_authz_check_access(authz, "repo", "/A/B/C/", "userA",
+                                       svn_authz_write, &granted, pool));
+  SVN_TEST_ASSERT(!granted);
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 static int max_threads = 4;
 
 static struct svn_test_descriptor_t test_funcs[] =
@@ -524,6 +622,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "issue 4741 groups"),
     SVN_TEST_PASS2(reposful_reposless_stanzas_inherit,
                     "[foo:/] inherits [/]"),
+    SVN_TEST_PASS2(lookup_reuses_parents,
+                   "reuse parent lookups across paths"),
     SVN_TEST_NULL
   };
 
@@ -35,12 +35,14 @@
 #include "svn_repos.h"
 #include "svn_path.h"
 #include "svn_delta.h"
+#include "svn_diff.h"
 #include "svn_config.h"
 #include "svn_props.h"
 #include "svn_sorts.h"
 #include "svn_version.h"
 #include "private/svn_repos_private.h"
 #include "private/svn_dep_compat.h"
+#include "private/svn_diff_private.h"
 
 /* be able to look into svn_config_t */
 #include "../../libsvn_subr/config_impl.h"
@@ -4468,6 +4470,941 @@ test_list(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Log receiver that appends the revision numbers to the
+   apr_array_header_t of svn_revnum_t in BATON. */
+static svn_error_t *
+log_revs_receiver(void *baton,
+                  svn_repos_log_entry_t *log_entry,
+                  apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *revs = baton;
+  APR_ARRAY_PUSH(revs, svn_revnum_t) = log_entry->revision;
+  return SVN_NO_ERROR;
+}
+
+/* Set *REVS to the revisions reported by svn_repos_get_logs5() for PATH
+   in REPOS from HEAD down to 0.  Allocate *REVS in POOL. */
+static svn_error_t *
+get_log_revs(apr_array_header_t **revs,
+             svn_repos_t *repos,
+             const char *path,
+             svn_boolean_t strict_node_history,
+             apr_pool_t *pool)
+{
+  apr_array_header_t *paths = apr_array_make(pool, 1, sizeof(const char *));
+  APR_ARRAY_PUSH(paths, const char *) = path;
+
+  *revs = apr_array_make(pool, 4, sizeof(svn_revnum_t));
+  SVN_ERR(svn_repos_get_logs5(repos, paths, SVN_INVALID_REVNUM, 0, 0,
+                              strict_node_history, FALSE, NULL, NULL, NULL,
+                              NULL, NULL, log_revs_receiver, *revs, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Assert that the revision lists ACTUAL and EXPECTED are equal. */
+static svn_error_t *
+compare_log_revs(const apr_array_header_t *actual,
+                 const apr_array_header_t *expected)
+{
+  int i;
+
+  SVN_TEST_INT_ASSERT(actual->nelts, expected->nelts);
+  for (i = 0; i < actual->nelts; ++i)
+    SVN_TEST_INT_ASSERT(APR_ARRAY_IDX(actual, i, svn_revnum_t),
+                        APR_ARRAY_IDX(expected, i, svn_revnum_t));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+get_logs_cached(const svn_test_opts_t *opts,
+                apr_pool_t *pool)
+{
+  svn_repos_t *repos, *repos2;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root, *rev_root;
+  svn_revnum_t youngest_rev = 0;
+  apr_array_header_t *revs, *cached_revs;
+  apr_pool_t *subpool = svn_pool_create(pool);
+  static const svn_revnum_t expected[] = { 5, 4, 2, 1 };
+  static const svn_revnum_t expected_strict[] = { 5, 4 };
+  int i;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-get-logs-cached",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  /* r1: greek tree, r2: change A/mu, r3: change iota,
+     r4: copy A to A2, r5: change A2/mu. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/mu", "r2", subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "iota", "r3", subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_copy(rev_root, "A", txn_root, "A2", subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A2/mu", "r5", subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  svn_pool_clear(subpool);
+
+  /* Populate the cache, then read from it.  Other repository instances
+     share the cache entries. */
+  SVN_ERR(svn_repos_open3(&repos2, svn_repos_path(repos, pool), NULL,
+                          pool, pool));
+  for (i = 0; i < 2; ++i)
+    {
+      svn_boolean_t strict = (i == 1);
+      const svn_revnum_t *expected_revs = strict ? expected_strict
+                                                 : expected;
+      int count = strict ? 2 : 4;
+      int k;
+
+      SVN_ERR(get_log_revs(&revs, repos, "/A2/mu", strict, subpool));
+      SVN_TEST_INT_ASSERT(revs->nelts, count);
+      for (k = 0; k < count; ++k)
+        SVN_TEST_INT_ASSERT(APR_ARRAY_IDX(revs, k, svn_revnum_t),
+                            expected_revs[k]);
+
+      SVN_ERR(get_log_revs(&cached_revs, repos, "/A2/mu", strict, subpool));
+      SVN_ERR(compare_log_revs(cached_revs, revs));
+
+      SVN_ERR(get_log_revs(&cached_revs, repos2, "/A2/mu", strict, subpool));
+      SVN_ERR(compare_log_revs(cached_revs, revs));
+    }
+
+  /* A new commit must show up even though older history is cached. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A2/mu", "r6", subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+
+  SVN_ERR(get_log_revs(&revs, repos2, "/A2/mu", FALSE, subpool));
+  SVN_TEST_INT_ASSERT(revs->nelts, 5);
+  SVN_TEST_INT_ASSERT(APR_ARRAY_IDX(revs, 0, svn_revnum_t), 6);
+  SVN_TEST_INT_ASSERT(APR_ARRAY_IDX(revs, 1, svn_revnum_t), 5);
+
+  svn_pool_destroy(subpool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+get_logs_cached_recreated(const svn_test_opts_t *opts,
+                          apr_pool_t *pool)
+{
+  const char *repos_name = "test-repo-get-logs-cached-recreated";
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root, *rev_root;
+  svn_revnum_t youngest_rev;
+  apr_array_header_t *revs;
+  const char *uuid;
+  apr_pool_t *subpool = svn_pool_create(pool);
+  int i;
+
+  /* Bail (with success) on known-untestable scenarios */
+  if ((strcmp(opts->fs_type, SVN_FS_TYPE_FSFS) == 0)
+      && opts->server_minor_version
+      && (opts->server_minor_version < 9))
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "FSFS instance IDs require SVN 1.9+");
+
+  /* r1: greek tree, r2: copy A to A2, r3 to r5: change A2/mu. */
+  SVN_ERR(svn_test__create_repos(&repos, repos_name, opts, subpool));
+  fs = svn_repos_fs(repos);
+  youngest_rev = 0;
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_copy(rev_root, "A", txn_root, "A2", subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+
+  for (i = 3; i <= 5; ++i)
+    {
+      SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, "A2/mu",
+                                          apr_psprintf(subpool, "r%d", i),
+                                          subpool));
+      SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                      subpool));
+    }
+
+  /* Populate the history cache. */
+  SVN_ERR(get_log_revs(&revs, repos, "/A2/mu", FALSE, subpool));
+  SVN_TEST_INT_ASSERT(revs->nelts, 5);
+  SVN_ERR(svn_fs_get_uuid(fs, &uuid, pool));
+  svn_pool_clear(subpool);
+
+  /* Re-create the repository at the same path and with the same UUID
+     but with a different history: r1: greek tree, r2 to r4: change iota,
+     r5: copy A to A2. */
+  SVN_ERR(svn_test__create_repos(&repos, repos_name, opts, subpool));
+  fs = svn_repos_fs(repos);
+  SVN_ERR(svn_fs_set_uuid(fs, uuid, subpool));
+  youngest_rev = 0;
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+
+  for (i = 2; i <= 4; ++i)
+    {
+      SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, "iota",
+                                          apr_psprintf(subpool, "r%d", i),
+                                          subpool));
+      SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                      subpool));
+    }
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_copy(rev_root, "A", txn_root, "A2", subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+
+  /* None of the old history may leak into the new repository. */
+  SVN_ERR(get_log_revs(&revs, repos, "/A2/mu", FALSE, subpool));
+  SVN_TEST_INT_ASSERT(revs->nelts, 2);
+  SVN_TEST_INT_ASSERT(APR_ARRAY_IDX(revs, 0, svn_revnum_t), 5);
+  SVN_TEST_INT_ASSERT(APR_ARRAY_IDX(revs, 1, svn_revnum_t), 1);
+
+  svn_pool_destroy(subpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton for the blame callbacks below. */
+typedef struct blame_test_baton_t
+{
+  /* The line attribution, as version indexes as ints. */
+  svn_diff__blame_chain_t *chain;
+
+  /* How to compare the versions. */
+  const svn_diff_file_options_t *options;
+
+  /* The reported versions and ranges of lines in the format of
+     check_blame(). */
+  svn_stringbuf_t *revs;
+  svn_stringbuf_t *lines;
+} blame_test_baton_t;
+
+/* Implements svn_repos__blame_diff_t.add_file(). */
+static svn_error_t *
+blame_test_add_file(void *baton,
+                    const char *last_file,
+                    const char *file,
+                    int version,
+                    apr_pool_t *scratch_pool)
+{
+  blame_test_baton_t *btb = baton;
+  int *rev = apr_palloc(btb->chain->pool, sizeof(*rev));
+
+  *rev = version;
+  return svn_error_trace(svn_diff__blame_add_file(btb->chain, last_file,
+                                                  file, rev, btb->options,
+                                                  NULL, NULL,
+                                                  scratch_pool));
+}
+
+/* Implements svn_repos__blame_diff_t.get_chunks(). */
+static svn_error_t *
+blame_test_get_chunks(apr_array_header_t **chunks,
+                      void *baton,
+                      apr_pool_t *result_pool)
+{
+  blame_test_baton_t *btb = baton;
+  const svn_diff__blame_chunk_t *walk;
+
+  *chunks = apr_array_make(result_pool, 4, sizeof(svn_repos__blame_chunk_t));
+  for (walk = btb->chain->blame; walk; walk = walk->next)
+    {
+      svn_repos__blame_chunk_t *chunk = apr_array_push(*chunks);
+
+      chunk->line_start = walk->start;
+      chunk->version = *(const int *)walk->rev;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_repos__blame_rev_func_t.  Append REVISION to the list
+   of versions in BATON. */
+static svn_error_t *
+blame_test_rev_func(void *baton,
+                    const char *path,
+                    svn_revnum_t revision,
+                    apr_hash_t *rev_props,
+                    apr_pool_t *scratch_pool)
+{
+  blame_test_baton_t *btb = baton;
+
+  SVN_TEST_STRING_ASSERT(path, "/iota");
+  SVN_TEST_ASSERT(svn_hash_gets(rev_props, SVN_PROP_REVISION_DATE));
+
+  svn_stringbuf_appendcstr(btb->revs,
+                           apr_psprintf(scratch_pool, "%s%ld",
+                                        btb->revs->len ? " " : "",
+                                        revision));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_repos__blame_chunk_func_t.  Append LINE_START and
+   REVISION to the list of ranges in BATON. */
+static svn_error_t *
+blame_test_chunk_func(void *baton,
+                      apr_int64_t line_start,
+                      svn_revnum_t revision,
+                      apr_pool_t *scratch_pool)
+{
+  blame_test_baton_t *btb = baton;
+
+  svn_stringbuf_appendcstr(btb->lines,
+                           apr_psprintf(scratch_pool,
+                                        "%s%" APR_INT64_T_FMT ":%ld",
+                                        btb->lines->len ? " " : "",
+                                        line_start, revision));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_repos_authz_func_t.  Deny access to everything older
+   than the revision pointed to by BATON. */
+static svn_error_t *
+blame_test_authz_func(svn_boolean_t *allowed,
+                      svn_fs_root_t *root,
+                      const char *path,
+                      void *baton,
+                      apr_pool_t *pool)
+{
+  const svn_revnum_t *oldest_readable = baton;
+
+  *allowed = svn_fs_revision_root_revision(root) >= *oldest_readable;
+
+  return SVN_NO_ERROR;
+}
+
+/* Blame PATH in REPOS from START to END with DIFF_OPTIONS, hiding the
+   revisions before OLDEST_READABLE from authz.  Compare the reported
+   versions to EXPECTED_REVS, a string of space-separated revisions, and
+   the reported ranges of lines to EXPECTED_LINES, a string of
+   space-separated "line:rev" pairs with rev being -1 for lines that are
+   older than START. */
+static svn_error_t *
+check_blame(svn_repos_t *repos,
+            const char *path,
+            svn_revnum_t start,
+            svn_revnum_t end,
+            svn_diff_file_options_t *diff_options,
+            svn_revnum_t oldest_readable,
+            const char *expected_revs,
+            const char *expected_lines,
+            apr_pool_t *pool)
+{
+  blame_test_baton_t btb;
+  svn_repos__blame_diff_t diff;
+
+  btb.chain = svn_diff__blame_chain_create(pool);
+  btb.options = diff_options;
+  btb.revs = svn_stringbuf_create_empty(pool);
+  btb.lines = svn_stringbuf_create_empty(pool);
+
+  diff.add_file = blame_test_add_file;
+  diff.get_chunks = blame_test_get_chunks;
+  diff.options_key = apr_itoa(pool, diff_options->ignore_space);
+  diff.baton = &btb;
+
+  SVN_ERR(svn_repos__get_file_blame(repos, path, start, end, &diff,
+                                    blame_test_authz_func, &oldest_readable,
+                                    blame_test_rev_func,
+                                    blame_test_chunk_func, &btb, pool));
+
+  SVN_TEST_STRING_ASSERT(btb.revs->data, expected_revs);
+  SVN_TEST_STRING_ASSERT(btb.lines->data, expected_lines);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+get_file_blame(const svn_test_opts_t *opts,
+               apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev = 0;
+  svn_diff_file_options_t *diff_options;
+  svn_diff_file_options_t *ignore_space;
+  apr_pool_t *subpool = svn_pool_create(pool);
+
+  /* r1: greek tree, r2: replace iota, r3: change a property of iota,
+     r4: change the second line and add a third one,
+     r5: change whitespace in the first line. */
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-get-file-blame",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "iota",
+                                      "line 1\nline 2\n", subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_fs_change_node_prop(txn_root, "iota", "prop",
+                                  svn_string_create("value", subpool),
+                                  subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "iota",
+                                      "line 1\nline two\nline 3\n",
+                                      subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "iota",
+                                      "line  1\nline two\nline 3\n",
+                                      subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  svn_pool_clear(subpool);
+
+  diff_options = svn_diff_file_options_create(pool);
+  ignore_space = svn_diff_file_options_create(pool);
+  ignore_space->ignore_space = svn_diff_file_ignore_space_change;
+
+  /* Property changes are never blamed, but the versions are reported. */
+  SVN_ERR(check_blame(repos, "/iota", 1, 4, diff_options, 0,
+                      "1 2 3 4", "0:2 1:4", subpool));
+  SVN_ERR(check_blame(repos, "/iota", 1, 5, diff_options, 0,
+                      "1 2 3 4 5", "0:5 1:4", subpool));
+  SVN_ERR(check_blame(repos, "/iota", 1, 5, ignore_space, 0,
+                      "1 2 3 4 5", "0:2 1:4", subpool));
+
+  /* Lines older than START are not blamed on anybody. */
+  SVN_ERR(check_blame(repos, "/iota", 3, 5, diff_options, 0,
+                      "2 3 4 5", "0:5 1:4", subpool));
+  SVN_ERR(check_blame(repos, "/iota", 5, 5, diff_options, 0,
+                      "4 5", "0:5 1:-1", subpool));
+  SVN_ERR(check_blame(repos, "/iota", 5, 5, ignore_space, 0,
+                      "4 5", "0:-1", subpool));
+
+  /* Unreadable history ends the blame, even if the complete result has
+     been cached before.  The complete result is still cached then. */
+  SVN_ERR(check_blame(repos, "/iota", 1, 5, ignore_space, 4,
+                      "4 5", "0:4", subpool));
+  SVN_ERR(check_blame(repos, "/iota", 1, 5, ignore_space, 0,
+                      "1 2 3 4 5", "0:2 1:4", subpool));
+
+  SVN_TEST_ASSERT_ERROR(check_blame(repos, "/iota", 5, 4, diff_options, 0,
+                                    "", "", subpool),
+                        SVN_ERR_INCORRECT_PARAMS);
+
+  svn_pool_destroy(subpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *REVS to the revisions reported by a log of PATHS from END down to
+   START in REPOS, allocated in POOL. */
+static svn_error_t *
+get_paths_log_revs(apr_array_header_t **revs,
+                   svn_repos_t *repos,
+                   const apr_array_header_t *paths,
+                   svn_revnum_t start,
+                   svn_revnum_t end,
+                   svn_boolean_t strict_node_history,
+                   apr_pool_t *pool)
+{
+  *revs = apr_array_make(pool, 4, sizeof(svn_revnum_t));
+  SVN_ERR(svn_repos_get_logs5(repos, paths, end, start, 0,
+                              strict_node_history, FALSE, NULL, NULL, NULL,
+                              NULL, NULL, log_revs_receiver, *revs, pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+get_logs_many_paths(const svn_test_opts_t *opts,
+                    apr_pool_t *pool)
+{
+  svn_repos_t *repos, *parallel_repos, *read_ahead_repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root, *rev_root;
+  svn_revnum_t youngest_rev = 0;
+  apr_pool_t *subpool = svn_pool_create(pool);
+  apr_array_header_t *paths = apr_array_make(pool, 8, sizeof(const char *));
+  apr_hash_t *fs_config = apr_hash_make(pool);
+  static const char *files[] = { "iota", "A/mu", "A/B/lambda",
+                                 "A/D/gamma", "A/D/G/pi" };
+  int i, k;
+
+  /* Enough history per path to require several batches of history
+     locations when tracing it on worker threads. */
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-get-logs-many-paths",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+
+  for (i = 0; i < 120; ++i)
+    {
+      svn_pool_clear(subpool);
+      SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+
+      /* Branch A/D/G halfway through and keep changing the copy. */
+      if (i == 60)
+        {
+          SVN_ERR(svn_fs_revision_root(&rev_root, fs, youngest_rev,
+                                       subpool));
+          SVN_ERR(svn_fs_copy(rev_root, "A/D/G", txn_root, "A/D/G2",
+                              subpool));
+        }
+      else
+        {
+          const char *file = files[i % 7 % 5];
+          if (i > 60 && strcmp(file, "A/D/G/pi") == 0)
+            file = "A/D/G2/pi";
+
+          SVN_ERR(svn_test__set_file_contents(txn_root, file,
+                                              apr_psprintf(subpool, "%d", i),
+                                              subpool));
+        }
+
+      SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                      subpool));
+    }
+  svn_pool_clear(subpool);
+
+  /* A second instance of the repository that traces the histories on
+     worker threads. */
+  svn_hash_sets(fs_config, SVN_REPOS_CONFIG_PARALLEL_LOG, "true");
+  SVN_ERR(svn_repos_open3(&parallel_repos, svn_repos_path(repos, pool),
+                          fs_config, pool, pool));
+
+  /* Worker threads must not deadlock waiting for read-ahead tasks that
+     they would queue to their own thread pool. */
+  fs_config = apr_hash_copy(pool, fs_config);
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_READ_AHEAD, "16");
+  SVN_ERR(svn_repos_open3(&read_ahead_repos, svn_repos_path(repos, pool),
+                          fs_config, pool, pool));
+
+  APR_ARRAY_PUSH(paths, const char *) = "/iota";
+  APR_ARRAY_PUSH(paths, const char *) = "/A/mu";
+  APR_ARRAY_PUSH(paths, const char *) = "/A/B/lambda";
+  APR_ARRAY_PUSH(paths, const char *) = "/A/D/gamma";
+  APR_ARRAY_PUSH(paths, const char *) = "/A/D/G2/pi";
+  APR_ARRAY_PUSH(paths, const char *) = "/A/C";
+
+  /* The log of all paths must be the ordered union of the individual
+     path logs, no matter whether it gets cut off early or not. */
+  for (i = 0; i < 4; ++i)
+    {
+      svn_boolean_t strict = (i % 2 == 1);
+      svn_revnum_t start = (i < 2) ? 0 : 50;
+      apr_array_header_t *revs, *parallel_revs, *read_ahead_revs;
+      apr_array_header_t *expected;
+      svn_boolean_t *changed = apr_pcalloc(subpool, (youngest_rev + 1)
+                                                    * sizeof(*changed));
+      svn_revnum_t rev;
+
+      SVN_ERR(get_paths_log_revs(&revs, repos, paths, start, youngest_rev,
+                                 strict, subpool));
+      SVN_ERR(get_paths_log_revs(&parallel_revs, parallel_repos, paths,
+                                 start, youngest_rev, strict, subpool));
+      SVN_ERR(get_paths_log_revs(&read_ahead_revs, read_ahead_repos, paths,
+                                 start, youngest_rev, strict, subpool));
+
+      /* Logs of single paths get traced by the calling thread. */
+      for (k = 0; k < paths->nelts; ++k)
+        {
+          apr_array_header_t *path_revs;
+          apr_array_header_t *single
+            = apr_array_make(subpool, 1, sizeof(const char *));
+          int m;
+
+          APR_ARRAY_PUSH(single, const char *)
+            = APR_ARRAY_IDX(paths, k, const char *);
+          SVN_ERR(get_paths_log_revs(&path_revs, repos, single, start,
+                                     youngest_rev, strict, subpool));
+          for (m = 0; m < path_revs->nelts; ++m)
+            changed[APR_ARRAY_IDX(path_revs, m, svn_revnum_t)] = TRUE;
+        }
+
+      expected = apr_array_make(subpool, 4, sizeof(svn_revnum_t));
+      for (rev = youngest_rev; rev >= start; --rev)
+        if (changed[rev])
+          APR_ARRAY_PUSH(expected, svn_revnum_t) = rev;
+
+      SVN_ERR(compare_log_revs(revs, expected));
+      SVN_ERR(compare_log_revs(parallel_revs, expected));
+      SVN_ERR(compare_log_revs(read_ahead_revs, expected));
+      svn_pool_clear(subpool);
+    }
+
+  svn_pool_destroy(subpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Log receiver that appends the revision numbers to the svn_stringbuf_t
+   in BATON.  Revisions with merged children get a '*' appended, the end
+   of a list of merged children is shown as '-'. */
+static svn_error_t *
+log_tree_receiver(void *baton,
+                  svn_repos_log_entry_t *log_entry,
+                  apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *tree = baton;
+
+  if (tree->len)
+    svn_stringbuf_appendbyte(tree, ' ');
+
+  if (SVN_IS_VALID_REVNUM(log_entry->revision))
+    svn_stringbuf_appendcstr(tree, apr_psprintf(scratch_pool, "%ld%s",
+                                                log_entry->revision,
+                                                log_entry->has_children
+                                                  ? "*" : ""));
+  else
+    svn_stringbuf_appendbyte(tree, '-');
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+get_logs_merged_revisions(const svn_test_opts_t *opts,
+                          apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root, *rev_root;
+  svn_revnum_t youngest_rev = 0;
+  apr_pool_t *subpool = svn_pool_create(pool);
+  apr_array_header_t *paths = apr_array_make(pool, 1, sizeof(const char *));
+  svn_stringbuf_t *tree;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-get-logs-merged-revs",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  /* r1: The Greek tree. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  svn_pool_clear(subpool);
+
+  /* r2: Branch /A. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_copy(rev_root, "/A", txn_root, "/branch", subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  svn_pool_clear(subpool);
+
+  /* r3: Change both, /A and /branch. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "/A/mu", "r3", subpool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "/branch/mu", "r3",
+                                      subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  svn_pool_clear(subpool);
+
+  /* r4: Change /branch only. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "/branch/B/lambda", "r4",
+                                      subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  svn_pool_clear(subpool);
+
+  /* r5: Merge r3 and r4 from /branch into /A. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "/A/B/lambda", "r4",
+                                      subpool));
+  SVN_ERR(svn_fs_change_node_prop(txn_root, "/A", SVN_PROP_MERGEINFO,
+                                  svn_string_create("/branch:3-4", subpool),
+                                  subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  svn_pool_clear(subpool);
+
+  APR_ARRAY_PUSH(paths, const char *) = "/A";
+
+  /* The mergeinfo changes of r3 get looked up twice: as merged revision
+     of r5 and in the history of /A.  The second lookup is served from
+     the per-request index and must still find no mergeinfo changes. */
+  tree = svn_stringbuf_create_empty(pool);
+  SVN_ERR(svn_repos_get_logs5(repos, paths, youngest_rev, 0, 0,
+                              FALSE, TRUE, NULL, NULL, NULL, NULL, NULL,
+                              log_tree_receiver, tree, pool));
+  SVN_TEST_STRING_ASSERT(tree->data, "5* 4 3 - 3 1");
+
+  /* Without merged revisions, no index gets used. */
+  tree = svn_stringbuf_create_empty(pool);
+  SVN_ERR(svn_repos_get_logs5(repos, paths, youngest_rev, 0, 0,
+                              FALSE, FALSE, NULL, NULL, NULL, NULL, NULL,
+                              log_tree_receiver, tree, pool));
+  SVN_TEST_STRING_ASSERT(tree->data, "5 3 1");
+
+  /* Starting at r3, its lookup misses the index.  The result must be the
+     same as for the cached lookup above. */
+  tree = svn_stringbuf_create_empty(pool);
+  SVN_ERR(svn_repos_get_logs5(repos, paths, 3, 0, 0,
+                              FALSE, TRUE, NULL, NULL, NULL, NULL, NULL,
+                              log_tree_receiver, tree, pool));
+  SVN_TEST_STRING_ASSERT(tree->data, "3 1");
+
+  svn_pool_destroy(subpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Test that the reporter handles large reports that don't arrive in
+   depth-first order, including skipping the reports below a deleted
+   directory and honoring excluded paths. */
+static svn_error_t *
+reporter_unsorted_report(const svn_test_opts_t *opts,
+                         apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev;
+  const svn_delta_editor_t *editor;
+  void *edit_baton, *report_baton;
+  const char *other_paths[] = { "A/mu", "A/B/lambda", "A/D/gamma", "A/C",
+                                "iota" };
+  int i;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-reporter-unsorted",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  /* r1: the greek tree plus a directory with many files. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_fs_make_dir(txn_root, "big", pool));
+  for (i = 0; i < 40; ++i)
+    {
+      const char *path = apr_psprintf(pool, "big/f%02d", i);
+      SVN_ERR(svn_fs_make_file(txn_root, path, pool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, path, path, pool));
+    }
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  /* r2: remove that directory and change iota and A/D/G/pi. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_fs_delete(txn_root, "big", pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "iota",
+                                      "Changed file 'iota'.\n", pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/D/G/pi",
+                                      "Changed file 'pi'.\n", pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  /* Update from r1 to r2 with a report that lists the files in reverse
+     order, interleaved with other paths.  Exclude A/D/G in the middle
+     of it, so that its record does not start a restart interval. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 1, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(dir_delta_get_editor(&editor, &edit_baton, fs,
+                               txn_root, "", pool));
+
+  SVN_ERR(svn_repos_begin_report3(&report_baton, 2, repos, "/", "", NULL,
+                                  TRUE, svn_depth_infinity, FALSE, FALSE,
+                                  editor, edit_baton, NULL, NULL, 0,
+                                  pool));
+  SVN_ERR(svn_repos_set_path3(report_baton, "", 1, svn_depth_infinity,
+                              FALSE, NULL, pool));
+  for (i = 39; i >= 0; --i)
+    {
+      SVN_ERR(svn_repos_set_path3(report_baton,
+                                  apr_psprintf(pool, "big/f%02d", i), 1,
+                                  svn_depth_infinity, FALSE, NULL, pool));
+      if (i % 8 == 0)
+        SVN_ERR(svn_repos_set_path3(report_baton, other_paths[i / 8], 1,
+                                    svn_depth_infinity, FALSE, NULL, pool));
+      if (i == 21)
+        SVN_ERR(svn_repos_set_path3(report_baton, "A/D/G",
+                                    SVN_INVALID_REVNUM, svn_depth_exclude,
+                                    FALSE, NULL, pool));
+    }
+  SVN_ERR(svn_repos_finish_report(report_baton, pool));
+
+  /* The txn should now match r2, except for the excluded A/D/G. */
+  {
+    static svn_test__tree_entry_t entries[] = {
+      { "iota",        "Changed file 'iota'.\n" },
+      { "A",           0 },
+      { "A/mu",        "This is the file 'mu'.\n" },
+      { "A/B",         0 },
+      { "A/B/lambda",  "This is the file 'lambda'.\n" },
+      { "A/B/E",       0 },
+      { "A/B/E/alpha", "This is the file 'alpha'.\n" },
+      { "A/B/E/beta",  "This is the file 'beta'.\n" },
+      { "A/B/F",       0 },
+      { "A/C",         0 },
+      { "A/D",         0 },
+      { "A/D/gamma",   "This is the file 'gamma'.\n" },
+      { "A/D/G",       0 },
+      { "A/D/G/pi",    "This is the file 'pi'.\n" },
+      { "A/D/G/rho",   "This is the file 'rho'.\n" },
+      { "A/D/G/tau",   "This is the file 'tau'.\n" },
+      { "A/D/H",       0 },
+      { "A/D/H/chi",   "This is the file 'chi'.\n" },
+      { "A/D/H/psi",   "This is the file 'psi'.\n" },
+      { "A/D/H/omega", "This is the file 'omega'.\n" }
+    };
+    SVN_ERR(svn_test__validate_tree(txn_root,
+                                    entries,
+                                    sizeof(entries)/sizeof(entries[0]),
+                                    pool));
+  }
+
+  SVN_ERR(svn_fs_abort_txn(txn, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Test that the reporter handles reports that are too large to be kept
+   in memory, including skipping the reports below a deleted directory. */
+static svn_error_t *
+reporter_spilled_report(const svn_test_opts_t *opts,
+                        apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev;
+  const svn_delta_editor_t *editor;
+  void *edit_baton, *report_baton;
+  svn_stringbuf_t *lock_token;
+  /* All files of the greek tree in depth-first order. */
+  const char *files[] = { "A/B/E/alpha", "A/B/E/beta", "A/B/lambda",
+                          "A/D/G/pi", "A/D/G/rho", "A/D/G/tau",
+                          "A/D/H/chi", "A/D/H/omega", "A/D/H/psi",
+                          "A/D/gamma", "A/mu", "iota" };
+  int i;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-reporter-spilled",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  /* r1: the greek tree. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  /* r2: remove A/B and change iota. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_fs_delete(txn_root, "A/B", pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "iota",
+                                      "Changed file 'iota'.\n", pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  /* Update from r1 to r2.  Huge (and defunct) lock tokens make the report
+     exceed the reporter's in-memory limit of a few MB. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 1, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(dir_delta_get_editor(&editor, &edit_baton, fs,
+                               txn_root, "", pool));
+
+  lock_token = svn_stringbuf_create("opaquelocktoken:", pool);
+  while (lock_token->len < 500000)
+    svn_stringbuf_appendcstr(lock_token, "0123456789abcdef");
+
+  SVN_ERR(svn_repos_begin_report3(&report_baton, 2, repos, "/", "", NULL,
+                                  TRUE, svn_depth_infinity, FALSE, FALSE,
+                                  editor, edit_baton, NULL, NULL, 0,
+                                  pool));
+  SVN_ERR(svn_repos_set_path3(report_baton, "", 1, svn_depth_infinity,
+                              FALSE, NULL, pool));
+  for (i = 0; i < sizeof(files) / sizeof(files[0]); ++i)
+    SVN_ERR(svn_repos_set_path3(report_baton, files[i], 1,
+                                svn_depth_infinity, FALSE,
+                                lock_token->data, pool));
+  SVN_ERR(svn_repos_finish_report(report_baton, pool));
+
+  /* The txn should now match r2. */
+  {
+    static svn_test__tree_entry_t entries[] = {
+      { "iota",        "Changed file 'iota'.\n" },
+      { "A",           0 },
+      { "A/mu",        "This is the file 'mu'.\n" },
+      { "A/C",         0 },
+      { "A/D",         0 },
+      { "A/D/gamma",   "This is the file 'gamma'.\n" },
+      { "A/D/G",       0 },
+      { "A/D/G/pi",    "This is the file 'pi'.\n" },
+      { "A/D/G/rho",   "This is the file 'rho'.\n" },
+      { "A/D/G/tau",   "This is the file 'tau'.\n" },
+      { "A/D/H",       0 },
+      { "A/D/H/chi",   "This is the file 'chi'.\n" },
+      { "A/D/H/psi",   "This is the file 'psi'.\n" },
+      { "A/D/H/omega", "This is the file 'omega'.\n" }
+    };
+    SVN_ERR(svn_test__validate_tree(txn_root,
+                                    entries,
+                                    sizeof(entries)/sizeof(entries[0]),
+                                    pool));
+  }
+
+  SVN_ERR(svn_fs_abort_txn(txn, pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* The test table.  */
 
 static int max_threads = 4;
@@ -4539,6 +5476,20 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "optional authz wildcard performance test"),
     SVN_TEST_OPTS_PASS(test_list,
                        "test svn_repos_list"),
+    SVN_TEST_OPTS_PASS(get_logs_cached,
+                       "test svn_repos_get_logs5 with history cache"),
+    SVN_TEST_OPTS_PASS(get_logs_cached_recreated,
+                       "test history cache of a re-created repository"),
+    SVN_TEST_OPTS_PASS(get_logs_many_paths,
+                       "test svn_repos_get_logs5 with many paths"),
+    SVN_TEST_OPTS_PASS(get_logs_merged_revisions,
+                       "test svn_repos_get_logs5 with merged revisions"),
+    SVN_TEST_OPTS_PASS(reporter_unsorted_report,
+                       "test reporter with unsorted large report"),
+    SVN_TEST_OPTS_PASS(reporter_spilled_report,
+                       "test reporter with report spilled to disk"),
+    SVN_TEST_OPTS_PASS(get_file_blame,
+                       "test svn_repos__get_file_blame"),
     SVN_TEST_NULL
   };
 
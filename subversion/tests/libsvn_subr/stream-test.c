@@ -772,6 +772,42 @@ test_stream_base64_2(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Encode all byte values, so that every entry of the encoding tables
+   is used at least once, and compare against a known result. */
+static svn_error_t *
+test_base64_all_bytes(apr_pool_t *pool)
+{
+  const char *expected =
+    "AAECAwQFBgcICQoLDA0ODxAREhMUFRYXGBkaGx"
+    "wdHh8gISIjJCUmJygpKissLS4vMDEyMzQ1Njc4\n"
+    "OTo7PD0+P0BBQkNERUZHSElKS0xNTk9QUVJTVF"
+    "VWV1hZWltcXV5fYGFiY2RlZmdoaWprbG1ub3Bx\n"
+    "cnN0dXZ3eHl6e3x9fn+AgYKDhIWGh4iJiouMjY"
+    "6PkJGSk5SVlpeYmZqbnJ2en6ChoqOkpaanqKmq\n"
+    "q6ytrq+wsbKztLW2t7i5uru8vb6/wMHCw8TFxs"
+    "fIycrLzM3Oz9DR0tPU1dbX2Nna29zd3t/g4eLj\n"
+    "5OXm5+jp6uvs7e7v8PHy8/T19vf4+fr7/P3+/w==\n";
+  char bytes[256];
+  svn_string_t original;
+  const svn_string_t *encoded;
+  const svn_string_t *decoded;
+  int i;
+
+  for (i = 0; i < sizeof(bytes); i++)
+    bytes[i] = (char)i;
+
+  original.data = bytes;
+  original.len = sizeof(bytes);
+
+  encoded = svn_base64_encode_string2(&original, TRUE, pool);
+  SVN_TEST_STRING_ASSERT(encoded->data, expected);
+
+  decoded = svn_base64_decode_string(encoded, pool);
+  SVN_TEST_ASSERT(svn_string_compare(decoded, &original));
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 test_stringbuf_from_stream(apr_pool_t *pool)
 {
@@ -1104,6 +1140,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test reading CRLF-terminated lines from file"),
     SVN_TEST_PASS2(test_stream_readline_file_nul,
                    "test reading line from file with nul bytes"),
+    SVN_TEST_PASS2(test_base64_all_bytes,
+                   "base64 encoding of all byte values"),
     SVN_TEST_NULL
   };
 
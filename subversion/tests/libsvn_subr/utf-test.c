@@ -215,6 +215,51 @@ utf_validate2(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Test that the validators find multi-byte chars and invalid octets
+   at any position between long ASCII runs. */
+static svn_error_t *
+utf_validate_ascii_runs(apr_pool_t *pool)
+{
+  static const struct {
+    const char *seq;
+    svn_boolean_t valid;
+  } inserts[] = {
+    { "\xC5\x81", TRUE },
+    { "\xE5\x81\x81", TRUE },
+    { "\xF2\x91\x81\x81", TRUE },
+    { "\x80", FALSE },
+    { "\xE5\x81", FALSE },
+    { "\xFF", FALSE },
+  };
+  int i;
+  apr_size_t pos;
+
+  for (i = 0; i < sizeof(inserts) / sizeof(inserts[0]); ++i)
+    for (pos = 0; pos < 40; ++pos)
+      {
+        char str[100];
+        apr_size_t seq_len = strlen(inserts[i].seq);
+        apr_size_t len;
+        const char *expected;
+
+        /* ASCII, a multi-byte char, more ASCII, the insert, more ASCII. */
+        memset(str, 'a', sizeof(str));
+        memcpy(str + 13, "\xC3\xA4", 2);
+        memcpy(str + 20 + pos, inserts[i].seq, seq_len);
+        len = 20 + pos + seq_len + 23;
+
+        expected = inserts[i].valid ? str + len : str + 20 + pos;
+        if (svn_utf__last_valid(str, len) != expected
+            || svn_utf__last_valid2(str, len) != expected
+            || svn_utf__is_valid(str, len) != inserts[i].valid)
+          return svn_error_createf
+            (SVN_ERR_TEST_FAILED, NULL,
+             "insert %d at offset %d failed", i, (int)(20 + pos));
+      }
+
+  return SVN_NO_ERROR;
+}
+
 /* Test conversion from different codepages to utf8. */
 static svn_error_t *
 test_utf_cstring_to_utf8_ex2(apr_pool_t *pool)
@@ -1028,6 +1073,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test svn_utf__normalize"),
     SVN_TEST_PASS2(test_utf_xfrm,
                    "test svn_utf__xfrm"),
+    SVN_TEST_PASS2(utf_validate_ascii_runs,
+                   "test validation across ASCII runs"),
     SVN_TEST_NULL
   };
 
@@ -20,7 +20,9 @@
  * ====================================================================
  */
 
+#include <string.h>
 #include <apr.h>
+#include <apr_strings.h>
 
 #include "svn_pools.h"
 #include "svn_string.h"
@@ -332,6 +334,53 @@ test_xml_doctype_declaration(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+test_xml_escape_word_boundaries(apr_pool_t *pool)
+{
+  static const char plain[] = "0123456789abcdef\xc3\xa4"
+                              "0123456789abcdef-";
+  static const char specials[] = "&<>\"'\r\n\t";
+  static const char *cdata_quoted[] =
+    { "&amp;", "&lt;", "&gt;", "\"", "'", "&#13;", "\n", "\t" };
+  static const char *attr_quoted[] =
+    { "&amp;", "&lt;", "&gt;", "&quot;", "&apos;", "&#13;", "&#10;", "&#9;" };
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i, k;
+
+  /* Put each special char at every position of a text spanning several
+     machine words, so the word-wise scan has to find it everywhere. */
+  for (i = 0; i < (int)strlen(specials); ++i)
+    for (k = 0; k < (int)strlen(plain); ++k)
+      {
+        svn_stringbuf_t *text;
+        svn_stringbuf_t *cdata = NULL;
+        svn_stringbuf_t *attr = NULL;
+        const char *expected;
+
+        svn_pool_clear(iterpool);
+        text = svn_stringbuf_create(plain, iterpool);
+        text->data[k] = specials[i];
+
+        svn_xml_escape_cdata_stringbuf(&cdata, text, iterpool);
+        expected = apr_pstrcat(iterpool,
+                               apr_pstrndup(iterpool, text->data, k),
+                               cdata_quoted[i], text->data + k + 1,
+                               SVN_VA_NULL);
+        SVN_TEST_STRING_ASSERT(cdata->data, expected);
+
+        svn_xml_escape_attr_stringbuf(&attr, text, iterpool);
+        expected = apr_pstrcat(iterpool,
+                               apr_pstrndup(iterpool, text->data, k),
+                               attr_quoted[i], text->data + k + 1,
+                               SVN_VA_NULL);
+        SVN_TEST_STRING_ASSERT(attr->data, expected);
+      }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 /* The test table.  */
 static int max_threads = 1;
 
@@ -354,6 +403,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test XML custom entity expansion"),
     SVN_TEST_PASS2(test_xml_doctype_declaration,
                    "test XML doctype declaration"),
+    SVN_TEST_PASS2(test_xml_escape_word_boundaries,
+                   "test XML escaping at word boundaries"),
     SVN_TEST_NULL
   };
 